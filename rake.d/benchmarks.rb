@@ -0,0 +1,23 @@
+#!/usr/bin/env ruby
+
+namespace :tests do
+  desc "Build the micro-benchmarks"
+  task :benchmarks => "tests/benchmarks/benchmarks"
+
+  desc "Build and run the micro-benchmarks"
+  task :run_benchmarks => 'tests:benchmarks' do
+    run "./tests/benchmarks/benchmarks #{ENV['BENCHMARKS']}"
+  end
+end
+
+$build_system_modules[:benchmarks] = {
+  :define_tasks => lambda do
+    Application.
+      new("tests/benchmarks/benchmarks").
+      description("Build the micro-benchmarks executable").
+      aliases(:benchmarks).
+      sources([ "tests/benchmarks" ], :type => :dir).
+      libraries(:mtxmerge, :mtxinput, :mtxoutput, :mtxmerge, $common_libs, :avi, :rmff, :mpegparser, :flac, :vorbis, :ogg, $custom_libs, :pthread).
+      create
+  end,
+}
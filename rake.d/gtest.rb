@@ -1,6 +1,6 @@
 #!/usr/bin/env ruby
 
-$gtest_apps     = %w{common merge propedit}
+$gtest_apps     = %w{common extract info merge propedit}
 $gtest_internal = c(:GTEST_TYPE) == "internal"
 
 namespace :tests do
@@ -24,8 +24,10 @@ $build_system_modules[:gtest] = {
   :define_tasks => lambda do
     gtest_libs = {
       'common'   => [],
+      'extract'  => [ :mtxextract, :avi, :rmff, :vorbis, :ogg ],
+      'info'     => [ :mtxinfo ],
       'propedit' => [ :mtxpropedit ],
-      'merge'    => [ :mtxmerge ],
+      'merge'    => [ :mtxmerge, :mtxinput, :mtxoutput, :mtxmerge, :avi, :rmff, :mpegparser, :flac, :vorbis, :ogg ],
     }
 
     #
@@ -17,82 +17,129 @@
 
 zlib_compressor_c::zlib_compressor_c()
   : compressor_c(COMPRESSION_ZLIB)
+  , m_c_stream_initialized{}
+  , m_d_stream_initialized{}
+  , m_decompression_ratio{4.0}
 {
 }
 
 zlib_compressor_c::~zlib_compressor_c() {
+  if (m_c_stream_initialized)
+    deflateEnd(&m_c_stream);
+  if (m_d_stream_initialized)
+    inflateEnd(&m_d_stream);
 }
 
+/** \brief Decompresses a buffer with an inflate stream that is reused
+
+   The stream is only initialized for the first buffer and merely
+   reset for all following ones. The output buffer is sized according
+   to the ratio seen for the previous buffer and doubled whenever it
+   turns out to be too small.
+*/
 memory_cptr
 zlib_compressor_c::do_decompress(memory_cptr const &buffer) {
-  z_stream d_stream;
+  int result;
+
+  if (!m_d_stream_initialized) {
+    memset(&m_d_stream, 0, sizeof(m_d_stream));
+
+    m_d_stream.zalloc = (alloc_func)0;
+    m_d_stream.zfree  = (free_func)0;
+    m_d_stream.opaque = (voidpf)0;
+    result            = inflateInit2(&m_d_stream, 15 + 32); // 15: window size; 32: look for zlib/gzip headers automatically
 
-  d_stream.zalloc = (alloc_func)0;
-  d_stream.zfree  = (free_func)0;
-  d_stream.opaque = (voidpf)0;
-  int result      = inflateInit2(&d_stream, 15 + 32); // 15: window size; 32: look for zlib/gzip headers automatically
+    if (Z_OK != result)
+      mxerror(boost::format(Y("inflateInit() failed. Result: %1%\n")) % result);
 
-  if (Z_OK != result)
-    mxerror(boost::format(Y("inflateInit() failed. Result: %1%\n")) % result);
+    m_d_stream_initialized = true;
 
-  d_stream.next_in   = reinterpret_cast<Bytef *>(buffer->get_buffer());
-  d_stream.avail_in  = buffer->get_size();
-  int n              = 0;
-  memory_cptr dst    = memory_c::alloc(0);
+  } else
+    inflateReset(&m_d_stream);
 
-  do {
-    n++;
-    dst->resize(n * 4000);
-    d_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + (n - 1) * 4000);
-    d_stream.avail_out = 4000;
-    result             = inflate(&d_stream, Z_NO_FLUSH);
+  auto in_size         = buffer->get_size();
+  memory_cptr dst      = memory_c::alloc(static_cast<size_t>(in_size * m_decompression_ratio) + 1024);
 
-    if ((Z_OK != result) && (Z_STREAM_END != result))
+  m_d_stream.next_in   = reinterpret_cast<Bytef *>(buffer->get_buffer());
+  m_d_stream.avail_in  = in_size;
+  m_d_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer());
+  m_d_stream.avail_out = dst->get_size();
+
+  while (true) {
+    result = inflate(&m_d_stream, Z_NO_FLUSH);
+
+    if (Z_STREAM_END == result)
+      break;
+
+    if ((Z_OK != result) && (Z_BUF_ERROR != result))
       throw mtx::compression_x(boost::format(Y("Zlib decompression failed. Result: %1%\n")) % result);
 
-  } while ((0 == d_stream.avail_out) && (0 != d_stream.avail_in) && (Z_STREAM_END != result));
+    // Space left in the output buffer means that all of the input
+    // has been consumed without reaching the end of the stream.
+    if (0 != m_d_stream.avail_out)
+      throw mtx::compression_x(Y("Zlib decompression failed: the compressed data is truncated.\n"));
+
+    auto old_size = dst->get_size();
+    dst->resize(2 * old_size);
 
-  dst->resize(d_stream.total_out);
-  inflateEnd(&d_stream);
+    m_d_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + old_size);
+    m_d_stream.avail_out = old_size;
+  }
 
-  mxverb(3, boost::format("zlib_compressor_c: Decompression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / buffer->get_size()));
+  dst->resize(m_d_stream.total_out);
+
+  if (in_size)
+    m_decompression_ratio = static_cast<double>(dst->get_size()) / in_size;
+
+  mxverb(3, boost::format("zlib_compressor_c: Decompression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / std::max<size_t>(buffer->get_size(), 1)));
 
   return dst;
 }
 
+/** \brief Compresses a buffer with a deflate stream that is reused
+
+   The stream is only initialized for the first buffer and merely
+   reset for all following ones. The output is allocated once with
+   the maximum size that \c deflateBound() reports so that the whole
+   buffer can be compressed in a single call.
+
+   Errors are thrown as \c mtx::compression_x as this may run on the
+   compression pool's workers.
+*/
 memory_cptr
 zlib_compressor_c::do_compress(memory_cptr const &buffer) {
-  z_stream c_stream;
+  int result;
+
+  if (!m_c_stream_initialized) {
+    memset(&m_c_stream, 0, sizeof(m_c_stream));
+
+    m_c_stream.zalloc = (alloc_func)0;
+    m_c_stream.zfree  = (free_func)0;
+    m_c_stream.opaque = (voidpf)0;
+    result            = deflateInit(&m_c_stream, 9);
 
-  c_stream.zalloc = (alloc_func)0;
-  c_stream.zfree  = (free_func)0;
-  c_stream.opaque = (voidpf)0;
-  int result      = deflateInit(&c_stream, 9);
+    if (Z_OK != result)
+      throw mtx::compression_x(boost::format(Y("deflateInit() failed. Result: %1%\n")) % result);
 
-  if (Z_OK != result)
-    mxerror(boost::format(Y("deflateInit() failed. Result: %1%\n")) % result);
+    m_c_stream_initialized = true;
 
-  c_stream.next_in   = (Bytef *)buffer->get_buffer();
-  c_stream.avail_in  = buffer->get_size();
-  int n              = 0;
-  memory_cptr dst    = memory_c::alloc(0);
+  } else
+    deflateReset(&m_c_stream);
 
-  do {
-    n++;
-    dst->resize(n * 4000);
-    c_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + (n - 1) * 4000);
-    c_stream.avail_out = 4000;
-    result             = deflate(&c_stream, Z_FINISH);
+  memory_cptr dst      = memory_c::alloc(deflateBound(&m_c_stream, buffer->get_size()));
 
-    if ((Z_OK != result) && (Z_STREAM_END != result))
-      mxerror(boost::format(Y("Zlib decompression failed. Result: %1%\n")) % result);
+  m_c_stream.next_in   = (Bytef *)buffer->get_buffer();
+  m_c_stream.avail_in  = buffer->get_size();
+  m_c_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer());
+  m_c_stream.avail_out = dst->get_size();
+  result               = deflate(&m_c_stream, Z_FINISH);
 
-  } while ((c_stream.avail_out == 0) && (result != Z_STREAM_END));
+  if (Z_STREAM_END != result)
+    throw mtx::compression_x(boost::format(Y("Zlib compression failed. Result: %1%\n")) % result);
 
-  dst->resize(c_stream.total_out);
-  deflateEnd(&c_stream);
+  dst->resize(m_c_stream.total_out);
 
-  mxverb(3, boost::format("zlib_compressor_c: Compression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / buffer->get_size()));
+  mxverb(3, boost::format("zlib_compressor_c: Compression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / std::max<size_t>(buffer->get_size(), 1)));
 
   return dst;
 }
@@ -21,6 +21,11 @@
 #include "common/compression.h"
 
 class zlib_compressor_c: public compressor_c {
+protected:
+  z_stream m_c_stream, m_d_stream;
+  bool m_c_stream_initialized, m_d_stream_initialized;
+  double m_decompression_ratio;
+
 public:
   zlib_compressor_c();
   virtual ~zlib_compressor_c();
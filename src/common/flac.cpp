@@ -21,6 +21,8 @@
 #include <stdarg.h>
 
 #include "common/bit_cursor.h"
+#include "common/checksums/base.h"
+#include "common/endian.h"
 #include "common/flac.h"
 #include "common/mm_io_x.h"
 
@@ -250,6 +252,85 @@ get_num_samples(unsigned char const *mem,
   }
 }
 
+/** \brief Parses a frame header and validates its CRC-8
+
+   Unlike \c get_num_samples() this does not need the stream info and
+   rejects all reserved values. It is therefore suitable for finding
+   frames by scanning for their sync code.
+
+   See http://flac.sourceforge.net/format.html#frame_header
+
+   \return \c false if \c mem does not start with a valid frame header
+     or if \c size is too small to contain all of it.
+*/
+bool
+parse_frame_header(unsigned char const *mem,
+                   size_t size,
+                   frame_header_t &header) {
+  // Sync word, reserved bit and blocking strategy
+  if ((5 > size) || (0xff != mem[0]) || (0xf8 != (mem[1] & 0xfe)))
+    return false;
+
+  auto block_size_code  = mem[2] >> 4;
+  auto sample_rate_code = mem[2] & 0x0f;
+  auto channels_code    = mem[3] >> 4;
+  auto sample_size_code = (mem[3] >> 1) & 0x07;
+
+  if (   (0x0 == block_size_code)
+      || (0xf == sample_rate_code)
+      || (0xa <  channels_code)
+      || (0x3 == sample_size_code)
+      || (mem[3] & 0x01))
+    return false;
+
+  header.variable_block_size = mem[1] & 0x01;
+
+  // Frame or sample number coded like UTF-8 characters
+  auto pos      = size_t{4};
+  auto num_ones = 0u;
+  while ((8 > num_ones) && (mem[pos] & (0x80 >> num_ones)))
+    ++num_ones;
+
+  if ((1 == num_ones) || ((header.variable_block_size ? 7u : 6u) < num_ones))
+    return false;
+
+  auto num_continuation_bytes = num_ones ? num_ones - 1 : 0;
+  header.number               = mem[pos] & (0x7f >> num_ones);
+  ++pos;
+
+  if (size < (pos + num_continuation_bytes))
+    return false;
+
+  for (auto idx = 0u; idx < num_continuation_bytes; ++idx, ++pos) {
+    if (0x80 != (mem[pos] & 0xc0))
+      return false;
+    header.number = (header.number << 6) | (mem[pos] & 0x3f);
+  }
+
+  // Block size and sample rate stored at the end of the header
+  auto num_block_size_bytes  = 6 == block_size_code ? 1 : 7 == block_size_code ? 2 : 0;
+  auto num_sample_rate_bytes = 12 == sample_rate_code ? 1 : (13 == sample_rate_code) || (14 == sample_rate_code) ? 2 : 0;
+
+  if (size < (pos + num_block_size_bytes + num_sample_rate_bytes + 1))
+    return false;
+
+  header.num_samples
+    = 1 == block_size_code ? 192
+    : 5 >= block_size_code ? 576 << (block_size_code - 2)
+    : 6 == block_size_code ? mem[pos] + 1
+    : 7 == block_size_code ? get_uint16_be(&mem[pos]) + 1
+    :                        256 << (block_size_code - 8);
+
+  pos += num_block_size_bytes + num_sample_rate_bytes;
+
+  if (mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc8_atm, mem, pos) != mem[pos])
+    return false;
+
+  header.size = pos + 1;
+
+  return true;
+}
+
 #define FPFX "flac_decode_headers: "
 
 struct header_extractor_t {
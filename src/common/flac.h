@@ -60,7 +60,15 @@ public:
   virtual void init_flac_decoder();
 };
 
+struct frame_header_t {
+  size_t size{};                // including the CRC-8
+  bool variable_block_size{};
+  uint64_t number{};            // frame number or, with variable block sizes, sample number
+  unsigned int num_samples{};
+};
+
 int get_num_samples(unsigned char const *buf, int size, FLAC__StreamMetadata_StreamInfo const &stream_info);
+bool parse_frame_header(unsigned char const *mem, size_t size, frame_header_t &header);
 int decode_headers(unsigned char const *mem, int size, int num_elements, ...);
 
 }}                              // namespace mtx::flac
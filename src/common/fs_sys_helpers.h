@@ -18,6 +18,7 @@
 namespace mtx { namespace sys {
 
 int64_t get_current_time_millis();
+int64_t get_current_thread_cpu_time_nanos();
 
 int system(std::string const &command);
 
@@ -17,6 +17,7 @@
 
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 
 #if defined(SYS_APPLE)
 # include <mach-o/dyld.h>
@@ -38,6 +39,19 @@ get_current_time_millis() {
   return (int64_t)tv.tv_sec * 1000 + (int64_t)tv.tv_usec / 1000;
 }
 
+int64_t
+get_current_thread_cpu_time_nanos() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (0 != clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+    return -1;
+
+  return (int64_t)ts.tv_sec * 1000000000ll + (int64_t)ts.tv_nsec;
+#else
+  return -1;
+#endif
+}
+
 bfs::path
 get_application_data_folder() {
   auto home = getenv("HOME");
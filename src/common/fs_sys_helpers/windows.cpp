@@ -37,6 +37,20 @@ get_current_time_millis() {
   return (int64_t)tb.time * 1000 + tb.millitm;
 }
 
+int64_t
+get_current_thread_cpu_time_nanos() {
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+    return -1;
+
+  // FILETIME values are given in units of 100ns.
+  auto to_nanos = [](FILETIME const &time) -> int64_t {
+    return ((static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+  };
+
+  return to_nanos(kernel_time) + to_nanos(user_time);
+}
+
 void
 set_environment_variable(const std::string &key,
                          const std::string &value) {
@@ -28,6 +28,7 @@
 #include "common/hacks.h"
 #include "common/mm_io.h"
 #include "common/hevc.h"
+#include "common/mpeg.h"
 #include "common/strings/formatting.h"
 
 namespace mtx { namespace hevc {
@@ -1570,62 +1571,15 @@ es_parser_c::discard_actual_frames(bool discard) {
 void
 es_parser_c::add_bytes(unsigned char *buffer,
                        size_t size) {
-  memory_slice_cursor_c cursor;
-  int marker_size              = 0;
-  int previous_marker_size     = 0;
-  int previous_pos             = -1;
   uint64_t previous_parsed_pos = m_parsed_position;
 
-  if (m_unparsed_buffer && (0 != m_unparsed_buffer->get_size()))
-    cursor.add_slice(m_unparsed_buffer);
-  cursor.add_slice(buffer, size);
-
-  if (3 <= cursor.get_remaining_size()) {
-    uint32_t marker =                               1 << 24
-                    | (unsigned int)cursor.get_char() << 16
-                    | (unsigned int)cursor.get_char() <<  8
-                    | (unsigned int)cursor.get_char();
-
-    while (1) {
-      if (NALU_START_CODE == marker)
-        marker_size = 4;
-      else if (NALU_START_CODE == (marker & 0x00ffffff))
-        marker_size = 3;
-
-      if (0 != marker_size) {
-        if (-1 != previous_pos) {
-          int new_size = cursor.get_position() - marker_size - previous_pos - previous_marker_size;
-          memory_cptr nalu(new memory_c(safemalloc(new_size), new_size, true));
-          cursor.copy(nalu->get_buffer(), previous_pos + previous_marker_size, new_size);
-          m_parsed_position = previous_parsed_pos + previous_pos;
-          handle_nalu(nalu);
-        }
-        previous_pos         = cursor.get_position() - marker_size;
-        previous_marker_size = marker_size;
-        marker_size          = 0;
-      }
-
-      if (!cursor.char_available())
-        break;
-
-      marker <<= 8;
-      marker  |= (unsigned int)cursor.get_char();
-    }
-  }
-
-  if (-1 == previous_pos)
-    previous_pos = 0;
+  auto unparsed_pos = mtx::mpeg::split_nalus(buffer, size, m_unparsed_buffer, [this, previous_parsed_pos](memory_cptr const &nalu, size_t offset) {
+    m_parsed_position = previous_parsed_pos + offset;
+    handle_nalu(nalu);
+  });
 
   m_stream_position += size;
-  m_parsed_position  = previous_parsed_pos + previous_pos;
-
-  int new_size = cursor.get_size() - previous_pos;
-  if (0 != new_size) {
-    m_unparsed_buffer = memory_cptr(new memory_c(safemalloc(new_size), new_size, true));
-    cursor.copy(m_unparsed_buffer->get_buffer(), previous_pos, new_size);
-
-  } else
-    m_unparsed_buffer.reset();
+  m_parsed_position  = previous_parsed_pos + unparsed_pos;
 }
 
 void
@@ -1697,6 +1651,8 @@ es_parser_c::flush_unhandled_nalus() {
 void
 es_parser_c::handle_slice_nalu(memory_cptr &nalu) {
   if (!m_hevcc_ready) {
+    // The NALU may only point into the buffer passed to add_bytes().
+    nalu->grab();
     m_unhandled_nalus.push_back(nalu);
     return;
   }
@@ -0,0 +1,196 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   per-stage timing instrumentation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <map>
+
+#include "common/debugging.h"
+#include "common/fs_sys_helpers.h"
+#include "common/instrumentation.h"
+#include "common/mm_io_x.h"
+
+namespace mtx { namespace instrumentation {
+
+namespace {
+
+std::mutex s_mutex;
+std::map<std::pair<std::string, std::string>, std::unique_ptr<counter_c>> s_counters;
+thread_local scope_c *tl_current_scope = nullptr;
+
+int64_t
+get_wall_nanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string
+escape_json(std::string const &s) {
+  std::string escaped;
+
+  for (auto c : s) {
+    if (('"' == c) || ('\\' == c))
+      escaped += std::string{"\\"} + c;
+    else if (0x20 > static_cast<unsigned char>(c))
+      escaped += (boost::format("\\u%|1$04x|") % static_cast<unsigned int>(static_cast<unsigned char>(c))).str();
+    else
+      escaped += c;
+  }
+
+  return escaped;
+}
+
+}
+
+counter_c::counter_c(std::string const &stage,
+                     std::string const &name)
+  : m_stage{stage}
+  , m_name{name}
+  , m_num_calls{}
+  , m_num_bytes{}
+  , m_wall_nanos{}
+  , m_cpu_nanos{}
+  , m_self_wall_nanos{}
+  , m_self_cpu_nanos{}
+{
+}
+
+// ------------------------------------------------------------
+
+scope_c::scope_c(counter_c *counter)
+  : m_counter{counter}
+  , m_parent{}
+  , m_wall_start{}
+  , m_cpu_start{}
+  , m_children_wall_nanos{}
+  , m_children_cpu_nanos{}
+  , m_num_bytes{}
+{
+  if (!m_counter)
+    return;
+
+  m_parent         = tl_current_scope;
+  tl_current_scope = this;
+  m_cpu_start      = mtx::sys::get_current_thread_cpu_time_nanos();
+  m_wall_start     = get_wall_nanos();
+}
+
+scope_c::~scope_c() {
+  if (!m_counter)
+    return;
+
+  auto wall_nanos = get_wall_nanos() - m_wall_start;
+  auto cpu_end    = mtx::sys::get_current_thread_cpu_time_nanos();
+  auto cpu_nanos  = (0 <= m_cpu_start) && (0 <= cpu_end) ? cpu_end - m_cpu_start : 0;
+
+  m_counter->m_num_calls       += 1;
+  m_counter->m_num_bytes       += m_num_bytes;
+  m_counter->m_wall_nanos      += wall_nanos;
+  m_counter->m_cpu_nanos       += cpu_nanos;
+  m_counter->m_self_wall_nanos += std::max<int64_t>(wall_nanos - m_children_wall_nanos, 0);
+  m_counter->m_self_cpu_nanos  += std::max<int64_t>(cpu_nanos  - m_children_cpu_nanos,  0);
+
+  if (m_parent) {
+    m_parent->m_children_wall_nanos += wall_nanos;
+    m_parent->m_children_cpu_nanos  += cpu_nanos;
+  }
+
+  tl_current_scope = m_parent;
+}
+
+// ------------------------------------------------------------
+
+bool
+enabled() {
+  static debugging_option_c s_debug{"instrumentation"};
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+  return s_debug;
+}
+
+/** \brief Returns the counter for an object's stage, creating it if necessary
+
+   \return \c nullptr if instrumentation is not active.
+*/
+counter_c *
+get_counter(std::string const &stage,
+            std::string const &name) {
+  if (!enabled())
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+
+  auto &counter = s_counters[std::make_pair(stage, name)];
+  if (!counter)
+    counter.reset(new counter_c{stage, name});
+
+  return counter.get();
+}
+
+/** \brief Outputs the accumulated statistics as a JSON document
+
+   The report is written to the file given as the argument of the
+   debugging option (e.g. \c --debug instrumentation=report.json) or
+   output like other debugging messages if no argument is given.
+*/
+void
+dump_report() {
+  if (!enabled())
+    return;
+
+  std::string report = "{\n  \"stages\": [";
+
+  {
+    std::lock_guard<std::mutex> lock{s_mutex};
+
+    auto first = true;
+    for (auto const &pair : s_counters) {
+      auto const &counter = *pair.second;
+      if (!counter.m_num_calls)
+        continue;
+
+      report += (boost::format("%1%\n    { \"stage\": \"%2%\", \"name\": \"%3%\", \"calls\": %4%, \"bytes\": %5%, "
+                               "\"wall_ns\": %6%, \"cpu_ns\": %7%, \"self_wall_ns\": %8%, \"self_cpu_ns\": %9% }")
+                 % (first ? "" : ",")
+                 % escape_json(counter.m_stage)
+                 % escape_json(counter.m_name)
+                 % counter.m_num_calls.load()
+                 % counter.m_num_bytes.load()
+                 % counter.m_wall_nanos.load()
+                 % counter.m_cpu_nanos.load()
+                 % counter.m_self_wall_nanos.load()
+                 % counter.m_self_cpu_nanos.load()).str();
+      first = false;
+    }
+  }
+
+  report += "\n  ]\n}\n";
+
+  std::string file_name;
+  debugging_c::requested("instrumentation", &file_name);
+
+  if (file_name.empty()) {
+    debugging_c::output(report);
+    return;
+  }
+
+  try {
+    mm_file_io_c out{file_name, MODE_CREATE};
+    out.puts(report);
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxwarn(boost::format(Y("The instrumentation report could not be written to '%1%': %2%\n")) % file_name % ex);
+  }
+}
+
+}}
@@ -0,0 +1,75 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   definitions for the per-stage timing instrumentation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_INSTRUMENTATION_H
+#define MTX_COMMON_INSTRUMENTATION_H
+
+#include "common/common_pch.h"
+
+#include <atomic>
+
+namespace mtx { namespace instrumentation {
+
+/** \brief Accumulated statistics for one stage of one object
+
+   A stage is a kind of work, e.g. "read" for a reader's \c read()
+   function; the name identifies the object doing the work, e.g. the
+   file being read. Counters are never deleted once created so that
+   callers can keep pointers to them.
+
+   The "self" times exclude the time spent in nested scopes on the same
+   thread, e.g. a packetizer's \c process() called from within its
+   reader's \c read().
+*/
+class counter_c {
+public:
+  std::string const m_stage, m_name;
+  std::atomic<uint64_t> m_num_calls, m_num_bytes;
+  std::atomic<int64_t> m_wall_nanos, m_cpu_nanos, m_self_wall_nanos, m_self_cpu_nanos;
+
+public:
+  counter_c(std::string const &stage, std::string const &name);
+};
+
+/** \brief Measures the time between its construction and destruction
+
+   Does nothing if \c counter is \c nullptr which is what \c
+   get_counter() returns if instrumentation is not active. Scopes must
+   be nested properly on each thread, which is always the case if they
+   are only created on the stack.
+*/
+class scope_c {
+protected:
+  counter_c *m_counter;
+  scope_c *m_parent;
+  int64_t m_wall_start, m_cpu_start, m_children_wall_nanos, m_children_cpu_nanos;
+  uint64_t m_num_bytes;
+
+public:
+  explicit scope_c(counter_c *counter);
+  ~scope_c();
+
+  void add_bytes(int64_t num_bytes) {
+    if (m_counter && (0 < num_bytes))
+      m_num_bytes += num_bytes;
+  }
+};
+
+bool enabled();
+counter_c *get_counter(std::string const &stage, std::string const &name);
+
+void dump_report();
+
+}}
+
+#endif // MTX_COMMON_INSTRUMENTATION_H
@@ -19,15 +19,19 @@
 #include <ebml/EbmlStream.h>
 #include <ebml/EbmlVoid.h>
 #include <matroska/KaxCluster.h>
+#include <matroska/KaxInfo.h>
+#include <matroska/KaxInfoData.h>
 #include <matroska/KaxSeekHead.h>
 #include <matroska/KaxSegment.h>
 #include <matroska/KaxTags.h>
 
 #include "common/ebml.h"
 #include "common/error.h"
+#include "common/checksums/base.h"
 #include "common/kax_analyzer.h"
 #include "common/mm_io_x.h"
 #include "common/strings/editing.h"
+#include "common/vint.h"
 
 using namespace libebml;
 using namespace libmatroska;
@@ -36,6 +40,20 @@ using namespace libmatroska;
 
 #define CONSOLE_PERCENTAGE_WIDTH 25
 
+// File format of the index cache: the magic, the size and modification
+// time of the Matroska file, the position of its segment, the CRC-32 of
+// the file's first and last 64 KB (32 bit each) and its segment UID (32
+// bit length followed by the bytes) followed by the number of entries
+// (64 bit) and the entries themselves. Each entry consists of the
+// element ID's value (32 bit), its length (8 bit), its position (64 bit)
+// and its size (64 bit). All numbers are big endian.
+static char const s_index_cache_magic[] = "MTXIDX02";
+static size_t const s_index_cache_magic_size     = 8;
+static size_t const s_index_cache_entry_size     = 4 + 1 + 8 + 8;
+static size_t const s_index_cache_checksum_range = 64 * 1024;
+
+bool kax_analyzer_c::s_index_cache_enabled = false;
+
 bool
 operator <(const kax_analyzer_data_cptr &d1,
            const kax_analyzer_data_cptr &d2) {
@@ -66,6 +84,9 @@ kax_analyzer_c::kax_analyzer_c(std::string file_name)
   , m_file(nullptr)
   , m_close_file(true)
   , m_stream(nullptr)
+  , m_use_index_cache{s_index_cache_enabled}
+  , m_data_is_complete{}
+  , m_data_from_index_cache{}
   , m_debugging_requested{"kax_analyzer"}
 {
 }
@@ -75,6 +96,9 @@ kax_analyzer_c::kax_analyzer_c(mm_file_io_c *file)
   , m_file(file)
   , m_close_file(false)
   , m_stream(nullptr)
+  , m_use_index_cache{s_index_cache_enabled}
+  , m_data_is_complete{}
+  , m_data_from_index_cache{}
   , m_debugging_requested{"kax_analyzer"}
 {
 }
@@ -154,6 +178,7 @@ kax_analyzer_c::validate_data_structures(const std::string &hook_name) {
 void
 kax_analyzer_c::verify_data_structures_against_file(const std::string &hook_name) {
   kax_analyzer_c actual_content(m_file);
+  actual_content.m_use_index_cache = false;
   actual_content.process();
 
   unsigned int num_items = std::max(m_data.size(), actual_content.m_data.size());
@@ -201,6 +226,28 @@ kax_analyzer_c::probe(std::string file_name) {
   }
 }
 
+/** \brief Enables or disables the on-disk index cache for all analyzers
+   created afterwards
+
+   If enabled then the list of level 1 elements found by a full scan is
+   stored next to the Matroska file (see \c get_index_cache_file_name).
+   Subsequent analyzers for the same file load that list instead of
+   scanning the whole file again as long as the file's size,
+   modification time, segment position and segment UID are unchanged
+   and all non-cluster elements are still located at their recorded
+   positions. The cache is rewritten after each successful
+   modification made by \c update_element or \c remove_elements.
+ */
+void
+kax_analyzer_c::enable_index_cache(bool enable) {
+  s_index_cache_enabled = enable;
+}
+
+std::string
+kax_analyzer_c::get_index_cache_file_name(std::string const &file_name) {
+  return file_name + ".mtxidx";
+}
+
 bool
 kax_analyzer_c::process(kax_analyzer_c::parse_mode_e parse_mode,
                         const open_mode mode,
@@ -254,6 +301,14 @@ kax_analyzer_c::process_internal(kax_analyzer_c::parse_mode_e parse_mode,
   }
 
   m_segment            = std::shared_ptr<KaxSegment>(static_cast<KaxSegment *>(l0));
+  m_data_is_complete      = false;
+  m_data_from_index_cache = false;
+
+  if (m_use_index_cache && read_index_cache()) {
+    show_progress_done();
+    return true;
+  }
+
   int upper_lvl_el     = 0;
   bool aborted         = false;
   bool cluster_found   = false;
@@ -297,6 +352,10 @@ kax_analyzer_c::process_internal(kax_analyzer_c::parse_mode_e parse_mode,
     if (parse_mode_full != parse_mode)
       fix_element_sizes(file_size);
 
+    m_data_is_complete = parse_fully;
+    if (m_use_index_cache && m_data_is_complete)
+      write_index_cache();
+
     return true;
   }
 
@@ -360,13 +419,17 @@ kax_analyzer_c::update_element(EbmlElement *e,
 
   } catch (kax_analyzer_c::update_element_result_e result) {
     debug_dump_elements_maybe("update_element_exception");
+    update_index_cache(result);
     return result;
 
   } catch (mtx::mm_io::exception &ex) {
     mxdebug_if(m_debugging_requested, boost::format("I/O exception: %1%\n") % ex.what());
+    update_index_cache(uer_error_unknown);
     return uer_error_unknown;
   }
 
+  update_index_cache(uer_success);
+
   return uer_success;
 }
 
@@ -383,9 +446,12 @@ kax_analyzer_c::remove_elements(EbmlId id) {
 
   } catch (kax_analyzer_c::update_element_result_e result) {
     debug_dump_elements_maybe("update_element_exception");
+    update_index_cache(result);
     return result;
   }
 
+  update_index_cache(uer_success);
+
   return uer_success;
 }
 
@@ -1127,6 +1193,219 @@ kax_analyzer_c::get_placement_strategy_for(EbmlElement *e) {
   return Is<KaxTags>(e) ? ps_end : ps_anywhere;
 }
 
+memory_cptr
+kax_analyzer_c::read_segment_uid() {
+  auto info_idx = find(EBML_ID(KaxInfo));
+  if (-1 == info_idx)
+    return memory_cptr{};
+
+  auto info = read_element(info_idx);
+  auto uid  = info ? FindChild<KaxSegmentUID>(*info) : nullptr;
+
+  return uid ? memory_c::clone(uid->GetBuffer(), uid->GetSize()) : memory_cptr{};
+}
+
+/** \brief Loads \c m_data from the index cache if it is still valid
+
+   The cache is only used if the size and the modification time of the
+   file, the checksums of its head and tail, the segment's position and
+   its UID match the values recorded in the cache. Additionally the IDs
+   of all non-cluster elements and of the first and the last cluster
+   are verified at their recorded positions. The other clusters are not
+   verified as there are usually far too many of them.
+
+   \return \c true if the cache was valid and \c m_data has been filled
+     from it and \c false otherwise, in which case \c m_data is empty.
+*/
+bool
+kax_analyzer_c::read_index_cache() {
+  auto cache_name = get_index_cache_file_name(m_file_name);
+  auto debug      = analyzer_debugging_requested("index_cache");
+
+  try {
+    if (!bfs::exists(bfs::path{cache_name}))
+      return false;
+
+    mm_file_io_c in{cache_name};
+
+    char magic[s_index_cache_magic_size];
+    if ((in.read(magic, s_index_cache_magic_size) != s_index_cache_magic_size) || memcmp(magic, s_index_cache_magic, s_index_cache_magic_size))
+      return false;
+
+    auto file_size     = in.read_uint64_be();
+    auto mtime         = static_cast<int64_t>(in.read_uint64_be());
+    auto segment_pos   = in.read_uint64_be();
+    auto head_checksum = in.read_uint32_be();
+    auto tail_checksum = in.read_uint32_be();
+
+    if (   (file_size   != static_cast<uint64_t>(m_file->get_size()))
+        || (mtime       != static_cast<int64_t>(bfs::last_write_time(bfs::path{m_file_name})))
+        || (segment_pos != m_segment->GetElementPosition())) {
+      mxdebug_if(debug, boost::format("index cache %1% is outdated\n") % cache_name);
+      return false;
+    }
+
+    // Catches modifications that kept the size and the modification
+    // time, e.g. in-place edits whose time stamp has been restored.
+    if (   (head_checksum != calculate_index_cache_checksum(false))
+        || (tail_checksum != calculate_index_cache_checksum(true))) {
+      mxdebug_if(debug, boost::format("index cache %1%: checksum mismatch\n") % cache_name);
+      return false;
+    }
+
+    auto uid_size = in.read_uint32_be();
+    auto uid      = uid_size ? memory_c::alloc(uid_size) : memory_cptr{};
+    if (uid && (in.read(uid, uid_size) != uid_size))
+      return false;
+
+    auto num_entries = in.read_uint64_be();
+    if ((num_entries * s_index_cache_entry_size) != (in.get_size() - in.getFilePointer()))
+      return false;
+
+    auto previous_pos = segment_pos;
+    m_data.reserve(num_entries);
+
+    for (auto idx = 0ull; idx < num_entries; ++idx) {
+      auto id_value  = in.read_uint32_be();
+      auto id_length = in.read_uint8();
+      auto pos       = in.read_uint64_be();
+      auto size      = static_cast<int64_t>(in.read_uint64_be());
+
+      if ((1 > id_length) || (4 < id_length) || (pos <= previous_pos) || (pos >= file_size) || (0 > size)) {
+        m_data.clear();
+        return false;
+      }
+
+      m_data.push_back(kax_analyzer_data_c::create(EbmlId(id_value, id_length), pos, size));
+      previous_pos = pos;
+    }
+
+    auto first_cluster = std::find_if(m_data.begin(),  m_data.end(),  [](kax_analyzer_data_cptr const &data) { return Is<KaxCluster>(data->m_id); });
+    auto last_cluster  = std::find_if(m_data.rbegin(), m_data.rend(), [](kax_analyzer_data_cptr const &data) { return Is<KaxCluster>(data->m_id); });
+
+    for (auto const &data : m_data) {
+      if (   Is<KaxCluster>(data->m_id)
+          && ((m_data.end()  == first_cluster) || (data != *first_cluster))
+          && ((m_data.rend() == last_cluster)  || (data != *last_cluster)))
+        continue;
+
+      m_file->setFilePointer(data->m_pos);
+      auto id = vint_c::read_ebml_id(m_file);
+
+      if (!id.is_valid() || (EbmlId(id) != data->m_id)) {
+        mxdebug_if(debug, boost::format("index cache %1%: element mismatch at %2%\n") % cache_name % data->m_pos);
+        m_data.clear();
+        return false;
+      }
+    }
+
+    auto actual_uid = read_segment_uid();
+    if ((!uid != !actual_uid) || (uid && !(*uid == *actual_uid))) {
+      mxdebug_if(debug, boost::format("index cache %1%: segment UID mismatch\n") % cache_name);
+      m_data.clear();
+      return false;
+    }
+
+    mxdebug_if(debug, boost::format("index cache %1% loaded with %2% entries\n") % cache_name % m_data.size());
+    m_data_is_complete      = true;
+    m_data_from_index_cache = true;
+
+    return true;
+
+  } catch (...) {
+    m_data.clear();
+    return false;
+  }
+}
+
+void
+kax_analyzer_c::write_index_cache() {
+  auto cache_name = get_index_cache_file_name(m_file_name);
+  auto temp_name  = cache_name + ".tmp";
+
+  try {
+    m_file->flush();
+
+    auto uid = read_segment_uid();
+
+    {
+      mm_file_io_c out{temp_name, MODE_CREATE};
+
+      out.write(s_index_cache_magic, s_index_cache_magic_size);
+      out.write_uint64_be(m_file->get_size());
+      out.write_uint64_be(static_cast<int64_t>(bfs::last_write_time(bfs::path{m_file_name})));
+      out.write_uint64_be(m_segment->GetElementPosition());
+      out.write_uint32_be(calculate_index_cache_checksum(false));
+      out.write_uint32_be(calculate_index_cache_checksum(true));
+      out.write_uint32_be(uid ? uid->get_size() : 0);
+      if (uid)
+        out.write(uid);
+
+      out.write_uint64_be(m_data.size());
+      for (auto const &data : m_data) {
+        out.write_uint32_be(EBML_ID_VALUE(data->m_id));
+        out.write_uint8(EBML_ID_LENGTH(data->m_id));
+        out.write_uint64_be(data->m_pos);
+        out.write_uint64_be(data->m_size);
+      }
+    }
+
+    bfs::rename(bfs::path{temp_name}, bfs::path{cache_name});
+
+    mxdebug_if(analyzer_debugging_requested("index_cache"), boost::format("index cache %1% written with %2% entries\n") % cache_name % m_data.size());
+
+  } catch (...) {
+    auto ec = boost::system::error_code{};
+    bfs::remove(bfs::path{temp_name}, ec);
+    remove_index_cache();
+  }
+}
+
+/** \brief Calculates the CRC-32 of the file's first or last 64 KB
+*/
+uint32_t
+kax_analyzer_c::calculate_index_cache_checksum(bool tail) {
+  auto file_size = static_cast<uint64_t>(m_file->get_size());
+  auto size      = std::min<uint64_t>(file_size, s_index_cache_checksum_range);
+  auto buffer    = memory_c::alloc(size);
+
+  m_file->setFilePointer(tail ? file_size - size : 0);
+  if (m_file->read(buffer, size) != size)
+    throw mtx::mm_io::end_of_file_x{};
+
+  return mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc32_ieee, *buffer);
+}
+
+bool
+kax_analyzer_c::is_data_from_index_cache()
+  const {
+  return m_data_from_index_cache;
+}
+
+void
+kax_analyzer_c::remove_index_cache() {
+  auto ec = boost::system::error_code{};
+  bfs::remove(bfs::path{get_index_cache_file_name(m_file_name)}, ec);
+}
+
+/** \brief Brings the index cache up to date after the file has been modified
+
+   After a successful modification \c m_data reflects the file's new
+   layout, and the cache is rewritten from it without having to scan the
+   file again. If the modification failed or \c m_data was only
+   gathered partially (fast parse mode) then the cache is removed.
+*/
+void
+kax_analyzer_c::update_index_cache(update_element_result_e result) {
+  if (!m_use_index_cache)
+    return;
+
+  if ((uer_success == result) && m_data_is_complete)
+    write_index_cache();
+  else
+    remove_index_cache();
+}
+
 uint64_t
 kax_analyzer_c::get_segment_pos()
   const {
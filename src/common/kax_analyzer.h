@@ -97,10 +97,15 @@ private:
   std::shared_ptr<KaxSegment> m_segment;
   std::map<int64_t, bool> m_meta_seeks_by_position;
   EbmlStream *m_stream;
+  bool m_use_index_cache, m_data_is_complete, m_data_from_index_cache;
   debugging_option_c m_debugging_requested;
 
+  static bool s_index_cache_enabled;
+
 public:                         // Static functions
   static bool probe(std::string file_name);
+  static void enable_index_cache(bool enable);
+  static std::string get_index_cache_file_name(std::string const &file_name);
 
 public:
   kax_analyzer_c(std::string file_name);
@@ -136,6 +141,7 @@ public:
   virtual uint64_t get_segment_data_start_pos() const;
 
   virtual bool process(parse_mode_e parse_mode = parse_mode_full, const open_mode mode = MODE_WRITE, bool throw_on_error = false);
+  virtual bool is_data_from_index_cache() const;
 
   virtual void show_progress_start(int64_t /* size */) {
   }
@@ -188,6 +194,13 @@ protected:
   virtual void read_meta_seek(uint64_t pos, std::map<int64_t, bool> &positions_found);
   virtual void fix_element_sizes(uint64_t file_size);
 
+  virtual memory_cptr read_segment_uid();
+  virtual bool read_index_cache();
+  virtual void write_index_cache();
+  virtual void remove_index_cache();
+  virtual uint32_t calculate_index_cache_checksum(bool tail);
+  virtual void update_index_cache(update_element_result_e result);
+
 protected:
   virtual bool process_internal(parse_mode_e parse_mode, const open_mode mode);
 };
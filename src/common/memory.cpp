@@ -23,16 +23,35 @@ memory_c::resize(size_t new_size)
   if (!its_counter)
     its_counter = new counter(nullptr, 0, false);
 
-  if (its_counter->is_free) {
+  if (its_counter->is_free && !its_counter->is_pooled) {
     its_counter->ptr  = (unsigned char *)saferealloc(its_counter->ptr, new_size + its_counter->offset);
     its_counter->size = new_size + its_counter->offset;
 
+  } else if (its_counter->is_free) {
+    // Pooled buffers cannot be passed to realloc(). They often have
+    // some room to grow, though.
+    auto full_size = new_size + its_counter->offset;
+
+    if (full_size > memory_pool_c::get_capacity(its_counter->ptr)) {
+      auto old_ptr    = its_counter->ptr;
+      auto old_size   = its_counter->size;
+      auto old_offset = its_counter->offset;
+
+      its_counter->allocate(full_size);
+      memcpy(its_counter->ptr, old_ptr, std::min(old_size, full_size));
+      its_counter->offset = old_offset;
+
+      memory_pool_c::release(old_ptr);
+    }
+
+    its_counter->size = full_size;
+
   } else {
-    auto tmp = (unsigned char *)safemalloc(new_size);
-    memcpy(tmp, its_counter->ptr + its_counter->offset, std::min(new_size, its_counter->size - its_counter->offset));
-    its_counter->ptr     = tmp;
-    its_counter->is_free = true;
-    its_counter->size    = new_size;
+    auto old_ptr  = its_counter->ptr + its_counter->offset;
+    auto old_size = its_counter->size - its_counter->offset;
+
+    its_counter->allocate(new_size);
+    memcpy(its_counter->ptr, old_ptr, std::min(new_size, old_size));
   }
 }
 
@@ -18,6 +18,8 @@
 
 #include <deque>
 
+#include "common/memory_pool.h"
+
 namespace mtx {
   namespace mem {
     class exception: public mtx::exception {
@@ -93,8 +95,9 @@ public:
   }
 
   explicit memory_c(size_t s)
-    : its_counter(new counter(static_cast<unsigned char *>(safemalloc(s)), s, true))
+    : its_counter(new counter())
   {
+    its_counter->allocate(s);
   }
 
   ~memory_c() {
@@ -148,19 +151,53 @@ public:
     return its_counter && its_counter->is_free;
   }
 
+  bool is_read_only() const {
+    return its_counter && its_counter->is_read_only;
+  }
+
   void grab() {
-    if (!its_counter || its_counter->is_free)
+    if (!its_counter || its_counter->is_free || its_counter->owner)
       return;
 
-    its_counter->ptr      = static_cast<unsigned char *>(safememdup(get_buffer(), get_size()));
-    its_counter->is_free  = true;
-    its_counter->size    -= its_counter->offset;
-    its_counter->offset   = 0;
+    auto src  = get_buffer();
+    auto size = get_size();
+
+    its_counter->allocate(size);
+    memcpy(its_counter->ptr, src, size);
+  }
+
+  /** \brief Copies read-only data so that it can be modified in place */
+  void make_writable() {
+    if (!is_read_only())
+      return;
+
+    // Keeps the source alive until it has been copied.
+    auto owner = its_counter->owner;
+    auto src   = get_buffer();
+    auto size  = get_size();
+
+    its_counter->allocate(size);
+    memcpy(its_counter->ptr, src, size);
   }
 
+  /** \brief Hands the buffer over to the caller
+
+     The caller has to release it with \c free(). Buffers from the
+     memory pool are copied into memory allocated with \c malloc()
+     first.
+  */
   void lock() {
-    if (its_counter)
-      its_counter->is_free = false;
+    if (!its_counter)
+      return;
+
+    if (its_counter->is_free && its_counter->is_pooled) {
+      auto copy = static_cast<unsigned char *>(safememdup(its_counter->ptr, its_counter->size));
+      memory_pool_c::release(its_counter->ptr);
+      its_counter->ptr       = copy;
+      its_counter->is_pooled = false;
+    }
+
+    its_counter->is_free = false;
   }
 
   void resize(size_t new_size) throw();
@@ -195,16 +232,32 @@ public:
     return !(*this == cmp);
   }
 
+  // Only used for objects created with new. Use
+  // memory_pool_c::make_shared() instead of std::make_shared().
+  static void *operator new(size_t size) {
+    return memory_pool_c::allocate(size);
+  }
+
+  static void operator delete(void *ptr) {
+    memory_pool_c::release(ptr);
+  }
+
 public:
   static memory_cptr
   alloc(size_t size) {
-    return memory_cptr(new memory_c(static_cast<unsigned char *>(safemalloc(size)), size, true));
+    return memory_pool_c::make_shared<memory_c>(size);
   };
 
   static inline memory_cptr
   clone(const void *buffer,
         size_t size) {
-    return memory_cptr(new memory_c(static_cast<unsigned char *>(safememdup(buffer, size)), size, true));
+    if (!buffer)
+      return memory_pool_c::make_shared<memory_c>();
+
+    auto mem = memory_pool_c::make_shared<memory_c>(size);
+    memcpy(mem->get_buffer(), buffer, size);
+
+    return mem;
   }
 
   static inline memory_cptr
@@ -214,16 +267,38 @@ public:
 
   static inline memory_cptr
   point_to(std::string &buffer) {
-    return std::make_shared<memory_c>(reinterpret_cast<unsigned char *>(&buffer[0]), buffer.length(), false);
+    return memory_pool_c::make_shared<memory_c>(reinterpret_cast<unsigned char *>(&buffer[0]), buffer.length(), false);
+  }
+
+  /** \brief Refers to memory owned by another object without copying it
+
+     \c owner is kept alive for as long as the returned memory or any
+     copy of it exists. Therefore \c grab() doesn't have to copy the
+     data. If \c read_only is set then the data must not be modified
+     before \c make_writable() has been called.
+  */
+  static inline memory_cptr
+  share(void *buffer,
+        size_t size,
+        std::shared_ptr<void> const &owner,
+        bool read_only = false) {
+    auto mem = memory_pool_c::make_shared<memory_c>(buffer, size, false);
+    if (mem->its_counter) {
+      mem->its_counter->owner        = owner;
+      mem->its_counter->is_read_only = read_only;
+    }
+
+    return mem;
   }
 
 private:
   struct counter {
     unsigned char *ptr;
     size_t size;
-    bool is_free;
+    bool is_free, is_pooled, is_read_only;
     unsigned count;
     size_t offset;
+    std::shared_ptr<void> owner;
 
     counter(unsigned char *p = nullptr,
             size_t s = 0,
@@ -232,9 +307,38 @@ private:
       : ptr(p)
       , size(s)
       , is_free(f)
+      , is_pooled(false)
+      , is_read_only(false)
       , count(c)
       , offset(0)
     { }
+
+    // Replaces the buffer with a new one owned by this counter. Small
+    // buffers come from the memory pool.
+    void allocate(size_t new_size) {
+      is_pooled = new_size <= memory_pool_c::ms_max_pooled_size;
+      ptr       = is_pooled ? memory_pool_c::allocate(new_size) : static_cast<unsigned char *>(safemalloc(new_size));
+      size      = new_size;
+      offset       = 0;
+      is_free      = true;
+      is_read_only = false;
+      owner.reset();
+    }
+
+    void free_buffer() {
+      if (is_pooled)
+        memory_pool_c::release(ptr);
+      else
+        free(ptr);
+    }
+
+    static void *operator new(size_t size) {
+      return memory_pool_c::allocate(size);
+    }
+
+    static void operator delete(void *ptr) {
+      memory_pool_c::release(ptr);
+    }
   } *its_counter;
 
   void acquire(counter *c) throw() { // increment the count
@@ -247,7 +351,7 @@ private:
     if (its_counter) {
       if (--its_counter->count == 0) {
         if (its_counter->is_free)
-          free(its_counter->ptr);
+          its_counter->free_buffer();
         delete its_counter;
       }
       its_counter = 0;
@@ -0,0 +1,400 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   size-classed memory pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "common/memory_pool.h"
+
+namespace {
+
+struct block_header_t {
+  uint32_t size_class;
+  uint32_t reserved;
+  uint64_t capacity;
+};
+
+static_assert(16 == sizeof(block_header_t), "the block header must keep the alignment malloc() guarantees");
+
+unsigned int const s_min_class_shift                        = 4;
+unsigned int const s_num_size_classes                       = 11;
+uint32_t const s_unpooled_size_class                        = 0xffffffff;
+std::size_t const s_max_cached_bytes_per_size_class         = 4 * 1024 * 1024;
+std::size_t const s_min_cached_blocks_per_size_class        = 64;
+std::size_t const s_max_thread_cached_bytes_per_size_class  = 256 * 1024;
+std::size_t const s_min_thread_cached_blocks_per_size_class = 16;
+std::size_t const s_max_thread_cached_blocks_per_size_class = 256;
+
+struct size_class_t {
+  std::mutex mutex;
+  std::vector<unsigned char *> free_blocks;
+  std::size_t max_free_blocks;
+  int64_t num_in_use, peak_num_in_use;
+  uint64_t num_allocations, num_reused, num_discarded;
+
+  size_class_t()
+    : max_free_blocks{}
+    , num_in_use{}
+    , peak_num_in_use{}
+    , num_allocations{}
+    , num_reused{}
+    , num_discarded{}
+  {
+  }
+};
+
+struct pool_t {
+  size_class_t size_classes[s_num_size_classes];
+  std::atomic<uint64_t> num_unpooled_allocations, num_unpooled_bytes;
+
+  pool_t()
+    : num_unpooled_allocations{}
+    , num_unpooled_bytes{}
+  {
+    for (auto idx = 0u; idx < s_num_size_classes; ++idx)
+      size_classes[idx].max_free_blocks = std::max(s_min_cached_blocks_per_size_class, s_max_cached_bytes_per_size_class >> (s_min_class_shift + idx));
+  }
+};
+
+static_assert(memory_pool_c::ms_max_pooled_size == (static_cast<std::size_t>(1) << (s_min_class_shift + s_num_size_classes - 1)), "the largest size class must match ms_max_pooled_size");
+
+// A thread's cache of free blocks for one size class. The statistics
+// are only added to the shared ones while the shared free list is
+// locked anyway.
+struct cached_size_class_t {
+  std::vector<unsigned char *> free_blocks;
+  std::size_t max_free_blocks;
+  int64_t num_in_use;
+  uint64_t num_allocations, num_reused;
+
+  cached_size_class_t()
+    : max_free_blocks{}
+    , num_in_use{}
+    , num_allocations{}
+    , num_reused{}
+  {
+  }
+};
+
+struct thread_cache_t {
+  cached_size_class_t size_classes[s_num_size_classes];
+
+  thread_cache_t();
+  ~thread_cache_t();
+};
+
+pool_t &
+get_pool() {
+  // Never destroyed: blocks may still be released by the destructors
+  // of other static objects.
+  static auto s_pool = new pool_t;
+  return *s_pool;
+}
+
+unsigned int
+size_class_for(std::size_t size) {
+  auto idx = 0u;
+  while ((static_cast<std::size_t>(1) << (s_min_class_shift + idx)) < size)
+    ++idx;
+
+  return idx;
+}
+
+block_header_t *
+header_of(void const *ptr) {
+  return reinterpret_cast<block_header_t *>(const_cast<unsigned char *>(static_cast<unsigned char const *>(ptr)) - sizeof(block_header_t));
+}
+
+unsigned char *
+allocate_block(std::size_t capacity,
+               uint32_t size_class) {
+  auto header = static_cast<block_header_t *>(malloc(sizeof(block_header_t) + capacity));
+  if (!header)
+    mxerror(boost::format(Y("memory_pool_c::allocate(): malloc() returned nullptr for a size of %1% bytes.\n")) % capacity);
+
+  header->size_class = size_class;
+  header->reserved   = 0;
+  header->capacity   = capacity;
+
+  return reinterpret_cast<unsigned char *>(header + 1);
+}
+
+// Blocks may still be released by the destructors of thread_local
+// objects that are destroyed after the thread's cache.
+thread_local bool tl_thread_cache_destroyed = false;
+
+thread_cache_t *
+get_thread_cache() {
+  if (tl_thread_cache_destroyed)
+    return nullptr;
+
+  static thread_local thread_cache_t tl_thread_cache;
+  return &tl_thread_cache;
+}
+
+void
+add_statistics(size_class_t &size_class,
+               cached_size_class_t &cached) {
+  size_class.num_allocations += cached.num_allocations;
+  size_class.num_reused      += cached.num_reused;
+  size_class.num_in_use      += cached.num_in_use;
+  size_class.peak_num_in_use  = std::max(size_class.peak_num_in_use, size_class.num_in_use);
+
+  cached.num_allocations = 0;
+  cached.num_reused      = 0;
+  cached.num_in_use      = 0;
+}
+
+/** \brief Moves blocks from the shared free list into a thread's cache
+
+   Up to half of the cache's capacity is taken at once so that the
+   shared list is locked only for every couple of allocations.
+*/
+void
+refill_thread_cache(size_class_t &size_class,
+                    cached_size_class_t &cached) {
+  std::lock_guard<std::mutex> lock{size_class.mutex};
+
+  add_statistics(size_class, cached);
+
+  auto num_blocks = std::min(cached.max_free_blocks / 2, size_class.free_blocks.size());
+  auto first      = size_class.free_blocks.end() - num_blocks;
+
+  cached.free_blocks.insert(cached.free_blocks.end(), first, size_class.free_blocks.end());
+  size_class.free_blocks.erase(first, size_class.free_blocks.end());
+}
+
+/** \brief Moves the oldest \c num_blocks blocks from a thread's cache to the shared free list
+
+   Blocks that don't fit into the shared free list are freed.
+*/
+void
+flush_thread_cache(size_class_t &size_class,
+                   cached_size_class_t &cached,
+                   std::size_t num_blocks) {
+  auto last    = cached.free_blocks.begin() + std::min(num_blocks, cached.free_blocks.size());
+  auto to_free = std::vector<unsigned char *>{};
+
+  {
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    add_statistics(size_class, cached);
+
+    auto num_kept  = std::min<std::size_t>(last - cached.free_blocks.begin(), size_class.max_free_blocks - std::min(size_class.max_free_blocks, size_class.free_blocks.size()));
+    auto kept_last = cached.free_blocks.begin() + num_kept;
+
+    size_class.free_blocks.insert(size_class.free_blocks.end(), cached.free_blocks.begin(), kept_last);
+    to_free.assign(kept_last, last);
+    size_class.num_discarded += to_free.size();
+  }
+
+  cached.free_blocks.erase(cached.free_blocks.begin(), last);
+
+  for (auto block : to_free)
+    free(header_of(block));
+}
+
+thread_cache_t::thread_cache_t() {
+  for (auto idx = 0u; idx < s_num_size_classes; ++idx) {
+    auto &cached           = size_classes[idx];
+    cached.max_free_blocks = std::min(s_max_thread_cached_blocks_per_size_class, std::max(s_min_thread_cached_blocks_per_size_class, s_max_thread_cached_bytes_per_size_class >> (s_min_class_shift + idx)));
+    cached.free_blocks.reserve(cached.max_free_blocks);
+  }
+}
+
+thread_cache_t::~thread_cache_t() {
+  auto &pool = get_pool();
+
+  for (auto idx = 0u; idx < s_num_size_classes; ++idx)
+    flush_thread_cache(pool.size_classes[idx], size_classes[idx], size_classes[idx].free_blocks.size());
+
+  tl_thread_cache_destroyed = true;
+}
+
+}
+
+/** \brief Allocates a block of at least \c size bytes
+
+   The block is taken from the calling thread's cache or from the
+   shared free list of its size class if possible. Blocks larger than
+   \c ms_max_pooled_size are allocated with \c malloc().
+*/
+unsigned char *
+memory_pool_c::allocate(std::size_t size) {
+  auto &pool = get_pool();
+
+  if (size > ms_max_pooled_size) {
+    ++pool.num_unpooled_allocations;
+    pool.num_unpooled_bytes += size;
+
+    return allocate_block(size, s_unpooled_size_class);
+  }
+
+  auto idx         = size_class_for(size);
+  auto &size_class = pool.size_classes[idx];
+  auto cache       = get_thread_cache();
+
+  if (!cache) {
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    ++size_class.num_allocations;
+    ++size_class.num_in_use;
+    size_class.peak_num_in_use = std::max(size_class.peak_num_in_use, size_class.num_in_use);
+
+    if (!size_class.free_blocks.empty()) {
+      auto block = size_class.free_blocks.back();
+      size_class.free_blocks.pop_back();
+      ++size_class.num_reused;
+
+      return block;
+    }
+
+  } else {
+    auto &cached = cache->size_classes[idx];
+
+    ++cached.num_allocations;
+    ++cached.num_in_use;
+
+    if (cached.free_blocks.empty())
+      refill_thread_cache(size_class, cached);
+
+    if (!cached.free_blocks.empty()) {
+      auto block = cached.free_blocks.back();
+      cached.free_blocks.pop_back();
+      ++cached.num_reused;
+
+      return block;
+    }
+  }
+
+  return allocate_block(static_cast<std::size_t>(1) << (s_min_class_shift + idx), idx);
+}
+
+/** \brief Releases a block allocated with \c allocate()
+
+   The block doesn't have to be released by the thread that allocated
+   it. It ends up in the releasing thread's cache.
+*/
+void
+memory_pool_c::release(void *ptr) {
+  if (!ptr)
+    return;
+
+  auto header = header_of(ptr);
+
+  if (s_unpooled_size_class == header->size_class) {
+    free(header);
+    return;
+  }
+
+  auto &size_class = get_pool().size_classes[header->size_class];
+  auto cache       = get_thread_cache();
+
+  if (cache) {
+    auto &cached = cache->size_classes[header->size_class];
+
+    --cached.num_in_use;
+
+    if (cached.free_blocks.size() >= cached.max_free_blocks)
+      flush_thread_cache(size_class, cached, cached.max_free_blocks / 2);
+
+    cached.free_blocks.push_back(static_cast<unsigned char *>(ptr));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    --size_class.num_in_use;
+
+    if (size_class.free_blocks.size() < size_class.max_free_blocks) {
+      size_class.free_blocks.push_back(static_cast<unsigned char *>(ptr));
+      return;
+    }
+
+    ++size_class.num_discarded;
+  }
+
+  free(header);
+}
+
+/** \brief Returns the number of bytes that can be used in a block
+
+   This may be more than the size requested when the block was
+   allocated.
+*/
+std::size_t
+memory_pool_c::get_capacity(void const *ptr) {
+  return ptr ? header_of(ptr)->capacity : 0;
+}
+
+/** \brief Returns how often blocks have been reused in all size classes
+
+   Other threads' reuses are only counted up to the last time their
+   caches exchanged blocks with the shared free lists.
+*/
+uint64_t
+memory_pool_c::get_num_reused() {
+  auto &pool      = get_pool();
+  auto cache      = get_thread_cache();
+  auto num_reused = uint64_t{};
+
+  for (auto idx = 0u; idx < s_num_size_classes; ++idx) {
+    auto &size_class = pool.size_classes[idx];
+
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    if (cache)
+      add_statistics(size_class, cache->size_classes[idx]);
+    num_reused += size_class.num_reused;
+  }
+
+  return num_reused;
+}
+
+void
+memory_pool_c::dump_statistics() {
+  static debugging_option_c s_debug{"memory_pool"};
+
+  if (!s_debug)
+    return;
+
+  auto &pool = get_pool();
+  auto cache = get_thread_cache();
+
+  for (auto idx = 0u; idx < s_num_size_classes; ++idx) {
+    auto &size_class = pool.size_classes[idx];
+
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    if (cache)
+      add_statistics(size_class, cache->size_classes[idx]);
+
+    if (!size_class.num_allocations)
+      continue;
+
+    mxdebug(boost::format("memory_pool: size class %|1$5| bytes: allocations %2% reused %3% (%4%%%) discarded %5% peak in use %6% in use %7% cached %8%\n")
+            % (static_cast<std::size_t>(1) << (s_min_class_shift + idx))
+            % size_class.num_allocations
+            % size_class.num_reused
+            % (size_class.num_reused * 100 / size_class.num_allocations)
+            % size_class.num_discarded
+            % size_class.peak_num_in_use
+            % size_class.num_in_use
+            % size_class.free_blocks.size());
+  }
+
+  mxdebug(boost::format("memory_pool: unpooled allocations %1% with %2% bytes\n") % pool.num_unpooled_allocations % pool.num_unpooled_bytes);
+}
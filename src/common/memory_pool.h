@@ -0,0 +1,137 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the size-classed memory pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MEMORY_POOL_H
+#define MTX_COMMON_MEMORY_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/** \brief Recycles small blocks of memory
+
+   Blocks are grouped into size classes that are powers of two from 16
+   bytes up to \c ms_max_pooled_size bytes. Released blocks are kept on
+   a free list per size class, up to a certain number, and handed out
+   again by later allocations of the same class. Larger blocks are
+   allocated and freed with \c malloc() and \c free() directly.
+
+   Each thread caches a small number of free blocks per size class in
+   front of the shared free lists so that most allocations and releases
+   don't have to lock anything. Blocks are moved between a thread's
+   cache and the shared lists in batches. A block may be released by a
+   different thread than the one that allocated it; it ends up in the
+   releasing thread's cache. A thread's cached blocks are returned to
+   the shared lists when the thread exits.
+
+   All functions are thread-safe.
+
+   Blocks must only be released with \c release(). They must never be
+   passed to \c free() or \c realloc(). Each block is preceded by a
+   small header that records its size class.
+
+   Allocation statistics are output when mkvmerge finishes if the
+   debugging option \c memory_pool is active.
+
+   Objects shared via \c std::shared_ptr should be created with \c
+   make_shared() below. \c std::make_shared() would bypass a class's
+   \c operator new, and the control block allocated by \c
+   std::shared_ptr's constructor doesn't come from the pool either.
+*/
+class memory_pool_c {
+public:
+  static std::size_t const ms_max_pooled_size = 16384;
+
+public:
+  static unsigned char *allocate(std::size_t size);
+  static void release(void *ptr);
+  static std::size_t get_capacity(void const *ptr);
+  static uint64_t get_num_reused();
+
+  static void dump_statistics();
+
+  template<typename Ttype, typename... Targs>
+  static std::shared_ptr<Ttype> make_shared(Targs &&... args);
+
+  template<typename Ttype>
+  static std::shared_ptr<Ttype> own(Ttype *ptr);
+};
+
+/** \brief A standard allocator handing out blocks from the memory pool
+*/
+template<typename Ttype>
+class memory_pool_allocator_c {
+public:
+  typedef Ttype value_type;
+
+  template<typename Tother>
+  struct rebind {
+    typedef memory_pool_allocator_c<Tother> other;
+  };
+
+public:
+  memory_pool_allocator_c() {
+  }
+
+  template<typename Tother>
+  memory_pool_allocator_c(memory_pool_allocator_c<Tother> const &) {
+  }
+
+  Ttype *
+  allocate(std::size_t num) {
+    return reinterpret_cast<Ttype *>(memory_pool_c::allocate(num * sizeof(Ttype)));
+  }
+
+  void
+  deallocate(Ttype *ptr,
+             std::size_t) {
+    memory_pool_c::release(ptr);
+  }
+};
+
+template<typename Ttype, typename Tother>
+bool
+operator ==(memory_pool_allocator_c<Ttype> const &,
+            memory_pool_allocator_c<Tother> const &) {
+  return true;
+}
+
+template<typename Ttype, typename Tother>
+bool
+operator !=(memory_pool_allocator_c<Ttype> const &,
+            memory_pool_allocator_c<Tother> const &) {
+  return false;
+}
+
+/** \brief Creates a shared object in a single block from the pool
+
+   The block holds both the object and the \c std::shared_ptr's control
+   block.
+*/
+template<typename Ttype, typename... Targs>
+std::shared_ptr<Ttype>
+memory_pool_c::make_shared(Targs &&... args) {
+  return std::allocate_shared<Ttype>(memory_pool_allocator_c<Ttype>{}, std::forward<Targs>(args)...);
+}
+
+/** \brief Takes ownership of an object that has been created with \c new
+
+   The \c std::shared_ptr's control block is taken from the pool.
+*/
+template<typename Ttype>
+std::shared_ptr<Ttype>
+memory_pool_c::own(Ttype *ptr) {
+  return std::shared_ptr<Ttype>{ptr, std::default_delete<Ttype>{}, memory_pool_allocator_c<Ttype>{}};
+}
+
+#endif // MTX_COMMON_MEMORY_POOL_H
@@ -0,0 +1,244 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mm_async_write_io.h"
+#include "common/mm_io_x.h"
+
+mm_async_write_io_c::mm_async_write_io_c(mm_io_c *out,
+                                         size_t chunk_size,
+                                         size_t max_queued_chunks,
+                                         bool delete_out)
+  : mm_proxy_io_c(out, delete_out)
+  , m_fill{}
+  , m_chunk_size{std::max<size_t>(chunk_size, 1)}
+  , m_max_queued_chunks{std::max<size_t>(max_queued_chunks, 1)}
+  , m_position{out->getFilePointer()}
+  , m_writing{}
+  , m_quit{}
+  , m_debug{"async_write_io"}
+{
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+mm_async_write_io_c::~mm_async_write_io_c() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+mm_io_cptr
+mm_async_write_io_c::open(const std::string &file_name,
+                          size_t chunk_size,
+                          size_t max_queued_chunks) {
+  return mm_io_cptr(new mm_async_write_io_c(new mm_file_io_c(file_name, MODE_CREATE), chunk_size, max_queued_chunks));
+}
+
+uint64
+mm_async_write_io_c::getFilePointer() {
+  return m_position;
+}
+
+void
+mm_async_write_io_c::setFilePointer(int64 offset,
+                                    seek_mode mode) {
+  if ((seek_beginning == mode) && (static_cast<uint64_t>(offset) == m_position))
+    return;
+
+  if ((seek_current == mode) && !offset)
+    return;
+
+  wait_for_writer();
+
+  m_proxy_io->setFilePointer(offset, mode);
+  m_position = m_proxy_io->getFilePointer();
+}
+
+void
+mm_async_write_io_c::flush() {
+  wait_for_writer();
+  m_proxy_io->flush();
+}
+
+void
+mm_async_write_io_c::close() {
+  if (!m_proxy_io)
+    return;
+
+  try {
+    wait_for_writer();
+  } catch (...) {
+    stop_writer();
+    mm_proxy_io_c::close();
+    throw;
+  }
+
+  stop_writer();
+  mm_proxy_io_c::close();
+}
+
+int
+mm_async_write_io_c::truncate(int64_t pos) {
+  wait_for_writer();
+
+  auto result = m_proxy_io->truncate(pos);
+  m_position  = m_proxy_io->getFilePointer();
+
+  return result;
+}
+
+uint32
+mm_async_write_io_c::_read(void *buffer,
+                           size_t size) {
+  wait_for_writer();
+
+  auto num_read = m_proxy_io->read(buffer, size);
+  m_position    = m_proxy_io->getFilePointer();
+
+  return num_read;
+}
+
+size_t
+mm_async_write_io_c::_write(const void *buffer,
+                            size_t size) {
+  rethrow_writer_exception();
+
+  auto src    = static_cast<unsigned char const *>(buffer);
+  auto remain = size;
+
+  while (remain) {
+    if (!m_chunk) {
+      m_chunk = memory_c::alloc(m_chunk_size);
+      m_fill  = 0;
+    }
+
+    auto num_bytes = std::min(remain, m_chunk_size - m_fill);
+    memcpy(m_chunk->get_buffer() + m_fill, src, num_bytes);
+
+    m_fill     += num_bytes;
+    m_position += num_bytes;
+    src        += num_bytes;
+    remain     -= num_bytes;
+
+    if (m_fill == m_chunk_size)
+      queue_chunk();
+  }
+
+  return size;
+}
+
+void
+mm_async_write_io_c::queue_chunk() {
+  if (!m_chunk || !m_fill)
+    return;
+
+  m_chunk->set_size(m_fill);
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  m_queue_changed.wait(lock, [this]() { return (m_queue.size() < m_max_queued_chunks) || m_exception; });
+
+  if (m_exception)
+    std::rethrow_exception(m_exception);
+
+  m_queue.push_back(m_chunk);
+  m_chunk.reset();
+  m_fill = 0;
+
+  lock.unlock();
+  m_queue_changed.notify_all();
+}
+
+void
+mm_async_write_io_c::wait_for_writer() {
+  queue_chunk();
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  m_queue_changed.wait(lock, [this]() { return (m_queue.empty() && !m_writing) || m_exception; });
+
+  if (m_exception)
+    std::rethrow_exception(m_exception);
+}
+
+void
+mm_async_write_io_c::rethrow_writer_exception() {
+  std::lock_guard<std::mutex> lock{m_mutex};
+
+  if (m_exception)
+    std::rethrow_exception(m_exception);
+}
+
+void
+mm_async_write_io_c::stop_writer() {
+  if (!m_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_quit = true;
+  }
+
+  m_queue_changed.notify_all();
+  m_thread.join();
+}
+
+void
+mm_async_write_io_c::run() {
+  while (true) {
+    memory_cptr chunk;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+
+      m_queue_changed.wait(lock, [this]() { return !m_queue.empty() || m_quit; });
+
+      if (m_queue.empty())
+        return;
+
+      chunk = m_queue.front();
+      m_queue.pop_front();
+      m_writing = true;
+    }
+
+    m_queue_changed.notify_all();
+
+    std::exception_ptr exception;
+
+    try {
+      auto written = m_proxy_io->write(chunk->get_buffer(), chunk->get_size());
+
+      mxdebug_if(m_debug, boost::format("async_write_io: wrote %1% of %2% bytes, now at %3%\n") % written % chunk->get_size() % m_proxy_io->getFilePointer());
+
+      if (written != chunk->get_size())
+        throw mtx::mm_io::insufficient_space_x();
+
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+
+      m_writing = false;
+      if (exception) {
+        m_exception = exception;
+        m_queue.clear();
+      }
+    }
+
+    m_queue_changed.notify_all();
+  }
+}
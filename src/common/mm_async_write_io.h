@@ -0,0 +1,78 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_ASYNC_WRITE_IO_H
+#define MTX_COMMON_MM_ASYNC_WRITE_IO_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "common/mm_io.h"
+
+/** \brief Writes to the proxied file from a background thread
+
+   Written data is collected in chunks. Full chunks are handed to a
+   writer thread through a bounded queue so that the caller can go on
+   producing data while the previous chunks are written.
+
+   The file position reported by \c getFilePointer() always includes
+   the data that hasn't been written yet. All other operations that
+   need the file's actual state (seeking, reading, flushing) wait
+   until the writer thread has caught up. Errors that occur on the
+   writer thread are re-thrown by the next call on the caller's
+   thread.
+*/
+class mm_async_write_io_c: public mm_proxy_io_c {
+protected:
+  memory_cptr m_chunk;
+  size_t m_fill, m_chunk_size, m_max_queued_chunks;
+  uint64_t m_position;
+
+  std::deque<memory_cptr> m_queue;
+  bool m_writing, m_quit;
+  std::exception_ptr m_exception;
+  std::mutex m_mutex;
+  std::condition_variable m_queue_changed;
+  std::thread m_thread;
+
+  debugging_option_c m_debug;
+
+public:
+  mm_async_write_io_c(mm_io_c *out, size_t chunk_size, size_t max_queued_chunks, bool delete_out = true);
+  virtual ~mm_async_write_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual void flush();
+  virtual void close();
+  virtual int truncate(int64_t pos);
+
+  static mm_io_cptr open(const std::string &file_name, size_t chunk_size, size_t max_queued_chunks);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void queue_chunk();
+  void wait_for_writer();
+  void rethrow_writer_exception();
+  void stop_writer();
+  void run();
+};
+
+#endif // MTX_COMMON_MM_ASYNC_WRITE_IO_H
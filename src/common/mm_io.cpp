@@ -26,6 +26,7 @@
 #include "common/endian.h"
 #include "common/error.h"
 #include "common/fs_sys_helpers.h"
+#include "common/instrumentation.h"
 #include "common/mm_io.h"
 #include "common/mm_io_x.h"
 #include "common/strings/editing.h"
@@ -41,6 +42,7 @@ mm_file_io_c::mm_file_io_c(const std::string &path,
                            const open_mode mode)
   : m_file_name(path)
   , m_file(nullptr)
+  , m_write_counter{}
 {
   const char *cmode;
 
@@ -73,6 +75,9 @@ mm_file_io_c::mm_file_io_c(const std::string &path,
 
   if (!m_file)
     throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+
+  if (MODE_READ != mode)
+    m_write_counter = mtx::instrumentation::get_counter("write", path);
 }
 
 void
@@ -91,10 +96,14 @@ mm_file_io_c::setFilePointer(int64 offset,
 size_t
 mm_file_io_c::_write(const void *buffer,
                      size_t size) {
+  mtx::instrumentation::scope_c scope{m_write_counter};
+
   size_t bwritten = fwrite(buffer, 1, size, (FILE *)m_file);
   if (ferror((FILE *)m_file) != 0)
     throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
 
+  scope.add_bytes(bwritten);
+
   m_current_position += bwritten;
   m_cached_size       = -1;
 
@@ -272,6 +281,17 @@ mm_io_c::read(size_t size) {
   return buffer;
 }
 
+/** \brief Reads data without copying it if the implementation can
+
+   Implementations that keep the file's content in memory anyway can
+   return memory referring to it. All others copy the data just like
+   \c read() does.
+*/
+memory_cptr
+mm_io_c::read_shared(size_t size) {
+  return read(size);
+}
+
 uint32_t
 mm_io_c::read(void *buffer,
               size_t size) {
@@ -866,6 +886,8 @@ mm_mem_io_c::get_content()
    Class for handling UTF-8/UTF-16/UTF-32 text files.
 */
 
+static size_t const s_text_io_buffer_size = 64 * 1024;
+
 mm_text_io_c::mm_text_io_c(mm_io_c *in,
                            bool delete_in)
   : mm_proxy_io_c(in, delete_in)
@@ -874,6 +896,8 @@ mm_text_io_c::mm_text_io_c(mm_io_c *in,
   , m_uses_carriage_returns(false)
   , m_uses_newlines(false)
   , m_eol_style_detected(false)
+  , m_buffer_pos{}
+  , m_buffer_fill{}
 {
   in->setFilePointer(0, seek_beginning);
 
@@ -889,6 +913,16 @@ mm_text_io_c::mm_text_io_c(mm_io_c *in,
   in->setFilePointer(m_bom_len, seek_beginning);
 }
 
+mm_text_io_c::~mm_text_io_c() {
+  // Others may continue reading from the proxied I/O.
+  if (m_proxy_io && !m_proxy_delete_io) {
+    try {
+      discard_buffer();
+    } catch (...) {
+    }
+  }
+}
+
 void
 mm_text_io_c::detect_eol_style() {
   if (m_eol_style_detected)
@@ -1035,13 +1069,113 @@ mm_text_io_c::getline() {
   if (!m_eol_style_detected)
     detect_eol_style();
 
+  if ((BO_NONE != m_byte_order) && (BO_UTF8 != m_byte_order))
+    return getline_by_char();
+
+  // Both CR and LF only occur as themselves in UTF-8. Therefore lines
+  // can be split on the raw bytes. The search starts with the
+  // character the file uses for terminating its lines.
+  auto primary   = m_uses_newlines ? '\n' : '\r';
+  auto secondary = m_uses_newlines ? '\r' : '\n';
+
   std::string s;
-  char utf8char[9];
-  bool previous_was_carriage_return = false;
+  bool previous_was_carriage_return = false, at_eof = false;
+
+  auto append = [&s](unsigned char const *data, size_t size) {
+    // NUL characters have never been part of lines.
+    if (!memchr(data, 0, size)) {
+      s.append(reinterpret_cast<char const *>(data), size);
+      return;
+    }
+
+    for (auto end = data + size; data < end; ++data)
+      if (*data)
+        s += static_cast<char>(*data);
+  };
 
   while (1) {
-    memset(utf8char, 0, 9);
+    if ((m_buffer_pos >= m_buffer_fill) && !fill_buffer()) {
+      at_eof = true;
+      break;
+    }
+
+    auto buffer = m_buffer->get_buffer();
+
+    if (previous_was_carriage_return) {
+      auto c = buffer[m_buffer_pos];
+
+      if (('\r' == c) && m_uses_newlines) {
+        ++m_buffer_pos;
+        continue;
+      }
 
+      if ('\n' == c)
+        ++m_buffer_pos;
+
+      break;
+    }
+
+    auto start = buffer + m_buffer_pos;
+    auto size  = m_buffer_fill - m_buffer_pos;
+    auto eol   = static_cast<unsigned char *>(memchr(start, primary, size));
+    auto other = static_cast<unsigned char *>(memchr(start, secondary, eol ? eol - start : size));
+    if (other)
+      eol = other;
+
+    if (!eol) {
+      append(start, size);
+      m_buffer_pos = m_buffer_fill;
+      continue;
+    }
+
+    append(start, eol - start);
+    m_buffer_pos = eol - buffer + 1;
+
+    if ('\r' == *eol)
+      previous_was_carriage_return = true;
+
+    else if (!m_uses_carriage_returns)
+      break;
+
+    else
+      s += '\n';
+  }
+
+  if (BO_UTF8 != m_byte_order)
+    return s;
+
+  for (auto idx = 0u, length = static_cast<unsigned int>(s.length()); idx < length;) {
+    auto c    = static_cast<unsigned char>(s[idx]);
+    auto size = ((c & 0x80) == 0x00) ?  1u
+              : ((c & 0xe0) == 0xc0) ?  2u
+              : ((c & 0xf0) == 0xe0) ?  3u
+              : ((c & 0xf8) == 0xf0) ?  4u
+              : ((c & 0xfc) == 0xf8) ?  5u
+              : ((c & 0xfe) == 0xfc) ?  6u
+              :                        99u;
+
+    if (99 == size)
+      throw mtx::mm_io::text::invalid_utf8_char_x(c);
+
+    // A character cut off by the end of the file is dropped.
+    if (at_eof && ((idx + size) > length)) {
+      s.erase(idx);
+      break;
+    }
+
+    idx += size;
+  }
+
+  return s;
+}
+
+std::string
+mm_text_io_c::getline_by_char() {
+  std::string s;
+  char utf8char[8];
+  bool previous_was_carriage_return = false;
+
+  while (1) {
     int len = read_next_char(utf8char);
     if (0 == len)
       return s;
@@ -1064,27 +1198,114 @@ mm_text_io_c::getline() {
       return s;
     }
 
-    previous_was_carriage_return  = false;
-    s                            += utf8char;
+    previous_was_carriage_return = false;
+
+    if ((1 != len) || utf8char[0])
+      s.append(utf8char, len);
   }
 }
 
+bool
+mm_text_io_c::fill_buffer() {
+  if (!m_buffer)
+    m_buffer = memory_c::alloc(s_text_io_buffer_size);
+
+  m_buffer_pos  = 0;
+  m_buffer_fill = m_proxy_io->read(m_buffer->get_buffer(), m_buffer->get_size());
+
+  return 0 != m_buffer_fill;
+}
+
+/** \brief Drops the data buffered but not consumed yet
+
+   The proxied I/O is moved back to the logical position.
+*/
+void
+mm_text_io_c::discard_buffer() {
+  if (m_buffer_pos < m_buffer_fill)
+    m_proxy_io->setFilePointer(-static_cast<int64_t>(m_buffer_fill - m_buffer_pos), seek_current);
+
+  m_buffer_pos  = 0;
+  m_buffer_fill = 0;
+}
+
+uint32
+mm_text_io_c::_read(void *buffer,
+                    size_t size) {
+  auto num_copied = 0u;
+
+  if ((m_buffer_pos >= m_buffer_fill) && (size < s_text_io_buffer_size))
+    fill_buffer();
+
+  if (m_buffer_pos < m_buffer_fill) {
+    num_copied = std::min(size, m_buffer_fill - m_buffer_pos);
+    memcpy(buffer, m_buffer->get_buffer() + m_buffer_pos, num_copied);
+
+    m_buffer_pos += num_copied;
+    if (num_copied == size)
+      return num_copied;
+  }
+
+  return num_copied + m_proxy_io->read(static_cast<unsigned char *>(buffer) + num_copied, size - num_copied);
+}
+
+size_t
+mm_text_io_c::_write(const void *buffer,
+                     size_t size) {
+  discard_buffer();
+
+  return m_proxy_io->write(buffer, size);
+}
+
+uint64
+mm_text_io_c::getFilePointer() {
+  return m_proxy_io->getFilePointer() - (m_buffer_fill - m_buffer_pos);
+}
+
+bool
+mm_text_io_c::eof() {
+  return (m_buffer_pos >= m_buffer_fill) && m_proxy_io->eof();
+}
+
 void
 mm_text_io_c::setFilePointer(int64 offset,
                              seek_mode mode) {
-  mm_proxy_io_c::setFilePointer(((0 == offset) && (seek_beginning == mode)) ? m_bom_len : offset, mode);
+  if ((0 == offset) && (seek_beginning == mode))
+    offset = m_bom_len;
+
+  // Stay within the buffer if possible, e.g. when restoring a position
+  // or when getline_by_char() steps back.
+  if (m_buffer_fill && (seek_end != mode)) {
+    int64_t buffer_start = m_proxy_io->getFilePointer() - m_buffer_fill;
+    int64_t new_pos      = seek_beginning == mode ? offset : buffer_start + static_cast<int64_t>(m_buffer_pos) + offset;
+
+    if ((buffer_start <= new_pos) && (new_pos <= (buffer_start + static_cast<int64_t>(m_buffer_fill)))) {
+      m_buffer_pos = new_pos - buffer_start;
+      return;
+    }
+  }
+
+  if (seek_current == mode)
+    offset -= static_cast<int64_t>(m_buffer_fill - m_buffer_pos);
+
+  m_proxy_io->setFilePointer(offset, mode);
+
+  m_buffer_pos  = 0;
+  m_buffer_fill = 0;
 }
 
 /*
-   Class for reading from stdin & writing to stdout.
+   Class for reading from stdin & writing to stdout or stderr.
 */
 
-mm_stdio_c::mm_stdio_c() {
+mm_stdio_c::mm_stdio_c(FILE *out)
+  : m_out{out}
+{
 }
 
 uint64
 mm_stdio_c::getFilePointer() {
-  return 0;
+  return m_current_position;
 }
 
 void
@@ -1095,7 +1316,10 @@ mm_stdio_c::setFilePointer(int64,
 uint32
 mm_stdio_c::_read(void *buffer,
                   size_t size) {
-  return fread(buffer, 1, size, stdin);
+  auto num_read       = fread(buffer, 1, size, stdin);
+  m_current_position += num_read;
+
+  return num_read;
 }
 
 #if !defined(SYS_WINDOWS)
@@ -1104,7 +1328,10 @@ mm_stdio_c::_write(const void *buffer,
                    size_t size) {
   m_cached_size = -1;
 
-  return fwrite(buffer, 1, size, stdout);
+  auto num_written    = fwrite(buffer, 1, size, m_out);
+  m_current_position += num_written;
+
+  return num_written;
 }
 #endif // defined(SYS_WINDOWS)
 
@@ -1114,5 +1341,5 @@ mm_stdio_c::close() {
 
 void
 mm_stdio_c::flush() {
-  fflush(stdout);
+  fflush(m_out);
 }
@@ -20,6 +20,10 @@
 
 #include <ebml/IOCallback.h>
 
+namespace mtx { namespace instrumentation {
+class counter_c;
+}}
+
 using namespace libebml;
 
 class mm_io_c;
@@ -49,6 +53,7 @@ public:
   virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning) = 0;
   virtual bool setFilePointer2(int64 offset, seek_mode mode = seek_beginning);
   virtual memory_cptr read(size_t size);
+  virtual memory_cptr read_shared(size_t size);
   virtual uint32 read(void *buffer, size_t size);
   virtual uint32_t read(std::string &buffer, size_t size, size_t offset = 0);
   virtual uint32_t read(memory_cptr &buffer, size_t size, int offset = 0);
@@ -123,6 +128,7 @@ class mm_file_io_c: public mm_io_c {
 protected:
   std::string m_file_name;
   void *m_file;
+  mtx::instrumentation::counter_c *m_write_counter;
 
 #if defined(SYS_WINDOWS)
   bool m_eof;
@@ -262,16 +268,29 @@ using mm_mem_io_cptr = std::shared_ptr<mm_mem_io_c>;
 
 enum byte_order_e {BO_UTF8, BO_UTF16_LE, BO_UTF16_BE, BO_UTF32_LE, BO_UTF32_BE, BO_NONE};
 
+/** \brief Reads and writes text files in various Unicode encodings
+
+   Reading is done in chunks from the proxied I/O. For UTF-8 files and
+   files without a byte order marker \c getline() splits lines directly
+   in the chunk buffer; other encodings are decoded one character at a
+   time. The proxied I/O is positioned at the logical position again
+   before writing or if it isn't deleted along with this object.
+*/
 class mm_text_io_c: public mm_proxy_io_c {
 protected:
   byte_order_e m_byte_order;
   unsigned int m_bom_len;
   bool m_uses_carriage_returns, m_uses_newlines, m_eol_style_detected;
+  memory_cptr m_buffer;
+  size_t m_buffer_pos, m_buffer_fill;
 
 public:
   mm_text_io_c(mm_io_c *in, bool delete_in = true);
+  virtual ~mm_text_io_c();
 
   virtual void setFilePointer(int64 offset, seek_mode mode=seek_beginning);
+  virtual uint64 getFilePointer();
+  virtual bool eof();
   virtual std::string getline();
   virtual int read_next_char(char *buffer);
   virtual byte_order_e get_byte_order() const {
@@ -286,6 +305,12 @@ public:
 
 protected:
   virtual void detect_eol_style();
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  std::string getline_by_char();
+  bool fill_buffer();
+  void discard_buffer();
 
 public:
   static bool has_byte_order_marker(const std::string &string);
@@ -295,8 +320,11 @@ public:
 using mm_text_io_cptr = std::shared_ptr<mm_text_io_c>;
 
 class mm_stdio_c: public mm_io_c {
+protected:
+  FILE *m_out;
+
 public:
-  mm_stdio_c();
+  mm_stdio_c(FILE *out = stdout);
 
   virtual uint64 getFilePointer();
   virtual void setFilePointer(int64 offset, seek_mode mode=seek_beginning);
@@ -321,4 +349,17 @@ protected:
 
 using mm_stdio_cptr = std::shared_ptr<mm_stdio_c>;
 
+/** \brief Reads text line by line from the standard input
+
+   Unlike \c mm_stdio_c it reports when the end of the standard input
+   has been reached. Data is only read as far as requested so that
+   lines can be handled as soon as they arrive, e.g. from a pipe.
+*/
+class mm_stdin_c: public mm_stdio_c {
+public:
+  virtual bool eof() {
+    return feof(stdin) != 0;
+  }
+};
+
 #endif // MTX_COMMON_MM_IO_H
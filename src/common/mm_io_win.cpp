@@ -28,6 +28,7 @@
 #include "common/endian.h"
 #include "common/error.h"
 #include "common/fs_sys_helpers.h"
+#include "common/instrumentation.h"
 #include "common/mm_io.h"
 #include "common/mm_io_x.h"
 #include "common/strings/editing.h"
@@ -38,6 +39,7 @@ mm_file_io_c::mm_file_io_c(const std::string &path,
                            const open_mode mode)
   : m_file_name(path)
   , m_file(nullptr)
+  , m_write_counter{}
   , m_eof(false)
 {
   DWORD access_mode, share_mode, disposition;
@@ -75,6 +77,9 @@ mm_file_io_c::mm_file_io_c(const std::string &path,
   if (static_cast<HANDLE>(m_file) == INVALID_HANDLE_VALUE)
     throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
 
+  if (MODE_READ != mode)
+    m_write_counter = mtx::instrumentation::get_counter("write", path);
+
   m_dos_style_newlines = true;
 }
 
@@ -136,6 +141,7 @@ mm_file_io_c::_read(void *buffer,
 size_t
 mm_file_io_c::_write(const void *buffer,
                      size_t size) {
+  mtx::instrumentation::scope_c scope{m_write_counter};
   DWORD bytes_written;
 
   if (!WriteFile((HANDLE)m_file, buffer, size, &bytes_written, nullptr))
@@ -166,6 +172,8 @@ mm_file_io_c::_write(const void *buffer,
       LocalFree(error_msg);
   }
 
+  scope.add_bytes(bytes_written);
+
   m_current_position += bytes_written;
   m_cached_size       = -1;
   m_eof               = false;
@@ -209,7 +217,7 @@ static bool s_stdout_binmode_set = false;
 size_t
 mm_stdio_c::_write(const void *buffer,
                    size_t size) {
-  HANDLE h_stdout = GetStdHandle(STD_OUTPUT_HANDLE);
+  HANDLE h_stdout = GetStdHandle(stderr == m_out ? STD_ERROR_HANDLE : STD_OUTPUT_HANDLE);
   if (INVALID_HANDLE_VALUE == h_stdout)
     return 0;
 
@@ -226,18 +234,21 @@ mm_stdio_c::_write(const void *buffer,
 
     WriteConsoleW(h_stdout, w.c_str(), w.length(), &bytes_written, nullptr);
 
+    m_current_position += size;
+
     return bytes_written;
   }
 
-  if (!s_stdout_binmode_set) {
+  if ((stdout == m_out) && !s_stdout_binmode_set) {
     _setmode(1, _O_BINARY);
     s_stdout_binmode_set = true;
   }
 
-  size_t bytes_written = fwrite(buffer, 1, size, stdout);
-  fflush(stdout);
+  size_t bytes_written = fwrite(buffer, 1, size, m_out);
+  fflush(m_out);
 
-  m_cached_size = -1;
+  m_cached_size       = -1;
+  m_current_position += bytes_written;
 
   return bytes_written;
 }
@@ -0,0 +1,276 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if !defined(SYS_WINDOWS)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
+#include "common/mm_io_x.h"
+#include "common/mm_mmap_io.h"
+
+// How far the kernel is asked to read ahead after a seek
+static uint64_t const s_will_need_size = 8 * 1024 * 1024;
+
+mm_mmap_io_c::mm_mmap_io_c(std::string const &file_name)
+  : m_file_name{file_name}
+  , m_data{}
+  , m_size{}
+  , m_pos{}
+  , m_will_need_start{}
+  , m_will_need_end{}
+  , m_fd{-1}
+  , m_debug{"mmap_io"}
+{
+#if defined(SYS_WINDOWS)
+  throw mtx::mm_io::open_x{};
+
+#else
+  auto local_path = g_cc_local_utf8->native(file_name);
+  auto fd         = ::open(local_path.c_str(), O_RDONLY);
+
+  if (-1 == fd)
+    throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+
+  struct stat st;
+  if ((0 != fstat(fd, &st)) || !S_ISREG(st.st_mode) || (0 == st.st_size) || (static_cast<uint64_t>(st.st_size) > std::numeric_limits<size_t>::max())) {
+    ::close(fd);
+    throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+  }
+
+  auto size = static_cast<size_t>(st.st_size);
+  auto addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (MAP_FAILED == addr) {
+    ::close(fd);
+    throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+  }
+
+  // The descriptor is kept open for checking the file's size.
+  m_fd      = fd;
+  m_mapping = std::shared_ptr<void>{addr, [size](void *p) { munmap(p, size); }};
+  m_data    = static_cast<unsigned char *>(addr);
+  m_size    = size;
+
+  madvise(addr, size, MADV_SEQUENTIAL);
+  advise_will_need(0, 0);
+
+  mxdebug_if(m_debug, boost::format("mmap_io: mapped '%1%' with %2% bytes\n") % m_file_name % m_size);
+#endif
+}
+
+mm_mmap_io_c::~mm_mmap_io_c() {
+  close();
+}
+
+bool
+mm_mmap_io_c::is_supported() {
+#if defined(SYS_WINDOWS)
+  return false;
+#else
+  return true;
+#endif
+}
+
+/** \brief Maps a file if possible
+
+   \return The mapped file or an empty pointer if the file cannot be
+     mapped, e.g. because it is empty, not a regular file or larger
+     than the address space.
+*/
+mm_io_cptr
+mm_mmap_io_c::open(std::string const &file_name) {
+  if (!is_supported())
+    return mm_io_cptr{};
+
+  try {
+    return std::make_shared<mm_mmap_io_c>(file_name);
+
+  } catch (mtx::mm_io::exception &) {
+    return mm_io_cptr{};
+  }
+}
+
+uint64
+mm_mmap_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_mmap_io_c::setFilePointer(int64 offset,
+                             seek_mode mode) {
+  // Notices truncation before the new position is used.
+  check_size();
+
+  int64_t new_pos
+    = seek_beginning == mode ? offset
+    : seek_end       == mode ? static_cast<int64_t>(m_size) + offset // offsets from the end are negative already
+    :                          static_cast<int64_t>(m_pos)  + offset;
+
+  if ((0 > new_pos) || (static_cast<int64_t>(m_size) < new_pos))
+    throw mtx::mm_io::seek_x{};
+
+  m_pos = new_pos;
+
+  advise_will_need(m_pos, 0);
+}
+
+/** \brief Checks whether or not the file has been truncated
+
+   If it has then the size is reduced to the file's new size so that
+   the pages beyond its end aren't accessed.
+*/
+void
+mm_mmap_io_c::check_size() {
+#if !defined(SYS_WINDOWS)
+  struct stat st;
+
+  if ((-1 == m_fd) || (0 != fstat(m_fd, &st)) || (static_cast<uint64_t>(st.st_size) >= m_size))
+    return;
+
+  mxwarn(boost::format(Y("The file '%1%' was truncated from %2% to %3% bytes while it was being read.\n")) % m_file_name % m_size % st.st_size);
+
+  m_size            = st.st_size;
+  m_pos             = std::min(m_pos,             m_size);
+  m_will_need_start = std::min(m_will_need_start, m_size);
+  m_will_need_end   = std::min(m_will_need_end,   m_size);
+#endif
+}
+
+/** \brief Prepares a range of the mapping for being accessed
+
+   Checks the file's size and tells the kernel to read ahead from \c
+   start unless the range prepared last already covers at least \c
+   min_size bytes from \c start.
+
+   \return The end of the prepared range. All bytes between \c start
+     and the end may be accessed directly via \c get_mapped_data().
+*/
+uint64_t
+mm_mmap_io_c::prepare_range(uint64_t start,
+                            uint64_t min_size) {
+  check_size();
+  return advise_will_need(start, min_size);
+}
+
+/** \brief Tells the kernel to read ahead from \c start
+
+   Only done if the range announced last doesn't cover at least \c
+   min_size bytes from \c start already. Sequential reading within it
+   is covered by \c MADV_SEQUENTIAL.
+*/
+uint64_t
+mm_mmap_io_c::advise_will_need(uint64_t start,
+                               uint64_t min_size) {
+#if !defined(SYS_WINDOWS)
+  if (!m_data)
+    return 0;
+
+  if ((start >= m_will_need_start) && (start < m_will_need_end) && ((start + min_size) <= m_will_need_end))
+    return m_will_need_end;
+
+  if (start >= m_size)
+    return m_size;
+
+  static auto s_page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+  m_will_need_start = start - (start % s_page_size);
+  m_will_need_end   = std::min(start + std::max(min_size, s_will_need_size), m_size);
+
+  madvise(m_data + m_will_need_start, m_will_need_end - m_will_need_start, MADV_WILLNEED);
+#endif
+
+  return m_will_need_end;
+}
+
+uint32
+mm_mmap_io_c::_read(void *buffer,
+                    size_t size) {
+  if (!m_data)
+    return 0;
+
+  if ((m_pos + size) > m_will_need_end)
+    prepare_range(m_pos, size);
+
+  auto num_read = std::min<uint64_t>(size, m_size - m_pos);
+  memcpy(buffer, m_data + m_pos, num_read);
+
+  m_pos += num_read;
+
+  return num_read;
+}
+
+/** \brief Reads data without copying it
+
+   \return Read-only memory referring to the mapping directly. It
+     keeps the mapping alive on its own.
+*/
+memory_cptr
+mm_mmap_io_c::read_shared(size_t size) {
+  if (m_data && ((m_pos + size) > m_will_need_end))
+    prepare_range(m_pos, size);
+
+  if (!m_data || ((m_size - m_pos) < size))
+    throw mtx::mm_io::end_of_file_x{};
+
+  auto mem = memory_c::share(m_data + m_pos, size, m_mapping, true);
+
+  m_pos += size;
+
+  return mem;
+}
+
+/** \brief Returns read-only memory referring to the whole mapping
+
+   Only the ranges prepared with \c prepare_range() may be accessed.
+*/
+memory_cptr
+mm_mmap_io_c::get_mapped_data() {
+  return memory_c::share(m_data, m_size, m_mapping, true);
+}
+
+size_t
+mm_mmap_io_c::_write(const void *,
+                     size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x{};
+}
+
+int64_t
+mm_mmap_io_c::get_size() {
+  return m_size;
+}
+
+void
+mm_mmap_io_c::close() {
+#if !defined(SYS_WINDOWS)
+  if (-1 != m_fd)
+    ::close(m_fd);
+#endif
+
+  // Memory handed out by read_shared() keeps the mapping alive.
+  m_mapping.reset();
+  m_fd   = -1;
+  m_data = nullptr;
+  m_size = 0;
+  m_pos  = 0;
+}
+
+bool
+mm_mmap_io_c::eof() {
+  return m_pos >= m_size;
+}
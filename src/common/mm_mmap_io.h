@@ -0,0 +1,86 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_MMAP_IO_H
+#define MTX_COMMON_MM_MMAP_IO_H
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+/** \brief Reads from a local file that is mapped into memory
+
+   The whole file is mapped into memory at once. \c read() copies from
+   the mapping without any system call, and seeking is free. \c
+   read_shared() doesn't copy at all: the memory returned refers to
+   the mapping directly and keeps it alive even after the file has
+   been closed.
+
+   The kernel is told that the file will be read sequentially. After
+   each seek it is told to start reading ahead from the new position.
+
+   The mapping is read-only. Memory returned by \c read_shared() and
+   \c get_mapped_data() is marked as such and must be copied with
+   \c memory_c::make_writable() before it is modified.
+
+   Accessing pages of the mapping that lie beyond the end of the file
+   raises \c SIGBUS. Therefore the file's size is checked whenever a
+   new range is prepared for reading with \c prepare_range(), which
+   happens on each seek and whenever reading leaves the range
+   prepared last. If the file has been truncated then the size is
+   reduced accordingly, and reading stops at the new end just like it
+   does for regular files. Truncation while data from the range
+   prepared last is being accessed cannot be detected, though, and
+   neither can truncation affecting memory returned earlier. Files
+   must therefore not be truncated while they're being read.
+*/
+class mm_mmap_io_c: public mm_io_c {
+protected:
+  std::string m_file_name;
+  std::shared_ptr<void> m_mapping;
+  unsigned char *m_data;
+  uint64_t m_size, m_pos, m_will_need_start, m_will_need_end;
+  int m_fd;
+
+  debugging_option_c m_debug;
+
+public:
+  mm_mmap_io_c(std::string const &file_name);
+  virtual ~mm_mmap_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual memory_cptr read_shared(size_t size);
+  virtual int64_t get_size();
+  virtual void close();
+  virtual bool eof();
+
+  virtual std::string get_file_name() const {
+    return m_file_name;
+  }
+
+  memory_cptr get_mapped_data();
+  uint64_t prepare_range(uint64_t start, uint64_t min_size);
+
+  static bool is_supported();
+  static mm_io_cptr open(std::string const &file_name);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void check_size();
+  uint64_t advise_will_need(uint64_t start, uint64_t min_size);
+};
+
+#endif // MTX_COMMON_MM_MMAP_IO_H
@@ -0,0 +1,168 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_probe_io.h"
+
+// The head is read in pieces of at least this size so that probe
+// functions reading a couple of bytes at a time don't cause a read
+// each.
+static size_t const s_probe_chunk_size = 64 * 1024;
+
+mm_probe_io_c::mm_probe_io_c(mm_io_c *in,
+                             size_t max_head_size,
+                             bool delete_in)
+  : mm_proxy_io_c{in, delete_in}
+  , m_head{memory_c::alloc(0)}
+  , m_head_fill{}
+  , m_max_head_size{}
+  , m_pos{}
+  , m_size{in->get_size()}
+  , m_eof{}
+  , m_num_deep_reads{}
+  , m_num_deep_bytes{}
+{
+  m_max_head_size = std::min<uint64_t>(max_head_size, std::max<int64_t>(m_size, 0));
+}
+
+mm_probe_io_c::~mm_probe_io_c() {
+  close();
+}
+
+uint64
+mm_probe_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_probe_io_c::setFilePointer(int64 offset,
+                              seek_mode mode) {
+  int64_t new_pos
+    = seek_beginning == mode ? offset
+    : seek_end       == mode ? m_size                     + offset // offsets from the end are negative already
+    :                          static_cast<int64_t>(m_pos) + offset;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x{};
+
+  m_pos = new_pos;
+  m_eof = false;
+}
+
+int64_t
+mm_probe_io_c::get_size() {
+  return m_size;
+}
+
+bool
+mm_probe_io_c::eof() {
+  return m_eof;
+}
+
+void
+mm_probe_io_c::clear_eof() {
+  m_eof = false;
+}
+
+/** \brief Returns the start of the file
+
+   At least \c size bytes are available unless the head's maximum size
+   or the file is smaller; see \c get_head_size().
+*/
+unsigned char const *
+mm_probe_io_c::get_head(size_t size) {
+  fill_head(size);
+  return m_head->get_buffer();
+}
+
+/** \brief Returns the number of bytes read into the head so far
+ */
+size_t
+mm_probe_io_c::get_head_size()
+  const {
+  return m_head_fill;
+}
+
+unsigned int
+mm_probe_io_c::get_num_deep_reads()
+  const {
+  return m_num_deep_reads;
+}
+
+uint64_t
+mm_probe_io_c::get_num_deep_bytes()
+  const {
+  return m_num_deep_bytes;
+}
+
+uint32
+mm_probe_io_c::_read(void *buffer,
+                     size_t size) {
+  auto dest     = static_cast<unsigned char *>(buffer);
+  auto num_read = size_t{};
+
+  if (m_pos < m_max_head_size)
+    fill_head(std::min<uint64_t>(m_pos + size, m_max_head_size));
+
+  if (m_pos < m_head_fill) {
+    num_read = std::min<uint64_t>(size, m_head_fill - m_pos);
+    memcpy(dest, m_head->get_buffer() + m_pos, num_read);
+    m_pos += num_read;
+  }
+
+  if ((num_read < size) && (m_pos >= m_max_head_size) && (static_cast<int64_t>(m_pos) < m_size)) {
+    m_proxy_io->setFilePointer(m_pos, seek_beginning);
+    auto num_deep = m_proxy_io->read(dest + num_read, size - num_read);
+
+    m_pos            += num_deep;
+    num_read         += num_deep;
+    m_num_deep_bytes += num_deep;
+    ++m_num_deep_reads;
+  }
+
+  if (num_read < size)
+    m_eof = true;
+
+  return num_read;
+}
+
+size_t
+mm_probe_io_c::_write(const void *,
+                      size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x{};
+}
+
+/** \brief Reads the head up to \c end unless that has happened already
+ */
+void
+mm_probe_io_c::fill_head(size_t end) {
+  end = std::min(end, m_max_head_size);
+  if (end <= m_head_fill)
+    return;
+
+  end = std::min(std::max(end, m_head_fill + s_probe_chunk_size), m_max_head_size);
+
+  if (m_head->get_size() < end)
+    m_head->resize(std::min(std::max(end, m_head->get_size() * 2), m_max_head_size));
+
+  m_proxy_io->setFilePointer(m_head_fill, seek_beginning);
+  auto num_read = m_proxy_io->read(m_head->get_buffer() + m_head_fill, end - m_head_fill);
+
+  // The file is shorter than its reported size.
+  if (num_read < (end - m_head_fill))
+    m_max_head_size = m_head_fill + num_read;
+
+  m_head_fill += num_read;
+}
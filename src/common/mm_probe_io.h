@@ -0,0 +1,61 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_PROBE_IO_H
+#define MTX_COMMON_MM_PROBE_IO_H
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+/** \brief Keeps the head of a file in memory while it is being probed
+
+   The first \c max_head_size bytes are read on demand: only as much
+   of them as the probe functions actually access is read, and each
+   byte only once. All reads within that range are served from memory
+   no matter how often the position is changed. Reads beyond it are
+   passed on to the proxied file and counted as deep reads.
+*/
+class mm_probe_io_c: public mm_proxy_io_c {
+protected:
+  memory_cptr m_head;
+  size_t m_head_fill, m_max_head_size;
+  uint64_t m_pos;
+  int64_t m_size;
+  bool m_eof;
+  unsigned int m_num_deep_reads;
+  uint64_t m_num_deep_bytes;
+
+public:
+  mm_probe_io_c(mm_io_c *in, size_t max_head_size, bool delete_in = false);
+  virtual ~mm_probe_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual int64_t get_size();
+  virtual bool eof();
+  virtual void clear_eof();
+
+  unsigned char const *get_head(size_t size);
+  size_t get_head_size() const;
+  unsigned int get_num_deep_reads() const;
+  uint64_t get_num_deep_bytes() const;
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void fill_head(size_t end);
+};
+
+#endif // MTX_COMMON_MM_PROBE_IO_H
@@ -15,6 +15,7 @@
 #include "common/common_pch.h"
 
 #include "common/mm_io_x.h"
+#include "common/mm_mmap_io.h"
 #include "common/mm_read_buffer_io.h"
 
 mm_read_buffer_io_c::mm_read_buffer_io_c(mm_io_c *in,
@@ -31,6 +32,32 @@ mm_read_buffer_io_c::mm_read_buffer_io_c(mm_io_c *in,
   , m_buffering(true)
   , m_debug_seek{"read_buffer_io|read_buffer_io_read"}
   , m_debug_read{"read_buffer_io|read_buffer_io_read"}
+  , m_mapped_in{}
+{
+  setFilePointer(0, seek_beginning);
+}
+
+/** \brief Uses the mapping of a file as the buffer
+
+   Nothing is copied. Only the bytes up to the end of the range
+   prepared with \c mm_mmap_io_c::prepare_range() count as buffered so
+   that truncation of the file is noticed before the mapping is
+   accessed beyond its end.
+*/
+mm_read_buffer_io_c::mm_read_buffer_io_c(mm_mmap_io_c *in,
+                                         memory_cptr const &mapped_data)
+  : mm_proxy_io_c(in, false)
+  , m_af_buffer(mapped_data)
+  , m_buffer(mapped_data->get_buffer())
+  , m_cursor(0)
+  , m_eof(false)
+  , m_fill(0)
+  , m_offset(0)
+  , m_size(mapped_data->get_size())
+  , m_buffering(true)
+  , m_debug_seek{"read_buffer_io|read_buffer_io_read"}
+  , m_debug_read{"read_buffer_io|read_buffer_io_read"}
+  , m_mapped_in{in}
 {
   setFilePointer(0, seek_beginning);
 }
@@ -70,6 +97,9 @@ mm_read_buffer_io_c::setFilePointer(int64 offset,
       break;
 
     case seek_end:
+      if (0 > get_size())
+        throw mtx::mm_io::seek_x();
+
       new_pos = static_cast<int64_t>(get_size()) + offset; // offsets from the end are negative already
       break;
 
@@ -77,6 +107,16 @@ mm_read_buffer_io_c::setFilePointer(int64 offset,
       throw mtx::mm_io::seek_x();
   }
 
+  if (m_mapped_in) {
+    if (0 > new_pos)
+      throw mtx::mm_io::seek_x();
+
+    m_cursor = std::min<int64_t>(new_pos, get_size());
+    mapped_refill(0);
+
+    return;
+  }
+
   // Still within the current buffer?
   int64_t in_buf = new_pos - m_offset;
   if ((0 <= in_buf) && (in_buf <= static_cast<int64_t>(m_fill))) {
@@ -85,9 +125,10 @@ mm_read_buffer_io_c::setFilePointer(int64 offset,
   }
 
   int64_t previous_pos = m_proxy_io->getFilePointer();
+  auto source_size     = get_size();
 
   // Actual seeking
-  m_proxy_io->setFilePointer(std::min(new_pos, get_size()), seek_beginning);
+  m_proxy_io->setFilePointer(0 > source_size ? new_pos : std::min(new_pos, source_size), seek_beginning);
 
   // Get the actual offset from the underlying stream
   // Better be safe than sorry and use this instead of just taking
@@ -123,12 +164,18 @@ mm_read_buffer_io_c::_read(void *buffer,
       size     -= avail;
       m_cursor += avail;
 
+    } else if (m_mapped_in) {
+      if (!mapped_refill(1))
+        break;
+
     } else {
-      // Refill the buffer
-      m_offset += m_cursor;
-      m_cursor  = 0;
-      m_fill    = 0;
-      avail     = std::min(get_size() - m_offset, static_cast<int64_t>(m_size));
+      // Refill the buffer. A negative size means that the size of a
+      // stream isn't known yet.
+      auto source_size = get_size();
+      m_offset        += m_cursor;
+      m_cursor         = 0;
+      m_fill           = 0;
+      avail            = 0 > source_size ? static_cast<int64_t>(m_size) : std::min(source_size - m_offset, static_cast<int64_t>(m_size));
 
       if (!avail) {
         // must keep track of eof, as m_proxy_io->eof() will never be reached
@@ -161,6 +208,11 @@ mm_read_buffer_io_c::_write(const void *,
 
 void
 mm_read_buffer_io_c::enable_buffering(bool enable) {
+  // Reading from a mapping doesn't involve buffering that could be
+  // turned off.
+  if (m_mapped_in)
+    return;
+
   m_buffering = enable;
   if (!m_buffering) {
     m_offset = 0;
@@ -168,3 +220,105 @@ mm_read_buffer_io_c::enable_buffering(bool enable) {
     m_fill   = 0;
   }
 }
+
+bool
+mm_read_buffer_io_c::cursor_refill(size_t num_bytes) {
+  if (m_mapped_in)
+    return mapped_refill(num_bytes);
+
+  if (!m_buffering || (num_bytes > m_size))
+    return false;
+
+  // Move the bytes not consumed yet to the start of the buffer so
+  // that the requested range will be contiguous.
+  if (m_cursor) {
+    m_fill -= m_cursor;
+    memmove(m_buffer, m_buffer + m_cursor, m_fill);
+    m_offset += m_cursor;
+    m_cursor  = 0;
+  }
+
+  auto file_size = get_size();
+
+  while (m_fill < num_bytes) {
+    auto avail = 0 > file_size ? static_cast<int64_t>(m_size - m_fill) : std::min<int64_t>(file_size - m_offset - m_fill, m_size - m_fill);
+    if (0 >= avail) {
+      m_eof = true;
+      return false;
+    }
+
+    int64_t previous_pos = m_proxy_io->getFilePointer();
+    auto num_read        = m_proxy_io->read(m_buffer + m_fill, avail);
+
+    mxdebug_if(m_debug_read, boost::format("physical read from position %3% for %1% returned %2%\n") % avail % num_read % previous_pos);
+
+    if (!num_read) {
+      m_eof = true;
+      return false;
+    }
+
+    m_fill += num_read;
+  }
+
+  return true;
+}
+
+/** \brief Extends the buffered range of a mapped file
+
+   \return \c false if less than \c num_bytes bytes are left in the
+     file.
+*/
+bool
+mm_read_buffer_io_c::mapped_refill(size_t num_bytes) {
+  m_fill = std::max<uint64_t>(m_mapped_in->prepare_range(m_cursor, num_bytes), m_cursor);
+
+  if (cursor_available() >= num_bytes)
+    return true;
+
+  m_eof = true;
+  return false;
+}
+
+bool
+mm_read_buffer_io_c::cursor_seek(int64_t num_bytes) {
+  auto new_pos   = static_cast<int64_t>(getFilePointer()) + num_bytes;
+  auto file_size = get_size();
+  if ((0 > new_pos) || ((0 <= file_size) && (new_pos > file_size)))
+    return false;
+
+  setFilePointer(new_pos, seek_beginning);
+
+  return true;
+}
+
+/** \brief Returns a buffered reader for \c in
+
+   \c in itself is returned if it is a buffered reader already.
+   Otherwise a new buffered reader is created that keeps a reference to
+   \c in and that starts at \c in's current position. If \c in is a
+   file mapped into memory then the reader uses the mapping directly
+   instead of a buffer of \c buffer_size bytes.
+*/
+mm_read_buffer_io_cptr
+mm_read_buffer_io_c::wrap(mm_io_cptr const &in,
+                          size_t buffer_size) {
+  auto buffered = std::dynamic_pointer_cast<mm_read_buffer_io_c>(in);
+  if (buffered)
+    return buffered;
+
+  auto position = in->getFilePointer();
+  auto mapped   = std::dynamic_pointer_cast<mm_mmap_io_c>(in);
+
+  if (mapped)
+    buffered = std::make_shared<mm_read_buffer_io_c>(mapped.get(), mapped->get_mapped_data());
+
+  else {
+    in->setFilePointer(0, seek_beginning);
+    buffered = std::make_shared<mm_read_buffer_io_c>(in.get(), buffer_size, false);
+  }
+
+  buffered->m_shared_proxy_io = in;
+  buffered->setFilePointer(position, seek_beginning);
+
+  return buffered;
+}
@@ -19,8 +19,29 @@
 
 #include "common/mm_io.h"
 
+class mm_mmap_io_c;
+class mm_read_buffer_io_c;
+using mm_read_buffer_io_cptr = std::shared_ptr<mm_read_buffer_io_c>;
+
+/** \brief Buffered reader with a fast path for parsing byte by byte
+
+   Apart from the usual \c mm_io_c interface this class offers a read
+   cursor that operates directly on its buffer: \c cursor_ensure()
+   makes sure that a number of bytes is available, \c cursor_data()
+   returns a pointer to them, and \c cursor_advance() consumes
+   them. The \c try_read_*() and \c try_skip() functions build on
+   that. All of these are inlined and report the end of the file via
+   their return value instead of throwing an exception. They can be
+   mixed freely with the normal read and seek functions.
+
+   The cursor requires buffering to be enabled.
+
+   Files mapped into memory aren't copied into a buffer at all. The
+   mapping itself is used as the buffer instead, see \c wrap().
+*/
 class mm_read_buffer_io_c: public mm_proxy_io_c {
 protected:
+  mm_io_cptr m_shared_proxy_io;
   memory_cptr m_af_buffer;
   unsigned char *m_buffer;
   size_t m_cursor;
@@ -30,9 +51,11 @@ protected:
   const size_t m_size;
   bool m_buffering;
   debugging_option_c m_debug_seek, m_debug_read;
+  mm_mmap_io_c *m_mapped_in;
 
 public:
   mm_read_buffer_io_c(mm_io_c *in, size_t buffer_size = 1 << 12, bool delete_in = true);
+  mm_read_buffer_io_c(mm_mmap_io_c *in, memory_cptr const &mapped_data);
   virtual ~mm_read_buffer_io_c();
 
   virtual uint64 getFilePointer();
@@ -42,11 +65,78 @@ public:
   virtual void clear_eof() { m_eof = false; }
   virtual void enable_buffering(bool enable);
 
+  inline size_t cursor_available() const {
+    return m_fill - m_cursor;
+  }
+
+  /** \brief Makes sure that at least \c num_bytes bytes can be accessed via \c cursor_data()
+
+     \c num_bytes must not be bigger than the buffer size.
+
+     \return \c false if the end of the file has been reached before.
+  */
+  inline bool cursor_ensure(size_t num_bytes) {
+    return (cursor_available() >= num_bytes) || cursor_refill(num_bytes);
+  }
+
+  inline unsigned char const *cursor_data() const {
+    return m_buffer + m_cursor;
+  }
+
+  inline void cursor_advance(size_t num_bytes) {
+    assert(num_bytes <= cursor_available());
+    m_cursor += num_bytes;
+  }
+
+  inline bool try_read_uint8(uint8_t &value) {
+    if (!cursor_ensure(1))
+      return false;
+
+    value = m_buffer[m_cursor++];
+    return true;
+  }
+
+  inline bool try_read_uint16_be(uint16_t &value) {
+    if (!cursor_ensure(2))
+      return false;
+
+    value     = (static_cast<uint16_t>(m_buffer[m_cursor]) << 8) | m_buffer[m_cursor + 1];
+    m_cursor += 2;
+    return true;
+  }
+
+  inline bool try_read_uint32_be(uint32_t &value) {
+    if (!cursor_ensure(4))
+      return false;
+
+    auto data = m_buffer + m_cursor;
+    value     = (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+    m_cursor += 4;
+    return true;
+  }
+
+  /** \brief Skips \c num_bytes bytes, seeking if they're not buffered
+
+     \return \c false if the end of the file would be passed.
+  */
+  inline bool try_skip(int64_t num_bytes) {
+    if ((0 <= num_bytes) && (static_cast<uint64_t>(num_bytes) <= cursor_available())) {
+      m_cursor += num_bytes;
+      return true;
+    }
+
+    return cursor_seek(num_bytes);
+  }
+
+  static mm_read_buffer_io_cptr wrap(mm_io_cptr const &in, size_t buffer_size = 1 << 17);
+
 protected:
   virtual uint32 _read(void *buffer, size_t size);
   virtual size_t _write(const void *buffer, size_t size);
-};
 
-using mm_read_buffer_io_cptr = std::shared_ptr<mm_read_buffer_io_c>;
+  bool cursor_refill(size_t num_bytes);
+  bool mapped_refill(size_t num_bytes);
+  bool cursor_seek(int64_t num_bytes);
+};
 
 #endif // MTX_COMMON_MM_READ_BUFFER_IO_H
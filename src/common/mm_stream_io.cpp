@@ -0,0 +1,213 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if defined(SYS_WINDOWS)
+# include <fcntl.h>
+# include <io.h>
+#endif
+
+#include "common/mm_io_x.h"
+#include "common/mm_stream_io.h"
+
+static size_t const s_stream_io_chunk_size = 64 * 1024;
+
+mm_stream_io_c::mm_stream_io_c(mm_io_c *in,
+                               std::string const &file_name,
+                               size_t history_size,
+                               bool delete_in)
+  : mm_proxy_io_c{in, delete_in}
+  , m_file_name{file_name}
+  , m_buffer{memory_c::alloc(s_stream_io_chunk_size)}
+  , m_buffer_start{}
+  , m_pos{}
+  , m_buffer_fill{}
+  , m_history_size{history_size}
+  , m_keep_head{true}
+  , m_eof{}
+  , m_source_eof{}
+{
+}
+
+mm_stream_io_c::~mm_stream_io_c() {
+  close();
+}
+
+uint64
+mm_stream_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_stream_io_c::setFilePointer(int64 offset,
+                               seek_mode mode) {
+  if ((seek_end == mode) && !m_source_eof)
+    throw mtx::mm_io::seek_x{};
+
+  int64_t new_pos
+    = seek_beginning == mode ? offset
+    : seek_end       == mode ? get_size()                  + offset // offsets from the end are negative already
+    :                          static_cast<int64_t>(m_pos) + offset;
+
+  // Data that has been dropped from the window cannot be read again.
+  if ((0 > new_pos) || (static_cast<uint64_t>(new_pos) < m_buffer_start))
+    throw mtx::mm_io::seek_x{};
+
+  m_pos = new_pos;
+  m_eof = false;
+}
+
+int64_t
+mm_stream_io_c::get_size() {
+  return m_source_eof ? static_cast<int64_t>(m_buffer_start + m_buffer_fill) : -1;
+}
+
+bool
+mm_stream_io_c::eof() {
+  return m_eof;
+}
+
+void
+mm_stream_io_c::clear_eof() {
+  m_eof = false;
+}
+
+std::string
+mm_stream_io_c::get_file_name()
+  const {
+  return m_file_name;
+}
+
+/** \brief Returns up to \c size bytes from the start of the source
+
+   The current position is not changed. This is only possible as long
+   as the head is kept.
+*/
+memory_cptr
+mm_stream_io_c::read_head(size_t size) {
+  if (!m_keep_head)
+    throw mtx::mm_io::seek_x{};
+
+  auto previous_pos = m_pos;
+  auto head         = memory_c::alloc(size);
+
+  m_pos = 0;
+  head->set_size(read(head->get_buffer(), size));
+
+  m_pos = previous_pos;
+  m_eof = false;
+
+  return head;
+}
+
+/** \brief Stops keeping the head of the source in memory
+
+   Must be called once probing and header parsing are done. Otherwise
+   the whole source would be kept in memory.
+*/
+void
+mm_stream_io_c::release_head() {
+  m_keep_head = false;
+}
+
+uint32
+mm_stream_io_c::_read(void *buffer,
+                      size_t size) {
+  auto dest     = static_cast<unsigned char *>(buffer);
+  auto num_read = size_t{};
+
+  while (num_read < size) {
+    auto buffer_end = m_buffer_start + m_buffer_fill;
+
+    if (m_pos < buffer_end) {
+      auto num_copied = std::min<uint64_t>(size - num_read, buffer_end - m_pos);
+      memcpy(dest + num_read, m_buffer->get_buffer() + (m_pos - m_buffer_start), num_copied);
+
+      m_pos    += num_copied;
+      num_read += num_copied;
+
+    } else if (!fill_buffer())
+      break;
+  }
+
+  if (num_read < size)
+    m_eof = true;
+
+  return num_read;
+}
+
+size_t
+mm_stream_io_c::_write(const void *,
+                       size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x{};
+}
+
+/** \brief Appends the next chunk of the source to the window
+
+   Data before the history is dropped first. This is only done once
+   enough of it has accumulated so that the data kept isn't moved
+   around on every read.
+
+   \return \c false if the end of the source has been reached.
+*/
+bool
+mm_stream_io_c::fill_buffer() {
+  if (m_source_eof)
+    return false;
+
+  auto keep_from = m_pos > m_history_size ? m_pos - m_history_size : 0;
+  auto num_stale = keep_from > m_buffer_start ? std::min<uint64_t>(keep_from - m_buffer_start, m_buffer_fill) : 0;
+
+  if (!m_keep_head && num_stale && ((num_stale == m_buffer_fill) || (num_stale >= m_history_size))) {
+    m_buffer_fill  -= num_stale;
+    m_buffer_start += num_stale;
+    memmove(m_buffer->get_buffer(), m_buffer->get_buffer() + num_stale, m_buffer_fill);
+  }
+
+  if (m_buffer->get_size() < (m_buffer_fill + s_stream_io_chunk_size))
+    m_buffer->resize(std::max(m_buffer_fill + s_stream_io_chunk_size, m_buffer->get_size() * 2));
+
+  auto num_read  = m_proxy_io->read(m_buffer->get_buffer() + m_buffer_fill, s_stream_io_chunk_size);
+  m_buffer_fill += num_read;
+
+  if (num_read < s_stream_io_chunk_size)
+    m_source_eof = true;
+
+  return 0 != num_read;
+}
+
+/** \brief Determines whether or not a file name refers to a non-seekable source
+
+   This is the case for '-' meaning the standard input and for FIFOs.
+*/
+bool
+mm_stream_io_c::is_stream(std::string const &file_name) {
+  if ("-" == file_name)
+    return true;
+
+  boost::system::error_code ec;
+  return bfs::status(bfs::path{file_name}, ec).type() == bfs::fifo_file;
+}
+
+mm_stream_io_cptr
+mm_stream_io_c::open(std::string const &file_name) {
+  if ("-" != file_name)
+    return std::make_shared<mm_stream_io_c>(new mm_file_io_c{file_name}, file_name);
+
+#if defined(SYS_WINDOWS)
+  _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+  return std::make_shared<mm_stream_io_c>(new mm_stdio_c, file_name);
+}
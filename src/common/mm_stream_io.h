@@ -0,0 +1,71 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_STREAM_IO_H
+#define MTX_COMMON_MM_STREAM_IO_H
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+class mm_stream_io_c;
+using mm_stream_io_cptr = std::shared_ptr<mm_stream_io_c>;
+
+/** \brief Reads from sources that cannot seek, e.g. pipes and FIFOs
+
+   The data read from the source is kept in a window in memory. The
+   position can be changed freely within that window and to any point
+   after it; seeking forward beyond the window reads and discards the
+   data in between.
+
+   Initially the window always starts at the beginning of the source
+   so that its head can be probed and its headers be parsed as often
+   as necessary. After \c release_head() has been called only the last
+   \c history_size bytes before the current position are kept.
+
+   The size is unknown until the end of the source has been reached.
+   Until then \c get_size() returns -1.
+*/
+class mm_stream_io_c: public mm_proxy_io_c {
+protected:
+  std::string m_file_name;
+  memory_cptr m_buffer;
+  uint64_t m_buffer_start, m_pos;
+  size_t m_buffer_fill, m_history_size;
+  bool m_keep_head, m_eof, m_source_eof;
+
+public:
+  mm_stream_io_c(mm_io_c *in, std::string const &file_name, size_t history_size = 1024 * 1024, bool delete_in = true);
+  virtual ~mm_stream_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual int64_t get_size();
+  virtual bool eof();
+  virtual void clear_eof();
+  virtual std::string get_file_name() const;
+
+  memory_cptr read_head(size_t size);
+  void release_head();
+
+  static bool is_stream(std::string const &file_name);
+  static mm_stream_io_cptr open(std::string const &file_name);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  bool fill_buffer();
+};
+
+#endif // MTX_COMMON_MM_STREAM_IO_H
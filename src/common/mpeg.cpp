@@ -0,0 +1,205 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   helper functions shared by the MPEG elementary stream parsers
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define MTX_START_CODE_SCANNER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# include <emmintrin.h>
+# define MTX_START_CODE_SCANNER_SSE2
+#endif
+
+#if defined(COMP_MSC)
+# include <intrin.h>
+#endif
+
+#include "common/endian.h"
+#include "common/mpeg.h"
+
+namespace mtx { namespace mpeg {
+
+namespace {
+
+#if defined(MTX_START_CODE_SCANNER_AVX2) || defined(MTX_START_CODE_SCANNER_SSE2)
+inline unsigned int
+count_trailing_zero_bits(unsigned int value) {
+# if defined(COMP_MSC)
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return index;
+# else
+  return __builtin_ctz(value);
+# endif
+}
+#endif
+
+std::size_t
+find_start_code_scalar(unsigned char const *buffer,
+                       std::size_t size,
+                       std::size_t pos) {
+  // Look at the third byte of each candidate first. If it is neither 0
+  // nor 1 then no start code can begin at any of the three positions
+  // ending with it.
+  while ((pos + 2) < size) {
+    auto third = buffer[pos + 2];
+
+    if (1 < third)
+      pos += 3;
+
+    else if (0 == third)
+      ++pos;
+
+    else if (!buffer[pos] && !buffer[pos + 1])
+      return pos;
+
+    else
+      pos += 3;
+  }
+
+  return size;
+}
+
+}
+
+std::size_t
+find_start_code(unsigned char const *buffer,
+                std::size_t size) {
+  std::size_t pos = 0;
+
+#if defined(MTX_START_CODE_SCANNER_AVX2)
+  auto const zeros = _mm256_setzero_si256();
+  auto const ones  = _mm256_set1_epi8(1);
+
+  while ((pos + 2 + 32) <= size) {
+    auto first  = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(buffer + pos)),     zeros);
+    auto second = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(buffer + pos + 1)), zeros);
+    auto third  = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(buffer + pos + 2)), ones);
+    auto mask   = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(first, second), third)));
+
+    if (mask)
+      return pos + count_trailing_zero_bits(mask);
+
+    pos += 32;
+  }
+
+#elif defined(MTX_START_CODE_SCANNER_SSE2)
+  auto const zeros = _mm_setzero_si128();
+  auto const ones  = _mm_set1_epi8(1);
+
+  while ((pos + 2 + 16) <= size) {
+    auto first  = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + pos)),     zeros);
+    auto second = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + pos + 1)), zeros);
+    auto third  = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + pos + 2)), ones);
+    auto mask   = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(first, second), third)));
+
+    if (mask)
+      return pos + count_trailing_zero_bits(mask);
+
+    pos += 16;
+  }
+#endif
+
+  return find_start_code_scalar(buffer, size, pos);
+}
+
+std::size_t
+find_nalu_start_code(unsigned char const *buffer,
+                     std::size_t size,
+                     std::size_t offset,
+                     std::size_t &marker_size) {
+  if (offset >= size)
+    return size;
+
+  auto pos = offset + find_start_code(buffer + offset, size - offset);
+  if (pos >= size)
+    return size;
+
+  if ((0 < pos) && !buffer[pos - 1]) {
+    marker_size = 4;
+    return pos - 1;
+  }
+
+  marker_size = 3;
+  return pos;
+}
+
+std::size_t
+split_nalus(unsigned char *buffer,
+            std::size_t size,
+            memory_cptr &unparsed_buffer,
+            std::function<void(memory_cptr const &nalu, std::size_t offset)> const &handle_nalu) {
+  unsigned char *data              = buffer;
+  std::size_t data_size            = size;
+  std::size_t scan_pos             = 0;
+  std::size_t marker_size          = 0;
+  std::size_t previous_marker_size = 0;
+  int64_t previous_pos             = -1;
+
+  // Keep the data contiguous so that the start code search can run over
+  // a single buffer and so that the NALUs can be handed on as slices of
+  // that buffer. The unparsed buffer always starts with the start code
+  // of the NALU that was incomplete after the last call, if there was
+  // one, and has already been searched up to its last two bytes.
+  if (unparsed_buffer && (0 != unparsed_buffer->get_size())) {
+    auto unparsed_size = unparsed_buffer->get_size();
+    auto unparsed      = unparsed_buffer->get_buffer();
+
+    if ((4 <= unparsed_size) && (get_uint32_be(unparsed) == 0x00000001))
+      previous_marker_size = 4;
+    else if ((3 <= unparsed_size) && (get_uint24_be(unparsed) == 0x000001))
+      previous_marker_size = 3;
+
+    if (previous_marker_size)
+      previous_pos = 0;
+
+    scan_pos = std::max<std::size_t>(unparsed_size, 2) - 2;
+
+    unparsed_buffer->add(buffer, size);
+    data      = unparsed_buffer->get_buffer();
+    data_size = unparsed_buffer->get_size();
+  }
+
+  while (true) {
+    auto marker_pos = find_nalu_start_code(data, data_size, scan_pos, marker_size);
+    if (marker_pos >= data_size)
+      break;
+
+    if (-1 != previous_pos)
+      handle_nalu(memory_pool_c::make_shared<memory_c>(data + previous_pos + previous_marker_size, marker_pos - previous_pos - previous_marker_size, false), previous_pos);
+
+    previous_pos         = marker_pos;
+    previous_marker_size = marker_size;
+    scan_pos             = marker_pos + marker_size;
+  }
+
+  if (-1 == previous_pos)
+    previous_pos = 0;
+
+  auto new_size = data_size - previous_pos;
+  if (0 == new_size)
+    unparsed_buffer.reset();
+
+  else if (data == buffer)
+    unparsed_buffer = memory_c::clone(data + previous_pos, new_size);
+
+  else if (0 != previous_pos) {
+    memmove(data, data + previous_pos, new_size);
+    unparsed_buffer->set_size(new_size);
+  }
+
+  return previous_pos;
+}
+
+}}
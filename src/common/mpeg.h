@@ -0,0 +1,77 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   helper functions shared by the MPEG elementary stream parsers
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MPEG_H
+#define MTX_COMMON_MPEG_H
+
+#include "common/common_pch.h"
+
+#include <functional>
+
+namespace mtx { namespace mpeg {
+
+/** \brief Finds the next three byte start code \c 00 00 01
+
+   Uses SSE2 or AVX2 instructions if the compiler targets them and a
+   scalar search otherwise.
+
+   \param buffer The buffer to search.
+   \param size Number of bytes in \c buffer.
+
+   \return The offset of the first byte of the start code or \c size
+     if \c buffer doesn't contain a complete start code.
+*/
+std::size_t find_start_code(unsigned char const *buffer, std::size_t size);
+
+/** \brief Finds the next NALU start code in an AVC/HEVC elementary stream
+
+   Works like \c find_start_code but starts searching at \c offset. If
+   the start code is preceded by a zero byte then that byte is
+   considered to be part of a four byte start code \c 00 00 00 01.
+
+   \param buffer The buffer to search.
+   \param size Number of bytes in \c buffer.
+   \param offset Position to start searching at.
+   \param marker_size Set to 3 or 4 for a three or four byte start code.
+
+   \return The offset of the first byte of the start code or \c size
+     if no further start code was found.
+*/
+std::size_t find_nalu_start_code(unsigned char const *buffer, std::size_t size, std::size_t offset, std::size_t &marker_size);
+
+/** \brief Splits the data of an AVC/HEVC elementary stream into NALUs
+
+   \c unparsed_buffer holds the data of the last, incomplete NALU of
+   the previous call including its start code. \c buffer is appended
+   to it if it isn't empty. Each NALU that is complete is passed to \c
+   handle_nalu without its start code. Afterwards \c unparsed_buffer
+   holds the data of the new last, incomplete NALU.
+
+   The NALUs passed to \c handle_nalu may point into \c buffer or into
+   \c unparsed_buffer. They have to be copied if they're kept.
+
+   \param buffer The new data.
+   \param size Number of bytes in \c buffer.
+   \param unparsed_buffer The data left over from the previous call.
+   \param handle_nalu Called for each complete NALU with the NALU and
+     the offset of its start code relative to the start of the data
+     left over from the previous call.
+
+   \return The offset of the data now in \c unparsed_buffer relative to
+     the start of the data left over from the previous call.
+*/
+std::size_t split_nalus(unsigned char *buffer, std::size_t size, memory_cptr &unparsed_buffer, std::function<void(memory_cptr const &nalu, std::size_t offset)> const &handle_nalu);
+
+}}
+
+#endif  // MTX_COMMON_MPEG_H
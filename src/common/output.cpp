@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
 #include <sstream>
 
 #include "common/ebml.h"
@@ -32,6 +33,7 @@ charset_converter_cptr g_cc_stdio = charset_converter_cptr(new charset_converter
 std::shared_ptr<mm_io_c> g_mm_stdio   = std::shared_ptr<mm_io_c>(new mm_stdio_c);
 
 static mxmsg_handler_t s_mxmsg_info_handler, s_mxmsg_warning_handler, s_mxmsg_error_handler;
+static thread_local bool tl_errors_as_exceptions = false;
 
 void
 redirect_stdio(const mm_io_cptr &stdio) {
@@ -62,10 +64,15 @@ void
 mxmsg(unsigned int level,
       std::string message) {
   static bool s_saw_cr_after_nl = false;
+  static std::mutex s_mutex;
 
   if (g_suppress_info && (MXMSG_INFO == level))
     return;
 
+  // Worker threads, e.g. mkvmerge's reader threads or mkvextract's
+  // workers, may emit messages, too.
+  std::lock_guard<std::mutex> lock{s_mutex};
+
   if ('\n' == message[0]) {
     message.erase(0, 1);
     g_mm_stdio->puts("\n");
@@ -143,10 +150,23 @@ default_mxerror(unsigned int,
 
 void
 mxerror(std::string const &error) {
+  if (tl_errors_as_exceptions)
+    throw mtx::output::error_x{error};
+
   if (s_mxmsg_error_handler)
     s_mxmsg_error_handler(MXMSG_ERROR, error);
 }
 
+mtx::output::errors_as_exceptions_c::errors_as_exceptions_c()
+  : m_previous{tl_errors_as_exceptions}
+{
+  tl_errors_as_exceptions = true;
+}
+
+mtx::output::errors_as_exceptions_c::~errors_as_exceptions_c() {
+  tl_errors_as_exceptions = m_previous;
+}
+
 void
 mxinfo_fn(const std::string &file_name,
           const std::string &info) {
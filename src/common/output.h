@@ -28,7 +28,7 @@ using namespace libebml;
 using mxmsg_handler_t = std::function<void(unsigned int level, std::string const &)>;
 void set_mxmsg_handler(unsigned int level, mxmsg_handler_t const &handler);
 
-extern bool g_suppress_info, g_suppress_warnings;
+extern bool g_suppress_info, g_suppress_warnings, g_warning_issued;
 extern std::string g_stdio_charset;
 extern charset_converter_cptr g_cc_stdio;
 extern std::shared_ptr<mm_io_c> g_mm_stdio;
@@ -68,6 +68,40 @@ mxerror(const boost::format &error) {
   mxerror(error.str());
 }
 
+namespace mtx { namespace output {
+
+class error_x: public exception {
+protected:
+  std::string m_message;
+public:
+  error_x(std::string const &message): m_message(message) { }
+  virtual ~error_x() throw() { }
+
+  virtual const char *what() const throw() {
+    return m_message.c_str();
+  }
+};
+
+/** \brief Makes \c mxerror() throw \c error_x on the current thread
+
+   Threads other than the main thread must never terminate the
+   program. Code run on them can still report errors via \c mxerror()
+   as long as such a scope is active: the error is thrown as an
+   \c error_x which can be handed over to the main thread and be
+   reported there.
+
+   The previous behaviour is restored when the scope ends.
+*/
+class errors_as_exceptions_c {
+protected:
+  bool m_previous;
+public:
+  errors_as_exceptions_c();
+  ~errors_as_exceptions_c();
+};
+
+}}
+
 #define mxverb(level, message)        \
   if (verbose >= level)               \
     mxinfo(message);
@@ -12,6 +12,7 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -157,6 +158,10 @@ std::vector<property_element_c> &
 property_element_c::get_table_for(const EbmlCallbacks &master_callbacks,
                                   const EbmlCallbacks *sub_master_callbacks,
                                   bool full_table) {
+  // mkvpropedit's batch mode validates changes on several threads.
+  static std::mutex s_mutex;
+  std::lock_guard<std::mutex> lock{s_mutex};
+
   if (s_properties.empty())
     init_tables();
 
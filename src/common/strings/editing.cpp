@@ -198,6 +198,37 @@ unescape(const std::string &source) {
   return dst;
 }
 
+/** \brief Escapes a string for use inside a JSON string literal
+
+   The source is assumed to be valid UTF-8. Only the characters JSON
+   requires to be escaped are escaped; all others are copied as they
+   are.
+*/
+std::string
+escape_json(std::string const &src) {
+  std::string dst;
+  dst.reserve(src.length());
+
+  for (auto c : src) {
+    if ('"' == c)
+      dst += "\\\"";
+    else if ('\\' == c)
+      dst += "\\\\";
+    else if ('\n' == c)
+      dst += "\\n";
+    else if ('\r' == c)
+      dst += "\\r";
+    else if ('\t' == c)
+      dst += "\\t";
+    else if (0x20 > static_cast<unsigned char>(c))
+      dst += (boost::format("\\u%|1$04x|") % static_cast<unsigned int>(c)).str();
+    else
+      dst += c;
+  }
+
+  return dst;
+}
+
 std::string
 get_displayable_string(const char *src,
                        int max_len) {
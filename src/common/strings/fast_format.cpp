@@ -0,0 +1,226 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   pre-parsed format strings
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <cstdio>
+
+#include "common/strings/fast_format.h"
+
+namespace {
+
+void
+append_unsigned(std::string &dst,
+                uint64_t value) {
+  char buffer[24];
+  auto end = buffer + sizeof(buffer);
+  auto ptr = end;
+
+  do {
+    *--ptr  = '0' + (value % 10);
+    value  /= 10;
+  } while (value);
+
+  dst.append(ptr, end - ptr);
+}
+
+void
+append_signed(std::string &dst,
+              int64_t value) {
+  if (0 <= value) {
+    append_unsigned(dst, value);
+    return;
+  }
+
+  dst += '-';
+  append_unsigned(dst, static_cast<uint64_t>(-(value + 1)) + 1);
+}
+
+template<typename T>
+void
+append_printf(std::string &dst,
+              std::string const &printf_format,
+              T value) {
+  char buffer[128];
+  auto length = snprintf(buffer, sizeof(buffer), printf_format.c_str(), value);
+
+  if (length < static_cast<int>(sizeof(buffer))) {
+    dst.append(buffer, std::max(length, 0));
+    return;
+  }
+
+  auto large_buffer = std::string(length + 1, '\0');
+  snprintf(&large_buffer[0], large_buffer.size(), printf_format.c_str(), value);
+  dst.append(large_buffer.c_str(), length);
+}
+
+}
+
+fast_format_c::fast_format_c()
+  : m_num_args{}
+{
+}
+
+fast_format_c::fast_format_c(std::string const &format)
+  : m_num_args{}
+{
+  parse(format);
+}
+
+void
+fast_format_c::parse(std::string const &format) {
+  auto literal = std::string{};
+  auto length  = format.length();
+  auto idx     = 0u;
+
+  while (idx < length) {
+    auto c = format[idx];
+
+    if ((c != '%') || ((idx + 1) >= length)) {
+      literal += c;
+      ++idx;
+      continue;
+    }
+
+    auto next = format[idx + 1];
+
+    if (next == '%') {
+      literal += '%';
+      idx     += 2;
+      continue;
+    }
+
+    auto arg_idx = 0u;
+    auto spec    = std::string{};
+    auto end     = std::string::npos;
+
+    if (isdigit(next)) {
+      end = format.find('%', idx + 1);
+      if (std::string::npos != end)
+        arg_idx = atoi(format.substr(idx + 1, end - idx - 1).c_str());
+
+    } else if (next == '|') {
+      end        = format.find('|', idx + 2);
+      auto dollar = format.find('$', idx + 2);
+
+      if ((std::string::npos != end) && (std::string::npos != dollar) && (dollar < end)) {
+        arg_idx = atoi(format.substr(idx + 2, dollar - idx - 2).c_str());
+        spec    = format.substr(dollar + 1, end - dollar - 1);
+      }
+    }
+
+    if (!arg_idx) {
+      literal += c;
+      ++idx;
+      continue;
+    }
+
+    m_segments.push_back(segment_t{ literal, spec, arg_idx });
+    literal.clear();
+
+    m_num_args = std::max(m_num_args, arg_idx);
+    idx        = end + 1;
+  }
+
+  if (!literal.empty())
+    m_segments.push_back(segment_t{ literal, std::string{}, 0 });
+}
+
+void
+fast_format_c::append_arg(std::string &dst,
+                          arg_c const &arg,
+                          std::string const &spec) {
+  if (spec.empty()) {
+    if (arg_c::t_signed == arg.m_type)
+      append_signed(dst, arg.m_signed);
+
+    else if (arg_c::t_unsigned == arg.m_type)
+      append_unsigned(dst, arg.m_unsigned);
+
+    else if (arg_c::t_char == arg.m_type)
+      dst += arg.m_char;
+
+    else if (arg_c::t_string == arg.m_type)
+      dst.append(arg.m_string, arg.m_string_length);
+
+    else
+      append_printf(dst, "%g", arg.m_double);
+
+    return;
+  }
+
+  // Split the specification into flags/width/precision and the
+  // conversion character and use the conversion suitable for the
+  // argument's type.
+  auto conversion = spec.back();
+  auto modifiers  = spec;
+
+  if (isalpha(conversion))
+    modifiers.erase(modifiers.length() - 1);
+  else
+    conversion = '\0';
+
+  auto is_integer_conversion = (conversion == 'd') || (conversion == 'i') || (conversion == 'u') || (conversion == 'x') || (conversion == 'X') || (conversion == 'o');
+  auto is_float_conversion   = (conversion == 'f') || (conversion == 'F') || (conversion == 'e') || (conversion == 'E') || (conversion == 'g') || (conversion == 'G');
+  auto printf_format         = std::string{"%"} + modifiers;
+
+  if (arg_c::t_string == arg.m_type)
+    append_printf(dst, printf_format + "s", arg.m_string);
+
+  else if (arg_c::t_char == arg.m_type)
+    append_printf(dst, printf_format + "c", static_cast<int>(arg.m_char));
+
+  else if (arg_c::t_double == arg.m_type)
+    append_printf(dst, printf_format + (is_float_conversion ? conversion : 'g'), arg.m_double);
+
+  else if (is_float_conversion)
+    append_printf(dst, printf_format + conversion, arg_c::t_signed == arg.m_type ? static_cast<double>(arg.m_signed) : static_cast<double>(arg.m_unsigned));
+
+  else if ((arg_c::t_signed == arg.m_type) && (!is_integer_conversion || (conversion == 'd') || (conversion == 'i')))
+    append_printf(dst, printf_format + "lld", static_cast<long long>(arg.m_signed));
+
+  else if (arg_c::t_signed == arg.m_type)
+    append_printf(dst, printf_format + "ll" + conversion, static_cast<unsigned long long>(arg.m_signed));
+
+  else
+    append_printf(dst, printf_format + "ll" + (is_integer_conversion && (conversion != 'd') && (conversion != 'i') ? conversion : 'u'), static_cast<unsigned long long>(arg.m_unsigned));
+}
+
+/** \brief Appends the formatted text to \c dst
+
+   Arguments that are referenced by the format string but not passed
+   are output as empty strings.
+*/
+void
+fast_format_c::append(std::string &dst,
+                      std::initializer_list<arg_c> args)
+  const {
+  auto num_args = args.size();
+  auto first    = args.begin();
+
+  for (auto const &segment : m_segments) {
+    dst += segment.m_literal;
+
+    if (segment.m_arg_idx && (segment.m_arg_idx <= num_args))
+      append_arg(dst, first[segment.m_arg_idx - 1], segment.m_spec);
+  }
+}
+
+std::string
+fast_format_c::format(std::initializer_list<arg_c> args)
+  const {
+  auto result = std::string{};
+  append(result, args);
+
+  return result;
+}
@@ -0,0 +1,95 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for pre-parsed format strings
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_STRINGS_FAST_FORMAT_H
+#define MTX_COMMON_STRINGS_FAST_FORMAT_H
+
+#include "common/common_pch.h"
+
+#include <initializer_list>
+
+/** \brief A format string that is parsed once and applied many times
+
+   The format string uses the positional subset of \c boost::format's
+   syntax that translated strings use: \c %N% for the Nth argument with
+   default formatting, \c %|N$spec| for the Nth argument formatted with
+   the \c printf() specification \c spec (e.g. \c %|3$08x| or
+   \c %|1$.3f|) and \c %% for a literal percent sign. Arguments are
+   numbered from 1.
+
+   In contrast to \c boost::format no stream is involved, and the
+   result is appended to an existing string. This makes it suitable
+   for output that is generated in tight loops, e.g. one line per
+   frame.
+*/
+class fast_format_c {
+public:
+  class arg_c {
+  public:
+    enum type_e {
+      t_signed,
+      t_unsigned,
+      t_double,
+      t_char,
+      t_string,
+    };
+
+    type_e m_type;
+    union {
+      int64_t m_signed;
+      uint64_t m_unsigned;
+      double m_double;
+      char m_char;
+    };
+    char const *m_string;
+    std::size_t m_string_length;
+
+  public:
+    arg_c(int value)                 : m_type{t_signed},   m_signed{value},   m_string{}, m_string_length{} {}
+    arg_c(long value)                : m_type{t_signed},   m_signed{value},   m_string{}, m_string_length{} {}
+    arg_c(long long value)           : m_type{t_signed},   m_signed{value},   m_string{}, m_string_length{} {}
+    arg_c(unsigned int value)        : m_type{t_unsigned}, m_unsigned{value}, m_string{}, m_string_length{} {}
+    arg_c(unsigned long value)       : m_type{t_unsigned}, m_unsigned{value}, m_string{}, m_string_length{} {}
+    arg_c(unsigned long long value)  : m_type{t_unsigned}, m_unsigned{value}, m_string{}, m_string_length{} {}
+    arg_c(double value)              : m_type{t_double},   m_double{value},   m_string{}, m_string_length{} {}
+    arg_c(char value)                : m_type{t_char},     m_char{value},     m_string{}, m_string_length{} {}
+    arg_c(std::string const &value)  : m_type{t_string},   m_signed{},        m_string{value.c_str()}, m_string_length{value.length()} {}
+    arg_c(char const *value)         : m_type{t_string},   m_signed{},        m_string{value}, m_string_length{strlen(value)} {}
+  };
+
+protected:
+  struct segment_t {
+    std::string m_literal, m_spec;
+    unsigned int m_arg_idx;     // 0 == literal only
+  };
+
+  std::vector<segment_t> m_segments;
+  unsigned int m_num_args;
+
+public:
+  fast_format_c();
+  explicit fast_format_c(std::string const &format);
+
+  unsigned int get_num_args() const {
+    return m_num_args;
+  }
+
+  void append(std::string &dst, std::initializer_list<arg_c> args) const;
+  std::string format(std::initializer_list<arg_c> args) const;
+
+protected:
+  void parse(std::string const &format);
+  static void append_arg(std::string &dst, arg_c const &arg, std::string const &spec);
+};
+
+#endif  // MTX_COMMON_STRINGS_FAST_FORMAT_H
@@ -57,6 +57,59 @@ format_timecode(int64_t timecode,
   return result;
 }
 
+/** \brief Appends the same text as \c format_timecode() to \c dst
+
+   This variant does not use \c boost::format and is meant for code
+   that outputs a lot of timecodes, e.g. one per frame.
+*/
+void
+append_timecode(std::string &dst,
+                int64_t timecode,
+                unsigned int precision) {
+  auto append_digits = [&dst](unsigned int value, unsigned int num_digits) {
+    char buffer[10];
+    auto ptr = buffer + num_digits;
+
+    while (ptr > buffer) {
+      *--ptr  = '0' + (value % 10);
+      value  /= 10;
+    }
+
+    dst.append(buffer, num_digits);
+  };
+
+  bool negative = 0 > timecode;
+  if (negative) {
+    timecode *= -1;
+    dst      += '-';
+  }
+
+  if (precision && (9 > precision)) {
+    auto shift = 5ll;
+    for (int shift_idx = 9 - precision; shift_idx > 1; --shift_idx)
+      shift *= 10;
+    timecode += shift;
+  }
+
+  auto hours = static_cast<int>(timecode / 60 / 60 / 1000000000);
+  if (100 > hours)
+    append_digits(hours, 2);
+  else
+    dst += std::to_string(hours);
+
+  dst += ':';
+  append_digits((timecode / 60 / 1000000000) % 60, 2);
+  dst += ':';
+  append_digits((timecode      / 1000000000) % 60, 2);
+
+  if (!precision)
+    return;
+
+  dst += '.';
+  append_digits(timecode % 1000000000, 9);
+  dst.erase(dst.length() - 9 + std::min(precision, 9u));
+}
+
 std::string
 to_string(double value,
           unsigned int precision) {
@@ -39,6 +39,7 @@
 #define WRAP_AT_TERMINAL_WIDTH -1
 
 std::string format_timecode(int64_t timecode, unsigned int precision = 9);
+void append_timecode(std::string &dst, int64_t timecode, unsigned int precision = 9);
 
 template<typename T>
 std::string
@@ -0,0 +1,103 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   generic worker thread pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/thread_pool.h"
+
+/** \brief Starts the workers
+
+   \param num_threads The number of workers to start. If it is 0 then
+     \c get_default_num_threads() workers are started.
+*/
+thread_pool_c::thread_pool_c(unsigned int num_threads)
+  : m_quit{}
+{
+  if (!num_threads)
+    num_threads = get_default_num_threads();
+
+  for (auto worker_num = 0u; worker_num < num_threads; ++worker_num)
+    m_workers.emplace_back([this]() { run(); });
+}
+
+thread_pool_c::~thread_pool_c() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_quit = true;
+  }
+
+  m_jobs_available.notify_all();
+
+  for (auto &worker : m_workers)
+    worker.join();
+}
+
+/** \brief Returns the number of hardware threads, but at least 1
+*/
+unsigned int
+thread_pool_c::get_default_num_threads() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+unsigned int
+thread_pool_c::get_num_threads()
+  const {
+  return m_workers.size();
+}
+
+/** \brief Queues a job
+
+   \return A future that becomes ready once the job has run. If the job
+     threw an exception then \c get() rethrows it.
+*/
+std::future<void>
+thread_pool_c::submit(job_t job) {
+  auto queued_job = std::unique_ptr<queued_job_t>{new queued_job_t};
+  queued_job->job = std::move(job);
+  auto future     = queued_job->done.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_jobs.push_back(std::move(queued_job));
+  }
+
+  m_jobs_available.notify_one();
+
+  return future;
+}
+
+void
+thread_pool_c::run() {
+  while (true) {
+    std::unique_ptr<queued_job_t> queued_job;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_jobs_available.wait(lock, [this]() { return m_quit || !m_jobs.empty(); });
+
+      if (m_jobs.empty())
+        break;
+
+      queued_job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    try {
+      queued_job->job();
+      queued_job->done.set_value();
+
+    } catch (...) {
+      queued_job->done.set_exception(std::current_exception());
+    }
+  }
+}
@@ -0,0 +1,63 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for a generic worker thread pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_THREAD_POOL_H
+#define MTX_COMMON_THREAD_POOL_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/** \brief Runs arbitrary jobs on a fixed number of worker threads
+
+   Jobs are started in the order they are submitted, but they may
+   finish in any order. Callers that need the results in a certain
+   order have to wait for the returned futures in that order.
+
+   The destructor waits for all jobs that have already been submitted.
+*/
+class thread_pool_c {
+public:
+  using job_t = std::function<void()>;
+
+protected:
+  struct queued_job_t {
+    job_t job;
+    std::promise<void> done;
+  };
+
+  std::deque<std::unique_ptr<queued_job_t>> m_jobs;
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_jobs_available;
+  bool m_quit;
+
+public:
+  thread_pool_c(unsigned int num_threads = 0);
+  ~thread_pool_c();
+
+  std::future<void> submit(job_t job);
+  unsigned int get_num_threads() const;
+
+  static unsigned int get_default_num_threads();
+
+protected:
+  void run();
+};
+
+#endif  // MTX_COMMON_THREAD_POOL_H
@@ -14,6 +14,7 @@
 #include "common/common_pch.h"
 
 #include "common/ebml.h"
+#include "common/strings/editing.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
 #include "common/translation.h"
@@ -59,6 +60,7 @@ extract_cli_parser_c::init_parser() {
 
   add_section_header(YT("Global options"));
   OPT("f|parse-fully",    set_parse_fully,      YT("Parse the whole file instead of relying on the index."));
+  OPT("index-cache",      enable_index_cache,   YT("Cache the list of top level elements in a file next to the source file and re-use it."));
 
   add_common_options();
 
@@ -69,6 +71,8 @@ extract_cli_parser_c::init_parser() {
   OPT("blockadd=level", set_blockadd, YT("Keep only the BlockAdditions up to this level (default: keep all levels)"));
   OPT("raw",            set_raw,      YT("Extract the data to a raw file."));
   OPT("fullraw",        set_fullraw,  YT("Extract the data to a raw file including the CodecPrivate as a header."));
+  OPT("range=start-end", set_range,   YT("Only extract the frames between the timecodes 'start' and 'end'. Each track starts with the key frame preceding 'start'. "
+                                         "Either timecode may be omitted. The cues are used for seeking to 'start' directly."));
   add_informational_option("TID:out", YT("Write track with the ID TID to the file 'out'."));
 
   add_section_header(YT("Example"));
@@ -145,6 +149,11 @@ extract_cli_parser_c::set_parse_fully() {
   m_options.m_parse_mode = kax_analyzer_c::parse_mode_full;
 }
 
+void
+extract_cli_parser_c::enable_index_cache() {
+  kax_analyzer_c::enable_index_cache(true);
+}
+
 void
 extract_cli_parser_c::set_charset() {
   assert_mode(options_c::em_tracks);
@@ -176,6 +185,28 @@ extract_cli_parser_c::set_fullraw() {
   m_target_mode = track_spec_t::tm_full_raw;
 }
 
+void
+extract_cli_parser_c::set_range() {
+  assert_mode(options_c::em_tracks);
+
+  auto parts = split(m_next_arg, "-", 2);
+  auto start = int64_t{};
+  auto end   = int64_t{};
+  auto valid = (2 == parts.size())
+            && (!parts[0].empty() || !parts[1].empty())
+            && (parts[0].empty()  || parse_timecode(parts[0], start))
+            && (parts[1].empty()  || parse_timecode(parts[1], end))
+            && (parts[0].empty()  || parts[1].empty() || (start < end));
+
+  if (!valid)
+    mxerror(boost::format(Y("Invalid range specification in '%1% %2%'.\n")) % m_current_arg % m_next_arg);
+
+  if (!parts[0].empty())
+    m_options.m_range_start = timecode_c::ns(start);
+  if (!parts[1].empty())
+    m_options.m_range_end   = timecode_c::ns(end);
+}
+
 void
 extract_cli_parser_c::set_simple() {
   assert_mode(options_c::em_chapters);
@@ -43,11 +43,13 @@ protected:
   void assert_mode(options_c::extraction_mode_e mode);
 
   void set_parse_fully();
+  void enable_index_cache();
   void set_charset();
   void set_cuesheet();
   void set_blockadd();
   void set_raw();
   void set_fullraw();
+  void set_range();
   void set_simple();
   void set_mode_or_extraction_spec();
   void set_extraction_mode();
@@ -108,7 +108,7 @@ main(int argc,
   options_c options = extract_cli_parser_c(command_line_utf8(argc, argv)).run();
 
   if (options_c::em_tracks == options.m_extraction_mode) {
-    extract_tracks(options.m_file_name, options.m_tracks, options.m_parse_mode);
+    extract_tracks(options.m_file_name, options.m_tracks, options.m_parse_mode, options.m_range_start, options.m_range_end);
 
     if (0 == verbose)
       mxinfo(Y("Progress: 100%\n"));
@@ -22,6 +22,7 @@
 #include "common/file_types.h"
 #include "common/kax_analyzer.h"
 #include "common/mm_io.h"
+#include "common/timecode.h"
 #include "extract/track_spec.h"
 #include "librmff/librmff.h"
 
@@ -49,7 +50,7 @@ show_error(const boost::format &format) {
 
 void find_and_verify_track_uids(KaxTracks &tracks, std::vector<track_spec_t> &tspecs);
 
-bool extract_tracks(const std::string &file_name, std::vector<track_spec_t> &tspecs, kax_analyzer_c::parse_mode_e parse_mode);
+bool extract_tracks(const std::string &file_name, std::vector<track_spec_t> &tspecs, kax_analyzer_c::parse_mode_e parse_mode, timecode_c const &range_start, timecode_c const &range_end);
 void extract_tags(const std::string &file_name, kax_analyzer_c::parse_mode_e parse_mode);
 void extract_chapters(const std::string &file_name, bool chapter_format_simple, kax_analyzer_c::parse_mode_e parse_mode);
 void extract_attachments(const std::string &file_name, std::vector<track_spec_t> &tracks, kax_analyzer_c::parse_mode_e parse_mode);
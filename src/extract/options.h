@@ -13,6 +13,8 @@
 
 #include "common/common_pch.h"
 
+#include "common/timecode.h"
+
 class options_c {
 public:
   enum extraction_mode_e {
@@ -30,6 +32,7 @@ public:
   bool m_simple_chapter_format;
   kax_analyzer_c::parse_mode_e m_parse_mode;
   extraction_mode_e m_extraction_mode;
+  timecode_c m_range_start, m_range_end;
 
   std::vector<track_spec_t> m_tracks;
 
@@ -0,0 +1,123 @@
+/*
+   mkvextract -- extract tracks from Matroska files into other files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   per-track extraction workers
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "extract/track_worker.h"
+
+track_worker_c::track_worker_c(std::size_t max_jobs)
+  : m_max_jobs{std::max<std::size_t>(max_jobs, 1)}
+  , m_quit{}
+{
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+track_worker_c::~track_worker_c() {
+  abort();
+}
+
+void
+track_worker_c::add_job(job_t job) {
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_space_available.wait(lock, [this]() { return m_exception || (m_jobs.size() < m_max_jobs); });
+
+    if (!m_exception)
+      m_jobs.push_back(std::move(job));
+  }
+
+  rethrow_exception();
+  m_jobs_available.notify_one();
+}
+
+/** \brief Waits until all queued jobs have been run and stops the thread
+ */
+void
+track_worker_c::finish() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_quit = true;
+    }
+
+    m_jobs_available.notify_one();
+    m_thread.join();
+  }
+
+  rethrow_exception();
+}
+
+/** \brief Drops all queued jobs and stops the thread
+
+   The job currently running is finished first. Exceptions thrown by
+   the jobs are not rethrown.
+*/
+void
+track_worker_c::abort() {
+  if (!m_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_jobs.clear();
+    m_quit = true;
+  }
+
+  m_jobs_available.notify_one();
+  m_thread.join();
+}
+
+void
+track_worker_c::rethrow_exception() {
+  std::exception_ptr exception;
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    exception = m_exception;
+  }
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+void
+track_worker_c::run() {
+  mtx::output::errors_as_exceptions_c errors_as_exceptions;
+
+  while (true) {
+    job_t job;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_jobs_available.wait(lock, [this]() { return m_quit || !m_jobs.empty(); });
+
+      if (m_jobs.empty())
+        break;
+
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    m_space_available.notify_one();
+
+    try {
+      job();
+
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_exception = std::current_exception();
+      m_jobs.clear();
+      m_space_available.notify_one();
+      break;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+/*
+   mkvextract -- extract tracks from Matroska files into other files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the per-track extraction workers
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_EXTRACT_TRACK_WORKER_H
+#define MTX_EXTRACT_TRACK_WORKER_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/** \brief Runs the jobs for one output file on its own thread
+
+   The jobs are run in the order they were added. The queue is bounded:
+   \c add_job() blocks while \c m_max_jobs jobs are waiting so that the
+   reading thread cannot get arbitrarily far ahead of a slow extractor.
+
+   If a job throws then all following jobs are dropped, and the
+   exception is rethrown by the next call to \c add_job() or \c finish()
+   on the adding thread. Errors reported by the jobs via \c mxerror()
+   are thrown as \c mtx::output::error_x so that they never terminate
+   the program from the worker thread.
+
+   The thread is always joined by \c finish(), \c abort() or the
+   destructor on the thread owning the worker.
+*/
+class track_worker_c {
+public:
+  using job_t = std::function<void()>;
+
+protected:
+  std::deque<job_t> m_jobs;
+  std::size_t m_max_jobs;
+
+  std::mutex m_mutex;
+  std::condition_variable m_jobs_available, m_space_available;
+  bool m_quit;
+  std::exception_ptr m_exception;
+
+  std::thread m_thread;
+
+public:
+  track_worker_c(std::size_t max_jobs);
+  ~track_worker_c();
+
+  void add_job(job_t job);
+  void finish();
+  void abort();
+
+protected:
+  void run();
+  void rethrow_exception();
+};
+using track_worker_cptr = std::shared_ptr<track_worker_c>;
+
+#endif  // MTX_EXTRACT_TRACK_WORKER_H
@@ -24,6 +24,8 @@
 #include <matroska/KaxBlockData.h>
 #include <matroska/KaxCluster.h>
 #include <matroska/KaxClusterData.h>
+#include <matroska/KaxCues.h>
+#include <matroska/KaxCuesData.h>
 #include <matroska/KaxInfo.h>
 #include <matroska/KaxInfoData.h>
 #include <matroska/KaxSegment.h>
@@ -37,17 +39,38 @@
 #include "common/mm_io_x.h"
 #include "common/mm_write_buffer_io.h"
 #include "extract/mkvextract.h"
+#include "extract/track_worker.h"
 #include "extract/xtr_base.h"
 
 using namespace libmatroska;
 
+// The number of frames that may be queued for each output file before
+// reading the source file is paused.
+#define MAX_QUEUED_FRAMES 1024
+
 static std::vector<xtr_base_c *> extractors;
 
+// The frames are handled by one worker thread per output file. All
+// extractors writing to the same file share their master's worker. The
+// workers themselves are owned by extract_tracks().
+static std::unordered_map<xtr_base_c *, track_worker_c *> s_workers_by_extractor;
+
+// The range of timecodes to extract ('--range') and the state of each
+// track regarding its start.
+struct range_state_t {
+  bool m_started;
+  std::vector<track_worker_c::job_t> m_pending_jobs;
+};
+
+static timecode_c s_range_start, s_range_end;
+static std::unordered_map<xtr_base_c *, range_state_t> s_range_states;
+
 // ------------------------------------------------------------------------
 
 static void
 create_extractors(KaxTracks &kax_tracks,
-                  std::vector<track_spec_t> &tracks) {
+                  std::vector<track_spec_t> &tracks,
+                  std::vector<track_worker_cptr> &workers) {
   size_t i;
   int64_t track_id = -1;
 
@@ -118,11 +141,146 @@ create_extractors(KaxTracks &kax_tracks,
   // Signal that all headers have been taken care of.
   for (i = 0; i < extractors.size(); i++)
     extractors[i]->headers_done();
+
+  for (auto extractor : extractors) {
+    auto master = extractor->m_master ? extractor->m_master : extractor;
+    if (!s_workers_by_extractor[master]) {
+      workers.push_back(std::make_shared<track_worker_c>(MAX_QUEUED_FRAMES));
+      s_workers_by_extractor[master] = workers.back().get();
+    }
+
+    s_workers_by_extractor[extractor] = s_workers_by_extractor[master];
+  }
+}
+
+/** \brief Hands a job over to the extractor's worker thread
+
+   The job must not refer to data owned by the cluster unless it holds
+   a reference to the cluster itself.
+*/
+static void
+queue_job(xtr_base_c *extractor,
+          track_worker_c::job_t const &job) {
+  s_workers_by_extractor[extractor]->add_job(job);
+}
+
+/** \brief Hands a frame over to its worker if it lies inside the range
+
+   Frames at or after the range's end are dropped. Each track starts
+   with its last key frame at or before the range's start. Whether or
+   not a key frame is the last one is only known once the next frame
+   after the start arrives; until then the frames from that key frame
+   on are held back.
+*/
+static void
+queue_frame(xtr_base_c *extractor,
+            int64_t timecode,
+            bool keyframe,
+            track_worker_c::job_t const &job) {
+  if (s_range_end.valid() && (timecode >= s_range_end.to_ns()))
+    return;
+
+  if (!s_range_start.valid()) {
+    queue_job(extractor, job);
+    return;
+  }
+
+  auto &state = s_range_states[extractor];
+
+  if (state.m_started) {
+    queue_job(extractor, job);
+    return;
+  }
+
+  if (timecode <= s_range_start.to_ns()) {
+    if (keyframe)
+      state.m_pending_jobs.clear();
+    if (keyframe || !state.m_pending_jobs.empty())
+      state.m_pending_jobs.push_back(job);
+    return;
+  }
+
+  if (state.m_pending_jobs.empty() && !keyframe)
+    return;
+
+  state.m_started = true;
+
+  for (auto const &pending_job : state.m_pending_jobs)
+    queue_job(extractor, pending_job);
+  state.m_pending_jobs.clear();
+
+  queue_job(extractor, job);
+}
+
+static void
+flush_range_states() {
+  for (auto &state : s_range_states)
+    for (auto const &pending_job : state.second.m_pending_jobs)
+      queue_job(state.first, pending_job);
+
+  s_range_states.clear();
+}
+
+/** \brief Finds the position of the cluster to start reading at for '--range'
+
+   This is the cluster of the last cue point at or before the range's
+   start.
+
+   \return The absolute file position or -1 if there are no suitable
+     cues.
+*/
+static int64_t
+find_range_start_position(kax_analyzer_c &analyzer,
+                          uint64_t tc_scale) {
+  auto cues_m = analyzer.read_all(EBML_INFO(KaxCues));
+  auto cues   = dynamic_cast<KaxCues *>(cues_m.get());
+
+  if (!cues)
+    return -1;
+
+  auto start         = s_range_start.to_ns();
+  auto best_time     = int64_t{-1};
+  auto best_position = int64_t{-1};
+
+  for (auto const &elt : *cues) {
+    auto kcue_point = dynamic_cast<KaxCuePoint *>(elt);
+    auto ktime      = kcue_point ? FindChild<KaxCueTime>(*kcue_point)            : nullptr;
+    auto ktrack_pos = kcue_point ? FindChild<KaxCueTrackPositions>(*kcue_point)  : nullptr;
+    auto kposition  = ktrack_pos ? FindChild<KaxCueClusterPosition>(*ktrack_pos) : nullptr;
+
+    if (!ktime || !kposition)
+      continue;
+
+    auto time     = static_cast<int64_t>(ktime->GetValue() * tc_scale);
+    auto position = static_cast<int64_t>(kposition->GetValue());
+
+    if (   (time > start)
+        || (time < best_time)
+        || ((time == best_time) && (position >= best_position)))
+      continue;
+
+    best_time     = time;
+    best_position = position;
+  }
+
+  return -1 == best_position ? -1 : analyzer.get_segment_data_start_pos() + best_position;
+}
+
+/** \brief Drops all frames not handled yet and joins the workers
+ */
+static void
+stop_workers(std::vector<track_worker_cptr> &workers) {
+  for (auto &worker : workers)
+    worker->abort();
+
+  s_workers_by_extractor.clear();
+  workers.clear();
 }
 
 static int64_t
 handle_blockgroup(KaxBlockGroup &blockgroup,
                   KaxCluster &cluster,
+                  ebml_element_cptr const &cluster_ref,
                   int64_t tc_scale) {
   // Only continue if this block group actually contains a block.
   KaxBlock *block = FindChild<KaxBlock>(&blockgroup);
@@ -168,7 +326,9 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
   KaxCodecState *kcstate = FindChild<KaxCodecState>(&blockgroup);
   if (kcstate) {
     memory_cptr codec_state(new memory_c(kcstate->GetBuffer(), kcstate->GetSize(), false));
-    extractor->handle_codec_state(codec_state);
+    queue_job(extractor, [extractor, codec_state, cluster_ref]() mutable {
+      extractor->handle_codec_state(codec_state);
+    });
   }
 
   for (i = 0; i < block->NumberFrames(); i++) {
@@ -189,9 +349,11 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
       discard_padding = timecode_c::ns(kdiscard_padding->GetValue());
 
     auto &data = block->GetBuffer(i);
-    auto frame = std::make_shared<memory_c>(data.Buffer(), data.Size(), false);
-    auto f     = xtr_frame_t{frame, kadditions, this_timecode, this_duration, bref, fref, false, false, true, discard_padding};
-    extractor->decode_and_handle_frame(f);
+    auto frame = memory_pool_c::make_shared<memory_c>(data.Buffer(), data.Size(), false);
+    queue_frame(extractor, this_timecode, (0 == bref) && (0 == fref), [extractor, frame, kadditions, this_timecode, this_duration, bref, fref, discard_padding, cluster_ref]() mutable {
+      auto f = xtr_frame_t{frame, kadditions, this_timecode, this_duration, bref, fref, false, false, true, discard_padding};
+      extractor->decode_and_handle_frame(f);
+    });
 
     max_timecode = std::max(max_timecode, this_timecode);
   }
@@ -201,7 +363,8 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
 
 static int64_t
 handle_simpleblock(KaxSimpleBlock &simpleblock,
-                   KaxCluster &cluster) {
+                   KaxCluster &cluster,
+                   ebml_element_cptr const &cluster_ref) {
   if (0 == simpleblock.NumberFrames())
     return - 1;
 
@@ -233,10 +396,14 @@ handle_simpleblock(KaxSimpleBlock &simpleblock,
       this_duration = duration / simpleblock.NumberFrames();
     }
 
-    auto &data = simpleblock.GetBuffer(i);
-    auto frame = std::make_shared<memory_c>(data.Buffer(), data.Size(), false);
-    auto f     = xtr_frame_t{frame, nullptr, this_timecode, this_duration, -1, -1, simpleblock.IsKeyframe(), simpleblock.IsDiscardable(), false, timecode_c::ns(0)};
-    extractor->decode_and_handle_frame(f);
+    auto &data        = simpleblock.GetBuffer(i);
+    auto frame        = memory_pool_c::make_shared<memory_c>(data.Buffer(), data.Size(), false);
+    auto keyframe     = simpleblock.IsKeyframe();
+    auto discardable  = simpleblock.IsDiscardable();
+    queue_frame(extractor, this_timecode, keyframe, [extractor, frame, this_timecode, this_duration, keyframe, discardable, cluster_ref]() mutable {
+      auto f = xtr_frame_t{frame, nullptr, this_timecode, this_duration, -1, -1, keyframe, discardable, false, timecode_c::ns(0)};
+      extractor->decode_and_handle_frame(f);
+    });
 
     max_timecode = std::max(max_timecode, this_timecode);
   }
@@ -245,9 +412,16 @@ handle_simpleblock(KaxSimpleBlock &simpleblock,
 }
 
 static void
-close_extractors() {
+close_extractors(std::vector<track_worker_cptr> &workers) {
   size_t i;
 
+  // Wait for the workers to handle all queued frames first.
+  flush_range_states();
+
+  for (auto &worker : workers)
+    worker->finish();
+  stop_workers(workers);
+
   for (i = 0; i < extractors.size(); i++)
     extractors[i]->finish_track();
 
@@ -341,13 +515,20 @@ handle_segment_info(EbmlMaster *info,
   file->set_timecode_scale(tc_scale);
 }
 
-bool
-extract_tracks(const std::string &file_name,
-               std::vector<track_spec_t> &tspecs,
-               kax_analyzer_c::parse_mode_e parse_mode) {
+static bool
+extract_tracks_internal(const std::string &file_name,
+                        std::vector<track_spec_t> &tspecs,
+                        kax_analyzer_c::parse_mode_e parse_mode,
+                        timecode_c const &range_start,
+                        timecode_c const &range_end,
+                        std::vector<track_worker_cptr> &workers) {
   if (tspecs.empty())
     mxerror(Y("Nothing to do.\n"));
 
+  s_range_start = range_start;
+  s_range_end   = range_end;
+  s_range_states.clear();
+
   // open input file
   mm_io_cptr in;
   kax_file_cptr file;
@@ -362,6 +543,8 @@ extract_tracks(const std::string &file_name,
   int64_t file_size = in->get_size();
   uint64_t tc_scale = TIMECODE_SCALE;
   bool segment_info_found = false, tracks_found = false;
+  int64_t range_start_position = -1;
+  auto read_whole_file = std::any_of(tspecs.begin(), tspecs.end(), [](track_spec_t const &tspec) { return tspec.extract_cuesheet; });
 
   // open input file
   auto analyzer = open_and_analyze(file_name, parse_mode, false);
@@ -378,8 +561,13 @@ extract_tracks(const std::string &file_name,
     if (tracks) {
       tracks_found = true;
       find_and_verify_track_uids(*tracks, tspecs);
-      create_extractors(*tracks, tspecs);
+      create_extractors(*tracks, tspecs, workers);
     }
+
+    // Reading can only start in the middle of the file if the headers
+    // are already known. Cue sheets need all chapters and tags.
+    if (segment_info_found && tracks_found && s_range_start.valid() && !read_whole_file)
+      range_start_position = find_range_start_position(*analyzer, tc_scale);
   }
 
   try {
@@ -417,6 +605,11 @@ extract_tracks(const std::string &file_name,
       delete l0;
     }
 
+    if (-1 != range_start_position) {
+      mxverb(1, boost::format(Y("Seeking to the cluster at %1% for the start of the range.\n")) % range_start_position);
+      in->setFilePointer(range_start_position);
+    }
+
     EbmlElement *l1   = nullptr;
 
     KaxChapters all_chapters;
@@ -430,16 +623,21 @@ extract_tracks(const std::string &file_name,
       } else if (Is<KaxTracks>(l1) && !tracks_found) {
         tracks_found = true;
         find_and_verify_track_uids(*dynamic_cast<KaxTracks *>(l1), tspecs);
-        create_extractors(*dynamic_cast<KaxTracks *>(l1), tspecs);
+        create_extractors(*dynamic_cast<KaxTracks *>(l1), tspecs, workers);
 
       } else if (Is<KaxCluster>(l1)) {
         show_element(l1, 1, Y("Cluster"));
         KaxCluster *cluster = static_cast<KaxCluster *>(l1);
 
+        // The cluster is freed once all of its frames have been handled
+        // by the workers.
+        auto cluster_ref = ebml_element_cptr{l1};
+        l1               = nullptr;
+
         if (0 == verbose)
           mxinfo(boost::format(Y("Progress: %1%%%%2%")) % (int)(in->getFilePointer() * 100 / file_size) % "\r");
 
-        KaxClusterTimecode *ctc = FindChild<KaxClusterTimecode>(l1);
+        KaxClusterTimecode *ctc = FindChild<KaxClusterTimecode>(cluster);
         if (ctc) {
           uint64_t cluster_tc = ctc->GetValue();
           show_element(ctc, 2, boost::format(Y("Cluster timecode: %|1$.3f|s")) % ((float)cluster_tc * (float)tc_scale / 1000000000.0));
@@ -447,6 +645,9 @@ extract_tracks(const std::string &file_name,
         } else
           cluster->InitTimecode(0, tc_scale);
 
+        if (!read_whole_file && s_range_end.valid() && (static_cast<int64_t>(cluster->GlobalTimecode()) >= s_range_end.to_ns()))
+          break;
+
         size_t i;
         int64_t max_timecode = -1;
 
@@ -456,11 +657,11 @@ extract_tracks(const std::string &file_name,
 
           if (Is<KaxBlockGroup>(el)) {
             show_element(el, 2, Y("Block group"));
-            max_bg_timecode = handle_blockgroup(*static_cast<KaxBlockGroup *>(el), *cluster, tc_scale);
+            max_bg_timecode = handle_blockgroup(*static_cast<KaxBlockGroup *>(el), *cluster, cluster_ref, tc_scale);
 
           } else if (Is<KaxSimpleBlock>(el)) {
             show_element(el, 2, Y("SimpleBlock"));
-            max_bg_timecode = handle_simpleblock(*static_cast<KaxSimpleBlock *>(el), *cluster);
+            max_bg_timecode = handle_simpleblock(*static_cast<KaxSimpleBlock *>(el), *cluster, cluster_ref);
           }
 
           max_timecode = std::max(max_timecode, max_bg_timecode);
@@ -506,12 +707,49 @@ extract_tracks(const std::string &file_name,
     // Now just close the files and go to sleep. Mummy will sing you a
     // lullaby. Just close your eyes, listen to her sweet voice, singing,
     // singing, fading... fad... ing...
-    close_extractors();
+    close_extractors(workers);
 
     return true;
+
+  } catch (mtx::output::error_x &) {
+    throw;
+
   } catch (...) {
+    stop_workers(workers);
     show_error(Y("Caught exception"));
 
     return false;
   }
 }
+
+/** \brief Extracts the tracks with the workers' threads running
+
+   Errors reported via \c mxerror() by the workers or by the main
+   thread are caught here. All workers are joined before the error is
+   reported and the program terminated.
+*/
+bool
+extract_tracks(const std::string &file_name,
+               std::vector<track_spec_t> &tspecs,
+               kax_analyzer_c::parse_mode_e parse_mode,
+               timecode_c const &range_start,
+               timecode_c const &range_end) {
+  std::vector<track_worker_cptr> workers;
+  std::string error;
+  auto result = false;
+
+  try {
+    mtx::output::errors_as_exceptions_c errors_as_exceptions;
+    result = extract_tracks_internal(file_name, tspecs, parse_mode, range_start, range_end, workers);
+
+  } catch (mtx::output::error_x &ex) {
+    error = ex.error();
+  }
+
+  stop_workers(workers);
+
+  if (!error.empty())
+    mxerror(error);
+
+  return result;
+}
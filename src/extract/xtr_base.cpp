@@ -22,6 +22,7 @@
 #include "common/mm_io_x.h"
 #include "common/mm_write_buffer_io.h"
 #include "common/strings/editing.h"
+#include "common/strings/formatting.h"
 #include "extract/xtr_aac.h"
 #include "extract/xtr_alac.h"
 #include "extract/xtr_avc.h"
@@ -82,7 +83,15 @@ xtr_base_c::create_file(xtr_base_c *master,
 
 void
 xtr_base_c::decode_and_handle_frame(xtr_frame_t &f) {
-  m_content_decoder.reverse(f.frame, CONTENT_ENCODING_SCOPE_BLOCK);
+  // A single damaged frame must not abort the extraction.
+  try {
+    m_content_decoder.reverse(f.frame, CONTENT_ENCODING_SCOPE_BLOCK);
+
+  } catch (mtx::compression_x &ex) {
+    mxwarn(boost::format(Y("Track %1%: The frame at timestamp %2% could not be decompressed and will be skipped: %3%\n")) % m_tid % format_timecode(f.timecode) % balg::trim_right_copy(ex.error()));
+    return;
+  }
+
   handle_frame(f);
 }
 
@@ -22,6 +22,7 @@
 
 info_cli_parser_c::info_cli_parser_c(const std::vector<std::string> &args)
   : cli_parser_c(args)
+  , m_no_checksums(false)
 {
   verbose = 0;
 }
@@ -39,6 +40,7 @@ info_cli_parser_c::init_parser() {
 #endif
   OPT("c|checksum",     set_checksum,     YT("Calculate and display checksums of frame contents."));
   OPT("C|check-mode",   set_check_mode,   YT("Calculate and display checksums and use verbosity level 4."));
+  OPT("no-checksums",   set_no_checksums, YT("Do not calculate checksums of frame contents, not even in summary mode. In summary mode only the headers of the frames are read then."));
   OPT("s|summary",      set_summary,      YT("Only show summaries of the contents, not each element."));
   OPT("t|track-info",   set_track_info,   YT("Show statistics for each track in verbose mode."));
   OPT("x|hexdump",      set_hexdump,      YT("Show the first 16 bytes of each frame as a hex dump."));
@@ -71,6 +73,11 @@ info_cli_parser_c::set_check_mode() {
   verbose                    = 4;
 }
 
+void
+info_cli_parser_c::set_no_checksums() {
+  m_no_checksums = true;
+}
+
 void
 info_cli_parser_c::set_summary() {
   m_options.m_calc_checksums = true;
@@ -117,5 +124,8 @@ info_cli_parser_c::run() {
   m_options.m_verbose = verbose;
   verbose             = 0;
 
+  if (m_no_checksums)
+    m_options.m_calc_checksums = false;
+
   return m_options;
 }
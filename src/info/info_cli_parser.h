@@ -20,6 +20,7 @@
 class info_cli_parser_c: public cli_parser_c {
 protected:
   options_c m_options;
+  bool m_no_checksums;
 
 public:
   info_cli_parser_c(const std::vector<std::string> &args);
@@ -32,6 +33,7 @@ protected:
   void set_gui();
   void set_checksum();
   void set_check_mode();
+  void set_no_checksums();
   void set_summary();
   void set_hexdump();
   void set_full_hexdump();
@@ -65,6 +65,7 @@
 #include "common/mpeg4_p10.h"
 #include "common/stereo_mode.h"
 #include "common/strings/editing.h"
+#include "common/strings/fast_format.h"
 #include "common/strings/formatting.h"
 #include "common/translation.h"
 #include "common/version.h"
@@ -72,6 +73,7 @@
 #include "common/xml/ebml_tags_converter.h"
 #include "info/mkvinfo.h"
 #include "info/info_cli_parser.h"
+#include "info/summary_engine.h"
 
 using namespace libmatroska;
 
@@ -128,10 +130,12 @@ std::map<unsigned int, track_info_t> s_track_info;
 options_c g_options;
 static uint64_t s_tc_scale = TIMECODE_SCALE;
 std::vector<boost::format> g_common_boost_formats;
+std::vector<fast_format_c> g_common_fast_formats;
 size_t s_mkvmerge_track_id = 0;
 
 #define BF_DO(n)                             g_common_boost_formats[n]
-#define BF_ADD(s)                            g_common_boost_formats.push_back(boost::format(s))
+#define FF_DO(n)                             g_common_fast_formats[n]
+#define BF_ADD(s)                            add_common_format(s)
 #define BF_SHOW_UNKNOWN_ELEMENT              BF_DO( 0)
 #define BF_EBMLVOID                          BF_DO( 1)
 #define BF_FORMAT_BINARY_1                   BF_DO( 2)
@@ -169,10 +173,29 @@ size_t s_mkvmerge_track_id = 0;
 #define BF_AT                                BF_DO(31)
 #define BF_SIZE                              BF_DO(32)
 #define BF_BLOCK_GROUP_DISCARD_PADDING       BF_DO(33)
+#define BF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_CHECKSUM BF_DO(34)
+#define BF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_CHECKSUM   BF_DO(35)
+#define BF_SIMPLE_BLOCK_SUMMARY_NO_CHECKSUM              BF_DO(36)
+
+// The same formats for the summary engine.
+#define FF_SUMMARY_POSITION                              FF_DO(19)
+#define FF_BLOCK_GROUP_SUMMARY_WITH_DURATION             FF_DO(20)
+#define FF_BLOCK_GROUP_SUMMARY_NO_DURATION               FF_DO(21)
+#define FF_SIMPLE_BLOCK_SUMMARY                          FF_DO(25)
+#define FF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_CHECKSUM FF_DO(34)
+#define FF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_CHECKSUM   FF_DO(35)
+#define FF_SIMPLE_BLOCK_SUMMARY_NO_CHECKSUM              FF_DO(36)
+
+static void
+add_common_format(std::string const &format) {
+  g_common_boost_formats.push_back(boost::format(format));
+  g_common_fast_formats.push_back(fast_format_c{format});
+}
 
 void
 init_common_boost_formats() {
   g_common_boost_formats.clear();
+  g_common_fast_formats.clear();
   BF_ADD(Y("(Unknown element: %1%; ID: 0x%2% size: %3%)"));                                                     //  0 -- BF_SHOW_UNKNOWN_ELEMENT
   BF_ADD(Y("EbmlVoid (size: %1%)"));                                                                            //  1 -- BF_EBMLVOID
   BF_ADD(Y("length %1%, data: %2%"));                                                                           //  2 -- BF_FORMAT_BINARY_1
@@ -207,6 +230,9 @@ init_common_boost_formats() {
   BF_ADD(Y(" at %1%"));                                                                                         // 31 -- BF_AT
   BF_ADD(Y(" size %1%"));                                                                                       // 32 -- BF_SIZE
   BF_ADD(Y("Discard padding: %|1$.3f|ms (%2%ns)"));                                                             // 33 -- BF_BLOCK_GROUP_DISCARD_PADDING
+  BF_ADD(Y("%1% frame, track %2%, timecode %3% (%4%), duration %|5$.3f|, size %6%%7%%8%\n"));                   // 34 -- BF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_CHECKSUM
+  BF_ADD(Y("%1% frame, track %2%, timecode %3% (%4%), size %5%%6%%7%\n"));                                      // 35 -- BF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_CHECKSUM
+  BF_ADD(Y("%1% frame, track %2%, timecode %3% (%4%), size %5%%6%\n"));                                         // 36 -- BF_SIMPLE_BLOCK_SUMMARY_NO_CHECKSUM
 }
 
 std::string
@@ -345,7 +371,7 @@ create_codec_dependent_private_info(KaxCodecPrivate &c_priv,
                :                             Y("Unknown"))
             % (avcc.m_level_idc / 10) % (avcc.m_level_idc % 10)).str();
   } else if ((codec_id == MKV_V_MPEGH_HEVC) && ('v' == track_type) && (c_priv.GetSize() >= 4)) {
-    auto hevcc = mtx::hevc::hevcc_c::unpack(std::make_shared<memory_c>(c_priv.GetBuffer(), c_priv.GetSize(), false));
+    auto hevcc = mtx::hevc::hevcc_c::unpack(memory_pool_c::make_shared<memory_c>(c_priv.GetBuffer(), c_priv.GetSize(), false));
 
     return (boost::format(Y(" (HEVC profile: %1% @L%2%.%3%)"))
             % (  hevcc.m_general_profile_idc == 1 ? "Main"
@@ -1122,6 +1148,49 @@ handle_silent_track(EbmlStream *&es,
       show_unknown_element(l3, 3);
 }
 
+static void
+add_block_group_statistics(uint64_t track_number,
+                           int64_t timecode,
+                           float duration,
+                           unsigned int num_references,
+                           std::size_t num_frames,
+                           int64_t size) {
+  track_info_t &tinfo = s_track_info[track_number];
+
+  tinfo.m_blocks                                          += num_frames;
+  tinfo.m_blocks_by_ref_num[std::min(num_references, 2u)] += num_frames;
+  tinfo.m_min_timecode                                     = std::min(tinfo.m_min_timecode, timecode);
+  tinfo.m_size                                            += size;
+
+  if (!tinfo.max_timecode_unset() && (tinfo.m_max_timecode >= timecode))
+    return;
+
+  tinfo.m_max_timecode = timecode;
+
+  if (-1 == duration)
+    tinfo.m_add_duration_for_n_packets  = num_frames;
+  else {
+    tinfo.m_max_timecode               += duration * 1000000.0;
+    tinfo.m_add_duration_for_n_packets  = 0;
+  }
+}
+
+static void
+add_simple_block_statistics(uint64_t track_number,
+                            int64_t timecode,
+                            unsigned int ref_idx,
+                            std::size_t num_frames,
+                            int64_t size) {
+  track_info_t &tinfo = s_track_info[track_number];
+
+  tinfo.m_blocks                     += num_frames;
+  tinfo.m_blocks_by_ref_num[ref_idx] += num_frames;
+  tinfo.m_min_timecode                = std::min(tinfo.m_min_timecode, timecode);
+  tinfo.m_max_timecode                = std::max(tinfo.max_timecode_unset() ? 0 : tinfo.m_max_timecode, timecode);
+  tinfo.m_add_duration_for_n_packets  = num_frames;
+  tinfo.m_size                       += size;
+}
+
 void
 handle_block_group(EbmlStream *&es,
                    EbmlElement *&l2,
@@ -1273,7 +1342,7 @@ handle_block_group(EbmlStream *&es,
         frame_pos += frame_sizes[fidx];
       }
 
-      if (bduration != -1.0)
+      if ((bduration != -1.0) && g_options.m_calc_checksums)
         mxinfo(BF_BLOCK_GROUP_SUMMARY_WITH_DURATION
                % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
                % lf_tnum
@@ -1284,7 +1353,17 @@ handle_block_group(EbmlStream *&es,
                % frame_adlers[fidx]
                % frame_hexdumps[fidx]
                % position);
-      else
+      else if (bduration != -1.0)
+        mxinfo(BF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_CHECKSUM
+               % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
+               % lf_tnum
+               % std::llround(lf_timecode / 1000000.0)
+               % format_timecode(lf_timecode, 3)
+               % bduration
+               % frame_sizes[fidx]
+               % frame_hexdumps[fidx]
+               % position);
+      else if (g_options.m_calc_checksums)
         mxinfo(BF_BLOCK_GROUP_SUMMARY_NO_DURATION
                % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
                % lf_tnum
@@ -1294,6 +1373,15 @@ handle_block_group(EbmlStream *&es,
                % frame_adlers[fidx]
                % frame_hexdumps[fidx]
                % position);
+      else
+        mxinfo(BF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_CHECKSUM
+               % (num_references >= 2 ? 'B' : num_references == 1 ? 'P' : 'I')
+               % lf_tnum
+               % std::llround(lf_timecode / 1000000.0)
+               % format_timecode(lf_timecode, 3)
+               % frame_sizes[fidx]
+               % frame_hexdumps[fidx]
+               % position);
     }
 
   } else if (g_options.m_verbose > 2)
@@ -1303,24 +1391,7 @@ handle_block_group(EbmlStream *&es,
                  % lf_tnum
                  % std::llround(lf_timecode / 1000000.0));
 
-  track_info_t &tinfo = s_track_info[lf_tnum];
-
-  tinfo.m_blocks                                          += frame_sizes.size();
-  tinfo.m_blocks_by_ref_num[std::min(num_references, 2u)] += frame_sizes.size();
-  tinfo.m_min_timecode                                     = std::min(tinfo.m_min_timecode, lf_timecode);
-  tinfo.m_size                                            += boost::accumulate(frame_sizes, 0);
-
-  if (!tinfo.max_timecode_unset() && (tinfo.m_max_timecode >= lf_timecode))
-    return;
-
-  tinfo.m_max_timecode = lf_timecode;
-
-  if (-1 == bduration)
-    tinfo.m_add_duration_for_n_packets  = frame_sizes.size();
-  else {
-    tinfo.m_max_timecode               += bduration * 1000000.0;
-    tinfo.m_add_duration_for_n_packets  = 0;
-  }
+  add_block_group_statistics(lf_tnum, lf_timecode, bduration, num_references, frame_sizes.size(), boost::accumulate(frame_sizes, 0));
 }
 
 void
@@ -1336,7 +1407,6 @@ handle_simple_block(EbmlStream *&es,
   int64_t frame_pos   = block.GetElementPosition() + block.ElementSize();
   auto timecode_ns    = block.GlobalTimecode();
   auto timecode_ms    = std::llround(static_cast<double>(timecode_ns) / 1000000.0);
-  track_info_t &tinfo = s_track_info[block.TrackNum()];
 
   std::string info;
   if (block.IsKeyframe())
@@ -1382,14 +1452,23 @@ handle_simple_block(EbmlStream *&es,
         frame_pos += frame_sizes[fidx];
       }
 
-      mxinfo(BF_SIMPLE_BLOCK_SUMMARY
-             % (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P')
-             % block.TrackNum()
-             % timecode_ms
-             % format_timecode(timecode_ns, 3)
-             % frame_sizes[fidx]
-             % frame_adlers[fidx]
-             % position);
+      if (g_options.m_calc_checksums)
+        mxinfo(BF_SIMPLE_BLOCK_SUMMARY
+               % (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P')
+               % block.TrackNum()
+               % timecode_ms
+               % format_timecode(timecode_ns, 3)
+               % frame_sizes[fidx]
+               % frame_adlers[fidx]
+               % position);
+      else
+        mxinfo(BF_SIMPLE_BLOCK_SUMMARY_NO_CHECKSUM
+               % (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P')
+               % block.TrackNum()
+               % timecode_ms
+               % format_timecode(timecode_ns, 3)
+               % frame_sizes[fidx]
+               % position);
     }
 
   } else if (g_options.m_verbose > 2)
@@ -1399,12 +1478,62 @@ handle_simple_block(EbmlStream *&es,
                  % block.TrackNum()
                  % timecode_ms);
 
-  tinfo.m_blocks                                                                    += block.NumberFrames();
-  tinfo.m_blocks_by_ref_num[block.IsKeyframe() ? 0 : block.IsDiscardable() ? 2 : 1] += block.NumberFrames();
-  tinfo.m_min_timecode                                                                = std::min(tinfo.m_min_timecode, static_cast<int64_t>(timecode_ns));
-  tinfo.m_max_timecode                                                                = std::max(tinfo.max_timecode_unset() ? 0 : tinfo.m_max_timecode, static_cast<int64_t>(timecode_ns));
-  tinfo.m_add_duration_for_n_packets                                                  = block.NumberFrames();
-  tinfo.m_size                                                                       += boost::accumulate(frame_sizes, 0);
+  add_simple_block_statistics(block.TrackNum(), timecode_ns, block.IsKeyframe() ? 0 : block.IsDiscardable() ? 2 : 1, block.NumberFrames(), boost::accumulate(frame_sizes, 0));
+}
+
+static std::string s_summary_output;
+
+static void
+flush_summary_output() {
+  if (s_summary_output.empty())
+    return;
+
+  mxinfo(s_summary_output);
+  s_summary_output.clear();
+}
+
+static void
+show_summary_block(summary_block_t const &block) {
+  static std::string s_timecode, s_position;
+
+  auto frame_type  = block.get_frame_type();
+  auto timecode_ms = std::llround(static_cast<double>(block.m_timecode) / 1000000.0);
+  float duration   = block.m_has_duration ? static_cast<double>(block.m_duration) * s_tc_scale / 1000000.0 : -1.0;
+
+  s_timecode.clear();
+  append_timecode(s_timecode, block.m_timecode, 3);
+
+  for (auto const &frame : block.m_frames) {
+    s_position.clear();
+    if (1 <= g_options.m_verbose)
+      FF_SUMMARY_POSITION.append(s_position, { frame.m_position });
+
+    if (block.m_is_simple_block && g_options.m_calc_checksums)
+      FF_SIMPLE_BLOCK_SUMMARY.append(s_summary_output, { frame_type, block.m_track_number, timecode_ms, s_timecode, frame.m_size, frame.m_adler, s_position });
+
+    else if (block.m_is_simple_block)
+      FF_SIMPLE_BLOCK_SUMMARY_NO_CHECKSUM.append(s_summary_output, { frame_type, block.m_track_number, timecode_ms, s_timecode, frame.m_size, s_position });
+
+    else if (block.m_has_duration && g_options.m_calc_checksums)
+      FF_BLOCK_GROUP_SUMMARY_WITH_DURATION.append(s_summary_output, { frame_type, block.m_track_number, timecode_ms, s_timecode, duration, frame.m_size, frame.m_adler, "", s_position });
+
+    else if (block.m_has_duration)
+      FF_BLOCK_GROUP_SUMMARY_WITH_DURATION_NO_CHECKSUM.append(s_summary_output, { frame_type, block.m_track_number, timecode_ms, s_timecode, duration, frame.m_size, "", s_position });
+
+    else if (g_options.m_calc_checksums)
+      FF_BLOCK_GROUP_SUMMARY_NO_DURATION.append(s_summary_output, { frame_type, block.m_track_number, timecode_ms, s_timecode, frame.m_size, frame.m_adler, "", s_position });
+
+    else
+      FF_BLOCK_GROUP_SUMMARY_NO_DURATION_NO_CHECKSUM.append(s_summary_output, { frame_type, block.m_track_number, timecode_ms, s_timecode, frame.m_size, "", s_position });
+  }
+
+  if (block.m_is_simple_block)
+    add_simple_block_statistics(block.m_track_number, block.m_timecode, frame_type == 'I' ? 0 : frame_type == 'B' ? 2 : 1, block.m_frames.size(), block.get_total_size());
+  else
+    add_block_group_statistics(block.m_track_number, block.m_timecode, duration, block.m_num_references, block.m_frames.size(), block.get_total_size());
+
+  if (s_summary_output.size() >= 64 * 1024)
+    flush_summary_output();
 }
 
 void
@@ -1579,7 +1708,30 @@ handle_segment(EbmlElement *l0,
   // Prevent reporting "first timecode after resync":
   kax_file->set_timecode_scale(-1);
 
-  while ((l1 = kax_file->read_next_level1_element())) {
+  // Clusters can be summarized without libebml reading them
+  // completely. The hex dump requires the frame contents, though.
+  std::unique_ptr<summary_engine_c> summary_engine;
+  if (g_options.m_show_summary && !g_options.m_use_gui && !g_options.m_show_hexdump)
+    summary_engine.reset(new summary_engine_c{*in, show_summary_block, g_options.m_calc_checksums});
+
+  auto segment_end = l0->IsFiniteSize() ? std::min<int64_t>(l0->GetElementPosition() + l0->HeadSize() + l0->GetSize(), file_size) : file_size;
+
+  while (true) {
+    if (summary_engine && summary_engine->process_cluster(s_tc_scale, segment_end)) {
+      if (!in_parent(l0))
+        break;
+      continue;
+    }
+
+    if (summary_engine) {
+      summary_engine->flush();
+      flush_summary_output();
+    }
+
+    l1 = kax_file->read_next_level1_element();
+    if (!l1)
+      break;
+
     std::shared_ptr<EbmlElement> af_l1(l1);
 
     if (Is<KaxInfo>(l1))
@@ -1619,6 +1771,11 @@ handle_segment(EbmlElement *l0,
     if (!in_parent(l0))
       break;
   } // while (l1)
+
+  if (summary_engine) {
+    summary_engine->flush();
+    flush_summary_output();
+  }
 }
 
 void
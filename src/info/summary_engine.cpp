@@ -0,0 +1,525 @@
+/*
+   mkvinfo -- utility for gathering information about Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   streaming cluster summary engine
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxBlockData.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxClusterData.h>
+
+#include "common/checksums/base.h"
+#include "common/ebml.h"
+#include "common/endian.h"
+#include "common/mm_io_x.h"
+#include "info/summary_engine.h"
+
+using namespace libmatroska;
+
+namespace {
+
+std::size_t const s_read_window_size      = 4096;
+std::size_t const s_max_pending_per_thread = 2;
+
+/** \brief Decodes an EBML variable sized integer from a buffer
+
+   \return The number of bytes the integer occupies or 0 if the buffer
+     does not contain a valid integer.
+*/
+std::size_t
+decode_vint(unsigned char const *buffer,
+            std::size_t available,
+            uint64_t &value,
+            bool keep_length_marker) {
+  if (!available || !buffer[0])
+    return 0;
+
+  auto length = 1u;
+  auto mask   = 0x80u;
+
+  while (!(buffer[0] & mask)) {
+    mask >>= 1;
+    ++length;
+  }
+
+  if (length > available)
+    return 0;
+
+  value = keep_length_marker ? buffer[0] : buffer[0] & (mask - 1);
+  for (auto idx = 1u; idx < length; ++idx)
+    value = (value << 8) | buffer[idx];
+
+  return length;
+}
+
+}
+
+summary_block_t::summary_block_t()
+  : m_track_number{}
+  , m_timecode{}
+  , m_relative_timecode{}
+  , m_duration{}
+  , m_num_references{}
+  , m_is_simple_block{}
+  , m_is_keyframe{}
+  , m_is_discardable{}
+  , m_has_duration{}
+{
+}
+
+/** \brief Returns 'I', 'P' or 'B' the same way the libebml based code does
+*/
+char
+summary_block_t::get_frame_type()
+  const {
+  if (m_is_simple_block)
+    return m_is_keyframe ? 'I' : m_is_discardable ? 'B' : 'P';
+
+  return m_num_references >= 2 ? 'B' : m_num_references == 1 ? 'P' : 'I';
+}
+
+int64_t
+summary_block_t::get_total_size()
+  const {
+  auto size = int64_t{};
+  for (auto const &frame : m_frames)
+    size += frame.m_size;
+
+  return size;
+}
+
+summary_engine_c::summary_engine_c(mm_io_c &in,
+                                   handler_t const &handler,
+                                   bool calc_checksums)
+  : m_in(in)
+  , m_handler{handler}
+  , m_calc_checksums{calc_checksums}
+  , m_read_buffer_position{-1}
+  , m_read_buffer_filled{}
+  , m_cluster{}
+  , m_debug{"summary_engine"}
+  , m_num_clusters{}
+  , m_num_blocks{}
+{
+  if (m_calc_checksums)
+    m_pool.reset(new thread_pool_c);
+}
+
+summary_engine_c::~summary_engine_c() {
+  // Don't let the workers access clusters that are being destroyed.
+  for (auto &cluster : m_pending_clusters)
+    if (cluster->m_checksums_calculated.valid())
+      cluster->m_checksums_calculated.wait();
+
+  mxdebug_if(m_debug, boost::format("summary_engine: processed %1% clusters with %2% blocks\n") % m_num_clusters % m_num_blocks);
+}
+
+/** \brief Summarizes the cluster at the current file position
+
+   \param timecode_scale The segment's timecode scale.
+   \param parent_end The position the cluster must end at the latest,
+     usually the end of the segment.
+
+   \return \c true if the element at the current position was a
+     cluster that has been processed. The file pointer is positioned
+     at the end of the cluster then. Otherwise \c false is returned and
+     the file pointer is left unchanged.
+*/
+bool
+summary_engine_c::process_cluster(uint64_t timecode_scale,
+                                  int64_t parent_end) {
+  auto position = static_cast<int64_t>(m_in.getFilePointer());
+  auto cluster  = std::unique_ptr<cluster_t>{new cluster_t};
+  auto result   = false;
+  m_cluster     = cluster.get();
+
+  cluster->m_position = position;
+
+  try {
+    auto id               = uint32_t{};
+    auto data_position    = int64_t{};
+    auto data_size        = int64_t{};
+    auto cluster_timecode = uint64_t{};
+
+    if (   read_element_header(position, parent_end, id, data_position, data_size)
+        && (EBML_ID_VALUE(EBML_ID(KaxCluster)) == id)) {
+      auto end = data_position + data_size;
+
+      if (m_calc_checksums) {
+        cluster->m_data = memory_c::alloc(end - position);
+        m_in.setFilePointer(position);
+        result = m_in.read(cluster->m_data->get_buffer(), end - position) == static_cast<uint64_t>(end - position);
+      } else
+        result = true;
+
+      result = result && parse_cluster(data_position, end, cluster_timecode);
+
+      if (result) {
+        for (auto &block : cluster->m_blocks)
+          block.m_timecode = (static_cast<int64_t>(cluster_timecode) + block.m_relative_timecode) * static_cast<int64_t>(timecode_scale);
+
+        m_in.setFilePointer(end);
+      }
+    }
+
+  } catch (mtx::mm_io::exception &) {
+    result = false;
+  }
+
+  m_cluster = nullptr;
+
+  if (!result) {
+    mxdebug_if(m_debug, boost::format("summary_engine: falling back to libebml for the element at %1%\n") % position);
+    m_in.setFilePointer(position);
+    return false;
+  }
+
+  ++m_num_clusters;
+
+  if (!m_calc_checksums) {
+    deliver_cluster(*cluster);
+    return true;
+  }
+
+  auto &calculated_cluster        = *cluster;
+  cluster->m_checksums_calculated = m_pool->submit([&calculated_cluster]() { calculate_checksums(calculated_cluster); });
+  m_pending_clusters.push_back(std::move(cluster));
+
+  while (m_pending_clusters.size() > (m_pool->get_num_threads() * s_max_pending_per_thread)) {
+    deliver_cluster(*m_pending_clusters.front());
+    m_pending_clusters.pop_front();
+  }
+
+  return true;
+}
+
+/** \brief Calls the handler for all blocks that are still pending
+
+   Must be called before any other output is generated for the file
+   so that the output order matches the file order.
+*/
+void
+summary_engine_c::flush() {
+  while (!m_pending_clusters.empty()) {
+    deliver_cluster(*m_pending_clusters.front());
+    m_pending_clusters.pop_front();
+  }
+}
+
+void
+summary_engine_c::deliver_cluster(cluster_t &cluster) {
+  if (cluster.m_checksums_calculated.valid())
+    cluster.m_checksums_calculated.get();
+
+  for (auto const &block : cluster.m_blocks)
+    m_handler(block);
+
+  m_num_blocks += cluster.m_blocks.size();
+}
+
+void
+summary_engine_c::calculate_checksums(cluster_t &cluster) {
+  auto buffer = cluster.m_data->get_buffer();
+
+  for (auto &block : cluster.m_blocks)
+    for (auto &frame : block.m_frames)
+      frame.m_adler = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, buffer + frame.m_position - cluster.m_position, frame.m_size);
+}
+
+/** \brief Returns a pointer to up to \c size bytes starting at \c position
+
+   If the current cluster has been read completely then the pointer
+   points into its data. Otherwise the data is read from the file in
+   windows of at least \c s_read_window_size bytes so that the headers
+   of small neighbouring elements are read with a single read call.
+*/
+unsigned char const *
+summary_engine_c::read_at(int64_t position,
+                          std::size_t size,
+                          std::size_t &available) {
+  if (m_cluster && m_cluster->m_data) {
+    auto offset     = position - m_cluster->m_position;
+    auto total_size = static_cast<int64_t>(m_cluster->m_data->get_size());
+    available       = (0 <= offset) && (offset < total_size) ? std::min<int64_t>(size, total_size - offset) : 0;
+
+    return available ? m_cluster->m_data->get_buffer() + offset : nullptr;
+  }
+
+  auto buffer_end = m_read_buffer_position + static_cast<int64_t>(m_read_buffer_filled);
+
+  if (   (0 > m_read_buffer_position)
+      || (position < m_read_buffer_position)
+      || ((position + static_cast<int64_t>(size)) > buffer_end)) {
+    m_read_buffer.resize(std::max(size, s_read_window_size));
+    m_in.setFilePointer(position);
+
+    m_read_buffer_position = position;
+    m_read_buffer_filled   = m_in.read(&m_read_buffer[0], m_read_buffer.size());
+  }
+
+  auto offset = position - m_read_buffer_position;
+  available   = std::min<std::size_t>(size, m_read_buffer_filled - offset);
+
+  return &m_read_buffer[offset];
+}
+
+bool
+summary_engine_c::read_element_header(int64_t position,
+                                      int64_t parent_end,
+                                      uint32_t &id,
+                                      int64_t &data_position,
+                                      int64_t &data_size) {
+  auto available = std::size_t{};
+  auto buffer    = read_at(position, 12, available);
+  auto id_value  = uint64_t{};
+  auto size      = uint64_t{};
+
+  auto id_length = decode_vint(buffer, available, id_value, true);
+  if (!id_length || (4 < id_length))
+    return false;
+
+  auto size_length = decode_vint(buffer + id_length, available - id_length, size, false);
+  if (!size_length || (((1ull << (7 * size_length)) - 1) == size))
+    return false;
+
+  id            = id_value;
+  data_position = position + id_length + size_length;
+  data_size     = size;
+
+  return (data_position + data_size) <= parent_end;
+}
+
+bool
+summary_engine_c::read_unsigned(int64_t position,
+                                int64_t size,
+                                uint64_t &value) {
+  if (8 < size)
+    return false;
+
+  auto available = std::size_t{};
+  auto buffer    = read_at(position, size, available);
+
+  if (static_cast<int64_t>(available) < size)
+    return false;
+
+  value = 0;
+  for (auto idx = 0; idx < size; ++idx)
+    value = (value << 8) | buffer[idx];
+
+  return true;
+}
+
+bool
+summary_engine_c::parse_cluster(int64_t data_position,
+                                int64_t end,
+                                uint64_t &cluster_timecode) {
+  auto position = data_position;
+
+  while (position < end) {
+    auto id                  = uint32_t{};
+    auto child_data_position = int64_t{};
+    auto child_data_size     = int64_t{};
+
+    if (!read_element_header(position, end, id, child_data_position, child_data_size))
+      return false;
+
+    if (EBML_ID_VALUE(EBML_ID(KaxClusterTimecode)) == id) {
+      if (!read_unsigned(child_data_position, child_data_size, cluster_timecode))
+        return false;
+
+    } else if (EBML_ID_VALUE(EBML_ID(KaxSimpleBlock)) == id) {
+      m_cluster->m_blocks.emplace_back();
+      auto &block             = m_cluster->m_blocks.back();
+      block.m_is_simple_block = true;
+
+      if (!parse_block(child_data_position, child_data_size, block))
+        return false;
+
+    } else if (EBML_ID_VALUE(EBML_ID(KaxBlockGroup)) == id) {
+      if (!parse_block_group(child_data_position, child_data_position + child_data_size))
+        return false;
+    }
+
+    position = child_data_position + child_data_size;
+  }
+
+  return true;
+}
+
+bool
+summary_engine_c::parse_block_group(int64_t data_position,
+                                    int64_t end) {
+  auto block     = summary_block_t{};
+  auto has_block = false;
+  auto position  = data_position;
+
+  while (position < end) {
+    auto id                  = uint32_t{};
+    auto child_data_position = int64_t{};
+    auto child_data_size     = int64_t{};
+
+    if (!read_element_header(position, end, id, child_data_position, child_data_size))
+      return false;
+
+    if (EBML_ID_VALUE(EBML_ID(KaxBlock)) == id) {
+      // A duration only applies if it follows the block.
+      block.m_has_duration = false;
+      has_block            = true;
+
+      if (!parse_block(child_data_position, child_data_size, block))
+        return false;
+
+    } else if (EBML_ID_VALUE(EBML_ID(KaxBlockDuration)) == id) {
+      if (!read_unsigned(child_data_position, child_data_size, block.m_duration))
+        return false;
+
+      block.m_has_duration = true;
+
+    } else if (EBML_ID_VALUE(EBML_ID(KaxReferenceBlock)) == id)
+      ++block.m_num_references;
+
+    position = child_data_position + child_data_size;
+  }
+
+  if (has_block)
+    m_cluster->m_blocks.push_back(std::move(block));
+
+  return true;
+}
+
+bool
+summary_engine_c::parse_block(int64_t data_position,
+                              int64_t data_size,
+                              summary_block_t &block) {
+  // Most block headers including their lacing information are short.
+  // Only read the whole block if they aren't.
+  auto wanted_size = std::min<int64_t>(data_size, 64);
+
+  while (true) {
+    auto available      = std::size_t{};
+    auto need_more_data = false;
+    auto buffer         = read_at(data_position, wanted_size, available);
+
+    if (parse_block_header(buffer, available, data_position, data_size, block, need_more_data))
+      return true;
+
+    if (!need_more_data || (wanted_size >= data_size))
+      return false;
+
+    wanted_size = data_size;
+  }
+}
+
+bool
+summary_engine_c::parse_block_header(unsigned char const *buffer,
+                                     std::size_t available,
+                                     int64_t data_position,
+                                     int64_t data_size,
+                                     summary_block_t &block,
+                                     bool &need_more_data) {
+  auto track_number        = uint64_t{};
+  auto track_number_length = decode_vint(buffer, available, track_number, false);
+
+  if (!track_number_length || ((track_number_length + 3) > available))
+    return false;
+
+  auto ptr   = track_number_length;
+  auto flags = buffer[ptr + 2];
+
+  block.m_track_number      = track_number;
+  block.m_relative_timecode = static_cast<int16_t>(get_uint16_be(&buffer[ptr]));
+  ptr                      += 3;
+
+  if (block.m_is_simple_block) {
+    block.m_is_keyframe    = 0x80 == (flags & 0x80);
+    block.m_is_discardable = 0x01 == (flags & 0x01);
+  }
+
+  auto lacing     = flags & 0x06;
+  auto num_frames = 1u;
+  auto sizes      = std::vector<int64_t>{};
+
+  if (lacing) {
+    if (ptr >= available) {
+      need_more_data = true;
+      return false;
+    }
+
+    num_frames = buffer[ptr] + 1;
+    ++ptr;
+  }
+
+  if (0x02 == lacing) {         // Xiph lacing
+    for (auto frame_idx = 1u; frame_idx < num_frames; ++frame_idx) {
+      auto size = int64_t{};
+
+      while (true) {
+        if (ptr >= available) {
+          need_more_data = true;
+          return false;
+        }
+
+        auto byte  = buffer[ptr++];
+        size      += byte;
+        if (0xff != byte)
+          break;
+      }
+
+      sizes.push_back(size);
+    }
+
+  } else if (0x06 == lacing) {  // EBML lacing
+    auto previous_size = int64_t{};
+
+    for (auto frame_idx = 1u; frame_idx < num_frames; ++frame_idx) {
+      auto value  = uint64_t{};
+      auto length = decode_vint(buffer + ptr, available - ptr, value, false);
+
+      if (!length) {
+        need_more_data = (available - ptr) < 8;
+        return false;
+      }
+
+      auto size = 1 == frame_idx ? static_cast<int64_t>(value) : previous_size + static_cast<int64_t>(value) - ((1ll << (7 * length - 1)) - 1);
+      if (0 > size)
+        return false;
+
+      sizes.push_back(size);
+      previous_size  = size;
+      ptr           += length;
+    }
+  }
+
+  auto payload_size = data_size - static_cast<int64_t>(ptr);
+  auto laced_size   = int64_t{};
+
+  for (auto size : sizes)
+    laced_size += size;
+
+  if (laced_size > payload_size)
+    return false;
+
+  if (0x04 == lacing)           // fixed-size lacing
+    sizes.assign(num_frames, payload_size / num_frames);
+  else
+    sizes.push_back(payload_size - laced_size);
+
+  // Several blocks in one block group are summarized as one.
+  auto frame_position = data_position + static_cast<int64_t>(ptr);
+
+  for (auto size : sizes) {
+    block.m_frames.push_back(summary_frame_t{ frame_position, size, 0 });
+    frame_position += size;
+  }
+
+  return true;
+}
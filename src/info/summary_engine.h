@@ -0,0 +1,108 @@
+/*
+   mkvinfo -- utility for gathering information about Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the streaming cluster summary engine
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_INFO_SUMMARY_ENGINE_H
+#define MTX_INFO_SUMMARY_ENGINE_H
+
+#include "common/common_pch.h"
+
+#include <deque>
+#include <future>
+
+#include "common/mm_io.h"
+#include "common/thread_pool.h"
+
+struct summary_frame_t {
+  int64_t m_position, m_size;
+  uint32_t m_adler;
+};
+
+struct summary_block_t {
+  uint64_t m_track_number;
+  int64_t m_timecode;           // in ns
+  int16_t m_relative_timecode;
+  uint64_t m_duration;          // in units of the timecode scale
+  unsigned int m_num_references;
+  bool m_is_simple_block, m_is_keyframe, m_is_discardable, m_has_duration;
+  std::vector<summary_frame_t> m_frames;
+
+  summary_block_t();
+
+  char get_frame_type() const;
+  int64_t get_total_size() const;
+};
+
+/** \brief Summarizes clusters without building libebml objects for them
+
+   Only the element headers inside a cluster and the headers of
+   SimpleBlock and Block elements (track number, timecode, flags and
+   lacing) are read. The frame payloads are skipped by seeking over
+   them.
+
+   If checksums are requested then each cluster is read with a single
+   read call instead, and the Adler-32 checksums of its frames are
+   calculated on a thread pool while the following clusters are being
+   parsed. The handler is still called for all blocks in file order.
+
+   If a cluster cannot be parsed this way (e.g. because it has an
+   unknown size or contains damaged elements) then \c process_cluster()
+   returns \c false without having consumed anything, and the caller
+   can fall back to reading the cluster with libebml.
+*/
+class summary_engine_c {
+public:
+  using handler_t = std::function<void(summary_block_t const &)>;
+
+protected:
+  struct cluster_t {
+    int64_t m_position;
+    memory_cptr m_data;
+    std::vector<summary_block_t> m_blocks;
+    std::future<void> m_checksums_calculated;
+  };
+
+  mm_io_c &m_in;
+  handler_t m_handler;
+  bool m_calc_checksums;
+
+  std::unique_ptr<thread_pool_c> m_pool;
+  std::deque<std::unique_ptr<cluster_t>> m_pending_clusters;
+  std::vector<unsigned char> m_read_buffer;
+  int64_t m_read_buffer_position;
+  std::size_t m_read_buffer_filled;
+  cluster_t *m_cluster;
+
+  debugging_option_c m_debug;
+  uint64_t m_num_clusters, m_num_blocks;
+
+public:
+  summary_engine_c(mm_io_c &in, handler_t const &handler, bool calc_checksums);
+  ~summary_engine_c();
+
+  bool process_cluster(uint64_t timecode_scale, int64_t parent_end);
+  void flush();
+
+protected:
+  unsigned char const *read_at(int64_t position, std::size_t size, std::size_t &available);
+  bool read_element_header(int64_t position, int64_t parent_end, uint32_t &id, int64_t &data_position, int64_t &data_size);
+  bool read_unsigned(int64_t position, int64_t size, uint64_t &value);
+
+  bool parse_cluster(int64_t data_position, int64_t end, uint64_t &cluster_timecode);
+  bool parse_block_group(int64_t data_position, int64_t end);
+  bool parse_block(int64_t data_position, int64_t data_size, summary_block_t &block);
+  bool parse_block_header(unsigned char const *buffer, std::size_t available, int64_t data_position, int64_t data_size, summary_block_t &block, bool &need_more_data);
+
+  void deliver_cluster(cluster_t &cluster);
+  static void calculate_checksums(cluster_t &cluster);
+};
+
+#endif  // MTX_INFO_SUMMARY_ENGINE_H
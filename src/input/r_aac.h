@@ -38,6 +38,9 @@ public:
 
   virtual void read_headers();
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
+  virtual bool supports_threaded_reading() const {
+    return true;
+  }
   virtual void identify();
   virtual void create_packetizer(int64_t id);
   virtual bool is_providing_timecodes() const {
@@ -16,6 +16,8 @@
 #include <ogg/ogg.h>
 #include <vorbis/codec.h>
 
+#include "common/checksums/base.h"
+#include "common/checksums/crc.h"
 #include "common/codec.h"
 #include "common/flac.h"
 #include "input/r_flac.h"
@@ -23,7 +25,7 @@
 #include "merge/file_status.h"
 #include "merge/output_control.h"
 
-#define BUFFER_SIZE 4096
+#define BUFFER_SIZE (64 * 1024)
 
 #if defined(HAVE_FLAC_FORMAT_H)
 
@@ -50,6 +52,8 @@ flac_reader_c::flac_reader_c(const track_info_c &ti,
                              const mm_io_cptr &in)
   : generic_reader_c{ti, in}
   , decoder_c()                 // Don't use initializer-list syntax due to a bug in gcc < 4.8
+  , m_chunk{memory_c::alloc(BUFFER_SIZE)}
+  , m_debug{"flac_reader"}
 {
 }
 
@@ -62,26 +66,6 @@ flac_reader_c::read_headers() {
 
   if (!parse_file())
     throw mtx::input::header_parsing_x();
-
-  try {
-    uint32_t block_size = 0;
-
-    for (current_block = blocks.begin(); (current_block != blocks.end()) && (FLAC_BLOCK_TYPE_HEADERS == current_block->type); current_block++)
-      block_size += current_block->len;
-
-    m_header = memory_c::alloc(block_size);
-
-    block_size         = 0;
-    for (current_block = blocks.begin(); (current_block != blocks.end()) && (FLAC_BLOCK_TYPE_HEADERS == current_block->type); current_block++) {
-      m_in->setFilePointer(current_block->filepos);
-      if (m_in->read(m_header->get_buffer() + block_size, current_block->len) != current_block->len)
-        mxerror(Y("flac_reader: Could not read a header packet.\n"));
-      block_size += current_block->len;
-    }
-
-  } catch (mtx::exception &) {
-    mxerror(Y("flac_reader: could not initialize the FLAC packetizer.\n"));
-  }
 }
 
 flac_reader_c::~flac_reader_c() {
@@ -96,98 +80,189 @@ flac_reader_c::create_packetizer(int64_t) {
   show_packetizer_info(0, PTZR0);
 }
 
+/** \brief Reads the metadata blocks
+
+   Only the metadata is parsed with libFLAC. The frames are located
+   while muxing by scanning for their headers so that the file doesn't
+   have to be read twice.
+*/
 bool
 flac_reader_c::parse_file() {
-  FLAC__StreamDecoderState state;
-  flac_block_t block;
-  uint64_t u, old_pos;
-  int result, progress, old_progress;
-  bool ok;
+  uint64_t u;
 
   m_in->setFilePointer(0);
   metadata_parsed = false;
 
-  mxinfo(Y("+-> Parsing the FLAC file. This can take a LONG time.\n"));
-
   init_flac_decoder();
-  result = FLAC__stream_decoder_process_until_end_of_metadata(m_flac_decoder.get());
+  auto result = FLAC__stream_decoder_process_until_end_of_metadata(m_flac_decoder.get());
 
-  mxverb(2, boost::format("flac_reader: extract->metadata, result: %1%, mdp: %2%, num blocks: %3%\n") % result % metadata_parsed % blocks.size());
+  mxverb(2, boost::format("flac_reader: extract->metadata, result: %1%, mdp: %2%\n") % result % metadata_parsed);
 
   if (!metadata_parsed)
     mxerror_fn(m_ti.m_fname, Y("No metadata block found. This file is broken.\n"));
 
-  FLAC__stream_decoder_get_decode_position(m_flac_decoder.get(), &u);
+  if (!FLAC__stream_decoder_get_decode_position(m_flac_decoder.get(), &u) || (4 > u))
+    mxerror(Y("flac_reader: Could not read all header packets.\n"));
 
-  block.type    = FLAC_BLOCK_TYPE_HEADERS;
-  block.filepos = 0;
-  block.len     = u;
-  old_pos       = u;
+  m_flac_decoder.reset();
 
-  blocks.push_back(block);
+  mxverb(2, boost::format("flac_reader: headers: block at %1% with size %2%\n") % 4 % (u - 4));
 
-  mxverb(2, boost::format("flac_reader: headers: block at %1% with size %2%\n") % block.filepos % block.len);
+  try {
+    m_header = memory_c::alloc(u - 4);
 
-  old_progress = -5;
-  ok = FLAC__stream_decoder_skip_single_frame(m_flac_decoder.get());
-  while (ok) {
-    state = FLAC__stream_decoder_get_state(m_flac_decoder.get());
+    m_in->setFilePointer(4);
+    if (m_in->read(m_header->get_buffer(), u - 4) != (u - 4))
+      mxerror(Y("flac_reader: Could not read a header packet.\n"));
 
-    progress = m_in->getFilePointer() * 100 / m_size;
-    if ((progress - old_progress) >= 5) {
-      mxinfo(boost::format(Y("+-> Pre-parsing FLAC file: %1%%%%2%")) % progress % "\r");
-      old_progress = progress;
-    }
+    m_in->setFilePointer(u);
 
-    if (FLAC__stream_decoder_get_decode_position(m_flac_decoder.get(), &u) && (u != old_pos)) {
-      block.type    = FLAC_BLOCK_TYPE_DATA;
-      block.filepos = old_pos;
-      block.len     = u - old_pos;
-      old_pos       = u;
-      blocks.push_back(block);
+  } catch (mtx::exception &) {
+    mxerror(Y("flac_reader: could not initialize the FLAC packetizer.\n"));
+  }
 
-      mxverb(2, boost::format("flac_reader: skip/decode frame, block at %1% with size %2%\n") % block.filepos % block.len);
-    }
+  return metadata_parsed;
+}
+
+bool
+flac_reader_c::fill_buffer() {
+  if (m_end_of_file)
+    return false;
+
+  auto num_read = m_in->read(m_chunk->get_buffer(), BUFFER_SIZE);
+  if (num_read < BUFFER_SIZE)
+    m_end_of_file = true;
+
+  m_buffer.add(m_chunk->get_buffer(), num_read);
+
+  return 0 != num_read;
+}
+
+/** \brief Locates the frame at the start of the buffer
+
+   Data before the first valid frame header is skipped. The frame ends
+   where the next one starts. That is the next valid frame header whose
+   number continues the current frame's number or, if frames are
+   missing, for which the CRC-16 of the data before it is correct. The
+   last frame ends where its CRC-16 is correct, see
+   \c find_last_frame_end().
 
-    if (state > FLAC__STREAM_DECODER_READ_FRAME)
+   \return The frame's size or 0 if there are no more frames.
+*/
+size_t
+flac_reader_c::find_next_frame() {
+  static size_t const s_max_frame_header_size = 16;
+
+  auto num_skipped = size_t{};
+
+  while (true) {
+    if ((m_buffer.get_size() < s_max_frame_header_size) && fill_buffer())
+      continue;
+
+    auto buffer = m_buffer.get_buffer();
+    auto size   = m_buffer.get_size();
+
+    if (!size)
+      return 0;
+
+    if (mtx::flac::parse_frame_header(buffer, size, m_current_header))
       break;
 
-    ok = FLAC__stream_decoder_skip_single_frame(m_flac_decoder.get());
+    auto sync = static_cast<unsigned char const *>(memchr(buffer + 1, 0xff, size - 1));
+    auto skip = sync ? static_cast<size_t>(sync - buffer) : size;
+    m_buffer.remove(skip);
+
+    num_skipped += skip;
   }
 
-  if (100 != old_progress)
-    mxinfo(Y("+-> Pre-parsing FLAC file: 100%\n"));
-  else
-    mxinfo("\n");
+  if (num_skipped)
+    mxdebug_if(m_debug, boost::format("flac_reader: skipped %1% bytes before a frame header\n") % num_skipped);
 
-  if ((blocks.size() == 0) || (blocks[0].type != FLAC_BLOCK_TYPE_HEADERS))
-    mxerror(Y("flac_reader: Could not read all header packets.\n"));
+  auto expected_number = m_current_header.variable_block_size ? m_current_header.number + m_current_header.num_samples : m_current_header.number + 1;
+  auto pos             = m_current_header.size;
 
-  m_in->setFilePointer(0);
-  blocks[0].len     -= 4;
-  blocks[0].filepos  = 4;
+  while (true) {
+    auto buffer = m_buffer.get_buffer();
+    auto size   = m_buffer.get_size();
 
-  return metadata_parsed;
+    while (pos < size) {
+      auto sync = static_cast<unsigned char const *>(memchr(buffer + pos, 0xff, size - pos));
+      if (!sync) {
+        pos = size;
+        break;
+      }
+
+      pos = sync - buffer;
+
+      // Wait for the complete header unless the file ends.
+      if (((size - pos) < s_max_frame_header_size) && !m_end_of_file)
+        break;
+
+      mtx::flac::frame_header_t next_header;
+      if (   mtx::flac::parse_frame_header(sync, size - pos, next_header)
+          && (next_header.variable_block_size == m_current_header.variable_block_size)
+          && (   (next_header.number == expected_number)
+              || !mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc16_ansi, buffer, pos)))
+        return pos;
+
+      ++pos;
+    }
+
+    if (!fill_buffer())
+      return find_last_frame_end();
+  }
+}
+
+/** \brief Determines where the last frame in the file ends
+
+   Files may contain data after the last frame, e.g. an ID3v1 tag or
+   padding, which must not become part of the frame. The frame
+   therefore ends at the last position up to which the frame's CRC-16
+   is correct. If the CRC-16 is correct nowhere, e.g. because the file
+   has been truncated, all of the remaining data is used.
+*/
+size_t
+flac_reader_c::find_last_frame_end() {
+  auto buffer = m_buffer.get_buffer();
+  auto size   = m_buffer.get_size();
+
+  if (!mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc16_ansi, buffer, size))
+    return size;
+
+  mtx::checksum::crc16_ansi_c crc;
+  auto frame_end = size_t{};
+
+  crc.add(buffer, std::min<size_t>(m_current_header.size, size));
+
+  for (auto pos = m_current_header.size; pos < size; ++pos) {
+    crc.add(&buffer[pos], 1);
+    if (!crc.get_result_as_uint())
+      frame_end = pos + 1;
+  }
+
+  if (!frame_end)
+    return size;
+
+  mxdebug_if(m_debug, boost::format("flac_reader: ignoring %1% bytes after the last frame\n") % (size - frame_end));
+
+  return frame_end;
 }
 
 file_status_e
 flac_reader_c::read(generic_packetizer_c *,
                     bool) {
-  if (current_block == blocks.end())
+  auto frame_size = find_next_frame();
+  if (!frame_size)
     return flush_packetizers();
 
-  memory_cptr buf = memory_c::alloc(current_block->len);
-  m_in->setFilePointer(current_block->filepos);
-  if (m_in->read(buf, current_block->len) != current_block->len)
-    return flush_packetizers();
+  mxdebug_if(m_debug, boost::format("flac_reader: frame number %1% with %2% samples and size %3%\n") % m_current_header.number % m_current_header.num_samples % frame_size);
 
-  unsigned int samples_here = mtx::flac::get_num_samples(buf->get_buffer(), current_block->len, stream_info);
-  PTZR0->process(new packet_t(buf, samples * 1000000000 / sample_rate));
+  PTZR0->process(new packet_t(memory_c::clone(m_buffer.get_buffer(), frame_size), samples * 1000000000 / sample_rate));
 
-  samples += samples_here;
-  current_block++;
+  samples += m_current_header.num_samples;
+  m_buffer.remove(frame_size);
 
-  return (current_block == blocks.end()) ? flush_packetizers() : FILE_STATUS_MOREDATA;
+  return FILE_STATUS_MOREDATA;
 }
 
 FLAC__StreamDecoderReadStatus
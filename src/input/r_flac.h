@@ -16,6 +16,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/byte_buffer.h"
 #include "common/mm_io.h"
 #include "merge/generic_reader.h"
 
@@ -27,23 +28,16 @@
 #include "common/flac.h"
 #include "output/p_flac.h"
 
-#define FLAC_BLOCK_TYPE_HEADERS 0
-#define FLAC_BLOCK_TYPE_DATA    1
-
-struct flac_block_t {
-  int64_t filepos;
-  unsigned int type, len;
-};
-
 class flac_reader_c: public generic_reader_c, public mtx::flac::decoder_c {
 private:
-  memory_cptr m_header;
+  memory_cptr m_header, m_chunk;
   int sample_rate{};
-  bool metadata_parsed{};
+  bool metadata_parsed{}, m_end_of_file{};
   uint64_t samples{};
-  std::vector<flac_block_t> blocks;
-  std::vector<flac_block_t>::iterator current_block;
   FLAC__StreamMetadata_StreamInfo stream_info;
+  byte_buffer_c m_buffer;
+  mtx::flac::frame_header_t m_current_header;
+  debugging_option_c m_debug;
 
 public:
   flac_reader_c(const track_info_c &ti, const mm_io_cptr &in);
@@ -55,6 +49,9 @@ public:
 
   virtual void read_headers();
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
+  virtual bool supports_threaded_reading() const {
+    return true;
+  }
   virtual void identify();
   virtual void create_packetizer(int64_t id);
   virtual bool is_providing_timecodes() const {
@@ -73,6 +70,9 @@ public:
 
 protected:
   virtual bool parse_file();
+  virtual size_t find_next_frame();
+  virtual size_t find_last_frame_end();
+  virtual bool fill_buffer();
 };
 
 #else  // HAVE_FLAC_FORMAT_H
@@ -1862,6 +1862,25 @@ kax_reader_c::create_vc1_video_packetizer(kax_track_t *t,
     t->ptzr_ptr->process(new packet_t(new memory_c(reinterpret_cast<unsigned char *>(t->private_data) + sizeof(alBITMAPINFOHEADER), t->private_size - sizeof(alBITMAPINFOHEADER), false)));
 }
 
+/** \brief Decodes the frame added to a track's first frames last
+
+   Frames that cannot be decoded are kept as empty frames so that the
+   frame count stays correct. They're reported and skipped when they're
+   muxed.
+*/
+void
+kax_reader_c::read_first_frame_data(kax_track_t &track) {
+  auto &data = track.first_frames_data.back();
+
+  try {
+    track.content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+    data->grab();
+
+  } catch (mtx::compression_x &) {
+    data = memory_c::alloc(0);
+  }
+}
+
 void
 kax_reader_c::read_first_frames(kax_track_t *t,
                                 unsigned num_wanted) {
@@ -1899,8 +1918,7 @@ kax_reader_c::read_first_frames(kax_track_t *t,
 
             DataBuffer &data_buffer = block_simple->GetBuffer(frame_idx);
             block_track->first_frames_data.push_back(memory_cptr(new memory_c(data_buffer.Buffer(), data_buffer.Size())));
-            block_track->content_decoder.reverse(block_track->first_frames_data.back(), CONTENT_ENCODING_SCOPE_BLOCK);
-            block_track->first_frames_data.back()->grab();
+            read_first_frame_data(*block_track);
           }
 
         } else if (Is<KaxBlockGroup>((*cluster)[bgidx])) {
@@ -1924,8 +1942,7 @@ kax_reader_c::read_first_frames(kax_track_t *t,
 
             DataBuffer &data_buffer = block->GetBuffer(frame_idx);
             block_track->first_frames_data.push_back(memory_cptr(new memory_c(data_buffer.Buffer(), data_buffer.Size())));
-            block_track->content_decoder.reverse(block_track->first_frames_data.back(), CONTENT_ENCODING_SCOPE_BLOCK);
-            block_track->first_frames_data.back()->grab();
+            read_first_frame_data(*block_track);
           }
         }
       }
@@ -1953,7 +1970,10 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
   }
 
   try {
-    KaxCluster *cluster = m_in_file->read_next_cluster();
+    // Large frames are passed on as references into the cluster's
+    // buffers. The packets keep the cluster alive until they have been
+    // written so that the frame data doesn't have to be copied.
+    auto cluster = std::shared_ptr<KaxCluster>{m_in_file->read_next_cluster()};
     if (!cluster) {
       flush_packetizers();
 
@@ -1961,7 +1981,7 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
       return FILE_STATUS_DONE;
     }
 
-    auto cluster_tc = FindChildValue<KaxClusterTimecode>(cluster);
+    auto cluster_tc = FindChildValue<KaxClusterTimecode>(cluster.get());
     cluster->InitTimecode(cluster_tc, m_tc_scale);
 
     if (-1 == m_first_timecode) {
@@ -1984,8 +2004,6 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
         process_block_group(cluster, static_cast<KaxBlockGroup *>(element));
     }
 
-    delete cluster;
-
   } catch (...) {
     mxwarn(boost::format("%1% %2% %3%\n")
            % (boost::format(Y("%1%: an unknown exception occurred.")) % "kax_reader_c::read()")
@@ -1997,8 +2015,27 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
   return FILE_STATUS_MOREDATA;
 }
 
+/** \brief Creates the memory for data read from a cluster
+
+   Packets may be queued for a long time, e.g. those of a subtitle
+   track while the other tracks catch up. Memory referring to the
+   cluster's buffer keeps the whole cluster alive for that time. This
+   is only worth it for data that makes up a large part of its
+   cluster. Smaller data is copied so that it doesn't keep a cluster
+   many times its size in memory.
+*/
+memory_cptr
+kax_reader_c::create_block_memory(binary *buffer,
+                                  size_t size,
+                                  std::shared_ptr<KaxCluster> const &cluster) {
+  if ((size * 4) < cluster->GetSize())
+    return memory_c::clone(buffer, size);
+
+  return memory_c::share(buffer, size, cluster);
+}
+
 void
-kax_reader_c::process_simple_block(KaxCluster *cluster,
+kax_reader_c::process_simple_block(std::shared_ptr<KaxCluster> const &cluster,
                                    KaxSimpleBlock *block_simple) {
   int64_t block_duration = -1;
   int64_t block_bref     = VFT_IFRAME;
@@ -2050,8 +2087,10 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
     size_t i;
     for (i = 0; block_simple->NumberFrames() > i; ++i) {
       DataBuffer &data_buffer = block_simple->GetBuffer(i);
-      memory_cptr data(new memory_c(data_buffer.Buffer(), data_buffer.Size(), false));
-      block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+      auto data               = create_block_memory(data_buffer.Buffer(), data_buffer.Size(), cluster);
+      if (!decode_block_data(*block_track, data, m_last_timecode + i * frame_duration))
+        continue;
+
       packet_cptr packet(new packet_t(data, m_last_timecode + i * frame_duration, block_duration, block_bref, block_fref));
 
       static_cast<passthrough_packetizer_c *>(PTZR(block_track->ptzr))->process(packet);
@@ -2061,8 +2100,9 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
     size_t i;
     for (i = 0; i < block_simple->NumberFrames(); i++) {
       DataBuffer &data_buffer = block_simple->GetBuffer(i);
-      memory_cptr data(new memory_c(data_buffer.Buffer(), data_buffer.Size(), false));
-      block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+      auto data               = create_block_memory(data_buffer.Buffer(), data_buffer.Size(), cluster);
+      if (!decode_block_data(*block_track, data, m_last_timecode + i * frame_duration))
+        continue;
 
       if (('s' == block_track->type) && ('t' == block_track->sub_type)) {
         if ((2 < data->get_size()) || ((0 < data->get_size()) && (' ' != *data->get_buffer()) && (0 != *data->get_buffer()) && !iscr(*data->get_buffer()))) {
@@ -2093,8 +2133,30 @@ kax_reader_c::process_block_group_common(KaxBlockGroup *block_group,
     packet->discard_padding = timecode_c::ns(discard_padding->GetValue());
 }
 
+/** \brief Reverses the track's content encodings for a frame
+
+   A single damaged frame must not abort muxing. Frames that cannot be
+   decompressed are reported and have to be skipped by the caller.
+
+   \return \c false if the frame could not be decoded.
+*/
+bool
+kax_reader_c::decode_block_data(kax_track_t &track,
+                                memory_cptr &data,
+                                int64_t timecode) {
+  try {
+    track.content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+    return true;
+
+  } catch (mtx::compression_x &ex) {
+    mxwarn_tid(m_ti.m_fname, track.tnum,
+               boost::format(Y("The frame at timestamp %1% could not be decompressed and will be skipped: %2%\n")) % format_timecode(timecode) % balg::trim_right_copy(ex.error()));
+    return false;
+  }
+}
+
 void
-kax_reader_c::process_block_group(KaxCluster *cluster,
+kax_reader_c::process_block_group(std::shared_ptr<KaxCluster> const &cluster,
                                   KaxBlockGroup *block_group) {
   auto block = FindChild<KaxBlock>(block_group);
   if (!block)
@@ -2167,10 +2229,11 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
     size_t i;
     for (i = 0; i < block->NumberFrames(); i++) {
       auto &data_buffer = block->GetBuffer(i);
-      auto data         = std::make_shared<memory_c>(data_buffer.Buffer(), data_buffer.Size(), false);
-      block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+      auto data         = create_block_memory(data_buffer.Buffer(), data_buffer.Size(), cluster);
+      if (!decode_block_data(*block_track, data, m_last_timecode + i * frame_duration))
+        continue;
 
-      auto packet                = std::make_shared<packet_t>(data, m_last_timecode + i * frame_duration, block_duration, block_bref, block_fref);
+      auto packet                = memory_pool_c::make_shared<packet_t>(data, m_last_timecode + i * frame_duration, block_duration, block_bref, block_fref);
       packet->duration_mandatory = duration;
 
       process_block_group_common(block_group, packet.get());
@@ -2188,12 +2251,13 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
 
   for (auto block_idx = 0u, num_frames = block->NumberFrames(); block_idx < num_frames; ++block_idx) {
     auto &data_buffer = block->GetBuffer(block_idx);
-    auto data         = std::make_shared<memory_c>(data_buffer.Buffer(), data_buffer.Size(), false);
-    block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+    auto data         = create_block_memory(data_buffer.Buffer(), data_buffer.Size(), cluster);
+    if (!decode_block_data(*block_track, data, m_last_timecode + block_idx * frame_duration))
+      continue;
 
     if (('s' == block_track->type) && ('t' == block_track->sub_type)) {
       if ((2 < data->get_size()) || ((0 < data->get_size()) && (' ' != *data->get_buffer()) && (0 != *data->get_buffer()) && !iscr(*data->get_buffer()))) {
-        auto packet = std::make_shared<packet_t>(data, m_last_timecode, block_duration, block_bref, block_fref);
+        auto packet = memory_pool_c::make_shared<packet_t>(data, m_last_timecode, block_duration, block_bref, block_fref);
 
         process_block_group_common(block_group, packet.get());
 
@@ -2201,7 +2265,7 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
       }
 
     } else {
-      auto packet = std::make_shared<packet_t>(data, m_last_timecode + block_idx * frame_duration, block_duration, block_bref, block_fref);
+      auto packet = memory_pool_c::make_shared<packet_t>(data, m_last_timecode + block_idx * frame_duration, block_duration, block_bref, block_fref);
 
       if ((duration) && !duration->GetValue())
         packet->duration_mandatory = true;
@@ -2209,6 +2273,7 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
       process_block_group_common(block_group, packet.get());
 
       auto blockadd = FindChild<KaxBlockAdditions>(block_group);
+      auto decoded  = true;
       if (blockadd) {
         for (auto &child : *blockadd) {
           if (!(Is<KaxBlockMore>(child)))
@@ -2216,14 +2281,18 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
 
           auto blockmore     = static_cast<KaxBlockMore *>(child);
           auto blockadd_data = &GetChild<KaxBlockAdditional>(*blockmore);
-          auto blockadded    = std::make_shared<memory_c>(blockadd_data->GetBuffer(), blockadd_data->GetSize(), false);
-          block_track->content_decoder.reverse(blockadded, CONTENT_ENCODING_SCOPE_BLOCK);
+          auto blockadded    = create_block_memory(blockadd_data->GetBuffer(), blockadd_data->GetSize(), cluster);
+          decoded            = decode_block_data(*block_track, blockadded, packet->timecode);
+
+          if (!decoded)
+            break;
 
           packet->data_adds.push_back(blockadded);
         }
       }
 
-      PTZR(block_track->ptzr)->process(packet);
+      if (decoded)
+        PTZR(block_track->ptzr)->process(packet);
     }
   }
 
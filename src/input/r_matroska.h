@@ -227,6 +227,7 @@ protected:
   virtual void init_passthrough_packetizer(kax_track_t *t, track_info_c &nti);
   virtual void set_packetizer_headers(kax_track_t *t);
   virtual void read_first_frames(kax_track_t *t, unsigned num_wanted = 1);
+  virtual void read_first_frame_data(kax_track_t &track);
   virtual kax_track_t *find_track_by_num(uint64_t num, kax_track_t *c = nullptr);
   virtual kax_track_t *find_track_by_uid(uint64_t uid, kax_track_t *c = nullptr);
 
@@ -288,9 +289,11 @@ protected:
   virtual void read_headers_tracks(mm_io_c *io, EbmlElement *l0, int64_t position);
   virtual bool read_headers_internal();
 
-  virtual void process_simple_block(KaxCluster *cluster, KaxSimpleBlock *block_simple);
-  virtual void process_block_group(KaxCluster *cluster, KaxBlockGroup *block_group);
+  virtual void process_simple_block(std::shared_ptr<KaxCluster> const &cluster, KaxSimpleBlock *block_simple);
+  virtual void process_block_group(std::shared_ptr<KaxCluster> const &cluster, KaxBlockGroup *block_group);
   virtual void process_block_group_common(KaxBlockGroup *block_group, packet_t *packet);
+  virtual bool decode_block_data(kax_track_t &track, memory_cptr &data, int64_t timecode);
+  memory_cptr create_block_memory(binary *buffer, size_t size, std::shared_ptr<KaxCluster> const &cluster);
 
   void init_l1_position_storage(deferred_positions_t &storage);
   virtual bool has_deferred_element_been_processed(deferred_l1_type_e type, int64_t position);
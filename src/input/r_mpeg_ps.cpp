@@ -80,6 +80,11 @@ mpeg_ps_reader_c::read_headers() {
       m_in = mm_multi_file_io_c::open_multi(m_ti.m_fname, false);
     }
 
+    // Searching for start codes is done byte by byte on the buffer
+    // directly.
+    m_buffered_in = mm_read_buffer_io_c::wrap(m_in);
+    m_in          = m_buffered_in;
+
     m_size          = m_in->get_size();
     uint32_t header = m_in->read_uint32_be();
     bool done       = m_in->eof();
@@ -1059,45 +1064,55 @@ mpeg_ps_reader_c::found_new_stream(mpeg_ps_id_t id) {
 bool
 mpeg_ps_reader_c::find_next_packet(mpeg_ps_id_t &id,
                                    int64_t max_file_pos) {
+  auto &in = *m_buffered_in;
+
   try {
     uint32_t header;
 
-    header = m_in->read_uint32_be();
+    if (!in.try_read_uint32_be(header))
+      return false;
+
     while (1) {
       uint8_t byte;
 
-      if ((-1 != max_file_pos) && (m_in->getFilePointer() > static_cast<size_t>(max_file_pos)))
+      if ((-1 != max_file_pos) && (in.getFilePointer() > static_cast<size_t>(max_file_pos)))
         return false;
 
       switch (header) {
         case MPEGVIDEO_PACKET_START_CODE:
           if (-1 == version) {
-            byte = m_in->read_uint8();
-            if ((byte & 0xc0) != 0)
+            if (!in.cursor_ensure(1))
+              return false;
+
+            if ((in.cursor_data()[0] & 0xc0) != 0)
               version = 2;      // MPEG-2 PS
             else
               version = 1;
-            m_in->skip(-1);
           }
 
-          m_in->skip(2 * 4);   // pack header
+          if (!in.try_skip(2 * 4))   // pack header
+            return false;
+
           if (2 == version) {
-            m_in->skip(1);
-            byte = m_in->read_uint8() & 0x07;
-            m_in->skip(byte);  // stuffing bytes
+            if (!in.try_skip(1) || !in.try_read_uint8(byte) || !in.try_skip(byte & 0x07)) // stuffing bytes
+              return false;
           }
-          header = m_in->read_uint32_be();
+
+          if (!in.try_read_uint32_be(header))
+            return false;
           break;
 
         case MPEGVIDEO_SYSTEM_HEADER_START_CODE:
-          m_in->skip(2 * 4);   // system header
-          byte = m_in->read_uint8();
+          if (!in.try_skip(2 * 4) || !in.try_read_uint8(byte)) // system header
+            return false;
+
           while ((byte & 0x80) == 0x80) {
-            m_in->skip(2);     // P-STD info
-            byte = m_in->read_uint8();
+            if (!in.try_skip(2) || !in.try_read_uint8(byte))  // P-STD info
+              return false;
           }
-          m_in->skip(-1);
-          header = m_in->read_uint32_be();
+
+          if (!in.try_skip(-1) || !in.try_read_uint32_be(header))
+            return false;
           break;
 
         case MPEGVIDEO_MPEG_PROGRAM_END_CODE:
@@ -1131,38 +1146,46 @@ mpeg_ps_reader_c::find_next_packet(mpeg_ps_id_t &id,
 bool
 mpeg_ps_reader_c::find_next_packet_for_id(mpeg_ps_id_t id,
                                           int64_t max_file_pos) {
-  try {
-    mpeg_ps_id_t new_id;
-    while (find_next_packet(new_id, max_file_pos)) {
-      if (id.id == new_id.id)
-        return true;
-      m_in->skip(m_in->read_uint16_be());
-    }
-  } catch(...) {
+  mpeg_ps_id_t new_id;
+  while (find_next_packet(new_id, max_file_pos)) {
+    if (id.id == new_id.id)
+      return true;
+
+    uint16_t length;
+    if (!m_buffered_in->try_read_uint16_be(length) || !m_buffered_in->try_skip(length))
+      break;
   }
+
   return false;
 }
 
 bool
 mpeg_ps_reader_c::resync_stream(uint32_t &header) {
-  mxverb(2, boost::format("MPEG PS: synchronisation lost at %1%; looking for start code\n") % m_in->getFilePointer());
+  auto &in = *m_buffered_in;
 
-  try {
-    while (1) {
-      header <<= 8;
-      header  |= m_in->read_uint8();
-      if (mpeg_is_start_code(header))
-        break;
-    }
+  mxverb(2, boost::format("MPEG PS: synchronisation lost at %1%; looking for start code\n") % in.getFilePointer());
 
-    mxverb(2, boost::format("resync succeeded at %1%, header 0x%|2$08x|\n") % (m_in->getFilePointer() - 4) % header);
+  while (in.cursor_ensure(1)) {
+    auto data      = in.cursor_data();
+    auto available = in.cursor_available();
 
-    return true;
+    for (auto idx = 0u; idx < available; ++idx) {
+      header = (header << 8) | data[idx];
+      if (!mpeg_is_start_code(header))
+        continue;
 
-  } catch (...) {
-    mxverb(2, "resync failed: exception caught\n");
-    return false;
+      in.cursor_advance(idx + 1);
+
+      mxverb(2, boost::format("resync succeeded at %1%, header 0x%|2$08x|\n") % (in.getFilePointer() - 4) % header);
+
+      return true;
+    }
+
+    in.cursor_advance(available);
   }
+
+  mxverb(2, "resync failed: end of file reached\n");
+  return false;
 }
 
 void
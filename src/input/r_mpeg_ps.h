@@ -21,6 +21,7 @@
 #include "common/debugging.h"
 #include "common/dts.h"
 #include "common/mm_multi_file_io.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/mpeg1_2.h"
 #include "merge/packet_extensions.h"
 #include "merge/generic_reader.h"
@@ -192,6 +193,8 @@ operator <(mpeg_ps_track_ptr const &a,
 
 class mpeg_ps_reader_c: public generic_reader_c {
 private:
+  mm_read_buffer_io_cptr m_buffered_in;
+
   int64_t global_timecode_offset;
 
   std::map<int, int> id2idx;
@@ -88,7 +88,7 @@ mpeg_ts_track_c::send_to_packetizer() {
 
   if (use_packet) {
     auto bytes_to_skip = std::min<size_t>(pes_payload->get_size(), skip_packet_data_bytes);
-    process(std::make_shared<packet_t>(memory_c::clone(pes_payload->get_buffer() + bytes_to_skip, pes_payload->get_size() - bytes_to_skip), timecode_to_use.to_ns(-1)));
+    process(memory_pool_c::make_shared<packet_t>(memory_c::clone(pes_payload->get_buffer() + bytes_to_skip, pes_payload->get_size() - bytes_to_skip), timecode_to_use.to_ns(-1)));
   }
 
   pes_payload->remove(pes_payload->get_size());
@@ -650,7 +650,11 @@ mpeg_ts_reader_c::mpeg_ts_reader_c(const track_info_c &ti,
 void
 mpeg_ts_reader_c::read_headers() {
   try {
-    size_t size_to_probe   = std::min(m_size, static_cast<uint64_t>(TS_PIDS_DETECT_SIZE));
+    m_buffered_in = mm_read_buffer_io_c::wrap(m_in);
+    m_in          = m_buffered_in;
+
+    // The size of streams read from pipes is unknown.
+    size_t size_to_probe   = m_size ? std::min(m_size, static_cast<uint64_t>(TS_PIDS_DETECT_SIZE)) : TS_PIDS_DETECT_SIZE;
 
     m_detected_packet_size = detect_packet_size(m_in.get(), size_to_probe);
     m_in->setFilePointer(0);
@@ -664,7 +668,7 @@ mpeg_ts_reader_c::read_headers() {
     unsigned char buf[TS_MAX_PACKET_SIZE]; // maximum TS packet size + 1
 
     while (true) {
-      if (m_in->read(buf, m_detected_packet_size) != static_cast<unsigned int>(m_detected_packet_size))
+      if (!read_packet(buf))
         break;
 
       if (buf[0] != 0x47) {
@@ -1575,7 +1579,7 @@ mpeg_ts_reader_c::finish() {
   for (auto &track : tracks)
     if ((-1 != track->ptzr) && (0 < track->pes_payload->get_size())) {
       auto bytes_to_skip = std::min<size_t>(track->pes_payload->get_size(), track->skip_packet_data_bytes);
-      track->process(std::make_shared<packet_t>(memory_c::clone(track->pes_payload->get_buffer() + bytes_to_skip, track->pes_payload->get_size() - bytes_to_skip)));
+      track->process(memory_pool_c::make_shared<packet_t>(memory_c::clone(track->pes_payload->get_buffer() + bytes_to_skip, track->pes_payload->get_size() - bytes_to_skip)));
     }
 
   file_done = true;
@@ -1601,7 +1605,7 @@ mpeg_ts_reader_c::read(generic_packetizer_c *requested_ptzr,
     return flush_packetizers();
 
   while (true) {
-    if (m_in->read(buf, m_detected_packet_size) != static_cast<unsigned int>(m_detected_packet_size))
+    if (!read_packet(buf))
       return finish();
 
     if (buf[0] != 0x47) {
@@ -1691,31 +1695,32 @@ mpeg_ts_reader_c::parse_clip_info_file() {
 
 bool
 mpeg_ts_reader_c::resync(int64_t start_at) {
+  auto &in = *m_buffered_in;
+
   try {
     mxdebug_if(m_debug_resync, boost::format("mpeg_ts_reader_c::resync: Start resync for data from %1%\n") % start_at);
-    m_in->setFilePointer(start_at);
+    in.setFilePointer(start_at);
 
-    unsigned char buf[TS_MAX_PACKET_SIZE + 1];
+    // A packet start has been found if the byte after the packet is a
+    // sync byte, too.
+    while (in.cursor_ensure(m_detected_packet_size + 1)) {
+      auto data      = in.cursor_data();
+      auto available = in.cursor_available() - m_detected_packet_size;
+      auto sync      = static_cast<unsigned char const *>(memchr(data, 0x47, available));
 
-    while (!m_in->eof()) {
-      int64_t curr_pos = m_in->getFilePointer();
-      buf[0] = m_in->read_uint8();
-
-      if (0x47 != buf[0])
+      if (!sync) {
+        in.cursor_advance(available);
         continue;
+      }
 
-      if (m_in->read(&buf[1], m_detected_packet_size) != static_cast<unsigned int>(m_detected_packet_size))
-        return false;
+      in.cursor_advance(sync - data);
 
-      if (0x47 != buf[m_detected_packet_size]) {
-        m_in->setFilePointer(curr_pos + 1);
-        continue;
+      if (0x47 == sync[m_detected_packet_size]) {
+        mxdebug_if(m_debug_resync, boost::format("mpeg_ts_reader_c::resync: Re-established at %1%\n") % in.getFilePointer());
+        return true;
       }
 
-      mxdebug_if(m_debug_resync, boost::format("mpeg_ts_reader_c::resync: Re-established at %1%\n") % curr_pos);
-
-      m_in->setFilePointer(curr_pos);
-      return true;
+      in.cursor_advance(1);
     }
 
   } catch (...) {
@@ -1724,3 +1729,16 @@ mpeg_ts_reader_c::resync(int64_t start_at) {
 
   return false;
 }
+
+bool
+mpeg_ts_reader_c::read_packet(unsigned char *buf) {
+  auto &in = *m_buffered_in;
+
+  if (!in.cursor_ensure(m_detected_packet_size))
+    return false;
+
+  memcpy(buf, in.cursor_data(), m_detected_packet_size);
+  in.cursor_advance(m_detected_packet_size);
+
+  return true;
+}
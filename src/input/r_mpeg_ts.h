@@ -24,6 +24,7 @@
 #include "common/dts.h"
 #include "common/hevc.h"
 #include "common/mm_io.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/mpeg4_p10.h"
 #include "common/truehd.h"
 #include "input/packet_converter.h"
@@ -400,6 +401,8 @@ protected:
 
   std::vector<timecode_c> m_chapter_timecodes;
 
+  mm_read_buffer_io_cptr m_buffered_in;
+
   debugging_option_c m_dont_use_audio_pts, m_debug_resync, m_debug_pat_pmt, m_debug_headers, m_debug_packet, m_debug_aac, m_debug_timecode_wrapping, m_debug_clpi;
 
   unsigned int m_detected_packet_size, m_num_pat_crc_errors, m_num_pmt_crc_errors;
@@ -455,6 +458,7 @@ private:
   void process_chapter_entries();
 
   bool resync(int64_t start_at);
+  bool read_packet(unsigned char *buf);
 
   uint32_t calculate_crc(void const *buffer, size_t size) const;
 
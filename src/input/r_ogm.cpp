@@ -1117,7 +1117,7 @@ ogm_a_opus_demuxer_c::process_page(int64_t granulepos) {
     if ((4 <= op.bytes) && !memcmp(op.packet, "Opus", 4))
       continue;
 
-    auto packet                = std::make_shared<packet_t>(memory_c::clone(op.packet, op.bytes));
+    auto packet                = memory_pool_c::make_shared<packet_t>(memory_c::clone(op.packet, op.bytes));
     auto toc                   = mtx::opus::toc_t::decode(packet->data);
     m_calculated_end_timecode += toc.packet_duration;
 
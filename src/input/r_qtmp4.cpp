@@ -1380,24 +1380,31 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
 
   m_in->setFilePointer(index.file_pos);
 
-  int buffer_offset = 0;
   memory_cptr buffer;
+  auto chunk_read = false;
 
   if (   dmx->is_video()
       && !dmx->pos
       && dmx->codec.is(codec_c::type_e::V_MPEG4_P2)
       && dmx->esds_parsed
       && (dmx->esds.decoder_config)) {
-    buffer        = memory_c::alloc(index.size + dmx->esds.decoder_config->get_size());
-    buffer_offset = dmx->esds.decoder_config->get_size();
+    auto buffer_offset = dmx->esds.decoder_config->get_size();
+    buffer             = memory_c::alloc(index.size + buffer_offset);
 
-    memcpy(buffer->get_buffer(), dmx->esds.decoder_config->get_buffer(), dmx->esds.decoder_config->get_size());
+    memcpy(buffer->get_buffer(), dmx->esds.decoder_config->get_buffer(), buffer_offset);
+
+    chunk_read = m_in->read(buffer->get_buffer() + buffer_offset, index.size) == index.size;
 
   } else {
-    buffer = memory_c::alloc(index.size);
+    // Avoids copying the chunk if the file is mapped into memory.
+    try {
+      buffer     = m_in->read_shared(index.size);
+      chunk_read = true;
+    } catch (mtx::mm_io::end_of_file_x &) {
+    }
   }
 
-  if (m_in->read(buffer->get_buffer() + buffer_offset, index.size) != index.size) {
+  if (!chunk_read) {
     mxwarn(boost::format(Y("Quicktime/MP4 reader: Could not read chunk number %1%/%2% with size %3% from position %4%. Aborting.\n"))
            % dmx->pos % dmx->m_index.size() % index.size % index.file_pos);
     return flush_packetizers();
@@ -148,7 +148,7 @@ truehd_reader_c::read(generic_packetizer_c *,
   auto num_read = m_in->read(m_chunk->get_buffer(), read_len);
 
   if (0 < num_read)
-    m_converter.convert(std::make_shared<packet_t>(new memory_c(m_chunk->get_buffer(), num_read, false)));
+    m_converter.convert(memory_pool_c::make_shared<packet_t>(new memory_c(m_chunk->get_buffer(), num_read, false)));
 
   if (num_read == read_len)
     return FILE_STATUS_MOREDATA;
@@ -44,6 +44,153 @@ subtitles_c::process(generic_packetizer_c *p) {
 #define SRT_RE_TIMECODE_LINE "^" SRT_RE_TIMECODE "\\s*[\\-\\s]+>\\s*" SRT_RE_TIMECODE "\\s*"
 #define SRT_RE_COORDINATES   "([XY]\\d+:\\d+\\s*){4}\\s*$"
 
+namespace {
+
+struct srt_timecode_t {
+  int64_t neg;
+  int hours, minutes, seconds;
+  std::string fraction;
+
+  srt_timecode_t()
+    : neg{1}
+    , hours{}
+    , minutes{}
+    , seconds{}
+  {
+  }
+
+  int64_t
+  to_ns()
+    const {
+    auto rest = fraction.substr(0, 9);
+    while (rest.length() < 9)
+      rest += "0";
+
+    return ((static_cast<int64_t>(hours) * 60 * 60 + minutes * 60 + seconds) * 1000000000ll * neg) + atol(rest.c_str());
+  }
+};
+
+inline bool
+is_srt_space(char c) {
+  return (' ' == c) || (('\t' <= c) && ('\r' >= c));
+}
+
+inline bool
+is_srt_digit(char c) {
+  return ('0' <= c) && ('9' >= c);
+}
+
+bool
+is_srt_number(std::string const &s) {
+  return !s.empty() && std::all_of(s.begin(), s.end(), is_srt_digit);
+}
+
+/** \brief Matches a single timecode of \c SRT_RE_TIMECODE at \c p */
+bool
+match_srt_timecode(char const *&p,
+                   char const *end,
+                   srt_timecode_t &timecode) {
+  int *fields[3] = { &timecode.hours, &timecode.minutes, &timecode.seconds };
+
+  for (auto idx = 0; 4 > idx; ++idx) {
+    while ((p < end) && is_srt_space(*p))
+      ++p;
+
+    if ((p < end) && ('-' == *p)) {
+      timecode.neg *= -1;
+      ++p;
+    }
+
+    while ((p < end) && is_srt_space(*p))
+      ++p;
+
+    auto digits = p;
+    while ((p < end) && is_srt_digit(*p))
+      ++p;
+
+    if (digits == p)
+      return false;
+
+    if (3 == idx) {
+      timecode.fraction.assign(digits, p);
+      break;
+    }
+
+    // Leave values that might overflow to the regular expression.
+    if (9 < (p - digits))
+      return false;
+
+    auto &value = *fields[idx];
+    for (value = 0; digits < p; ++digits)
+      value = value * 10 + (*digits - '0');
+
+    // Hours, minutes and seconds are separated by colons; the
+    // fraction is introduced by a comma or a full stop. Anything else
+    // is left to the regular expression.
+    auto separator_ok = (p < end) && ((2 > idx) ? (':' == *p) : ((',' == *p) || ('.' == *p)));
+    if (!separator_ok)
+      return false;
+
+    ++p;
+  }
+
+  return true;
+}
+
+/** \brief Hand-written equivalent of \c SRT_RE_TIMECODE_LINE
+
+   Matching with the regular expression is rather slow. It is only used
+   if this function fails.
+*/
+bool
+match_srt_timecode_line(std::string const &line,
+                        srt_timecode_t &start,
+                        srt_timecode_t &end) {
+  auto p        = line.c_str();
+  auto line_end = p + line.length();
+
+  if (!match_srt_timecode(p, line_end, start))
+    return false;
+
+  auto arrow = p;
+  while ((p < line_end) && (is_srt_space(*p) || ('-' == *p)))
+    ++p;
+
+  if ((arrow == p) || (p == line_end) || ('>' != *p))
+    return false;
+
+  ++p;
+
+  return match_srt_timecode(p, line_end, end);
+}
+
+}
+
+/** \brief Matches a timecode line in the most common formats
+
+   This is much faster than matching \c SRT_RE_TIMECODE_LINE. It only
+   accepts colons between hours, minutes and seconds and a comma or a
+   full stop before the fraction. The regular expression has to be
+   used for lines it rejects.
+
+   \return \c true if the line matched. \c start and \c end are set to
+     the timecodes in nanoseconds in that case.
+*/
+bool
+srt_parser_c::match_timecode_line(std::string const &line,
+                                  int64_t &start,
+                                  int64_t &end) {
+  srt_timecode_t s_timecode, e_timecode;
+
+  if (!match_srt_timecode_line(line, s_timecode, e_timecode))
+    return false;
+
+  start = s_timecode.to_ns();
+  end   = e_timecode.to_ns();
+
+  return true;
+}
+
 bool
 srt_parser_c::probe(mm_text_io_c *io) {
   try {
@@ -87,7 +234,6 @@ srt_parser_c::srt_parser_c(mm_text_io_c *io,
 void
 srt_parser_c::parse() {
   boost::regex timecode_re(SRT_RE_TIMECODE_LINE, boost::regex::perl);
-  boost::regex number_re("^\\d+$", boost::regex::perl);
   boost::regex coordinates_re(SRT_RE_COORDINATES, boost::regex::perl);
 
   int64_t start                 = 0;
@@ -123,7 +269,7 @@ srt_parser_c::parse() {
     }
 
     if (STATE_INITIAL == state) {
-      if (!boost::regex_match(s, number_re)) {
+      if (!is_srt_number(s)) {
         mxwarn_tid(m_file_name, m_tid, boost::format(Y("Error in line %1%: expected subtitle number and found some text.\n")) % line_number);
         break;
       }
@@ -131,38 +277,45 @@ srt_parser_c::parse() {
       parse_number(s, subtitle_number);
 
     } else if (STATE_TIME == state) {
-      boost::smatch matches;
-      if (!boost::regex_search(s, matches, timecode_re)) {
-        mxwarn_tid(m_file_name, m_tid, boost::format(Y("Error in line %1%: expected a SRT timecode line but found something else. Aborting this file.\n")) % line_number);
-        break;
-      }
+      srt_timecode_t s_timecode, e_timecode;
 
-      int s_h = 0, s_min = 0, s_sec = 0, e_h = 0, e_min = 0, e_sec = 0;
+      if (!match_srt_timecode_line(s, s_timecode, e_timecode)) {
+        boost::smatch matches;
+        if (!boost::regex_search(s, matches, timecode_re)) {
+          mxwarn_tid(m_file_name, m_tid, boost::format(Y("Error in line %1%: expected a SRT timecode line but found something else. Aborting this file.\n")) % line_number);
+          break;
+        }
 
-      //        1         2       3      4        5     6             7    8
-      // "\\s*(-?)\\s*(\\d+):\\s(-?)*(\\d+):\\s*(-?)(\\d+)[,\\.]\\s*(-?)(\\d+)?"
+        //        1         2       3      4        5     6             7    8
+        // "\\s*(-?)\\s*(\\d+):\\s(-?)*(\\d+):\\s*(-?)(\\d+)[,\\.]\\s*(-?)(\\d+)?"
 
-      parse_number(matches[ 2].str(), s_h);
-      parse_number(matches[ 4].str(), s_min);
-      parse_number(matches[ 6].str(), s_sec);
-      parse_number(matches[10].str(), e_h);
-      parse_number(matches[12].str(), e_min);
-      parse_number(matches[14].str(), e_sec);
+        s_timecode = srt_timecode_t{};
+        e_timecode = srt_timecode_t{};
 
-      std::string s_rest = matches[ 8].str();
-      std::string e_rest = matches[16].str();
+        parse_number(matches[ 2].str(), s_timecode.hours);
+        parse_number(matches[ 4].str(), s_timecode.minutes);
+        parse_number(matches[ 6].str(), s_timecode.seconds);
+        parse_number(matches[10].str(), e_timecode.hours);
+        parse_number(matches[12].str(), e_timecode.minutes);
+        parse_number(matches[14].str(), e_timecode.seconds);
 
-      auto neg_calculator = [&](size_t const start_idx) -> int64_t {
-        int64_t neg = 1;
-        for (size_t idx = start_idx; idx <= (start_idx + 6); idx += 2)
-          neg *= matches[idx].str() == "-" ? -1 : 1;
-        return neg;
-      };
+        s_timecode.fraction = matches[ 8].str();
+        e_timecode.fraction = matches[16].str();
 
-      int64_t s_neg = neg_calculator(1);
-      int64_t e_neg = neg_calculator(9);
+        auto neg_calculator = [&](size_t const start_idx) -> int64_t {
+          int64_t neg = 1;
+          for (size_t idx = start_idx; idx <= (start_idx + 6); idx += 2)
+            neg *= matches[idx].str() == "-" ? -1 : 1;
+          return neg;
+        };
+
+        s_timecode.neg = neg_calculator(1);
+        e_timecode.neg = neg_calculator(9);
+      }
 
-      if (boost::regex_search(s, coordinates_re) && !m_coordinates_warning_shown) {
+      if (   !m_coordinates_warning_shown
+          && (std::string::npos != s.find_first_of("XY"))
+          && boost::regex_search(s, coordinates_re)) {
         mxwarn_tid(m_file_name, m_tid,
                    Y("This file contains coordinates in the timecode lines. "
                      "Such coordinates are not supported by the Matroska SRT subtitle format. "
@@ -177,23 +330,8 @@ srt_parser_c::parse() {
       }
 
       // Calculate the start and end time in ns precision for the following entry.
-      start  = (int64_t)s_h * 60 * 60 + s_min * 60 + s_sec;
-      end    = (int64_t)e_h * 60 * 60 + e_min * 60 + e_sec;
-
-      start *= 1000000000ll * s_neg;
-      end   *= 1000000000ll * e_neg;
-
-      while (s_rest.length() < 9)
-        s_rest += "0";
-      if (s_rest.length() > 9)
-        s_rest.erase(9);
-      start += atol(s_rest.c_str());
-
-      while (e_rest.length() < 9)
-        e_rest += "0";
-      if (e_rest.length() > 9)
-        e_rest.erase(9);
-      end += atol(e_rest.c_str());
+      start = s_timecode.to_ns();
+      end   = e_timecode.to_ns();
 
       if (0 > start) {
         mxwarn_tid(m_file_name, m_tid,
@@ -224,7 +362,7 @@ srt_parser_c::parse() {
         subtitles += "\n";
       subtitles += s;
 
-    } else if (boost::regex_match(s, number_re)) {
+    } else if (is_srt_number(s)) {
       state = STATE_TIME;
       parse_number(s, subtitle_number);
 
@@ -319,28 +457,33 @@ ssa_parser_c::parse() {
 
     bool add_to_global = true;
 
+    // All section headers start with '['. Only run the regular
+    // expressions for such lines.
+    auto first_char        = line.find_first_not_of(" \t\n\v\f\r");
+    auto is_section_header = (std::string::npos != first_char) && ('[' == line[first_char]);
+
     // A normal line. Let's see if this file is ASS and not SSA.
     if (!strcasecmp(line.c_str(), "ScriptType: v4.00+"))
       m_is_ass = true;
 
-    else if (boost::regex_search(line, sec_styles_ass_re)) {
+    else if (is_section_header && boost::regex_search(line, sec_styles_ass_re)) {
       m_is_ass = true;
       section  = SSA_SECTION_V4STYLES;
 
-    } else if (boost::regex_search(line, sec_styles_re))
+    } else if (is_section_header && boost::regex_search(line, sec_styles_re))
       section = SSA_SECTION_V4STYLES;
 
-    else if (boost::regex_search(line, sec_info_re))
+    else if (is_section_header && boost::regex_search(line, sec_info_re))
       section = SSA_SECTION_INFO;
 
-    else if (boost::regex_search(line, sec_events_re))
+    else if (is_section_header && boost::regex_search(line, sec_events_re))
       section = SSA_SECTION_EVENTS;
 
-    else if (boost::regex_search(line, sec_graphics_re)) {
+    else if (is_section_header && boost::regex_search(line, sec_graphics_re)) {
       section       = SSA_SECTION_GRAPHICS;
       add_to_global = false;
 
-    } else if (boost::regex_search(line, sec_fonts_re)) {
+    } else if (is_section_header && boost::regex_search(line, sec_fonts_re)) {
       section       = SSA_SECTION_FONTS;
       add_to_global = false;
 
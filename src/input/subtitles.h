@@ -86,6 +86,7 @@ public:
 
 public:
   static bool probe(mm_text_io_c *io);
+  static bool match_timecode_line(std::string const &line, int64_t &start, int64_t &end);
 };
 using srt_parser_cptr = std::shared_ptr<srt_parser_c>;
 
@@ -67,7 +67,7 @@ truehd_ac3_splitting_packet_converter_c::process_frames() {
       m_truehd_timecode = -1;
 
     } else if (frame->is_ac3() && m_ac3_ptzr) {
-      m_ac3_ptzr->process(std::make_shared<packet_t>(frame->m_data, m_ac3_timecode));
+      m_ac3_ptzr->process(memory_pool_c::make_shared<packet_t>(frame->m_data, m_ac3_timecode));
       m_ac3_timecode = -1;
     }
   }
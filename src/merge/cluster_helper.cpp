@@ -17,6 +17,7 @@
 #include "common/date_time.h"
 #include "common/ebml.h"
 #include "common/hacks.h"
+#include "common/instrumentation.h"
 #include "common/math.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
@@ -55,6 +56,7 @@ cluster_helper_c::impl_t::impl_t()
   , frame_field_number{1}
   , first_video_keyframe_seen{}
   , out{}
+  , render_counter{}
   , current_split_point(split_points.begin())
   , discarding{}
   , splitting_and_processed_fully{}
@@ -324,7 +326,8 @@ cluster_helper_c::get_cluster_content_size() {
 
 void
 cluster_helper_c::set_output(mm_io_c *out) {
-  m->out = out;
+  m->out            = out;
+  m->render_counter = out ? mtx::instrumentation::get_counter("render", out->get_file_name()) : nullptr;
 }
 
 void
@@ -391,6 +394,13 @@ cluster_helper_c::must_duration_be_set(render_groups_c *rg,
 
 int
 cluster_helper_c::render() {
+  // When streaming the headers cannot be changed once a cluster has
+  // been written after them.
+  if (g_streaming_output)
+    flush_held_back_headers();
+
+  mtx::instrumentation::scope_c scope{m->render_counter};
+
   std::vector<render_groups_cptr> render_groups;
   KaxCues cues;
   cues.SetGlobalTimecodeScale(g_timecode_scale);
@@ -559,6 +569,7 @@ cluster_helper_c::render() {
 
       m->cluster->Render(*m->out, cues);
       m->bytes_in_file += m->cluster->ElementSize();
+      scope.add_bytes(m->cluster->ElementSize());
 
       if (g_kax_sh_cues)
         g_kax_sh_cues->IndexThis(*m->cluster, *g_kax_segment);
@@ -0,0 +1,145 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   compression worker pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <unordered_map>
+
+#include "merge/compression_pool.h"
+#include "merge/output_control.h"
+
+std::unique_ptr<compression_pool_c> compression_pool_c::s_pool;
+
+compression_pool_c::compression_pool_c(unsigned int num_threads)
+  : m_quit{}
+  , m_debug{"compression_pool"}
+{
+  mxdebug_if(m_debug, boost::format("compression_pool: starting %1% workers\n") % num_threads);
+
+  for (auto worker_num = 0u; worker_num < std::max(num_threads, 1u); ++worker_num)
+    m_workers.emplace_back([this, worker_num]() { run(worker_num); });
+}
+
+compression_pool_c::~compression_pool_c() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_quit = true;
+  }
+
+  m_jobs_available.notify_all();
+
+  for (auto &worker : m_workers)
+    worker.join();
+}
+
+bool
+compression_pool_c::is_enabled() {
+  return 0 < g_compression_threads;
+}
+
+/** \brief Returns the pool, creating it on first use
+
+   The pool is started with \c g_compression_threads workers.
+*/
+compression_pool_c &
+compression_pool_c::get() {
+  if (!s_pool)
+    s_pool.reset(new compression_pool_c{g_compression_threads});
+
+  return *s_pool;
+}
+
+/** \brief Waits for all queued jobs and stops the workers
+
+   Must be called before the program exits so that the workers are not
+   left running during the destruction of global objects.
+*/
+void
+compression_pool_c::shutdown() {
+  s_pool.reset();
+}
+
+unsigned int
+compression_pool_c::get_num_threads()
+  const {
+  return m_workers.size();
+}
+
+/** \brief Queues a packet for compression
+
+   The packet's data and all of its data additions are replaced by
+   their compressed versions on one of the workers. The caller must
+   not touch the packet before the returned future is ready.
+
+   \return A future that becomes ready once the packet has been
+     compressed. If compression failed then \c get() rethrows the
+     exception.
+*/
+std::future<void>
+compression_pool_c::compress(compression_method_e method,
+                             packet_cptr const &packet) {
+  auto job    = std::unique_ptr<job_t>{new job_t};
+  job->method = method;
+  job->packet = packet;
+  auto future = job->done.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_jobs.push_back(std::move(job));
+  }
+
+  m_jobs_available.notify_one();
+
+  return future;
+}
+
+void
+compression_pool_c::run(unsigned int worker_num) {
+  std::unordered_map<int, compressor_ptr> compressors;
+  auto num_jobs = 0u;
+
+  while (true) {
+    std::unique_ptr<job_t> job;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_jobs_available.wait(lock, [this]() { return m_quit || !m_jobs.empty(); });
+
+      if (m_jobs.empty())
+        break;
+
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    try {
+      auto &compressor = compressors[job->method];
+      if (!compressor)
+        compressor = compressor_c::create(job->method);
+
+      auto &packet = *job->packet;
+      packet.data  = compressor->compress(packet.data);
+      for (auto &data_add : packet.data_adds)
+        data_add   = compressor->compress(data_add);
+
+      job->done.set_value();
+
+    } catch (...) {
+      job->done.set_exception(std::current_exception());
+    }
+
+    ++num_jobs;
+  }
+
+  mxdebug_if(m_debug, boost::format("compression_pool: worker %1% compressed %2% packets\n") % worker_num % num_jobs);
+}
@@ -0,0 +1,73 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the compression worker pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_MERGE_COMPRESSION_POOL_H
+#define MTX_MERGE_COMPRESSION_POOL_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "common/compression.h"
+#include "merge/packet.h"
+
+/** \brief Compresses packets on a fixed number of worker threads
+
+   Each worker keeps one compressor per compression method for its
+   whole lifetime so that expensive state like zlib's deflate stream
+   is set up once per worker instead of once per packet.
+
+   Jobs are processed in the order they are submitted, but they may
+   finish in any order. Callers have to keep track of the order
+   themselves, e.g. by waiting for the returned futures in submission
+   order.
+*/
+class compression_pool_c {
+protected:
+  struct job_t {
+    compression_method_e method;
+    packet_cptr packet;
+    std::promise<void> done;
+  };
+
+  std::deque<std::unique_ptr<job_t>> m_jobs;
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_jobs_available;
+  bool m_quit;
+
+  debugging_option_c m_debug;
+
+  static std::unique_ptr<compression_pool_c> s_pool;
+
+public:
+  compression_pool_c(unsigned int num_threads);
+  ~compression_pool_c();
+
+  std::future<void> compress(compression_method_e method, packet_cptr const &packet);
+  unsigned int get_num_threads() const;
+
+  static bool is_enabled();
+  static compression_pool_c &get();
+  static void shutdown();
+
+protected:
+  void run(unsigned int worker_num);
+};
+
+#endif  // MTX_MERGE_COMPRESSION_POOL_H
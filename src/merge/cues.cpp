@@ -15,8 +15,10 @@
 
 #include "common/debugging.h"
 #include "common/ebml.h"
+#include "common/endian.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
+#include "common/instrumentation.h"
 #include "common/math.h"
 #include "merge/cluster_helper.h"
 #include "merge/cues.h"
@@ -24,8 +26,87 @@
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
 
+namespace {
+
+// Size of the buffer the serialized cue points are collected in
+// before they're written.
+std::size_t const s_write_buffer_size = 1024 * 1024;
+
+// Upper bound for the size of a single serialized cue point: the heads
+// of two master and seven unsigned integer elements plus the values
+// of the latter.
+std::size_t const s_max_point_size    = 9 * (4 + 8) + 7 * 8;
+
+uint64_t
+calculate_head_size(EbmlId const &id,
+                    uint64_t content_size) {
+  return EBML_ID_LENGTH(id) + CodedSizeLength(content_size, 0, true);
+}
+
+unsigned char *
+put_ebml_head(unsigned char *dst,
+              EbmlId const &id,
+              uint64_t content_size) {
+  // Code the size with the same length libebml would use.
+  auto id_length   = EBML_ID_LENGTH(id);
+  auto size_length = CodedSizeLength(content_size, 0, true);
+
+  put_uint_be(dst, EBML_ID_VALUE(id), id_length);
+  CodedValueLength(content_size, size_length, dst + id_length);
+
+  return dst + id_length + size_length;
+}
+
+template<typename T>
+void
+reorder_vector(std::vector<T> &values,
+               std::vector<std::size_t> const &order) {
+  auto reordered = std::vector<T>{};
+  reordered.reserve(values.size());
+
+  for (auto idx : order)
+    reordered.push_back(values[idx]);
+
+  values.swap(reordered);
+}
+
+}
+
 cues_cptr cues_c::s_cues;
 
+void
+cue_points_t::add(uint64_t timecode,
+                  uint64_t cluster_position,
+                  uint32_t track_num,
+                  uint64_t block_number) {
+  m_timecodes.push_back(timecode);
+  m_durations.push_back(0);
+  m_cluster_positions.push_back(cluster_position);
+  m_block_numbers.push_back(block_number);
+  m_track_nums.push_back(track_num);
+  m_relative_positions.push_back(0);
+}
+
+void
+cue_points_t::clear() {
+  m_timecodes.clear();
+  m_durations.clear();
+  m_cluster_positions.clear();
+  m_block_numbers.clear();
+  m_track_nums.clear();
+  m_relative_positions.clear();
+}
+
+void
+cue_points_t::reorder(std::vector<std::size_t> const &order) {
+  reorder_vector(m_timecodes,          order);
+  reorder_vector(m_durations,          order);
+  reorder_vector(m_cluster_positions,  order);
+  reorder_vector(m_block_numbers,      order);
+  reorder_vector(m_track_nums,         order);
+  reorder_vector(m_relative_positions, order);
+}
+
 cues_c::cues_c()
   : m_num_cue_points_postprocessed{}
   , m_no_cue_duration{hack_engaged(ENGAGE_NO_CUE_DURATION)}
@@ -40,7 +121,7 @@ cues_c::set_duration_for_id_timecode(uint64_t id,
                                      uint64_t timecode,
                                      uint64_t duration) {
   if (!m_no_cue_duration)
-    m_id_timecode_duration_multimap.insert({ id_timecode_t{id, timecode}, duration });
+    m_id_timecode_durations.push_back({ id_timecode_t{id, timecode}, duration });
 }
 
 void
@@ -64,7 +145,7 @@ cues_c::add(KaxCuePoint &point) {
     uint64_t track_num = FindChildValue<KaxCueTrack>(*positions);
     assert(track_num <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
 
-    m_points.push_back({ timecode, 0, FindChildValue<KaxCueClusterPosition>(*positions), static_cast<uint32_t>(track_num), 0 });
+    m_points.add(timecode, FindChildValue<KaxCueClusterPosition>(*positions), static_cast<uint32_t>(track_num), FindChildValue<KaxCueBlockNumber>(*positions));
 
     uint64_t codec_state_position = FindChildValue<KaxCueCodecState>(*positions);
     if (codec_state_position)
@@ -78,9 +159,10 @@ cues_c::write(mm_io_c &out,
   if (!m_points.size() || !g_cue_writing_requested)
     return;
 
-  // auto start = mtx::sys::get_current_time_millis();
+  mtx::instrumentation::scope_c scope{mtx::instrumentation::get_counter("cues", out.get_file_name())};
+  auto start_position = out.getFilePointer();
+
   sort();
-  // auto end_sort = mtx::sys::get_current_time_millis();
 
   // Need to write the (empty) cues element so that its position will
   // be set for indexing in g_kax_sh_main. Necessary because there's
@@ -100,62 +182,140 @@ cues_c::write(mm_io_c &out,
   auto total_size = calculate_total_size();
   write_ebml_element_head(out, EBML_ID(KaxCues), total_size);
 
-  for (auto &point : m_points) {
-    KaxCuePoint kc_point;
-
-    GetChild<KaxCueTime>(kc_point).SetValue(point.timecode / g_timecode_scale);
+  // Serialize the cue points directly instead of creating libebml
+  // elements for each of them.
+  auto buffer     = std::vector<unsigned char>(s_write_buffer_size + s_max_point_size);
+  auto buffer_end = &buffer[0];
+  auto num_points = m_points.size();
 
-    auto &positions = GetChild<KaxCueTrackPositions>(kc_point);
-    GetChild<KaxCueTrack>(positions).SetValue(point.track_num);
-    GetChild<KaxCueClusterPosition>(positions).SetValue(point.cluster_position);
+  for (auto idx = 0u; idx < num_points; ++idx) {
+    buffer_end = serialize_point(idx, buffer_end);
 
-    auto codec_state_position = m_codec_state_position_map.find({ point.track_num, point.timecode });
-    if (codec_state_position != m_codec_state_position_map.end())
-      GetChild<KaxCueCodecState>(positions).SetValue(codec_state_position->second);
+    if (static_cast<std::size_t>(buffer_end - &buffer[0]) >= s_write_buffer_size) {
+      out.write(&buffer[0], buffer_end - &buffer[0]);
+      buffer_end = &buffer[0];
+    }
+  }
 
-    if (point.relative_position)
-      GetChild<KaxCueRelativePosition>(positions).SetValue(point.relative_position);
+  if (buffer_end != &buffer[0])
+    out.write(&buffer[0], buffer_end - &buffer[0]);
 
-    if (point.duration)
-      GetChild<KaxCueDuration>(positions).SetValue(RND_TIMECODE_SCALE(point.duration) / g_timecode_scale);
-
-    kc_point.Render(out);
-  }
+  scope.add_bytes(out.getFilePointer() - start_position);
 
   m_points.clear();
   m_codec_state_position_map.clear();
   m_num_cue_points_postprocessed = 0;
+}
+
+unsigned char *
+cues_c::serialize_point(std::size_t idx,
+                        unsigned char *dst)
+  const {
+  auto put_uint = [](unsigned char *uint_dst, EbmlId const &id, uint64_t value) -> unsigned char * {
+    auto value_length = calculate_bytes_for_uint(value);
+    uint_dst          = put_ebml_head(uint_dst, id, value_length);
+    put_uint_be(uint_dst, value, value_length);
+
+    return uint_dst + value_length;
+  };
+
+  auto timecode  = m_points.m_timecodes[idx];
+  auto track_num = m_points.m_track_nums[idx];
 
-  // auto end_all = mtx::sys::get_current_time_millis();
-  // mxinfo(boost::format("dur sort %1% write %2% total %3%\n") % (end_sort - start) % (end_all - end_sort) % (end_all - start));
+  unsigned char positions[s_max_point_size];
+  auto positions_end = positions;
+
+  positions_end = put_uint(positions_end, EBML_ID(KaxCueTrack),           track_num);
+  positions_end = put_uint(positions_end, EBML_ID(KaxCueClusterPosition), m_points.m_cluster_positions[idx]);
+
+  auto codec_state_position = m_codec_state_position_map.find({ track_num, timecode });
+  if (codec_state_position != m_codec_state_position_map.end())
+    positions_end = put_uint(positions_end, EBML_ID(KaxCueCodecState), codec_state_position->second);
+
+  if (m_points.m_relative_positions[idx])
+    positions_end = put_uint(positions_end, EBML_ID(KaxCueRelativePosition), m_points.m_relative_positions[idx]);
+
+  if (m_points.m_durations[idx])
+    positions_end = put_uint(positions_end, EBML_ID(KaxCueDuration), RND_TIMECODE_SCALE(m_points.m_durations[idx]) / g_timecode_scale);
+
+  if (m_points.m_block_numbers[idx])
+    positions_end = put_uint(positions_end, EBML_ID(KaxCueBlockNumber), m_points.m_block_numbers[idx]);
+
+  auto positions_size = static_cast<uint64_t>(positions_end - positions);
+  auto cue_time       = timecode / g_timecode_scale;
+  auto point_size     = calculate_uint_size(EBML_ID(KaxCueTime), cue_time)
+                      + calculate_head_size(EBML_ID(KaxCueTrackPositions), positions_size) + positions_size;
+
+  dst = put_ebml_head(dst, EBML_ID(KaxCuePoint), point_size);
+  dst = put_uint(dst, EBML_ID(KaxCueTime), cue_time);
+  dst = put_ebml_head(dst, EBML_ID(KaxCueTrackPositions), positions_size);
+
+  memcpy(dst, positions, positions_size);
+
+  return dst + positions_size;
 }
 
 void
 cues_c::sort() {
-  brng::sort(m_points, [](cue_point_t const &a, cue_point_t const &b) -> bool {
-      if (a.timecode < b.timecode)
-        return true;
-      if (a.timecode > b.timecode)
-        return false;
+  auto &timecodes  = m_points.m_timecodes;
+  auto &track_nums = m_points.m_track_nums;
+  auto num_points  = m_points.size();
+  auto is_less     = [&timecodes, &track_nums](std::size_t a, std::size_t b) -> bool {
+    if (timecodes[a] < timecodes[b])
+      return true;
+    if (timecodes[a] > timecodes[b])
+      return false;
 
-      if (a.track_num < b.track_num)
-        return true;
+    return track_nums[a] < track_nums[b];
+  };
 
-      return false;
-    });
+  // The points are usually added in order already.
+  auto is_sorted = true;
+  for (auto idx = 1u; is_sorted && (idx < num_points); ++idx)
+    if (is_less(idx, idx - 1))
+      is_sorted = false;
+
+  if (is_sorted)
+    return;
+
+  auto order = std::vector<std::size_t>(num_points);
+  for (auto idx = 0u; idx < num_points; ++idx)
+    order[idx] = idx;
+
+  brng::sort(order, is_less);
+
+  m_points.reorder(order);
 }
 
-std::multimap<id_timecode_t, uint64_t>
+/** \brief Finds the nth value for a key in a vector sorted by key
+
+   \return An iterator to the value or \c values.end() if there are
+     less than \c nth values for the key. \c nth starts at 1.
+*/
+std::vector<id_timecode_value_t>::const_iterator
+cues_c::find_nth(std::vector<id_timecode_value_t> const &values,
+                 id_timecode_t const &key,
+                 std::size_t nth) {
+  auto itr = std::lower_bound(values.begin(), values.end(), key, [](id_timecode_value_t const &value, id_timecode_t const &cmp) { return value.first < cmp; });
+  auto end = values.end();
+
+  for (auto i = 1u; (i < nth) && (itr != end) && (itr->first == key); ++i)
+    ++itr;
+
+  return (itr != end) && (itr->first == key) ? itr : end;
+}
+
+std::vector<id_timecode_value_t>
 cues_c::calculate_block_positions(KaxCluster &cluster)
   const {
 
-  std::multimap<id_timecode_t, uint64_t> positions;
+  std::vector<id_timecode_value_t> positions;
 
   for (auto child : cluster) {
     auto simple_block = dynamic_cast<KaxSimpleBlock *>(child);
     if (simple_block) {
       simple_block->SetParent(cluster);
-      positions.insert({ id_timecode_t{ simple_block->TrackNum(), simple_block->GlobalTimecode()}, simple_block->GetElementPosition() });
+      positions.push_back({ id_timecode_t{ simple_block->TrackNum(), simple_block->GlobalTimecode()}, simple_block->GetElementPosition() });
       continue;
     }
 
@@ -168,9 +328,12 @@ cues_c::calculate_block_positions(KaxCluster &cluster)
       continue;
 
     block->SetParent(cluster);
-    positions.insert({ id_timecode_t{ block->TrackNum(), block->GlobalTimecode()}, block_group->GetElementPosition() });
+    positions.push_back({ id_timecode_t{ block->TrackNum(), block->GlobalTimecode()}, block_group->GetElementPosition() });
   }
 
+  // Blocks with the same track number and timecode keep their order.
+  std::stable_sort(positions.begin(), positions.end(), [](id_timecode_value_t const &a, id_timecode_value_t const &b) { return a.first < b.first; });
+
   return positions;
 }
 
@@ -186,69 +349,66 @@ cues_c::postprocess_cues(KaxCues &cues,
   auto block_positions        = calculate_block_positions(cluster);
   std::map<id_timecode_t, size_t> nblocks_processed; //# blocks processed so far with given track #/timecode
 
-  for (auto point = m_points.begin() + m_num_cue_points_postprocessed, end = m_points.end(); point != end; ++point) {
-    nblocks_processed[id_timecode_t{ point->track_num, point->timecode }]++;
+  // Durations for the same track number and timecode keep their order.
+  std::stable_sort(m_id_timecode_durations.begin(), m_id_timecode_durations.end(), [](id_timecode_value_t const &a, id_timecode_value_t const &b) { return a.first < b.first; });
+
+  for (auto idx = m_num_cue_points_postprocessed, num_points = m_points.size(); idx < num_points; ++idx) {
+    auto track_num     = m_points.m_track_nums[idx];
+    auto timecode      = m_points.m_timecodes[idx];
+    auto key           = id_timecode_t{ track_num, timecode };
+    auto num_processed = ++nblocks_processed[key];
 
     // Set CueRelativePosition for all cues.
     if (!m_no_cue_relative_position) {
-      auto pair          = block_positions.equal_range({ point->track_num, point->timecode });
-      auto position_itr  = pair.first;
-      auto pos_end       = pair.second;
-      auto num_processed = nblocks_processed[id_timecode_t{ point->track_num, point->timecode }];
-
-      for (auto i = 0u; ((i + 1) < num_processed) && (position_itr != pos_end); ++i)
-        position_itr++;
-
+      auto position_itr      = find_nth(block_positions, key, num_processed);
       auto relative_position = block_positions.end() != position_itr ? std::max(position_itr->second, cluster_data_start_pos) - cluster_data_start_pos : 0ull;
 
       assert(relative_position <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
 
-      point->relative_position = relative_position;
+      m_points.m_relative_positions[idx] = relative_position;
 
       mxdebug_if(m_debug_cue_relative_position,
                  boost::format("cue_relative_position: looking for <%1%:%2%>: cluster_data_start_pos %3% position %4%\n")
-                 % point->track_num % point->timecode % cluster_data_start_pos % relative_position);
+                 % track_num % timecode % cluster_data_start_pos % relative_position);
     }
 
     // Set CueDuration if the packetizer wants them.
     if (m_no_cue_duration)
       continue;
 
-    auto pair          = m_id_timecode_duration_multimap.equal_range({ point->track_num, point->timecode });
-    auto duration_itr  = pair.first;
-    auto dur_end       = pair.second;
-    auto num_processed = nblocks_processed[id_timecode_t{ point->track_num, point->timecode }];
-
-    for (auto i = 0u; ((i + 1) < num_processed) && (duration_itr != dur_end); ++i)
-      duration_itr++;
-
-    auto ptzr         = g_packetizers_by_track_num[point->track_num];
+    auto duration_itr = find_nth(m_id_timecode_durations, key, num_processed);
+    auto ptzr         = g_packetizers_by_track_num[track_num];
 
     if (!ptzr || !ptzr->wants_cue_duration())
       continue;
 
-    if (m_id_timecode_duration_multimap.end() != duration_itr)
-      point->duration = duration_itr->second;
+    if (m_id_timecode_durations.end() != duration_itr)
+      m_points.m_durations[idx] = duration_itr->second;
 
     mxdebug_if(m_debug_cue_duration,
                boost::format("cue_duration: looking for <%1%:%2%>: %3%\n")
-               % point->track_num % point->timecode % (duration_itr == m_id_timecode_duration_multimap.end() ? static_cast<int64_t>(-1) : duration_itr->second));
+               % track_num % timecode % (duration_itr == m_id_timecode_durations.end() ? static_cast<int64_t>(-1) : duration_itr->second));
   }
 
   m_num_cue_points_postprocessed = m_points.size();
 
-  m_id_timecode_duration_multimap.clear();
+  m_id_timecode_durations.clear();
 }
 
 uint64_t
 cues_c::calculate_total_size()
   const {
-  return boost::accumulate(m_points, 0ull, [this](uint64_t sum, cue_point_t const &point) { return sum + calculate_point_size(point); });
+  auto total_size = 0ull;
+  auto num_points = m_points.size();
+
+  for (auto idx = 0u; idx < num_points; ++idx)
+    total_size += calculate_point_size(idx);
+
+  return total_size;
 }
 
 uint64_t
-cues_c::calculate_bytes_for_uint(uint64_t value)
-  const {
+cues_c::calculate_bytes_for_uint(uint64_t value) {
   for (int idx = 1; 7 >= idx; ++idx)
     if (value < (1ull << (idx * 8)))
       return idx;
@@ -256,25 +416,37 @@ cues_c::calculate_bytes_for_uint(uint64_t value)
 }
 
 uint64_t
-cues_c::calculate_point_size(cue_point_t const &point)
+cues_c::calculate_uint_size(EbmlId const &id,
+                            uint64_t value) {
+  auto value_length = calculate_bytes_for_uint(value);
+  return calculate_head_size(id, value_length) + value_length;
+}
+
+uint64_t
+cues_c::calculate_point_size(std::size_t idx)
   const {
-  uint64_t point_size = EBML_ID_LENGTH(EBML_ID(KaxCuePoint))           + 1
-                      + EBML_ID_LENGTH(EBML_ID(KaxCuePoint))           + 1 + calculate_bytes_for_uint(point.timecode / g_timecode_scale)
-                      + EBML_ID_LENGTH(EBML_ID(KaxCueTrackPositions))  + 1
-                      + EBML_ID_LENGTH(EBML_ID(KaxCueTrack))           + 1 + calculate_bytes_for_uint(point.track_num)
-                      + EBML_ID_LENGTH(EBML_ID(KaxCueClusterPosition)) + 1 + calculate_bytes_for_uint(point.cluster_position);
+  auto timecode       = m_points.m_timecodes[idx];
+  auto track_num      = m_points.m_track_nums[idx];
+  auto positions_size = calculate_uint_size(EBML_ID(KaxCueTrack),           track_num)
+                      + calculate_uint_size(EBML_ID(KaxCueClusterPosition), m_points.m_cluster_positions[idx]);
 
-  auto codec_state_position = m_codec_state_position_map.find({ point.track_num, point.timecode });
+  auto codec_state_position = m_codec_state_position_map.find({ track_num, timecode });
   if (codec_state_position != m_codec_state_position_map.end())
-    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueCodecState)) + 1 + calculate_bytes_for_uint(codec_state_position->second);
+    positions_size += calculate_uint_size(EBML_ID(KaxCueCodecState), codec_state_position->second);
+
+  if (m_points.m_relative_positions[idx])
+    positions_size += calculate_uint_size(EBML_ID(KaxCueRelativePosition), m_points.m_relative_positions[idx]);
+
+  if (m_points.m_durations[idx])
+    positions_size += calculate_uint_size(EBML_ID(KaxCueDuration), RND_TIMECODE_SCALE(m_points.m_durations[idx]) / g_timecode_scale);
 
-  if (point.relative_position)
-    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueRelativePosition)) + 1 + calculate_bytes_for_uint(point.relative_position);
+  if (m_points.m_block_numbers[idx])
+    positions_size += calculate_uint_size(EBML_ID(KaxCueBlockNumber), m_points.m_block_numbers[idx]);
 
-  if (point.duration)
-    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueDuration)) + 1 + calculate_bytes_for_uint(RND_TIMECODE_SCALE(point.duration) / g_timecode_scale);
+  auto point_size = calculate_uint_size(EBML_ID(KaxCueTime), timecode / g_timecode_scale)
+                  + calculate_head_size(EBML_ID(KaxCueTrackPositions), positions_size) + positions_size;
 
-  return point_size;
+  return calculate_head_size(EBML_ID(KaxCuePoint), point_size) + point_size;
 }
 
 cues_c &
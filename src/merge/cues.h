@@ -22,11 +22,26 @@
 
 #include "common/mm_io.h"
 
-using id_timecode_t = std::pair<uint64_t, uint64_t>;
+using id_timecode_t       = std::pair<uint64_t, uint64_t>;
+using id_timecode_value_t = std::pair<id_timecode_t, uint64_t>;
 
-struct cue_point_t {
-  uint64_t timecode, duration, cluster_position;
-  uint32_t track_num, relative_position;
+/** \brief Storage for the cue points as a structure of arrays
+
+   The nth entry of each vector belongs to the nth cue point.
+   Timecodes and durations are stored in ns. A block number of 0
+   means that the cue point doesn't reference a specific block.
+*/
+struct cue_points_t {
+  std::vector<uint64_t> m_timecodes, m_durations, m_cluster_positions, m_block_numbers;
+  std::vector<uint32_t> m_track_nums, m_relative_positions;
+
+  std::size_t size() const {
+    return m_timecodes.size();
+  }
+
+  void add(uint64_t timecode, uint64_t cluster_position, uint32_t track_num, uint64_t block_number = 0);
+  void clear();
+  void reorder(std::vector<std::size_t> const &order);
 };
 
 class cues_c;
@@ -34,8 +49,8 @@ using cues_cptr = std::shared_ptr<cues_c>;
 
 class cues_c {
 protected:
-  std::vector<cue_point_t> m_points;
-  std::multimap<id_timecode_t, uint64_t> m_id_timecode_duration_multimap;
+  cue_points_t m_points;
+  std::vector<id_timecode_value_t> m_id_timecode_durations;
   std::map<id_timecode_t, uint64_t> m_codec_state_position_map;
 
   size_t m_num_cue_points_postprocessed;
@@ -59,10 +74,14 @@ public:
 
 protected:
   void sort();
-  std::multimap<id_timecode_t, uint64_t> calculate_block_positions(KaxCluster &cluster) const;
+  std::vector<id_timecode_value_t> calculate_block_positions(KaxCluster &cluster) const;
   uint64_t calculate_total_size() const;
-  uint64_t calculate_point_size(cue_point_t const &point) const;
-  uint64_t calculate_bytes_for_uint(uint64_t value) const;
+  uint64_t calculate_point_size(std::size_t idx) const;
+  unsigned char *serialize_point(std::size_t idx, unsigned char *dst) const;
+
+  static uint64_t calculate_bytes_for_uint(uint64_t value);
+  static uint64_t calculate_uint_size(EbmlId const &id, uint64_t value);
+  static std::vector<id_timecode_value_t>::const_iterator find_nth(std::vector<id_timecode_value_t> const &values, id_timecode_t const &key, std::size_t nth);
 };
 
 #endif  // MTX_MERGE_CUES_H
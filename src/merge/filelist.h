@@ -17,6 +17,7 @@
 #include "common/common_pch.h"
 
 #include "common/file_types.h"
+#include "common/mm_stream_io.h"
 #include "merge/output_control.h"
 
 class generic_reader_c;
@@ -51,6 +52,8 @@ struct filelist_t {
   size_t playlist_index{}, playlist_previous_filelist_id{};
   mm_mpls_multi_file_io_cptr playlist_mpls_in;
 
+  mm_stream_io_cptr stream_in;
+
   timecode_c restricted_timecode_min, restricted_timecode_max;
 
   filelist_t()
@@ -31,10 +31,12 @@
 #include "common/strings/formatting.h"
 #include "common/unique_numbers.h"
 #include "common/xml/ebml_tags_converter.h"
+#include "merge/compression_pool.h"
 #include "merge/filelist.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
+#include "merge/reader_thread.h"
 #include "merge/webm.h"
 
 #define TRACK_TYPE_TO_DEFTRACK_TYPE(track_type)      \
@@ -89,6 +91,7 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
   , m_has_been_flushed{}
   , m_prevent_lacing{}
   , m_connected_successor{}
+  , m_process_counter{}
   , m_ti{ti}
   , m_reader{reader}
   , m_connected_to{}
@@ -251,6 +254,8 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
   // timecodes for the given FPS.
   if (!m_timecode_factory && (-1 != m_htrack_default_duration))
     m_timecode_factory = timecode_factory_c::create_fps_factory(m_htrack_default_duration, m_ti.m_tcsync);
+
+  m_process_counter = mtx::instrumentation::get_counter("process", (boost::format("%1% track %2%") % m_ti.m_fname % m_ti.m_id).str());
 }
 
 generic_packetizer_c::~generic_packetizer_c() {
@@ -392,6 +397,26 @@ generic_packetizer_c::get_track_default_duration()
   return m_htrack_default_duration;
 }
 
+/** \brief Estimates by how much this track's header may grow later on
+
+   Some packetizers only learn some of their header values from the
+   track's content, e.g. the codec private data of AVC or MPEG-1/2
+   video. They call \c rerender_track_headers() once they know
+   them. Enough space is reserved after the track headers so that they
+   can be updated in place.
+*/
+int64_t
+generic_packetizer_c::get_header_growth_estimate()
+  const {
+  if (track_video == m_htrack_type)
+    return m_hcodec_private ? 256 : 2048;
+
+  if (track_audio == m_htrack_type)
+    return 128;
+
+  return 64;
+}
+
 void
 generic_packetizer_c::set_track_forced_flag(bool forced_track) {
   m_ti.m_forced_track = forced_track;
@@ -797,6 +822,19 @@ generic_packetizer_c::add_packet(packet_cptr pack) {
       && (pack->data_adds.size()  > static_cast<size_t>(m_htrack_max_add_block_ids)))
     pack->data_adds.resize(m_htrack_max_add_block_ids);
 
+  if (m_compressor && (COMPRESSION_ZLIB == m_hcompression) && compression_pool_c::is_enabled()) {
+    // The reader may re-use its buffers as soon as this function
+    // returns.
+    pack->data->grab();
+    for (auto &data_add : pack->data_adds)
+      data_add->grab();
+
+    m_pending_compressions.emplace_back(pack, compression_pool_c::get().compress(m_hcompression, pack));
+    process_pending_compressions(false);
+
+    return;
+  }
+
   if (m_compressor) {
     try {
       pack->data = m_compressor->compress(pack->data);
@@ -809,6 +847,41 @@ generic_packetizer_c::add_packet(packet_cptr pack) {
     }
   }
 
+  add_compressed_packet(pack);
+}
+
+/** \brief Passes packets on whose compression has finished
+
+   Packets are passed on in the order they were added in. Only
+   finished packets at the front of the queue are passed on unless \c
+   wait_for_all is set or the queue has grown too long. In that case
+   this function waits for the pool.
+*/
+void
+generic_packetizer_c::process_pending_compressions(bool wait_for_all) {
+  while (!m_pending_compressions.empty()) {
+    auto &front    = m_pending_compressions.front();
+    auto must_wait = wait_for_all || (m_pending_compressions.size() > (4 * compression_pool_c::get().get_num_threads()));
+
+    if (!must_wait && (std::future_status::ready != front.second.wait_for(std::chrono::seconds{0})))
+      break;
+
+    try {
+      front.second.get();
+
+    } catch (mtx::compression_x &e) {
+      mxerror_tid(m_ti.m_fname, m_ti.m_id, boost::format(Y("Compression failed: %1%\n")) % e.error());
+    }
+
+    auto pack = front.first;
+    m_pending_compressions.pop_front();
+
+    add_compressed_packet(pack);
+  }
+}
+
+void
+generic_packetizer_c::add_compressed_packet(packet_cptr const &pack) {
   pack->data->grab();
   for (auto &data_add : pack->data_adds)
     data_add->grab();
@@ -1108,9 +1181,44 @@ generic_packetizer_c::contains_gap() {
   return m_timecode_factory ? m_timecode_factory->contains_gap() : false;
 }
 
+int
+generic_packetizer_c::process(packet_cptr packet) {
+  // Packets from readers running on worker threads are processed on
+  // the main thread later on.
+  if (reader_thread_c::queue_packet(*this, packet))
+    return FILE_STATUS_MOREDATA;
+
+  mtx::instrumentation::scope_c scope{m_process_counter};
+  scope.add_bytes(packet->data ? packet->data->get_size() : 0);
+
+  if (packet->data && packet->data->is_read_only() && !accepts_read_only_data())
+    packet->data->make_writable();
+
+  return process_impl(packet);
+}
+
+/** \brief Whether or not \c process_impl() leaves the packet data alone
+
+   Readers may hand over data that must not be modified, e.g. data
+   referring to a file mapped into memory. Such data is copied before
+   it is passed to packetizers that may modify it in place.
+*/
+bool
+generic_packetizer_c::accepts_read_only_data()
+  const {
+  return false;
+}
+
 void
 generic_packetizer_c::flush() {
+  if (reader_thread_c::queue_flush(*this))
+    return;
+
+  mtx::instrumentation::scope_c scope{m_process_counter};
+
+  process_pending_compressions(true);
   flush_impl();
+  process_pending_compressions(true);
 
   m_has_been_flushed = true;
   apply_factory();
@@ -1192,7 +1300,18 @@ generic_packetizer_c::create_track_number() {
 
 file_status_e
 generic_packetizer_c::read() {
-  return m_reader->read(this);
+  mtx::instrumentation::scope_c scope{m_reader->m_read_counter};
+
+  if (m_reader->m_reader_thread)
+    return m_reader->m_reader_thread->read();
+
+  auto position = m_reader->m_read_counter ? static_cast<int64_t>(m_reader->m_in->getFilePointer()) : 0;
+  auto status   = m_reader->read(this);
+
+  if (m_reader->m_read_counter)
+    scope.add_bytes(static_cast<int64_t>(m_reader->m_in->getFilePointer()) - position);
+
+  return status;
 }
 
 void
@@ -17,7 +17,9 @@
 #include "common/common_pch.h"
 
 #include <deque>
+#include <future>
 
+#include "common/instrumentation.h"
 #include "common/option_with_source.h"
 #include "common/timecode.h"
 #include "common/translation.h"
@@ -48,6 +50,7 @@ class generic_packetizer_c {
 protected:
   int m_num_packets;
   std::deque<packet_cptr> m_packet_queue, m_deferred_packets;
+  std::deque<std::pair<packet_cptr, std::future<void>>> m_pending_compressions;
   int m_next_packet_wo_assigned_timecode;
 
   int64_t m_free_refs, m_next_free_refs, m_enqueued_bytes;
@@ -86,6 +89,8 @@ protected:
   bool m_prevent_lacing;
   generic_packetizer_c *m_connected_successor;
 
+  mtx::instrumentation::counter_c *m_process_counter;
+
 protected:                      // static
   static int ms_track_number;
 
@@ -106,7 +111,7 @@ public:
   virtual file_status_e read();
 
   inline void add_packet(packet_t *packet) {
-    add_packet(packet_cptr(packet));
+    add_packet(memory_pool_c::own(packet));
   }
   virtual void add_packet(packet_cptr packet);
   virtual void add_packet2(packet_cptr pack);
@@ -135,9 +140,10 @@ public:
   virtual void set_headers();
   virtual void fix_headers();
   inline int process(packet_t *packet) {
-    return process(packet_cptr(packet));
+    return process(memory_pool_c::own(packet));
   }
-  virtual int process(packet_cptr packet) = 0;
+  int process(packet_cptr packet);
+  virtual bool accepts_read_only_data() const;
 
   virtual void set_cue_creation(cue_strategy_e create_cue_data) {
     m_ti.m_cues = create_cue_data;
@@ -190,6 +196,7 @@ public:
   virtual void set_track_default_duration(int64_t default_duration);
   virtual void set_track_max_additionals(int max_add_block_ids);
   virtual int64_t get_track_default_duration() const;
+  virtual int64_t get_header_growth_estimate() const;
   virtual void set_track_forced_flag(bool forced_track);
   virtual void set_track_enabled_flag(bool enabled_track);
   virtual void set_track_seek_pre_roll(timecode_c const &seek_pre_roll);
@@ -259,9 +266,13 @@ public:
   virtual void after_file_created();
 
 protected:
+  virtual int process_impl(packet_cptr packet) = 0;
   virtual void flush_impl() {
   };
 
+  void add_compressed_packet(packet_cptr const &pack);
+  void process_pending_compressions(bool wait_for_all);
+
   virtual void show_experimental_status_version(std::string const &codec_id);
 };
 
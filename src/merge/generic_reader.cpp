@@ -13,11 +13,13 @@
 
 #include "common/common_pch.h"
 
+#include "common/strings/editing.h"
 #include "common/strings/formatting.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/input_x.h"
 #include "merge/output_control.h"
+#include "merge/reader_thread.h"
 
 template<typename T>
 void
@@ -31,7 +33,7 @@ generic_reader_c::generic_reader_c(const track_info_c &ti,
                                    const mm_io_cptr &in)
   : m_ti{ti}
   , m_in{in}
-  , m_size{static_cast<uint64_t>(in->get_size())}
+  , m_size{static_cast<uint64_t>(std::max<int64_t>(in->get_size(), 0))}
   , m_ptzr_first_packet{}
   , m_max_timecode_seen{}
   , m_appending{}
@@ -39,6 +41,7 @@ generic_reader_c::generic_reader_c(const track_info_c &ti,
   , m_num_audio_tracks{}
   , m_num_subtitle_tracks{}
   , m_reference_timecode_tolerance{}
+  , m_read_counter{mtx::instrumentation::get_counter("read", ti.m_fname)}
 {
   add_all_requested_track_ids(*this, m_ti.m_atracks.m_items);
   add_all_requested_track_ids(*this, m_ti.m_vtracks.m_items);
@@ -65,6 +68,8 @@ generic_reader_c::generic_reader_c(const track_info_c &ti,
 generic_reader_c::~generic_reader_c() {
   size_t i;
 
+  m_reader_thread.reset();
+
   for (i = 0; i < m_reader_packetizers.size(); i++)
     delete m_reader_packetizers[i];
 }
@@ -88,6 +93,20 @@ generic_reader_c::get_timecode_restriction_max()
   return m_restricted_timecodes_max;
 }
 
+/** \brief Whether or not \c read() may be run on a worker thread
+
+   This is only the case if \c read() doesn't use its packetizers in
+   any other way than passing packets to them via
+   \c generic_packetizer_c::process() and flushing them, and if it
+   always reads for all of them no matter which packetizer it is
+   called for. See \c reader_thread_c.
+*/
+bool
+generic_reader_c::supports_threaded_reading()
+  const {
+  return false;
+}
+
 void
 generic_reader_c::read_all() {
   for (auto &packetizer : m_reader_packetizers)
@@ -313,6 +332,11 @@ generic_reader_c::id_result_tags(int64_t track_id,
 
 void
 generic_reader_c::display_identification_results() {
+  if (g_identify_json) {
+    display_identification_results_as_json();
+    return;
+  }
+
   std::string format_file, format_track, format_attachment, format_att_description, format_att_file_name;
 
   if (g_identify_for_mmg) {
@@ -385,6 +409,40 @@ generic_reader_c::display_identification_results() {
   }
 }
 
+/** \brief Outputs the identification results as a single JSON record
+
+   All verbose information is always included. Strings are output
+   untranslated.
+*/
+void
+generic_reader_c::display_identification_results_as_json() {
+  auto quote = [](std::string const &s) { return (boost::format("\"%1%\"") % escape_json(s)).str(); };
+
+  std::vector<std::string> tracks, attachments, chapters, global_tags, track_tags;
+
+  for (auto &result : m_id_results_tracks)
+    tracks.push_back((boost::format("{\"id\":%1%,\"type\":%2%,\"codec\":%3%,\"properties\":%4%}")
+                      % result.id % quote(result.type) % quote(result.info) % id_result_properties_to_json(result.verbose_info)).str());
+
+  for (auto &result : m_id_results_attachments)
+    attachments.push_back((boost::format("{\"id\":%1%,\"content_type\":%2%,\"size\":%3%,\"description\":%4%,\"file_name\":%5%,\"properties\":%6%}")
+                           % result.id % quote(result.type) % result.size % quote(result.description) % quote(result.info) % id_result_properties_to_json(result.verbose_info)).str());
+
+  for (auto &result : m_id_results_chapters)
+    chapters.push_back((boost::format("{\"num_entries\":%1%}") % result.size).str());
+
+  for (auto &result : m_id_results_tags)
+    if (ID_RESULT_GLOBAL_TAGS_ID == result.id)
+      global_tags.push_back((boost::format("{\"num_entries\":%1%}") % result.size).str());
+    else
+      track_tags.push_back((boost::format("{\"track_id\":%1%,\"num_entries\":%2%}") % result.id % result.size).str());
+
+  id_result_output_json((boost::format("{\"file_name\":%1%,\"container\":{\"recognized\":true,\"supported\":true,\"type\":%2%,\"properties\":%3%},"
+                                       "\"tracks\":[%4%],\"attachments\":[%5%],\"chapters\":[%6%],\"global_tags\":[%7%],\"track_tags\":[%8%],\"errors\":[]}")
+                         % quote(m_ti.m_fname) % quote(get_format_name().get_untranslated()) % id_result_properties_to_json(m_id_results_container.verbose_info)
+                         % join(",", tracks) % join(",", attachments) % join(",", chapters) % join(",", global_tags) % join(",", track_tags)).str());
+}
+
 std::string
 generic_reader_c::id_escape_string(const std::string &s) {
   return g_identify_for_mmg ? escape(s) : s;
@@ -407,8 +465,21 @@ generic_reader_c::add_available_track_id_range(int64_t start,
     add_available_track_id(id);
 }
 
+/** \brief Returns how much of the file has been read in percent
+
+   The size of streams read from pipes is only known once their end
+   has been reached. Until then the progress is reported as 0.
+*/
 int
 generic_reader_c::get_progress() {
+  if (!m_size) {
+    auto size = m_in->get_size();
+    if (0 >= size)
+      return 0;
+
+    m_size = size;
+  }
+
   return 100 * m_in->getFilePointer() / m_size;
 }
 
@@ -19,6 +19,7 @@
 #include <boost/optional.hpp>
 
 #include "common/chapters/chapters.h"
+#include "common/instrumentation.h"
 #include "common/translation.h"
 #include "merge/file_status.h"
 #include "merge/id_result.h"
@@ -30,6 +31,7 @@
 using namespace libmatroska;
 
 class generic_packetizer_c;
+class reader_thread_c;
 
 #define DEFTRACK_TYPE_AUDIO 0
 #define DEFTRACK_TYPE_VIDEO 1
@@ -49,7 +51,7 @@ class generic_reader_c {
 public:
   track_info_c m_ti;
   mm_io_cptr m_in;
-  uint64_t m_size;
+  uint64_t m_size;              // 0 if unknown, e.g. for pipes
 
   std::vector<generic_packetizer_c *> m_reader_packetizers;
   generic_packetizer_c *m_ptzr_first_packet;
@@ -61,6 +63,10 @@ public:
 
   int64_t m_reference_timecode_tolerance;
 
+  mtx::instrumentation::counter_c *m_read_counter;
+
+  std::unique_ptr<reader_thread_c> m_reader_thread;
+
 protected:
   id_result_t m_id_results_container;
   std::vector<id_result_t> m_id_results_tracks, m_id_results_attachments, m_id_results_chapters, m_id_results_tags;
@@ -83,6 +89,7 @@ public:
   virtual void read_headers() = 0;
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false) = 0;
   virtual void read_all();
+  virtual bool supports_threaded_reading() const;
   virtual int get_progress();
   virtual void set_headers();
   virtual void set_headers_for_track(int64_t tid);
@@ -121,6 +128,7 @@ public:
   virtual attach_mode_e attachment_requested(int64_t id);
 
   virtual void display_identification_results();
+  virtual void display_identification_results_as_json();
 
 protected:
   virtual bool demuxing_requested(char type, int64_t id, std::string const &language = "");
@@ -11,12 +11,23 @@
 
 #include "common/common_pch.h"
 
+#include "common/strings/editing.h"
 #include "merge/id_result.h"
 #include "merge/output_control.h"
 
+static std::string s_unsupported_container;
+
 void
 id_result_container_unsupported(const std::string &filename,
                                 const std::string &info) {
+  if (g_identifying && g_identify_json) {
+    // The caller decides how to go on. Probing may continue after
+    // this; only the first unsupported container found counts.
+    if (s_unsupported_container.empty())
+      s_unsupported_container = info;
+    return;
+  }
+
   if (g_identifying) {
     if (g_identify_for_mmg)
       mxinfo(boost::format("File '%1%': unsupported container: %2%\n") % filename % info);
@@ -27,3 +38,52 @@ id_result_container_unsupported(const std::string &filename,
   } else
     mxerror(boost::format(Y("The file '%1%' is a non-supported file type (%2%).\n")) % filename % info);
 }
+
+/** \brief Returns and forgets the unsupported container found last
+
+   Only used for JSON identification where an unsupported container
+   doesn't end the program.
+*/
+std::string
+id_result_take_unsupported_container() {
+  auto info = s_unsupported_container;
+  s_unsupported_container.clear();
+  return info;
+}
+
+/** \brief Converts verbose identification info to a JSON object
+
+   Each entry has the form \c key:value with the value escaped by \c
+   escape(). Some readers put several such pairs separated by spaces
+   into one entry. Decimal integers of up to 18 digits become numbers;
+   all other values, including larger IDs, become strings.
+*/
+std::string
+id_result_properties_to_json(std::vector<std::string> const &verbose_info) {
+  static boost::regex s_number_re{"^-?(0|[1-9][0-9]{0,17})$", boost::regex::perl};
+
+  std::vector<std::string> properties;
+
+  for (auto const &pair : split(join(" ", verbose_info), " ")) {
+    auto colon = pair.find(':');
+    if (pair.empty() || (std::string::npos == colon))
+      continue;
+
+    auto value = unescape(pair.substr(colon + 1));
+    auto json  = boost::regex_match(value, s_number_re) ? value : (boost::format("\"%1%\"") % escape_json(value)).str();
+
+    properties.push_back((boost::format("\"%1%\":%2%") % escape_json(unescape(pair.substr(0, colon))) % json).str());
+  }
+
+  return std::string{"{"} + join(",", properties) + "}";
+}
+
+/** \brief Outputs one JSON identification record on its own line
+
+   The record is written as UTF-8 regardless of the output charset.
+*/
+void
+id_result_output_json(std::string const &record) {
+  g_mm_stdio->write(record + "\n");
+  g_mm_stdio->flush();
+}
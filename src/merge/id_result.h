@@ -59,5 +59,8 @@ struct id_result_t {
 };
 
 void id_result_container_unsupported(const std::string &filename, const std::string &info);
+std::string id_result_take_unsupported_container();
+std::string id_result_properties_to_json(std::vector<std::string> const &verbose_info);
+void id_result_output_json(std::string const &record);
 
 #endif  // MTX_MERGE_ID_RESULT_H
@@ -46,10 +46,13 @@
 #include "common/extern_data.h"
 #include "common/file_types.h"
 #include "common/fs_sys_helpers.h"
+#include "common/instrumentation.h"
 #include "common/iso639.h"
+#include "common/memory_pool.h"
 #include "common/mm_io.h"
 #include "common/segmentinfo.h"
 #include "common/split_arg_parsing.h"
+#include "common/strings/editing.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
 #include "common/unique_numbers.h"
@@ -58,8 +61,10 @@
 #include "common/xml/ebml_segmentinfo_converter.h"
 #include "common/xml/ebml_tags_converter.h"
 #include "merge/cluster_helper.h"
+#include "merge/compression_pool.h"
 #include "merge/filelist.h"
 #include "merge/generic_reader.h"
+#include "merge/input_x.h"
 #include "merge/output_control.h"
 #include "merge/reader_detection_and_creation.h"
 #include "merge/track_info.h"
@@ -114,6 +119,16 @@ set_usage() {
   usage_text += Y("  --timecode-scale <n>     Force the timecode scale factor to n.\n");
   usage_text += Y("  --disable-track-statistics-tags\n"
                   "                           Do not write tags with track statistics.\n");
+  usage_text += Y("  --threaded-demuxing      Read source files in their own threads.\n");
+  usage_text += Y("  --threaded-output        Write the output file from a separate thread.\n");
+  usage_text += Y("  --mmap-input             Map local source files into memory instead of\n"
+                  "                           reading them.\n");
+  usage_text += Y("  --streaming-output       Write the output file in a single pass without\n"
+                  "                           seeking back, e.g. to a pipe. Enabled\n"
+                  "                           automatically if the output file is '-' or a FIFO.\n");
+  usage_text += Y("  --compression-threads <n>\n"
+                  "                           Compress zlib-compressed tracks with n\n"
+                  "                           worker threads.\n");
   usage_text +=   "\n";
   usage_text += Y(" File splitting, linking, appending and concatenating (more global options):\n");
   usage_text += Y("  --split <d[K,M,G]|HH:MM:SS|s>\n"
@@ -265,6 +280,12 @@ set_usage() {
   usage_text +=   "\n\n";
   usage_text += Y(" Other options:\n");
   usage_text += Y("  -i, --identify <file>    Print information about the source file.\n");
+  usage_text += Y("  -J, --identify-json <file>\n"
+                  "                           Print information about the source file as\n"
+                  "                           JSON.\n");
+  usage_text += Y("  --identify-batch <list>  Print information about each file named in the\n"
+                  "                           file 'list' (or the standard input if 'list'\n"
+                  "                           is '-') as one line of JSON per file.\n");
   usage_text += Y("  -l, --list-types         Lists supported input file types.\n");
   usage_text += Y("  --list-languages         Lists all ISO639 languages and their\n"
                   "                           ISO639-2 codes.\n");
@@ -399,6 +420,130 @@ identify(std::string &filename) {
   g_files.clear();
 }
 
+/** \brief Outputs a JSON record for a file that could not be identified
+*/
+static void
+output_json_identification_failure(std::string const &file_name,
+                                   std::string const &unsupported_container,
+                                   std::string const &error) {
+  auto container = unsupported_container.empty() ? std::string{"{\"recognized\":false,\"supported\":false}"}
+                 :                                 (boost::format("{\"recognized\":true,\"supported\":false,\"type\":\"%1%\"}") % escape_json(unsupported_container)).str();
+  auto errors    = error.empty()                 ? std::string{}
+                 :                                 (boost::format("\"%1%\"") % escape_json(error)).str();
+
+  id_result_output_json((boost::format("{\"file_name\":\"%1%\",\"container\":%2%,\"tracks\":[],\"attachments\":[],\"chapters\":[],\"global_tags\":[],\"track_tags\":[],\"errors\":[%3%]}")
+                         % escape_json(file_name) % container % errors).str());
+}
+
+/** \brief Identifies a file and outputs the result as a JSON record
+
+   Other than \c identify() this function returns even if the file
+   cannot be identified. Errors are reported in the record instead of
+   ending the program. Therefore it can be called for many files in a
+   row.
+
+   \return \c 0 if the file was identified, \c 3 if its container is
+     not supported and \c 2 otherwise, matching the exit codes of the
+     text identification.
+*/
+static int
+identify_json(std::string filename) {
+  auto disable_multi_file = false;
+  if (!filename.empty() && ('=' == filename[0])) {
+    disable_multi_file = true;
+    filename           = filename.substr(1);
+  }
+
+  verbose             = 0;
+  g_suppress_warnings = true;
+  g_identifying       = true;
+  g_identify_json     = true;
+
+  // Errors must not end the program but be reported for this file.
+  set_mxmsg_handler(MXMSG_ERROR, [](unsigned int, std::string const &message) {
+    throw mtx::input::extended_x{strip_copy(message, true)};
+  });
+
+  std::string error, unsupported_container;
+
+  try {
+    g_files.emplace_back(new filelist_t);
+    auto &file = *g_files.back();
+    file.ti    = std::make_unique<track_info_c>();
+
+    file.ti->m_disable_multi_file = disable_multi_file;
+    file.ti->m_fname              = filename;
+    file.name                     = filename;
+    file.all_names.push_back(filename);
+
+    get_file_type(file);
+
+    unsupported_container = id_result_take_unsupported_container();
+    if (unsupported_container.empty()) {
+      if (FILE_TYPE_IS_UNKNOWN == file.type)
+        throw mtx::input::extended_x{Y("The file type is unknown.")};
+
+      create_readers();
+      file.reader->identify();
+
+      unsupported_container = id_result_take_unsupported_container();
+      if (unsupported_container.empty())
+        file.reader->display_identification_results();
+    }
+
+  } catch (mtx::exception &ex) {
+    error = ex.error();
+
+  } catch (std::exception &ex) {
+    error = ex.what();
+  }
+
+  g_files.clear();
+
+  if (unsupported_container.empty())
+    unsupported_container = id_result_take_unsupported_container();
+
+  if (unsupported_container.empty() && error.empty())
+    return 0;
+
+  output_json_identification_failure(filename, unsupported_container, unsupported_container.empty() ? error : std::string{});
+
+  return unsupported_container.empty() ? 2 : 3;
+}
+
+/** \brief Identifies many files in one go
+
+   Reads file names from \c list_file_name (or from the standard input
+   if it is \c -), one per line, and outputs one JSON record per file
+   as soon as the file has been identified.
+
+   \return \c 0 if all files were identified and the highest exit code
+     of \c identify_json() otherwise.
+*/
+static int
+identify_batch(std::string const &list_file_name) {
+  auto list = mm_io_cptr{};
+
+  try {
+    list = "-" == list_file_name ? std::static_pointer_cast<mm_io_c>(std::make_shared<mm_stdin_c>())
+         :                         std::static_pointer_cast<mm_io_c>(std::make_shared<mm_text_io_c>(new mm_file_io_c(list_file_name)));
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % list_file_name % ex);
+  }
+
+  auto result = 0;
+  std::string file_name;
+
+  while (list->getline2(file_name)) {
+    strip(file_name, true);
+    if (!file_name.empty())
+      result = std::max(result, identify_json(file_name));
+  }
+
+  return result;
+}
+
 /** \brief Parse a number postfixed with a time-based unit
 
    This function parsers a number that is postfixed with one of the
@@ -1692,7 +1837,7 @@ handle_file_name_arg(const std::string &this_arg,
     if (file_name.empty())
       mxerror(Y("An empty file name is not valid.\n"));
 
-    else if (g_outfile == file_name)
+    else if ((g_outfile == file_name) && ("-" != file_name))
       mxerror(boost::format(Y("The name of the output file '%1%' and of one of the input files is the same. This would cause mkvmerge to overwrite "
                               "one of your input files. This is most likely not what you want.\n")) % g_outfile);
   }
@@ -1787,6 +1932,9 @@ parse_args(std::vector<std::string> args) {
        || (3 == args.size()))
       && (   (args[0] == "-i")
           || (args[0] == "--identify")
+          || (args[0] == "-J")
+          || (args[0] == "--identify-json")
+          || (args[0] == "--identify-batch")
           || (args[0] == "--identify-verbose")
           || (args[0] == "-I")
           || (args[0] == "--identify-for-mmg"))) {
@@ -1801,6 +1949,12 @@ parse_args(std::vector<std::string> args) {
     if (3 == args.size())
       verbose = 3;
 
+    if ((args[0] == "-J") || (args[0] == "--identify-json"))
+      mxexit(identify_json(args[1]));
+
+    if (args[0] == "--identify-batch")
+      mxexit(identify_batch(args[1]));
+
     identify(args[1]);
     mxexit();
   }
@@ -1819,14 +1973,17 @@ parse_args(std::vector<std::string> args) {
       list_iso639_languages();
       mxexit();
 
-    } else if ((this_arg == "-i") || (this_arg == "--identify") || (this_arg == "-I") || (this_arg == "--identify-verbose") || (this_arg == "--identify-for-mmg"))
+    } else if (   (this_arg == "-i") || (this_arg == "--identify") || (this_arg == "-I") || (this_arg == "--identify-verbose") || (this_arg == "--identify-for-mmg")
+               || (this_arg == "-J") || (this_arg == "--identify-json") || (this_arg == "--identify-batch"))
       mxerror(boost::format(Y("'%1%' can only be used with a file name. No further options are allowed if this option is used.\n")) % this_arg);
 
     else if (this_arg == "--capabilities") {
       print_capabilities();
       mxexit();
 
-    }
+    } else if (((this_arg == "-o") || (this_arg == "--output")) && (next_arg == "-") && !stdio_redirected())
+      // The output file is written to stdout, so messages must not be.
+      redirect_stdio(std::make_shared<mm_stdio_c>(stderr));
 
   }
 
@@ -1849,6 +2006,10 @@ parse_args(std::vector<std::string> args) {
       g_outfile = next_arg;
       sit++;
 
+      boost::system::error_code ec;
+      if ((g_outfile == "-") || (bfs::status(bfs::path{g_outfile}, ec).type() == bfs::fifo_file))
+        g_streaming_output = true;
+
     } else if ((this_arg == "-w") || (this_arg == "--webm"))
       set_output_compatibility(OC_WEBM);
   }
@@ -1971,6 +2132,28 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--disable-track-statistics-tags")
       g_no_track_statistics_tags = true;
 
+    else if (this_arg == "--threaded-demuxing")
+      g_threaded_demuxing = true;
+
+    else if (this_arg == "--threaded-output")
+      g_threaded_output = true;
+
+    else if (this_arg == "--mmap-input")
+      g_mmap_input = true;
+
+    else if (this_arg == "--streaming-output")
+      g_streaming_output = true;
+
+    else if (this_arg == "--compression-threads") {
+      if (no_next_arg)
+        mxerror(boost::format(Y("'%1%' lacks its argument.\n")) % this_arg);
+
+      if (!parse_number(next_arg, g_compression_threads))
+        mxerror(boost::format(Y("Invalid number of threads in '%1% %2%'.\n")) % this_arg % next_arg);
+
+      sit++;
+    }
+
     else if (this_arg == "--attachment-description") {
       if (no_next_arg)
         mxerror(Y("'--attachment-description' lacks the description.\n"));
@@ -2340,6 +2523,16 @@ parse_args(std::vector<std::string> args) {
   if (!g_cluster_helper->splitting() && !g_no_linking)
     mxwarn(Y("'--link' is only useful in combination with '--split'.\n"));
 
+  if (g_streaming_output) {
+    if (g_cluster_helper->splitting())
+      mxerror(Y("Splitting cannot be used when writing the output file in streaming mode.\n"));
+
+    // Both the cues and the meta seek entries for clusters would have to
+    // be written after all clusters which cannot be referenced anymore.
+    g_write_cues                   = false;
+    g_write_meta_seek_for_clusters = false;
+  }
+
   if (!inputs_found && g_files.empty())
     mxerror(Y("No input files were given. No output will be created.\n"));
 }
@@ -2491,6 +2684,14 @@ setup(int argc,
   mtx_common_init("mkvmerge", argv[0]);
   g_kax_tracks = std::make_unique<KaxTracks>();
 
+  // The compression pool's workers must be stopped before exit() is
+  // called.
+  set_mxmsg_handler(MXMSG_ERROR, [](unsigned int level, std::string const &message) {
+    compression_pool_c::shutdown();
+    mxmsg(level, message);
+    mxexit(2);
+  });
+
 #if defined(SYS_UNIX) || defined(SYS_APPLE)
   signal(SIGUSR1, sighandler);
   signal(SIGINT, sighandler);
@@ -2554,5 +2755,8 @@ main(int argc,
 
   cleanup();
 
+  memory_pool_c::dump_statistics();
+  mtx::instrumentation::dump_report();
+
   mxexit();
 }
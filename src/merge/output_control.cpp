@@ -54,6 +54,7 @@
 #include "common/ebml.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
+#include "common/mm_async_write_io.h"
 #include "common/mm_write_buffer_io.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
@@ -61,11 +62,14 @@
 #include "common/unique_numbers.h"
 #include "common/version.h"
 #include "merge/cluster_helper.h"
+#include "merge/compression_pool.h"
 #include "merge/cues.h"
 #include "merge/filelist.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
+#include "merge/packet_scheduler.h"
+#include "merge/reader_thread.h"
 #include "merge/webm.h"
 
 using namespace libmatroska;
@@ -106,6 +110,11 @@ bool g_no_lacing                            = false;
 bool g_no_linking                           = true;
 bool g_use_durations                        = false;
 bool g_no_track_statistics_tags             = false;
+bool g_threaded_demuxing                    = false;
+bool g_threaded_output                      = false;
+bool g_mmap_input                           = false;
+bool g_streaming_output                     = false;
+unsigned int g_compression_threads         = 0;
 
 double g_timecode_scale                     = TIMECODE_SCALE;
 timecode_scale_mode_e g_timecode_scale_mode = TIMECODE_SCALE_MODE_NORMAL;
@@ -117,6 +126,7 @@ int g_default_tracks_priority[3]            = { 0, 0, 0, };
 bool g_identifying                          = false;
 bool g_identify_verbose                     = false;
 bool g_identify_for_mmg                     = false;
+bool g_identify_json                        = false;
 
 std::unique_ptr<KaxSegment> g_kax_segment;
 std::unique_ptr<KaxTracks> g_kax_tracks;
@@ -170,6 +180,9 @@ static int64_t s_max_chapter_size           = 0;
 static std::unique_ptr<EbmlVoid> s_void_after_track_headers;
 
 static mm_io_cptr s_out;
+// When streaming: the actual output while s_out still collects the
+// headers in memory.
+static mm_io_cptr s_stream_out;
 
 static bitvalue_c s_seguid_prev(128), s_seguid_current(128), s_seguid_next(128);
 
@@ -185,6 +198,12 @@ static boost::posix_time::ptime s_writing_date;
 static auto s_required_matroska_version      = 1u;
 static auto s_required_matroska_read_version = 1u;
 
+static packet_scheduler_c s_packet_scheduler;
+static std::vector<std::size_t> s_packetizers_to_pull;
+static bool s_pull_all_packetizers = true;
+
+static size_t const s_max_reads_queued_per_reader_thread = 32;
+
 /** \brief Add a segment family UID to the list if it doesn't exist already.
 
   \param family This segment family element is converted to a 128 bit
@@ -223,7 +242,9 @@ calculate_file_duration() {
 #if defined(SYS_UNIX) || defined(SYS_APPLE)
 void
 sighandler(int /* signum */) {
-  if (!s_out)
+  // Nothing can be fixed when streaming as the output cannot be
+  // modified after it has been written.
+  if (!s_out || g_streaming_output)
     mxerror(Y("mkvmerge was interrupted by a SIGINT (Ctrl+C?)\n"));
 
   mxwarn(Y("\nmkvmerge received a SIGINT (probably because the user pressed "
@@ -286,6 +307,16 @@ determine_display_reader() {
   return winner->reader.get();
 }
 
+/** \brief Returns a reader's progress
+
+   Readers running on worker threads must not be asked directly. Their
+   workers record the progress after each read instead.
+*/
+static int
+get_reader_progress(generic_reader_c &reader) {
+  return reader.m_reader_thread ? reader.m_reader_thread->get_progress() : reader.get_progress();
+}
+
 /** \brief Selects a reader for displaying its progress information
 */
 static void
@@ -309,7 +340,7 @@ display_progress(bool is_100percent = false) {
     s_display_reader = determine_display_reader();
 
   bool display_progress  = false;
-  int current_percentage = (s_display_reader->get_progress() + s_display_files_done * 100) / s_display_path_length;
+  int current_percentage = (get_reader_progress(*s_display_reader) + s_display_files_done * 100) / s_display_path_length;
   int64_t current_time   = mtx::sys::get_current_time_millis();
 
   if (   (-1 == s_previous_percentage)
@@ -487,7 +518,7 @@ void
 rerender_ebml_head() {
   mm_io_c *out = g_cluster_helper->get_output();
 
-  if (!out || !s_head)
+  if (!out || !s_head || (g_streaming_output && !s_stream_out))
     return;
 
   out->save_pos(s_head->GetElementPosition());
@@ -495,6 +526,24 @@ rerender_ebml_head() {
   out->restore_pos();
 }
 
+/** \brief Calculates the space to reserve after the track headers
+
+   The amount depends on the number of tracks and on their
+   types. Video tracks whose codec private data is only known after
+   parsing the track's content may need a lot more space than audio or
+   subtitle tracks.
+*/
+static int64_t
+calculate_header_space_to_reserve() {
+  int64_t size = 1024;
+
+  for (auto &ptzr : g_packetizers)
+    if (ptzr.packetizer)
+      size += ptzr.packetizer->get_header_growth_estimate();
+
+  return size;
+}
+
 /** \brief Render the basic EBML and Matroska headers
 
    Renders the segment information and track headers. Also reserves
@@ -508,10 +557,15 @@ render_headers(mm_io_c *out) {
 
     s_kax_infos = std::make_unique<KaxInfo>();
 
-    s_kax_duration = new KaxMyDuration{ !g_video_packetizer || (TIMECODE_SCALE_MODE_AUTO == g_timecode_scale_mode) ? EbmlFloat::FLOAT_64 : EbmlFloat::FLOAT_32};
+    // The duration is unknown when streaming and left out.
+    if (!g_streaming_output) {
+      s_kax_duration = new KaxMyDuration{ !g_video_packetizer || (TIMECODE_SCALE_MODE_AUTO == g_timecode_scale_mode) ? EbmlFloat::FLOAT_64 : EbmlFloat::FLOAT_32};
 
-    s_kax_duration->SetValue(0.0);
-    s_kax_infos->PushElement(*s_kax_duration);
+      s_kax_duration->SetValue(0.0);
+      s_kax_infos->PushElement(*s_kax_duration);
+
+    } else
+      s_kax_duration = nullptr;
 
     if (s_muxing_app.empty()) {
       if (!hack_engaged(ENGAGE_NO_VARIABLE_DATA)) {
@@ -657,10 +711,9 @@ render_headers(mm_io_c *out) {
       g_kax_tracks->Render(*out, false);
       g_kax_sh_main->IndexThis(*g_kax_tracks, *g_kax_segment);
 
-      // Reserve some small amount of space for header changes by the
-      // packetizers.
+      // Reserve space for header changes by the packetizers.
       s_void_after_track_headers = std::make_unique<EbmlVoid>();
-      s_void_after_track_headers->SetSize(1024 + full_header_size - g_kax_tracks->ElementSize(false));
+      s_void_after_track_headers->SetSize(calculate_header_space_to_reserve() + full_header_size - g_kax_tracks->ElementSize(false));
       s_void_after_track_headers->Render(*out);
     }
 
@@ -669,130 +722,179 @@ render_headers(mm_io_c *out) {
   }
 }
 
-static void
-adjust_cue_and_seekhead_positions(int64_t original_offset,
-                                  int64_t new_offset) {
-  auto delta                    = new_offset - original_offset;
-  auto relative_original_offset = g_kax_segment->GetRelativePosition(original_offset);
-  mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender] Adjusting cue positions from %1% to %2%, delta %3%, relative from %4%\n") % original_offset % new_offset % delta % relative_original_offset);
-
-  if (!delta)
-    return;
-
-  // TODO: read cues from temporary storage file, adjust, write back
-  // if (g_cue_writing_requested)
-  //   for (auto cues_child : g_kax_cues->GetElementList()) {
-  //     auto point = dynamic_cast<KaxCuePoint *>(cues_child);
-  //     if (!point)
-  //       continue;
-
-  //     for (auto point_child : *point) {
-  //       auto positions = dynamic_cast<KaxCueTrackPositions *>(point_child);
-  //       if (!positions)
-  //         continue;
-
-  //       auto &cluster_position = GetChild<KaxCueClusterPosition>(positions);
-  //       auto old_value         = cluster_position.GetValue();
-  //       bool is_affected       = old_value < relative_original_offset;
-  //       auto new_value         = is_affected ? old_value : old_value + (delta > 0 ? delta : std::min<int64_t>(old_value, delta));
-  //       cluster_position.SetValue(new_value);
-
-  //       mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]  Cluster position: affected? %1% old %2% new %3%\n") % is_affected % old_value % new_value);
-  //     }
-  //   }
-
-  // TODO: adjust meta seek
-}
-
-static void
-render_void(int64_t new_size) {
+static std::unique_ptr<EbmlVoid>
+render_void(mm_io_c &out,
+            int64_t new_size) {
   auto actual_size = new_size;
+  auto void_elt    = std::make_unique<EbmlVoid>();
 
-  s_void_after_track_headers = std::make_unique<EbmlVoid>();
-  s_void_after_track_headers->SetSize(new_size);
-  s_void_after_track_headers->UpdateSize();
+  void_elt->SetSize(new_size);
+  void_elt->UpdateSize();
 
-  while (static_cast<int64_t>(s_void_after_track_headers->ElementSize()) > new_size)
-    s_void_after_track_headers->SetSize(--actual_size);
+  while (static_cast<int64_t>(void_elt->ElementSize()) > new_size)
+    void_elt->SetSize(--actual_size);
 
-  if (static_cast<int64_t>(s_void_after_track_headers->ElementSize()) < new_size)
-    s_void_after_track_headers->SetSizeLength(new_size - actual_size - 1);
+  if (static_cast<int64_t>(void_elt->ElementSize()) < new_size)
+    void_elt->SetSizeLength(new_size - actual_size - 1);
 
   mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender] render_void new_size %1% actual_size %2% size_length %3%\n") % new_size % actual_size % (new_size - actual_size - 1));
 
-  s_void_after_track_headers->Render(*s_out);
+  void_elt->Render(out);
+
+  return void_elt;
 }
 
-/** \brief Overwrites the track headers with current values
+/** \brief Overwrites track headers that have been written before
 
-   Can be used by packetizers that have to modify their headers
-   depending on the track contents.
+   \c tracks must have been rendered into \c out followed by \c
+   void_after. If the track headers still fit into the space taken by
+   both they're updated in place and \c void_after is shrunk
+   accordingly. Otherwise they may only grow if nothing has been
+   written after \c void_after yet. \c space_to_reserve bytes are
+   reserved after them again in that case.
+
+   Data written after \c void_after is never moved as that would mean
+   reading all of it into memory. Use \c relocate_track_headers() in
+   that case.
+
+   \return \c false if the track headers don't fit anymore and data has
+     already been written after them. Nothing is written in that case.
 */
-void
-rerender_track_headers() {
-  g_kax_tracks->UpdateSize(false);
+bool
+rerender_track_headers_in_place(mm_io_c &out,
+                                KaxTracks &tracks,
+                                std::unique_ptr<EbmlVoid> &void_after,
+                                int64_t space_to_reserve) {
+  tracks.UpdateSize(false);
 
-  int64_t new_void_size       = s_void_after_track_headers->GetElementPosition() + s_void_after_track_headers->ElementSize() - g_kax_tracks->GetElementPosition() - g_kax_tracks->ElementSize();
-  auto projected_new_void_pos = g_kax_tracks->GetElementPosition() + g_kax_tracks->ElementSize();
+  int64_t new_void_size       = void_after->GetElementPosition() + void_after->ElementSize() - tracks.GetElementPosition() - tracks.ElementSize();
+  auto projected_new_void_pos = tracks.GetElementPosition() + tracks.ElementSize();
 
   if (4 <= new_void_size) {
-    auto old_void_pos = s_void_after_track_headers->GetElementPosition();
+    auto old_void_pos = void_after->GetElementPosition();
 
-    s_out->save_pos(g_kax_tracks->GetElementPosition());
+    out.save_pos(tracks.GetElementPosition());
 
-    g_kax_tracks->Render(*s_out, false);
-    render_void(new_void_size);
+    tracks.Render(out, false);
+    void_after = render_void(out, new_void_size);
 
-    s_out->restore_pos();
+    out.restore_pos();
 
     mxdebug_if(s_debug_rerender_track_headers,
-               boost::format("[rerender] Normal case, only shrinking void down to %1%, new position %2% projected %9% new full size %3% new end %4% s_out size %5% old void start pos %6% tracks pos %7% tracks size %8%\n")
-               % new_void_size                                                                                  // 1
-               % s_void_after_track_headers->GetElementPosition()                                               // 2
-               % s_void_after_track_headers->ElementSize()                                                      // 3
-               % (s_void_after_track_headers->GetElementPosition() + s_void_after_track_headers->ElementSize()) // 4
-               % s_out->get_size()                                                                              // 5
-               % old_void_pos                                                                                   // 6
-               % g_kax_tracks->GetElementPosition()                                                             // 7
-               % g_kax_tracks->ElementSize()                                                                    // 8
-               % projected_new_void_pos);                                                                       // 9
+               boost::format("[rerender] Normal case, only shrinking void down to %1%, new position %2% projected %9% new full size %3% new end %4% out size %5% old void start pos %6% tracks pos %7% tracks size %8%\n")
+               % new_void_size                                                  // 1
+               % void_after->GetElementPosition()                               // 2
+               % void_after->ElementSize()                                      // 3
+               % (void_after->GetElementPosition() + void_after->ElementSize()) // 4
+               % out.get_size()                                                 // 5
+               % old_void_pos                                                   // 6
+               % tracks.GetElementPosition()                                    // 7
+               % tracks.ElementSize()                                           // 8
+               % projected_new_void_pos);                                       // 9
+
+    return true;
+  }
 
-    return;
+  int64_t data_start_pos = void_after->GetElementPosition() + void_after->ElementSize(true);
+  int64_t data_size      = out.get_size() - data_start_pos;
+
+  if (0 < data_size) {
+    mxdebug_if(s_debug_rerender_track_headers,
+               boost::format("[rerender] 4 > new void size (%1%) and %2% bytes written after the void at %3%; giving up\n") % new_void_size % data_size % data_start_pos);
+    return false;
   }
 
-  auto current_pos       = s_out->getFilePointer();
-  int64_t data_start_pos = s_void_after_track_headers->GetElementPosition() + s_void_after_track_headers->ElementSize(true);
-  int64_t data_size      = s_out->get_size() - data_start_pos;
-  memory_cptr data;
+  // Nothing has been written after the track headers yet. They can
+  // simply grow at their current position.
+  out.setFilePointer(tracks.GetElementPosition());
+  tracks.Render(out, false);
 
-  s_out->setFilePointer(data_start_pos);
+  void_after = render_void(out, space_to_reserve);
 
-  if (data_size) {
-    // Currently not supported due to lack of test file.
-    mxerror(boost::format(Y("Re-rendering track headers: data_size != 0 not implemented yet. %1%\n")) % BUGMSG);
+  mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender] 4 > new void size (%1%), nothing written after the void yet; new end %2%\n") % new_void_size % out.getFilePointer());
 
-    mxdebug_if(s_debug_rerender_track_headers,
-               boost::format("[rerender] void pos %1% void size %2% = data_start_pos %3% s_out size %4% => data_size %5%\n")
-               % s_void_after_track_headers->GetElementPosition() % s_void_after_track_headers->ElementSize(true) % data_start_pos % s_out->get_size() % data_size);
+  return true;
+}
 
-    data = s_out->read(data_size);
-  }
+/** \brief Moves the track headers to the end of the output
 
-  s_out->setFilePointer(g_kax_tracks->GetElementPosition());
-  g_kax_tracks->Render(*s_out, false);
+   Used if the track headers have outgrown the space reserved after
+   them and data has already been written after that space. That data
+   is never moved. Instead the track headers are rendered at the end
+   of \c out followed by \c space_to_reserve bytes reserved for further
+   changes. Their old location including \c void_after is overwritten
+   with a single void element, and the entry for the track headers in
+   \c seek_head is replaced. Replacing the entry only changes the
+   number of bytes needed for the position, therefore the seek head
+   still fits into the space reserved for it.
 
-  render_void(1024);
+   The file pointer of \c out is left at the end of the new void
+   element so that writing continues after it.
+*/
+void
+relocate_track_headers(mm_io_c &out,
+                       KaxTracks &tracks,
+                       std::unique_ptr<EbmlVoid> &void_after,
+                       KaxSeekHead &seek_head,
+                       KaxSegment &segment,
+                       int64_t space_to_reserve) {
+  auto old_tracks_pos = tracks.GetElementPosition();
+  auto old_end_pos    = void_after->GetElementPosition() + void_after->ElementSize();
+
+  out.setFilePointer(0, seek_end);
+  tracks.Render(out, false);
+  void_after = render_void(out, space_to_reserve);
+
+  out.save_pos(old_tracks_pos);
+  render_void(out, old_end_pos - old_tracks_pos);
+  out.restore_pos();
+
+  for (auto idx = seek_head.ListSize(); 0 < idx; --idx) {
+    auto seek    = dynamic_cast<KaxSeek *>(seek_head[idx - 1]);
+    auto seek_id = seek ? FindChild<KaxSeekID>(seek) : nullptr;
+    if (!seek_id)
+      continue;
 
-  int64_t new_data_start_pos = s_out->getFilePointer();
+    EbmlId the_id(seek_id->GetBuffer(), seek_id->GetSize());
+    if (!Is<KaxTracks>(the_id))
+      continue;
 
-  if (data) {
-    s_out->write(data);
-    adjust_cue_and_seekhead_positions(data_start_pos, new_data_start_pos);
+    delete seek;
+    seek_head.Remove(idx - 1);
   }
 
-  mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender] 4 > new void size (%1%). Size of data to move: %2% from %3% to %4%\n") % new_void_size % data_size % data_start_pos % new_data_start_pos);
+  seek_head.IndexThis(tracks, segment);
 
-  s_out->setFilePointer(current_pos + new_data_start_pos - data_start_pos);
+  mxdebug_if(s_debug_rerender_track_headers,
+             boost::format("[rerender] Relocated track headers from %1% to %2%; voided %3% bytes at the old position; new size %4% new void size %5%\n")
+             % old_tracks_pos % tracks.GetElementPosition() % (old_end_pos - old_tracks_pos) % tracks.ElementSize() % void_after->ElementSize());
+}
+
+/** \brief Overwrites the track headers with current values
+
+   Can be used by packetizers that have to modify their headers
+   depending on the track contents.
+
+   If the headers still fit into the space reserved after them then
+   they're updated in place. Otherwise they're moved to the end of the
+   file if data has already been written after them. The data already
+   written is never moved.
+*/
+void
+rerender_track_headers() {
+  if (g_streaming_output && !s_stream_out) {
+    static auto s_warning_shown = false;
+
+    if (!s_warning_shown)
+      mxwarn(Y("The track headers have changed after they had been written. They cannot be updated when streaming the output. "
+               "Therefore the output might not be playable.\n"));
+    s_warning_shown = true;
+
+    return;
+  }
+
+  if (!rerender_track_headers_in_place(*s_out, *g_kax_tracks, s_void_after_track_headers, calculate_header_space_to_reserve()))
+    relocate_track_headers(*s_out, *g_kax_tracks, s_void_after_track_headers, *g_kax_sh_main, *g_kax_segment, calculate_header_space_to_reserve());
 }
 
 /** \brief Render all attachments into the output file at the current position
@@ -1203,6 +1305,9 @@ add_tags_from_cue_chapters() {
     the maximum size of chapters is know. So we reserve space at the
     beginning of the file for all of the chapters.
 
+    When streaming the output the chapters are rendered right away
+    instead as the space reserved cannot be filled later.
+
     WebM compliant files must not contain chapters. This function
     issues a warning and invalidates the chapters if this is the case.
  */
@@ -1220,6 +1325,21 @@ render_chapter_void_placeholder() {
     return;
   }
 
+  if (g_streaming_output) {
+    if (!g_kax_chapters)
+      return;
+
+    auto chapters = clone(g_kax_chapters);
+    merge_chapter_entries(*chapters);
+    sort_ebml_master(chapters.get());
+    chapters->Render(*s_out, true);
+
+    if (!hack_engaged(ENGAGE_NO_CHAPTERS_IN_META_SEEK))
+      g_kax_sh_main->IndexThis(*chapters, *g_kax_segment);
+
+    return;
+  }
+
   s_kax_chapters_void = std::make_unique<EbmlVoid>();
   s_kax_chapters_void->SetSize(s_max_chapter_size + 100);
   s_kax_chapters_void->Render(*s_out);
@@ -1265,14 +1385,23 @@ create_next_output_file() {
   auto this_outfile   = g_cluster_helper->split_mode_produces_many_files() ? create_output_name() : g_outfile;
   g_kax_segment       = std::make_unique<KaxSegment>();
 
-  // Open the output file.
+  // Open the output file. When streaming the headers are assembled
+  // in memory first; see flush_held_back_headers().
   try {
-    s_out = !g_cluster_helper->discarding() ? mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024) : mm_io_cptr{ new mm_null_io_c{this_outfile} };
+    if (g_streaming_output) {
+      s_stream_out = "-" == this_outfile ? mm_io_cptr{ new mm_stdio_c }
+                   :                       mm_io_cptr{ new mm_file_io_c{this_outfile, MODE_CREATE} };
+      s_out        = mm_io_cptr{ new mm_mem_io_c{nullptr, 0, 64 * 1024} };
+
+    } else
+      s_out = g_cluster_helper->discarding() ? mm_io_cptr{ new mm_null_io_c{this_outfile} }
+            : g_threaded_output              ? mm_async_write_io_c::open(this_outfile, 4 * 1024 * 1024, 5)
+            :                                  mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024);
   } catch (mtx::mm_io::exception &ex) {
     mxerror(boost::format(Y("The file '%1%' could not be opened for writing: %2%.\n")) % this_outfile % ex);
   }
 
-  if (verbose && !g_cluster_helper->discarding())
+  if (verbose && !g_cluster_helper->discarding() && ("-" != this_outfile))
     mxinfo(boost::format(Y("The file '%1%' has been opened for writing.\n")) % this_outfile);
 
   g_cluster_helper->set_output(s_out.get());
@@ -1358,55 +1487,19 @@ set_track_statistics_tags(KaxTags *tags) {
   return tags;
 }
 
-/** \brief Finishes and closes the current file
+/** \brief Updates the duration and the segment UIDs in the segment information
 
-   Renders the data that is generated during the muxing run. The cues
-   and meta seek information are rendered at the end. If splitting is
-   active the chapters are stripped to those that actually lie in this
-   file and rendered at the front.  The segment duration and the
-   segment size are set to their actual values.
+   If splitting is active and this is the last part then handle the
+   'next segment UID'. If it was given on the command line then set it
+   here. Otherwise remove an existing one (e.g. from file linking
+   during splitting).
 */
-void
-finish_file(bool last_file,
-            bool create_new_file,
-            bool previously_discarding) {
-  if (g_kax_chapters && !previously_discarding)
-    add_chapters_for_current_part();
-
-  if (!last_file && !create_new_file)
-    return;
-
-  run_before_file_finished_packetizer_hooks();
-
-  bool do_output = verbose && !dynamic_cast<mm_null_io_c *>(s_out.get());
-  if (do_output)
-    mxinfo("\n");
-
-  // Render the track headers a second time if the user has requested that.
-  if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
-    auto second_tracks = clone(g_kax_tracks);
-    second_tracks->Render(*s_out);
-    g_kax_sh_main->IndexThis(*second_tracks, *g_kax_segment);
-  }
-
-  // Render the cues.
-  if (g_write_cues && g_cue_writing_requested) {
-    if (do_output)
-      mxinfo(Y("The cue entries (the index) are being written...\n"));
-    cues_c::get().write(*s_out, *g_kax_sh_main);
-  }
-
-  // Now re-render the s_kax_duration and fill in the biggest timecode
-  // as the file's duration.
+static void
+update_segment_info(bool last_file) {
   s_out->save_pos(s_kax_duration->GetElementPosition());
   s_kax_duration->SetValue(calculate_file_duration());
   s_kax_duration->Render(*s_out);
 
-  // If splitting is active and this is the last part then handle the
-  // 'next segment UID'. If it was given on the command line then set it here.
-  // Otherwise remove an existing one (e.g. from file linking during
-  // splitting).
-
   s_kax_infos->UpdateSize(true);
   int64_t info_size = s_kax_infos->ElementSize();
   int changed       = 0;
@@ -1446,6 +1539,93 @@ finish_file(bool last_file,
     }
   }
   s_out->restore_pos();
+}
+
+/** \brief Renders the meta seek element into the space reserved for it */
+static void
+render_meta_seek() {
+  if ((g_kax_sh_main->ListSize() == 0) || hack_engaged(ENGAGE_NO_META_SEEK))
+    return;
+
+  g_kax_sh_main->UpdateSize();
+  if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
+    mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. Size needed: %1%. %2%\n"))
+           % g_kax_sh_main->ElementSize() % BUGMSG);
+}
+
+/** \brief Writes the headers held back in memory when streaming
+
+   When streaming the output the headers are assembled in memory so
+   that packetizers can still update them until the first cluster is
+   rendered. Then they're written to the actual output together with
+   the meta seek element for them. Afterwards the output is only ever
+   appended to.
+*/
+void
+flush_held_back_headers() {
+  if (!s_stream_out)
+    return;
+
+  if (s_kax_as)
+    g_kax_sh_main->IndexThis(*s_kax_as, *g_kax_segment);
+
+  render_meta_seek();
+
+  auto held_back = static_cast<mm_mem_io_c *>(s_out.get());
+  s_stream_out->write(held_back->get_buffer(), held_back->get_size());
+
+  s_out = s_stream_out;
+  s_stream_out.reset();
+
+  g_cluster_helper->set_output(s_out.get());
+}
+
+/** \brief Finishes and closes the current file
+
+   Renders the data that is generated during the muxing run. The cues
+   and meta seek information are rendered at the end. If splitting is
+   active the chapters are stripped to those that actually lie in this
+   file and rendered at the front.  The segment duration and the
+   segment size are set to their actual values.
+*/
+void
+finish_file(bool last_file,
+            bool create_new_file,
+            bool previously_discarding) {
+  if (g_kax_chapters && !previously_discarding)
+    add_chapters_for_current_part();
+
+  if (!last_file && !create_new_file)
+    return;
+
+  run_before_file_finished_packetizer_hooks();
+
+  // Nothing may have been written yet if no cluster was rendered.
+  flush_held_back_headers();
+
+  bool do_output = verbose && !dynamic_cast<mm_null_io_c *>(s_out.get());
+  if (do_output)
+    mxinfo("\n");
+
+  // Render the track headers a second time if the user has requested that.
+  if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
+    auto second_tracks = clone(g_kax_tracks);
+    second_tracks->Render(*s_out);
+    g_kax_sh_main->IndexThis(*second_tracks, *g_kax_segment);
+  }
+
+  // Render the cues.
+  if (g_write_cues && g_cue_writing_requested) {
+    if (do_output)
+      mxinfo(Y("The cue entries (the index) are being written...\n"));
+    cues_c::get().write(*s_out, *g_kax_sh_main);
+  }
+
+  // Now re-render the s_kax_duration and fill in the biggest timecode
+  // as the file's duration. The segment information cannot be changed
+  // when streaming.
+  if (!g_streaming_output)
+    update_segment_info(last_file);
 
   // Render the segment info a second time if the user has requested that.
   if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
@@ -1500,17 +1680,16 @@ finish_file(bool last_file,
     s_kax_as.reset();
   }
 
-  if ((g_kax_sh_main->ListSize() > 0) && !hack_engaged(ENGAGE_NO_META_SEEK)) {
-    g_kax_sh_main->UpdateSize();
-    if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
-      mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. Size needed: %1%. %2%\n"))
-             % g_kax_sh_main->ElementSize() % BUGMSG);
-  }
+  // When streaming the meta seek element has been written along with
+  // the headers, and the segment's size stays unknown.
+  if (!g_streaming_output) {
+    render_meta_seek();
 
-  // Set the correct size for the segment.
-  int64_t final_file_size = s_out->getFilePointer();
-  if (g_kax_segment->ForceSize(final_file_size - g_kax_segment->GetElementPosition() - g_kax_segment->HeadSize()))
-    g_kax_segment->OverwriteHead(*s_out);
+    // Set the correct size for the segment.
+    int64_t final_file_size = s_out->getFilePointer();
+    if (g_kax_segment->ForceSize(final_file_size - g_kax_segment->GetElementPosition() - g_kax_segment->HeadSize()))
+      g_kax_segment->OverwriteHead(*s_out);
+  }
 
   s_out.reset();
 
@@ -1532,6 +1711,7 @@ force_close_output_file() {
     wb_out->discard_buffer();
 
   s_out.reset();
+  s_stream_out.reset();
 }
 
 static void establish_deferred_connections(filelist_t &file);
@@ -1801,50 +1981,103 @@ establish_deferred_connections(filelist_t &file) {
   // \todo Select a new file that the subs will defer to.
 }
 
+static void
+pull_packetizer_for_packet(packetizer_t &ptzr) {
+  if (FILE_STATUS_HOLDING == ptzr.status)
+    ptzr.status = FILE_STATUS_MOREDATA;
+
+  ptzr.old_status = ptzr.status;
+
+  while (   !ptzr.pack
+         && (FILE_STATUS_MOREDATA == ptzr.status)
+         && !ptzr.packetizer->packet_available())
+    ptzr.status = ptzr.packetizer->read();
+
+  if (   (FILE_STATUS_MOREDATA != ptzr.status)
+         && (FILE_STATUS_MOREDATA == ptzr.old_status))
+    ptzr.packetizer->force_duration_on_last_packet();
+
+  if (!ptzr.pack)
+    ptzr.pack = ptzr.packetizer->get_packet();
+
+  if (!ptzr.pack && (FILE_STATUS_DONE == ptzr.status))
+    ptzr.status = FILE_STATUS_DONE_AND_DRY;
+
+  // Has this packetizer changed its status from "data available" to
+  // "file done" during this loop? If so then decrease the number of
+  // unfinished packetizers in the corresponding file structure.
+  if (   (FILE_STATUS_DONE_AND_DRY == ptzr.status)
+      && (ptzr.old_status != ptzr.status)) {
+    auto &file = *g_files[ptzr.file];
+    file.num_unfinished_packetizers--;
+
+    // If all packetizers for a file have finished then establish the
+    // deferred connections.
+    if ((0 >= file.num_unfinished_packetizers) && (0 < file.old_num_unfinished_packetizers)) {
+      establish_deferred_connections(file);
+      file.done = true;
+    }
+    file.old_num_unfinished_packetizers = file.num_unfinished_packetizers;
+  }
+}
+
+/** \brief Makes each packetizer offer a packet if it can
+
+   A packetizer that offers a packet keeps offering it until the
+   packet has been consumed. Therefore only the packetizer whose packet
+   has been consumed last and the packetizers that have been holding
+   have to be pulled again. The first call pulls all of them.
+
+   Appending changes the packetizers and their states outside of this
+   function. All packetizers are pulled in that case.
+*/
 static void
 pull_packetizers_for_packets() {
-  for (auto &ptzr : g_packetizers) {
-    if (FILE_STATUS_HOLDING == ptzr.status)
-      ptzr.status = FILE_STATUS_MOREDATA;
+  if (s_appending_files) {
+    for (auto &ptzr : g_packetizers)
+      pull_packetizer_for_packet(ptzr);
+    return;
+  }
 
-    ptzr.old_status = ptzr.status;
+  auto to_pull = std::vector<std::size_t>{};
 
-    while (   !ptzr.pack
-           && (FILE_STATUS_MOREDATA == ptzr.status)
-           && !ptzr.packetizer->packet_available())
-      ptzr.status = ptzr.packetizer->read();
+  if (s_pull_all_packetizers) {
+    for (auto idx = 0u; idx < g_packetizers.size(); ++idx)
+      to_pull.push_back(idx);
+    s_pull_all_packetizers = false;
 
-    if (   (FILE_STATUS_MOREDATA != ptzr.status)
-           && (FILE_STATUS_MOREDATA == ptzr.old_status))
-      ptzr.packetizer->force_duration_on_last_packet();
+  } else {
+    std::swap(to_pull, s_packetizers_to_pull);
+    brng::sort(to_pull);
+  }
 
-    if (!ptzr.pack)
-      ptzr.pack = ptzr.packetizer->get_packet();
-
-    if (!ptzr.pack && (FILE_STATUS_DONE == ptzr.status))
-      ptzr.status = FILE_STATUS_DONE_AND_DRY;
-
-    // Has this packetizer changed its status from "data available" to
-    // "file done" during this loop? If so then decrease the number of
-    // unfinished packetizers in the corresponding file structure.
-    if (   (FILE_STATUS_DONE_AND_DRY == ptzr.status)
-        && (ptzr.old_status != ptzr.status)) {
-      auto &file = *g_files[ptzr.file];
-      file.num_unfinished_packetizers--;
-
-      // If all packetizers for a file have finished then establish the
-      // deferred connections.
-      if ((0 >= file.num_unfinished_packetizers) && (0 < file.old_num_unfinished_packetizers)) {
-        establish_deferred_connections(file);
-        file.done = true;
-      }
-      file.old_num_unfinished_packetizers = file.num_unfinished_packetizers;
-    }
+  for (auto idx : to_pull) {
+    auto &ptzr = g_packetizers[idx];
+
+    pull_packetizer_for_packet(ptzr);
+
+    // Packets without a valid timecode are considered to come first,
+    // just like timecode_c's comparison operator does.
+    if (ptzr.pack)
+      s_packet_scheduler.add(idx, ptzr.pack->output_order_timecode.to_ns(std::numeric_limits<int64_t>::min()));
+
+    else if (FILE_STATUS_HOLDING == ptzr.status)
+      s_packetizers_to_pull.push_back(idx);
   }
 }
 
 static packetizer_t *
 select_winning_packetizer() {
+  if (!s_appending_files) {
+    if (s_packet_scheduler.empty())
+      return nullptr;
+
+    auto idx = s_packet_scheduler.pop();
+    s_packetizers_to_pull.push_back(idx);
+
+    return &g_packetizers[idx];
+  }
+
   packetizer_t *winner = nullptr;
 
   for (auto &ptzr : g_packetizers) {
@@ -1861,6 +2094,39 @@ select_winning_packetizer() {
   return winner;
 }
 
+/** \brief Starts a worker thread for each reader that supports it
+
+   Appending connects packetizers of different readers with each
+   other while muxing. Files are therefore always read sequentially
+   in that case.
+*/
+static void
+start_reader_threads() {
+  if (!g_threaded_demuxing)
+    return;
+
+  if (s_appending_files) {
+    mxwarn(Y("Threaded demuxing cannot be used together with appending. The files will be read sequentially.\n"));
+    return;
+  }
+
+  for (auto &file : g_files) {
+    auto &reader = *file->reader;
+
+    if (!reader.get_num_packetizers() || !reader.supports_threaded_reading())
+      continue;
+
+    reader.m_reader_thread.reset(new reader_thread_c{reader, s_max_reads_queued_per_reader_thread});
+    reader.m_reader_thread->start();
+  }
+}
+
+static void
+stop_reader_threads() {
+  for (auto &file : g_files)
+    file->reader->m_reader_thread.reset();
+}
+
 static void
 discard_queued_packets() {
   for (auto &ptzr : g_packetizers)
@@ -1877,6 +2143,8 @@ discard_queued_packets() {
 */
 void
 main_loop() {
+  start_reader_threads();
+
   // Let's go!
   while (1) {
     // Step 1: Make sure a packet is available for each output
@@ -1914,6 +2182,8 @@ main_loop() {
       break;
   }
 
+  stop_reader_threads();
+
   // Render all remaining packets (if there are any).
   if (g_cluster_helper && (0 < g_cluster_helper->get_packet_count()))
     g_cluster_helper->render();
@@ -1936,6 +2206,8 @@ destroy_readers() {
 */
 void
 cleanup() {
+  compression_pool_c::shutdown();
+
   g_cluster_helper.reset();
 
   destroy_readers();
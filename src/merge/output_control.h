@@ -40,6 +40,10 @@ namespace libmatroska {
   class KaxInfo;
 };
 
+namespace libebml {
+  class EbmlVoid;
+};
+
 using namespace libmatroska;
 
 class mm_io_c;
@@ -180,8 +184,10 @@ extern generic_packetizer_c *g_video_packetizer;
 
 extern bool g_write_cues, g_cue_writing_requested;
 extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags;
+extern bool g_threaded_demuxing, g_threaded_output, g_mmap_input, g_streaming_output;
+extern unsigned int g_compression_threads;
 
-extern bool g_identifying, g_identify_verbose, g_identify_for_mmg;
+extern bool g_identifying, g_identify_verbose, g_identify_for_mmg, g_identify_json;
 
 extern int g_file_num;
 extern int64_t g_file_sizes;
@@ -210,7 +216,10 @@ void add_tags(KaxTag *tags);
 void create_next_output_file();
 void finish_file(bool last_file, bool create_new_file = false, bool previously_discarding = false);
 void force_close_output_file();
+void flush_held_back_headers();
 void rerender_track_headers();
+bool rerender_track_headers_in_place(mm_io_c &out, KaxTracks &tracks, std::unique_ptr<libebml::EbmlVoid> &void_after, int64_t space_to_reserve);
+void relocate_track_headers(mm_io_c &out, KaxTracks &tracks, std::unique_ptr<libebml::EbmlVoid> &void_after, KaxSeekHead &seek_head, KaxSegment &segment, int64_t space_to_reserve);
 void rerender_ebml_head();
 std::string create_output_name();
 
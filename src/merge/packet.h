@@ -16,6 +16,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/memory_pool.h"
 #include "common/timecode.h"
 
 namespace libmatroska {
@@ -120,7 +121,7 @@ struct packet_t {
            int64_t p_duration = -1,
            int64_t p_bref     = -1,
            int64_t p_fref     = -1)
-    : data(memory_cptr(n_memory))
+    : data(memory_pool_c::own(n_memory))
     , group{}
     , block{}
     , cluster{}
@@ -146,6 +147,17 @@ struct packet_t {
   ~packet_t() {
   }
 
+  // Packets are created and destroyed for each frame. Recycle their
+  // memory. Only used for packets created with new. Use
+  // memory_pool_c::make_shared() instead of std::make_shared().
+  static void *operator new(size_t size) {
+    return memory_pool_c::allocate(size);
+  }
+
+  static void operator delete(void *ptr) {
+    memory_pool_c::release(ptr);
+  }
+
   bool
   has_timecode()
     const {
@@ -0,0 +1,69 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the packet scheduler
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_MERGE_PACKET_SCHEDULER_H
+#define MTX_MERGE_PACKET_SCHEDULER_H
+
+#include "common/common_pch.h"
+
+#include <queue>
+
+/** \brief Orders the packetizers by the timecode of their next packet
+
+   Each packetizer is identified by its index. It is added with the
+   output order timecode of the packet it currently offers. \c pop()
+   returns the packetizer with the lowest timecode. Ties are broken
+   by the lower index so that the result is the same as that of a
+   linear scan over all packetizers.
+
+   A packetizer must be added again once it offers its next packet.
+*/
+class packet_scheduler_c {
+protected:
+  using entry_t = std::pair<int64_t, std::size_t>;
+
+  std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> m_queue;
+
+public:
+  void
+  add(std::size_t idx,
+      int64_t timecode) {
+    m_queue.emplace(timecode, idx);
+  }
+
+  bool
+  empty()
+    const {
+    return m_queue.empty();
+  }
+
+  std::size_t
+  size()
+    const {
+    return m_queue.size();
+  }
+
+  std::size_t
+  pop() {
+    auto idx = m_queue.top().second;
+    m_queue.pop();
+    return idx;
+  }
+
+  void
+  clear() {
+    m_queue = decltype(m_queue){};
+  }
+};
+
+#endif  // MTX_MERGE_PACKET_SCHEDULER_H
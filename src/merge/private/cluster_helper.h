@@ -15,6 +15,7 @@
 #ifndef MTX_MERGE_PRIVATE_CLUSTER_HELPER_H
 #define MTX_MERGE_PRIVATE_CLUSTER_HELPER_H
 
+#include "common/instrumentation.h"
 #include "merge/track_statistics.h"
 
 class render_groups_c {
@@ -46,6 +47,7 @@ public:
   int64_t max_timecode_in_file, min_timecode_in_cluster, max_timecode_in_cluster, frame_field_number;
   bool first_video_keyframe_seen;
   mm_io_c *out;
+  mtx::instrumentation::counter_c *render_counter;
 
   std::vector<split_point_c> split_points;
   std::vector<split_point_c>::iterator current_split_point;
@@ -12,8 +12,14 @@
 
 #include "common/common_pch.h"
 
+#include <chrono>
+
+#include "common/endian.h"
+#include "common/mm_mmap_io.h"
 #include "common/mm_mpls_multi_file_io.h"
+#include "common/mm_probe_io.h"
 #include "common/mm_read_buffer_io.h"
+#include "common/mm_stream_io.h"
 #include "common/strings/formatting.h"
 #include "common/xml/xml.h"
 #include "input/r_aac.h"
@@ -68,8 +74,24 @@ file_names_to_paths(const std::vector<std::string> &file_names) {
 static mm_io_cptr
 open_input_file(filelist_t &file) {
   try {
-    if (file.all_names.size() == 1)
+    // Pipes can only be opened once; the reader gets the same
+    // stream that has been probed.
+    if (file.stream_in)
+      return file.stream_in;
+
+    if (file.all_names.size() == 1) {
+      if (mm_stream_io_c::is_stream(file.name)) {
+        file.stream_in = mm_stream_io_c::open(file.name);
+        return file.stream_in;
+      }
+
+      // Fall back to regular reading if the file cannot be mapped.
+      auto mapped = g_mmap_input ? mm_mmap_io_c::open(file.name) : mm_io_cptr{};
+      if (mapped)
+        return mapped;
+
       return mm_io_cptr(new mm_read_buffer_io_c(new mm_file_io_c(file.name), 1 << 17));
+    }
 
     else {
       std::vector<bfs::path> paths = file_names_to_paths(file.all_names);
@@ -100,10 +122,11 @@ open_playlist_file(filelist_t &file,
 }
 
 static file_type_e
-detect_text_file_formats(filelist_t const &file) {
+detect_text_file_formats(filelist_t const &file,
+                         mm_io_c *in) {
   auto text_io = mm_text_io_cptr{};
   try {
-    text_io        = std::make_shared<mm_text_io_c>(new mm_file_io_c(file.name));
+    text_io        = std::make_shared<mm_text_io_c>(in, false);
     auto text_size = text_io->get_size();
 
     if (srt_reader_c::probe_file(text_io.get(), text_size))
@@ -129,82 +152,184 @@ detect_text_file_formats(filelist_t const &file) {
   return FILE_TYPE_IS_UNKNOWN;
 }
 
+static debugging_option_c s_debug_probe{"probe|probe_file"};
+
+/** \brief Calls a reader's probe function and times it
+
+   \c name is only used for the debug output.
+*/
+template<typename Treader, typename... Targs>
+static bool
+probe(char const *name,
+      mm_io_c *io,
+      int64_t size,
+      Targs... args) {
+  auto start  = std::chrono::steady_clock::now();
+  auto result = !!Treader::probe_file(io, size, args...);
+
+  mxdebug_if(s_debug_probe,
+             boost::format("probe: %1%: %2% in %3% us\n")
+             % name % (result ? "yes" : "no") % std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+  return result;
+}
+
+/** \brief Guesses the file type from a signature at the start of the file
+
+   Only signatures that the corresponding probe function checks for are
+   recognized. None of the probe functions tried before that one in the
+   full chain accepts files with such a signature. Trying it first
+   therefore yields the same result as the full chain would.
+*/
+static file_type_e
+guess_file_type_from_signature(mm_probe_io_c &io) {
+  auto head = io.get_head(12);
+  if (12 > io.get_head_size())
+    return FILE_TYPE_IS_UNKNOWN;
+
+  auto is = [head](size_t offset, char const *signature) {
+    return !memcmp(&head[offset], signature, strlen(signature));
+  };
+
+  return (0x1a45dfa3 == get_uint32_be(head))      ? FILE_TYPE_MATROSKA
+       : is(0, "RIFF") && is(8, "AVI ")           ? FILE_TYPE_AVI
+       : is(0, "RIFF") && is(8, "WAVE")           ? FILE_TYPE_WAV
+       : is(0, "OggS")                            ? FILE_TYPE_OGM
+       : is(0, "fLaC")                            ? FILE_TYPE_FLAC
+       : is(0, ".RMF")                            ? FILE_TYPE_REAL
+       : is(4, "ftyp") || is(4, "moov")
+      || is(4, "mdat") || is(4, "wide")
+      || is(4, "skip") || is(4, "pnot")           ? FILE_TYPE_QTMP4
+       : is(0, "TTA1")                            ? FILE_TYPE_TTA
+       : is(0, "wvpk")                            ? FILE_TYPE_WAVPACK4
+       : is(0, "DKIF")                            ? FILE_TYPE_IVF
+       : is(0, "caff")                            ? FILE_TYPE_COREAUDIO
+       :                                            FILE_TYPE_IS_UNKNOWN;
+}
+
+static bool
+probe_guessed_file_type(file_type_e type,
+                        mm_io_c *io,
+                        int64_t size) {
+  switch (type) {
+    case FILE_TYPE_MATROSKA:  return probe<kax_reader_c>("Matroska", io, size);
+    case FILE_TYPE_AVI:       return probe<avi_reader_c>("AVI", io, size);
+    case FILE_TYPE_WAV:       return probe<wav_reader_c>("WAV", io, size);
+    case FILE_TYPE_OGM:       return probe<ogm_reader_c>("Ogg", io, size);
+    case FILE_TYPE_FLAC:      return probe<flac_reader_c>("FLAC", io, size);
+    case FILE_TYPE_REAL:      return probe<real_reader_c>("RealMedia", io, size);
+    case FILE_TYPE_QTMP4:     return probe<qtmp4_reader_c>("QuickTime/MP4", io, size);
+    case FILE_TYPE_TTA:       return probe<tta_reader_c>("TTA", io, size);
+    case FILE_TYPE_WAVPACK4:  return probe<wavpack_reader_c>("WavPack", io, size);
+    case FILE_TYPE_IVF:       return probe<ivf_reader_c>("IVF", io, size);
+    case FILE_TYPE_COREAUDIO: return probe<coreaudio_reader_c>("CoreAudio", io, size);
+    default:                  return false;
+  }
+}
+
 /** \brief Probe the file type
 
    Opens the input file and calls the \c probe_file function for each known
    file reader class. Uses \c mm_text_io_c for subtitle probing.
+
+   The start of the file is read only once and only as far as the probe
+   functions access it. They read it from memory afterwards. If the file starts with a well-known signature then the
+   corresponding probe function is tried first.
+
+   Pipes and FIFOs are probed on the start of the stream only, which
+   is read up front. Only MPEG transport streams can be read from them
+   as all other readers need to seek.
 */
 static std::pair<file_type_e, int64_t>
 get_file_type_internal(filelist_t &file) {
+  // The largest probe window used for the raw audio formats is 1 MB.
+  static size_t const s_probe_head_size = 1024 * 1024 + 64 * 1024;
+
+  auto start       = std::chrono::steady_clock::now();
   mm_io_cptr af_io = open_input_file(file);
-  mm_io_c *io      = af_io.get();
-  int64_t size     = std::min(io->get_size(), static_cast<int64_t>(1 << 25));
+  memory_cptr stream_head;
+
+  if (file.stream_in) {
+    stream_head = file.stream_in->read_head(s_probe_head_size);
+    af_io       = std::make_shared<mm_mem_io_c>(*stream_head);
+  }
+
+  auto probe_io    = std::make_shared<mm_probe_io_c>(af_io.get(), s_probe_head_size);
+  auto is_playlist = !file.stream_in && !file.is_playlist && open_playlist_file(file, probe_io.get());
 
-  auto is_playlist = !file.is_playlist && open_playlist_file(file, io);
   if (is_playlist)
-    io = file.playlist_mpls_in.get();
+    probe_io = std::make_shared<mm_probe_io_c>(file.playlist_mpls_in.get(), s_probe_head_size);
+
+  // Sources whose size is unknown are probed on their head only.
+  mm_io_c *io  = probe_io.get();
+  int64_t size = 0 > io->get_size() ? static_cast<int64_t>(s_probe_head_size) : std::min(io->get_size(), static_cast<int64_t>(1 << 25));
 
-  file_type_e type = FILE_TYPE_IS_UNKNOWN;
+  file_type_e type = guess_file_type_from_signature(*probe_io);
+
+  if (!probe_guessed_file_type(type, io, size))
+    type = FILE_TYPE_IS_UNKNOWN;
 
   // File types that can be detected unambiguously but are not supported
-  if (aac_adif_reader_c::probe_file(io, size))
+  if (FILE_TYPE_IS_UNKNOWN != type)
+    ;                           // already detected by signature
+  else if (probe<aac_adif_reader_c>("AAC ADIF", io, size))
     type = FILE_TYPE_AAC;
-  else if (asf_reader_c::probe_file(io, size))
+  else if (probe<asf_reader_c>("ASF", io, size))
     type = FILE_TYPE_ASF;
-  else if (cdxa_reader_c::probe_file(io, size))
+  else if (probe<cdxa_reader_c>("CDXA", io, size))
     type = FILE_TYPE_CDXA;
-  else if (flv_reader_c::probe_file(io, size))
+  else if (probe<flv_reader_c>("FLV", io, size))
     type = FILE_TYPE_FLV;
-  else if (hdsub_reader_c::probe_file(io, size))
+  else if (probe<hdsub_reader_c>("HD-DVD sub", io, size))
     type = FILE_TYPE_HDSUB;
 
   // File types that can be detected unambiguously
-  else if (avi_reader_c::probe_file(io, size))
+  else if (probe<avi_reader_c>("AVI", io, size))
     type = FILE_TYPE_AVI;
-  else if (kax_reader_c::probe_file(io, size))
+  else if (probe<kax_reader_c>("Matroska", io, size))
     type = FILE_TYPE_MATROSKA;
-  else if (wav_reader_c::probe_file(io, size))
+  else if (probe<wav_reader_c>("WAV", io, size))
     type = FILE_TYPE_WAV;
-  else if (ogm_reader_c::probe_file(io, size))
+  else if (probe<ogm_reader_c>("Ogg", io, size))
     type = FILE_TYPE_OGM;
-  else if (flac_reader_c::probe_file(io, size))
+  else if (probe<flac_reader_c>("FLAC", io, size))
     type = FILE_TYPE_FLAC;
-  else if (pgssup_reader_c::probe_file(io, size))
+  else if (probe<pgssup_reader_c>("PGS SUP", io, size))
     type = FILE_TYPE_PGSSUP;
-  else if (real_reader_c::probe_file(io, size))
+  else if (probe<real_reader_c>("RealMedia", io, size))
     type = FILE_TYPE_REAL;
-  else if (qtmp4_reader_c::probe_file(io, size))
+  else if (probe<qtmp4_reader_c>("QuickTime/MP4", io, size))
     type = FILE_TYPE_QTMP4;
-  else if (tta_reader_c::probe_file(io, size))
+  else if (probe<tta_reader_c>("TTA", io, size))
     type = FILE_TYPE_TTA;
-  else if (vc1_es_reader_c::probe_file(io, size))
+  else if (probe<vc1_es_reader_c>("VC-1 ES", io, size))
     type = FILE_TYPE_VC1;
-  else if (wavpack_reader_c::probe_file(io, size))
+  else if (probe<wavpack_reader_c>("WavPack", io, size))
     type = FILE_TYPE_WAVPACK4;
-  else if (ivf_reader_c::probe_file(io, size))
+  else if (probe<ivf_reader_c>("IVF", io, size))
     type = FILE_TYPE_IVF;
-  else if (coreaudio_reader_c::probe_file(io, size))
+  else if (probe<coreaudio_reader_c>("CoreAudio", io, size))
     type = FILE_TYPE_COREAUDIO;
-  else if (dirac_es_reader_c::probe_file(io, size))
+  else if (probe<dirac_es_reader_c>("Dirac ES", io, size))
     type = FILE_TYPE_DIRAC;
 
   // All text file types (subtitles).
   else
-    type = detect_text_file_formats(file);
+    type = detect_text_file_formats(file, io);
 
   if (FILE_TYPE_IS_UNKNOWN != type)
     ;                           // intentional fall-through
   // File types that are mis-detected sometimes and that aren't supported
-  else if (dv_reader_c::probe_file(io, size))
+  else if (probe<dv_reader_c>("DV", io, size))
     type = FILE_TYPE_DV;
   // File types that are mis-detected sometimes
-  else if (dts_reader_c::probe_file(io, size, true))
+  else if (probe<dts_reader_c>("DTS (strict)", io, size, true))
     type = FILE_TYPE_DTS;
-  else if (mpeg_ts_reader_c::probe_file(io, size))
+  else if (probe<mpeg_ts_reader_c>("MPEG TS", io, size))
     type = FILE_TYPE_MPEG_TS;
-  else if (mpeg_ps_reader_c::probe_file(io, size))
+  else if (probe<mpeg_ps_reader_c>("MPEG PS", io, size))
     type = FILE_TYPE_MPEG_PS;
-  else if (mpeg_es_reader_c::probe_file(io, size))
+  else if (probe<mpeg_es_reader_c>("MPEG ES", io, size))
     type = FILE_TYPE_MPEG_ES;
   else {
     // File types which are the same in raw format and in other container formats.
@@ -214,36 +339,36 @@ get_file_type_internal(filelist_t &file) {
 
     int i;
     for (i = 0; (0 != s_probe_sizes[i]) && (FILE_TYPE_IS_UNKNOWN == type); ++i)
-      if (mp3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      if (probe<mp3_reader_c>("MP3", io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_MP3;
-      else if (ac3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<ac3_reader_c>("AC3", io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AC3;
-      else if (aac_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<aac_reader_c>("AAC", io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AAC;
   }
   // More file types with detection issues.
   if (type != FILE_TYPE_IS_UNKNOWN)
     ;
-  else if (truehd_reader_c::probe_file(io, size))
+  else if (probe<truehd_reader_c>("TrueHD", io, size))
     type = FILE_TYPE_TRUEHD;
-  else if (dts_reader_c::probe_file(io, size))
+  else if (probe<dts_reader_c>("DTS", io, size))
     type = FILE_TYPE_DTS;
-  else if (vobbtn_reader_c::probe_file(io, size))
+  else if (probe<vobbtn_reader_c>("VobBtn", io, size))
     type = FILE_TYPE_VOBBTN;
 
   // Try some more of the raw audio formats before trying h.264 (which
   // often enough simply works). However, require that the first frame
   // starts at the beginning of the file.
-  else if (mp3_reader_c::probe_file(io, size, 32 * 1024, 1, true))
+  else if (probe<mp3_reader_c>("MP3 (at start)", io, size, 32 * 1024, 1, true))
     type = FILE_TYPE_MP3;
-  else if (ac3_reader_c::probe_file(io, size, 32 * 1024, 1, true))
+  else if (probe<ac3_reader_c>("AC3 (at start)", io, size, 32 * 1024, 1, true))
     type = FILE_TYPE_AC3;
-  else if (aac_reader_c::probe_file(io, size, 32 * 1024, 1, true))
+  else if (probe<aac_reader_c>("AAC (at start)", io, size, 32 * 1024, 1, true))
     type = FILE_TYPE_AAC;
 
-  else if (avc_es_reader_c::probe_file(io, size))
+  else if (probe<avc_es_reader_c>("AVC ES", io, size))
     type = FILE_TYPE_AVC_ES;
-  else if (hevc_es_reader_c::probe_file(io, size))
+  else if (probe<hevc_es_reader_c>("HEVC ES", io, size))
     type = FILE_TYPE_HEVC_ES;
   else {
     // File types which are the same in raw format and in other container formats.
@@ -253,14 +378,22 @@ get_file_type_internal(filelist_t &file) {
 
     int i;
     for (i = 0; (0 != s_probe_sizes[i]) && (FILE_TYPE_IS_UNKNOWN == type); ++i)
-      if (mp3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      if (probe<mp3_reader_c>("MP3", io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_MP3;
-      else if (ac3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<ac3_reader_c>("AC3", io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AC3;
-      else if (aac_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<aac_reader_c>("AAC", io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AAC;
   }
 
+  if (file.stream_in && (FILE_TYPE_IS_UNKNOWN != type) && (FILE_TYPE_MPEG_TS != type))
+    mxerror(boost::format(Y("The file '%1%' is not an MPEG transport stream. Only those can be read from pipes and FIFOs.\n")) % file.name);
+
+  mxdebug_if(s_debug_probe,
+             boost::format("probe: '%1%': type %2% after %3% us; %4% bytes of the head read, %5% further reads with %6% bytes\n")
+             % file.name % static_cast<int>(type) % std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()
+             % probe_io->get_head_size() % probe_io->get_num_deep_reads() % probe_io->get_num_deep_bytes());
+
   return std::make_pair(type, size);
 }
 
@@ -388,6 +521,10 @@ create_readers() {
       }
 
       file->reader->read_headers();
+
+      if (file->stream_in)
+        file->stream_in->release_head();
+
       file->reader->set_timecode_restrictions(file->restricted_timecode_min, file->restricted_timecode_max);
 
       // Re-calculate file size because the reader might switch to a
@@ -0,0 +1,206 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   reader worker threads for threaded demuxing
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "merge/generic_packetizer.h"
+#include "merge/generic_reader.h"
+#include "merge/reader_thread.h"
+
+static thread_local reader_thread_c *tl_current_reader_thread = nullptr;
+
+reader_thread_c::reader_thread_c(generic_reader_c &reader,
+                                 size_t max_reads_queued)
+  : m_reader(reader)
+  , m_num_reads_queued{}
+  , m_max_reads_queued{std::max<size_t>(max_reads_queued, 1)}
+  , m_progress{reader.get_progress()}
+  , m_quit{}
+  , m_finished{}
+  , m_debug{"reader_thread"}
+{
+}
+
+reader_thread_c::~reader_thread_c() {
+  stop();
+}
+
+void
+reader_thread_c::start() {
+  mxdebug_if(m_debug, boost::format("reader_thread: starting worker for '%1%'\n") % m_reader.m_ti.m_fname);
+
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+void
+reader_thread_c::stop() {
+  if (!m_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_quit = true;
+  }
+
+  m_items_consumed.notify_all();
+  m_thread.join();
+}
+
+int
+reader_thread_c::get_progress()
+  const {
+  return m_progress;
+}
+
+/** \brief Replays one \c read() call of the worker on the current thread
+
+   Waits for the worker if necessary. All packets and flushes the
+   reader issued during that call are passed on to the packetizers
+   before the call's status is returned. Errors the worker ran into
+   are reported from here.
+*/
+file_status_e
+reader_thread_c::read() {
+  while (true) {
+    item_t item;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_items_produced.wait(lock, [this]() { return !m_items.empty() || m_finished; });
+
+      if (m_items.empty())
+        return FILE_STATUS_DONE;
+
+      item = std::move(m_items.front());
+      m_items.pop_front();
+
+      if (item_type_e::status == item.type)
+        --m_num_reads_queued;
+    }
+
+    if (item_type_e::status == item.type) {
+      m_items_consumed.notify_all();
+      return item.status;
+
+    } else if (item_type_e::packet == item.type)
+      item.ptzr->process(item.packet);
+
+    else if (item_type_e::flush == item.type)
+      item.ptzr->flush();
+
+    else {
+      try {
+        std::rethrow_exception(item.exception);
+      } catch (mtx::output::error_x &ex) {
+        mxerror(ex.error());
+      }
+    }
+  }
+}
+
+/** \brief Records a packet for the packetizer if called from a worker
+
+   Readers often hand over data that still belongs to them and that
+   they overwrite during their next \c read() call. Such data is
+   copied before it is queued.
+
+   \return \c false if the current thread isn't a reader worker. The
+     caller has to process the packet itself in that case.
+*/
+bool
+reader_thread_c::queue_packet(generic_packetizer_c &ptzr,
+                              packet_cptr const &packet) {
+  if (!tl_current_reader_thread)
+    return false;
+
+  if (packet->data)
+    packet->data->grab();
+  if (packet->codec_state)
+    packet->codec_state->grab();
+  for (auto &data_add : packet->data_adds)
+    data_add->grab();
+
+  tl_current_reader_thread->add_item({ item_type_e::packet, &ptzr, packet, FILE_STATUS_MOREDATA, std::exception_ptr{} });
+
+  return true;
+}
+
+/** \brief Records a flush for the packetizer if called from a worker
+
+   \return \c false if the current thread isn't a reader worker.
+*/
+bool
+reader_thread_c::queue_flush(generic_packetizer_c &ptzr) {
+  if (!tl_current_reader_thread)
+    return false;
+
+  tl_current_reader_thread->add_item({ item_type_e::flush, &ptzr, packet_cptr{}, FILE_STATUS_MOREDATA, std::exception_ptr{} });
+
+  return true;
+}
+
+void
+reader_thread_c::add_item(item_t &&item) {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (item_type_e::status == item.type)
+      ++m_num_reads_queued;
+
+    m_items.push_back(std::move(item));
+  }
+
+  m_items_produced.notify_all();
+}
+
+void
+reader_thread_c::run() {
+  tl_current_reader_thread = this;
+  mtx::output::errors_as_exceptions_c errors_as_exceptions;
+
+  // The readers running on workers ignore the packetizer they're
+  // asked to read for.
+  auto ptzr = m_reader.m_reader_packetizers.front();
+
+  try {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_items_consumed.wait(lock, [this]() { return m_quit || (m_num_reads_queued < m_max_reads_queued); });
+
+        if (m_quit)
+          break;
+      }
+
+      auto status = m_reader.read(ptzr, false);
+      m_progress  = m_reader.get_progress();
+
+      add_item({ item_type_e::status, nullptr, packet_cptr{}, status, std::exception_ptr{} });
+
+      if (FILE_STATUS_DONE == status)
+        break;
+    }
+
+  } catch (...) {
+    add_item({ item_type_e::error, nullptr, packet_cptr{}, FILE_STATUS_DONE, std::current_exception() });
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_finished = true;
+  }
+
+  m_items_produced.notify_all();
+
+  mxdebug_if(m_debug, boost::format("reader_thread: worker for '%1%' finished\n") % m_reader.m_ti.m_fname);
+}
@@ -0,0 +1,96 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the reader worker threads
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_MERGE_READER_THREAD_H
+#define MTX_MERGE_READER_THREAD_H
+
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "merge/file_status.h"
+#include "merge/packet.h"
+
+class generic_packetizer_c;
+class generic_reader_c;
+
+/** \brief Runs a reader's \c read() function on a worker thread
+
+   The worker only demuxes. Whatever the reader hands to its
+   packetizers via \c generic_packetizer_c::process() and
+   \c generic_packetizer_c::flush() is recorded in a queue together
+   with the status each \c read() call returned. The packetizers
+   themselves are never run on the worker.
+
+   The main thread calls \c read() instead of the reader's \c read()
+   function. It replays the recorded calls up to and including the
+   next status on the main thread. The packetizers therefore see
+   exactly the same sequence of calls as with sequential reading.
+
+   Only readers whose \c read() functions do not use their packetizers
+   in any other way may be run like this, see
+   \c generic_reader_c::supports_threaded_reading().
+*/
+class reader_thread_c {
+protected:
+  enum class item_type_e {
+    packet,
+    flush,
+    status,
+    error,
+  };
+
+  struct item_t {
+    item_type_e type;
+    generic_packetizer_c *ptzr;
+    packet_cptr packet;
+    file_status_e status;
+    std::exception_ptr exception;
+  };
+
+  generic_reader_c &m_reader;
+  std::deque<item_t> m_items;
+  size_t m_num_reads_queued, m_max_reads_queued;
+
+  std::mutex m_mutex;
+  std::condition_variable m_items_consumed, m_items_produced;
+  std::thread m_thread;
+  std::atomic<int> m_progress;
+  bool m_quit, m_finished;
+
+  debugging_option_c m_debug;
+
+public:
+  reader_thread_c(generic_reader_c &reader, size_t max_reads_queued);
+  ~reader_thread_c();
+
+  void start();
+  void stop();
+
+  file_status_e read();
+  int get_progress() const;
+
+  static bool queue_packet(generic_packetizer_c &ptzr, packet_cptr const &packet);
+  static bool queue_flush(generic_packetizer_c &ptzr);
+
+protected:
+  void run();
+  void add_item(item_t &&item);
+};
+
+#endif  // MTX_MERGE_READER_THREAD_H
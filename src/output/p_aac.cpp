@@ -74,7 +74,7 @@ aac_packetizer_c::process_headerless(packet_cptr packet) {
 }
 
 int
-aac_packetizer_c::process(packet_cptr packet) {
+aac_packetizer_c::process_impl(packet_cptr packet) {
   m_timecode_calculator.add_timecode(packet);
 
   if (m_headerless)
@@ -88,7 +88,7 @@ aac_packetizer_c::process(packet_cptr packet) {
   while (m_parser.frames_available()) {
     auto frame = m_parser.get_frame();
 
-    process_headerless(std::make_shared<packet_t>(frame.m_data));
+    process_headerless(memory_pool_c::make_shared<packet_t>(frame.m_data));
 
     if (verbose && frame.m_garbage_size)
       mxwarn_tid(m_ti.m_fname, m_ti.m_id, boost::format(Y("Skipping %1% bytes (no valid AAC header found). This might cause audio/video desynchronisation.\n")) % frame.m_garbage_size);
@@ -35,7 +35,6 @@ public:
   aac_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int profile, int samples_per_sec, int channels, bool headerless);
   virtual ~aac_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -44,6 +43,9 @@ public:
 
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
+protected:
+  virtual int process_impl(packet_cptr packet) override;
+
 private:
   virtual int process_headerless(packet_cptr packet);
 };
@@ -97,7 +97,7 @@ ac3_packetizer_c::set_headers() {
 }
 
 int
-ac3_packetizer_c::process(packet_cptr packet) {
+ac3_packetizer_c::process_impl(packet_cptr packet) {
   // if (packet->has_timecode())
   //   mxinfo(boost::format("tc %1% %2% %3% %4%\n") % format_timecode(packet->timecode) % to_hex(packet->data->get_buffer(), std::min<size_t>(packet->data->get_size(), 16))
   //          % mtx::checksum::calculate_as_uint(mtx::checksum::adler32, packet->data->get_buffer(), std::min<size_t>(packet->data->get_size(), 512)) % packet->data->get_size());
@@ -161,7 +161,7 @@ ac3_packetizer_c::flush_packets() {
   while (m_parser.frame_available()) {
     auto frame = get_frame();
     adjust_header_values(frame);
-    set_timecode_and_add_packet(std::make_shared<packet_t>(frame.m_data));
+    set_timecode_and_add_packet(memory_pool_c::make_shared<packet_t>(frame.m_data));
   }
 }
 
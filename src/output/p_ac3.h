@@ -33,7 +33,6 @@ public:
   ac3_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int samples_per_sec, int channels, int bsid, bool framed = false);
   virtual ~ac3_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void flush_packets();
   virtual void set_headers();
 
@@ -44,10 +43,11 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void add_to_buffer(unsigned char *const buf, int size);
   virtual void adjust_header_values(ac3::frame_c const &ac3_header);
   virtual ac3::frame_c get_frame();
-  virtual void flush_impl();
+  virtual void flush_impl() override;
   virtual int process_framed(packet_cptr const &packet);
   virtual void set_timecode_and_add_packet(packet_cptr const &packet);
 };
@@ -31,7 +31,6 @@ protected:
 public:
   mpeg4_p10_es_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti);
 
-  virtual int process(packet_cptr packet);
   virtual void add_extra_data(memory_cptr data);
   virtual void set_headers();
   virtual void set_container_default_field_duration(int64_t default_duration);
@@ -47,10 +46,11 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void handle_delayed_headers();
   virtual void handle_aspect_ratio();
   virtual void handle_actual_default_duration();
-  virtual void flush_impl();
+  virtual void flush_impl() override;
 };
 
 #endif // MTX_P_AVC_H
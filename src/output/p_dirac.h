@@ -31,7 +31,6 @@ protected:
 public:
   dirac_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti);
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -41,7 +40,8 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
-  virtual void flush_impl();
+  virtual int process_impl(packet_cptr packet) override;
+  virtual void flush_impl() override;
   virtual void flush_frames();
   virtual void headers_found();
 };
@@ -37,7 +37,6 @@ public:
   dts_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, mtx::dts::header_t const &dts_header);
   virtual ~dts_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
   virtual void set_skipping_is_normal(bool skipping_is_normal) {
     m_skipping_is_normal = skipping_is_normal;
@@ -49,7 +48,8 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
-  virtual void flush_impl();
+  virtual int process_impl(packet_cptr packet) override;
+  virtual void flush_impl() override;
 
 private:
   virtual memory_cptr get_dts_packet(mtx::dts::header_t &dts_header, bool flushing);
@@ -28,7 +28,6 @@ public:
   hdmv_pgs_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti);
   virtual ~hdmv_pgs_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
   virtual void set_aggregate_packets(bool aggregate_packets) {
     m_aggregate_packets = aggregate_packets;
@@ -38,6 +37,9 @@ public:
     return YT("HDMV PGS");
   }
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
+
+protected:
+  virtual int process_impl(packet_cptr packet) override;
 };
 
 #endif // MTX_P_PGS_H
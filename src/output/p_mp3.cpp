@@ -172,7 +172,7 @@ mp3_packetizer_c::set_headers() {
 }
 
 int
-mp3_packetizer_c::process(packet_cptr packet) {
+mp3_packetizer_c::process_impl(packet_cptr packet) {
   m_timecode_calculator.add_timecode(packet);
 
   unsigned char *mp3_packet;
@@ -182,7 +182,7 @@ mp3_packetizer_c::process(packet_cptr packet) {
 
   while ((mp3_packet = get_mp3_packet(&mp3header))) {
     auto new_timecode = m_timecode_calculator.get_next_timecode(m_samples_per_frame);
-    add_packet(std::make_shared<packet_t>(memory_c::clone(mp3_packet, mp3header.framesize), new_timecode.to_ns(), m_packet_duration));
+    add_packet(memory_pool_c::make_shared<packet_t>(memory_c::clone(mp3_packet, mp3header.framesize), new_timecode.to_ns(), m_packet_duration));
 
     m_first_packet = false;
   }
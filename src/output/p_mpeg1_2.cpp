@@ -172,7 +172,7 @@ mpeg1_2_video_packetizer_c::remove_stuffing_bytes_and_handle_sequence_headers(pa
 }
 
 int
-mpeg1_2_video_packetizer_c::process(packet_cptr packet) {
+mpeg1_2_video_packetizer_c::process_impl(packet_cptr packet) {
   if (0.0 > m_fps)
     extract_fps(packet->data->get_buffer(), packet->data->get_size());
 
@@ -188,11 +188,11 @@ mpeg1_2_video_packetizer_c::process_framed(packet_cptr packet) {
     return FILE_STATUS_MOREDATA;
 
   if (4 > packet->data->get_size())
-    return video_packetizer_c::process(packet);
+    return video_packetizer_c::process_impl(packet);
 
   remove_stuffing_bytes_and_handle_sequence_headers(packet);
 
-  return video_packetizer_c::process(packet);
+  return video_packetizer_c::process_impl(packet);
 }
 
 int
@@ -230,7 +230,7 @@ mpeg1_2_video_packetizer_c::process_unframed(packet_cptr packet) {
 
       remove_stuffing_bytes_and_handle_sequence_headers(new_packet);
 
-      video_packetizer_c::process(new_packet);
+      video_packetizer_c::process_impl(new_packet);
 
       frame->data = nullptr;
       state       = m_parser.GetState();
@@ -243,7 +243,7 @@ mpeg1_2_video_packetizer_c::process_unframed(packet_cptr packet) {
 void
 mpeg1_2_video_packetizer_c::flush_impl() {
   m_parser.SetEOS();
-  generic_packetizer_c::process(new packet_t(new memory_c((unsigned char *)"", 0, false)));
+  process_impl(packet_cptr(new packet_t(new memory_c((unsigned char *)"", 0, false))));
 }
 
 void
@@ -32,20 +32,19 @@ public:
   mpeg1_2_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int version, double fps, int width, int height, int dwidth, int dheight, bool framed);
   virtual ~mpeg1_2_video_packetizer_c();
 
-  virtual int process(packet_cptr packet);
-
   virtual translatable_string_c get_format_name() const {
     return YT("MPEG-1/2");
   }
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void extract_fps(const unsigned char *buffer, int size);
   virtual void extract_aspect_ratio(const unsigned char *buffer, int size);
   virtual void create_private_data();
   virtual int process_framed(packet_cptr packet);
   virtual int process_unframed(packet_cptr packet);
   virtual void remove_stuffing_bytes_and_handle_sequence_headers(packet_cptr packet);
-  virtual void flush_impl();
+  virtual void flush_impl() override;
 };
 
 #endif  // MTX_OUTPUT_P_MPEG1_2_H
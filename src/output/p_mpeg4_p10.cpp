@@ -96,7 +96,7 @@ mpeg4_p10_video_packetizer_c::extract_aspect_ratio() {
 }
 
 int
-mpeg4_p10_video_packetizer_c::process(packet_cptr packet) {
+mpeg4_p10_video_packetizer_c::process_impl(packet_cptr packet) {
   if (VFT_PFRAMEAUTOMATIC == packet->bref) {
     packet->fref = -1;
     packet->bref = m_ref_timecode;
@@ -25,7 +25,6 @@ protected:
 
 public:
   mpeg4_p10_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, double fps, int width, int height);
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
@@ -35,6 +34,7 @@ public:
   }
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void extract_aspect_ratio();
   virtual void setup_nalu_size_len_change();
   virtual void change_nalu_size_len(packet_cptr packet);
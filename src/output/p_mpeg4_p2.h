@@ -59,16 +59,15 @@ public:
   mpeg4_p2_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, double fps, int width, int height, bool input_is_native);
   virtual ~mpeg4_p2_video_packetizer_c();
 
-  virtual int process(packet_cptr packet);
-
   virtual translatable_string_c get_format_name() const {
     return YT("MPEG-4");
   }
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual int process_native(packet_cptr packet);
   virtual int process_non_native(packet_cptr packet);
-  virtual void flush_impl();
+  virtual void flush_impl() override;
   virtual void flush_frames(bool end_of_file);
   virtual void extract_aspect_ratio(const unsigned char *buffer, int size);
   virtual void extract_size(const unsigned char *buffer, int size);
@@ -31,7 +31,6 @@ public:
   opus_packetizer_c(generic_reader_c *reader,  track_info_c &ti);
   virtual ~opus_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -40,6 +39,9 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
   virtual bool is_compatible_with(output_compatibility_e compatibility);
+
+protected:
+  virtual int process_impl(packet_cptr packet) override;
 };
 
 #endif  // MTX_P_OPUS_H
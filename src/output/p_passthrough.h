@@ -22,13 +22,19 @@ class passthrough_packetizer_c: public generic_packetizer_c {
 public:
   passthrough_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti);
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
+  virtual bool accepts_read_only_data() const {
+    return true;
+  }
+
   virtual translatable_string_c get_format_name() const {
     return YT("passthrough");
   }
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
+
+protected:
+  virtual int process_impl(packet_cptr packet) override;
 };
 
 #endif // MTX_P_PASSTHROUGH_H
@@ -40,7 +40,6 @@ public:
   pcm_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int p_samples_per_sec, int channels, int bits_per_sample, pcm_format_e format = little_endian_integer);
   virtual ~pcm_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -49,8 +48,9 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual int process_packaged(packet_cptr const &packet);
-  virtual void flush_impl();
+  virtual void flush_impl() override;
   virtual int64_t size_to_samples(int64_t size) const;
   virtual int64_t samples_to_size(int64_t size) const;
 };
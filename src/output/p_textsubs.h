@@ -29,7 +29,6 @@ public:
   textsubs_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, const char *codec_id, bool recode, bool is_utf8);
   virtual ~textsubs_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -37,6 +36,9 @@ public:
   }
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
+protected:
+  virtual int process_impl(packet_cptr packet) override;
+
 private:
   static boost::regex s_re_remove_cr, s_re_translate_nl, s_re_remove_trailing_nl;
 };
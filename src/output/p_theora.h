@@ -22,13 +22,13 @@ class theora_video_packetizer_c: public video_packetizer_c {
 public:
   theora_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, double fps, int width, int height);
   virtual void set_headers();
-  virtual int process(packet_cptr packet);
 
   virtual translatable_string_c get_format_name() const {
     return YT("Theora");
   }
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void extract_aspect_ratio();
 };
 
@@ -33,7 +33,6 @@ public:
   truehd_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, truehd_frame_t::codec_e codec, int sampling_rate, int channels);
   virtual ~truehd_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void process_framed(truehd_frame_cptr const &frame, int64_t provided_timecode);
   virtual void set_headers();
 
@@ -44,9 +43,10 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void adjust_header_values(truehd_frame_cptr const &frame);
 
-  virtual void flush_impl();
+  virtual void flush_impl() override;
   virtual void flush_frames();
 };
 
@@ -113,7 +113,7 @@ vc1_video_packetizer_c::add_timecodes_to_parser(packet_cptr &packet) {
 }
 
 int
-vc1_video_packetizer_c::process(packet_cptr packet) {
+vc1_video_packetizer_c::process_impl(packet_cptr packet) {
   add_timecodes_to_parser(packet);
 
   m_parser.add_bytes(packet->data->get_buffer(), packet->data->get_size());
@@ -30,7 +30,6 @@ protected:
 public:
   vc1_video_packetizer_c(generic_reader_c *n_reader, track_info_c &n_ti);
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -40,7 +39,8 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
-  virtual void flush_impl();
+  virtual int process_impl(packet_cptr packet) override;
+  virtual void flush_impl() override;
   virtual void flush_frames();
   virtual void headers_found();
   virtual void add_timecodes_to_parser(packet_cptr &packet);
@@ -38,7 +38,6 @@ protected:
 public:
   video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, const char *codec_id, double fps, int width, int height);
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -47,6 +46,7 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
 protected:
+  virtual int process_impl(packet_cptr packet) override;
   virtual void check_fourcc();
   virtual void rederive_frame_type(packet_cptr &packet);
   virtual void rederive_frame_type_div3(packet_cptr &packet);
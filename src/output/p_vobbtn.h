@@ -29,13 +29,15 @@ public:
   vobbtn_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int width, int height);
   virtual ~vobbtn_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
     return YT("VobBtn");
   }
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
+
+protected:
+  virtual int process_impl(packet_cptr packet) override;
 };
 
 #endif // MTX_P_VOBBTN_H
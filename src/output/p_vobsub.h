@@ -24,7 +24,6 @@ public:
   vobsub_packetizer_c(generic_reader_c *reader, track_info_c &ti);
   virtual ~vobsub_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -32,6 +31,9 @@ public:
   }
   virtual connection_result_e can_connect_to(generic_packetizer_c *src,
                                              std::string &error_message);
+
+protected:
+  virtual int process_impl(packet_cptr packet) override;
 };
 
 #endif // MTX_P_VOBSUB_H
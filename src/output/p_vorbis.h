@@ -53,7 +53,6 @@ public:
                       unsigned char *d_codecsetup, int l_codecsetup);
   virtual ~vorbis_packetizer_c();
 
-  virtual int process(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
@@ -62,6 +61,9 @@ public:
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
 
   virtual bool is_compatible_with(output_compatibility_e compatibility);
+
+protected:
+  virtual int process_impl(packet_cptr packet) override;
 };
 
 #endif  // MTX_P_VORBIS_H
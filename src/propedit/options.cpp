@@ -14,6 +14,8 @@
 #include <matroska/KaxTag.h>
 #include <matroska/KaxTags.h>
 
+#include "common/mm_io_x.h"
+#include "common/strings/editing.h"
 #include "propedit/chapter_target.h"
 #include "propedit/options.h"
 #include "propedit/propedit.h"
@@ -24,16 +26,28 @@
 options_c::options_c()
   : m_show_progress(false)
   , m_parse_mode(kax_analyzer_c::parse_mode_fast)
+  , m_batch_mode(false)
+  , m_batch_threads(0)
 {
 }
 
 void
 options_c::validate() {
-  if (m_file_name.empty())
-    mxerror(Y("No file name given.\n"));
+  if (m_batch_mode) {
+    if (m_batch_entries.empty())
+      mxerror(Y("No file name given.\n"));
 
-  if (!has_changes())
-    mxerror(Y("Nothing to do.\n"));
+    auto has_file_specific_args = std::any_of(m_batch_entries.begin(), m_batch_entries.end(), [](batch_entry_t const &entry) { return !entry.m_args.empty(); });
+    if (!has_changes() && !has_file_specific_args)
+      mxerror(Y("Nothing to do.\n"));
+
+  } else {
+    if (m_file_name.empty())
+      mxerror(Y("No file name given.\n"));
+
+    if (!has_changes())
+      mxerror(Y("Nothing to do.\n"));
+  }
 
   for (auto &target : m_targets)
     target->validate();
@@ -115,6 +129,45 @@ options_c::set_parse_mode(const std::string &parse_mode) {
     throw false;
 }
 
+void
+options_c::add_batch_entry(std::string const &file_name,
+                           std::vector<std::string> const &args) {
+  m_batch_entries.push_back(batch_entry_t{ file_name, args });
+}
+
+/** \brief Reads the list of files to process in batch mode
+
+   Each line contains one file name. It may be followed by additional
+   arguments that only apply to this file, e.g. further '--edit' and
+   '--set' options. The file name and the arguments are separated by tab
+   characters. Empty lines and lines starting with '#' are ignored.
+*/
+void
+options_c::read_batch_file(std::string const &file_name) {
+  mm_text_io_c in(new mm_file_io_c(file_name));
+  std::string line;
+
+  while (in.getline2(line)) {
+    strip(line, true);
+    if (!line.empty() && ('#' != line[0]))
+      m_batch_entries.push_back(parse_batch_line(line));
+  }
+
+  m_batch_mode = true;
+}
+
+options_c::batch_entry_t
+options_c::parse_batch_line(std::string const &line) {
+  auto parts = split(line, "\t");
+  auto entry = batch_entry_t{ parts[0], std::vector<std::string>{} };
+
+  for (auto idx = 1u; idx < parts.size(); ++idx)
+    if (!parts[idx].empty())
+      entry.m_args.push_back(parts[idx]);
+
+  return entry;
+}
+
 void
 options_c::dump_info()
   const
@@ -122,10 +175,13 @@ options_c::dump_info()
   mxinfo(boost::format("options:\n"
                        "  file_name:     %1%\n"
                        "  show_progress: %2%\n"
-                       "  parse_mode:    %3%\n")
+                       "  parse_mode:    %3%\n"
+                       "  batch_mode:    %4% (%5% files)\n")
          % m_file_name
          % m_show_progress
-         % static_cast<int>(m_parse_mode));
+         % static_cast<int>(m_parse_mode)
+         % m_batch_mode
+         % m_batch_entries.size());
 
   for (auto &target : m_targets)
     target->dump_info();
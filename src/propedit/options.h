@@ -19,13 +19,28 @@
 #include "propedit/attachment_target.h"
 #include "propedit/target.h"
 
+class options_c;
+using options_cptr = std::shared_ptr<options_c>;
+
 class options_c {
 public:
+  struct batch_entry_t {
+    std::string m_file_name;
+    std::vector<std::string> m_args;
+  };
+
   std::string m_file_name;
   std::vector<target_cptr> m_targets;
   bool m_show_progress;
   kax_analyzer_c::parse_mode_e m_parse_mode;
 
+  // Batch mode: the actions from the command line are re-parsed for
+  // each file together with that file's additional arguments.
+  bool m_batch_mode;
+  unsigned int m_batch_threads;
+  std::vector<std::string> m_action_args;
+  std::vector<batch_entry_t> m_batch_entries;
+
 public:
   options_c();
 
@@ -38,6 +53,8 @@ public:
   void add_attachment_command(attachment_target_c::command_e command, std::string const &spec, attachment_target_c::options_t const &options);
   void set_file_name(const std::string &file_name);
   void set_parse_mode(const std::string &parse_mode);
+  void add_batch_entry(std::string const &file_name, std::vector<std::string> const &args = std::vector<std::string>{});
+  void read_batch_file(std::string const &file_name);
   void dump_info() const;
   bool has_changes() const;
 
@@ -48,7 +65,9 @@ public:
 protected:
   void remove_empty_targets();
   void merge_targets();
+
+public:
+  static batch_entry_t parse_batch_line(std::string const &line);
 };
-using options_cptr = std::shared_ptr<options_c>;
 
 #endif // MTX_PROPEDIT_OPTIONS_H
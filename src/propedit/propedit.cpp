@@ -10,6 +10,8 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+
 #include <matroska/KaxChapters.h>
 #include <matroska/KaxInfo.h>
 #include <matroska/KaxTags.h>
@@ -17,10 +19,24 @@
 
 #include "common/command_line.h"
 #include "common/mm_io_x.h"
+#include "common/strings/editing.h"
+#include "common/thread_pool.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
+#include "propedit/propedit.h"
 #include "propedit/propedit_cli_parser.h"
 
+struct batch_result_t {
+  std::string m_error;
+  std::vector<std::string> m_warnings;
+};
+
+// The result of the file the current thread works on in batch mode.
+static thread_local batch_result_t *tl_batch_result = nullptr;
+
+// The command line parser uses global state (e.g. the usage text).
+static std::mutex s_batch_parser_mutex;
+
 static void
 display_update_element_result(const EbmlCallbacks &callbacks,
                               kax_analyzer_c::update_element_result_e result) {
@@ -79,7 +95,7 @@ write_changes(options_cptr &options,
 }
 
 static void
-run(options_cptr &options) {
+process_file(options_cptr &options) {
   console_kax_analyzer_cptr analyzer;
 
   try {
@@ -121,10 +137,117 @@ run(options_cptr &options) {
   write_changes(options, analyzer.get());
 
   mxinfo(Y("Done.\n"));
+}
+
+static void
+run(options_cptr &options) {
+  process_file(options);
 
   mxexit();
 }
 
+/** \brief Modifies a single file in batch mode
+
+   The actions given on the command line are parsed again together with
+   the file's own arguments. This creates a fresh set of targets for the
+   file as the targets keep state about the file they're applied to.
+*/
+static void
+process_batch_entry(std::vector<std::string> const &action_args,
+                    options_c::batch_entry_t const &entry,
+                    batch_result_t &result) {
+  tl_batch_result = &result;
+
+  try {
+    auto args = action_args;
+    args.insert(args.end(), entry.m_args.begin(), entry.m_args.end());
+    args.push_back(entry.m_file_name);
+
+    options_cptr options;
+    {
+      std::lock_guard<std::mutex> lock{s_batch_parser_mutex};
+      options = propedit_cli_parser_c(args).run();
+    }
+
+    options->m_show_progress = false;
+
+    process_file(options);
+
+  } catch (mtx::propedit::batch_file_x &ex) {
+    result.m_error = ex.what();
+
+  } catch (std::exception &ex) {
+    result.m_error = ex.what();
+
+  } catch (...) {
+    result.m_error = Y("An unknown error occurred.");
+  }
+
+  tl_batch_result = nullptr;
+}
+
+/** \brief Applies the actions to all files on a thread pool
+
+   Messages of the individual files are not output while they're being
+   processed. Errors abort the modification of the current file only,
+   and they as well as warnings are reported in the order of the files
+   once each file is done, followed by a summary.
+*/
+static void
+run_batch(options_cptr &options) {
+  set_mxmsg_handler(MXMSG_INFO, [](unsigned int, std::string const &) {});
+
+  set_mxmsg_handler(MXMSG_WARNING, [](unsigned int, std::string const &message) {
+    if (tl_batch_result)
+      tl_batch_result->m_warnings.push_back(strip_copy(message, true));
+  });
+
+  set_mxmsg_handler(MXMSG_ERROR, [](unsigned int, std::string const &message) {
+    throw mtx::propedit::batch_file_x{strip_copy(message, true)};
+  });
+
+  auto const &entries = options->m_batch_entries;
+  auto results        = std::vector<batch_result_t>(entries.size());
+  auto futures        = std::vector<std::future<void>>{};
+  auto num_failed     = 0u;
+  auto num_warned     = 0u;
+
+  {
+    thread_pool_c pool{options->m_batch_threads};
+
+    mxmsg(MXMSG_INFO, boost::format(Y("Modifying %1% files with %2% threads.\n")) % entries.size() % pool.get_num_threads());
+
+    futures.reserve(entries.size());
+    for (auto idx = 0u; idx < entries.size(); ++idx)
+      futures.emplace_back(pool.submit(std::bind(process_batch_entry, std::cref(options->m_action_args), std::cref(entries[idx]), std::ref(results[idx]))));
+
+    for (auto idx = 0u; idx < entries.size(); ++idx) {
+      futures[idx].get();
+
+      auto const &result = results[idx];
+
+      for (auto const &warning : result.m_warnings)
+        mxmsg(MXMSG_WARNING, (boost::format(Y("'%1%': %2%")) % entries[idx].m_file_name % warning).str() + "\n");
+
+      if (!result.m_error.empty())
+        mxmsg(MXMSG_ERROR, (boost::format(Y("'%1%': %2%")) % entries[idx].m_file_name % result.m_error).str() + "\n");
+      else
+        mxmsg(MXMSG_INFO, (boost::format(Y("'%1%': %2%")) % entries[idx].m_file_name % Y("Done.")).str() + "\n");
+
+      num_failed += result.m_error.empty()    ? 0 : 1;
+      num_warned += result.m_warnings.empty() ? 0 : 1;
+    }
+  }
+
+  mxmsg(MXMSG_INFO, boost::format(Y("Batch summary: %1% files modified successfully, %2% with warnings, %3% failed.\n"))
+        % (entries.size() - num_failed) % num_warned % num_failed);
+
+  if (num_warned)
+    g_warning_issued = true;
+
+  mxexit(num_failed ? 2 : -1);
+}
+
 static
 void setup(char **argv) {
   mtx_common_init("mkvpropedit", argv[0]);
@@ -150,7 +273,10 @@ main(int argc,
     options->dump_info();
   }
 
-  run(options);
+  if (options->m_batch_mode)
+    run_batch(options);
+  else
+    run(options);
 
   mxexit();
 }
@@ -15,6 +15,24 @@
 
 #include "common/common_pch.h"
 
+#include "common/error.h"
+
 #define FILE_NOT_MODIFIED Y("The file has not been modified.")
 
+namespace mtx { namespace propedit {
+
+class batch_file_x: public exception {
+protected:
+  std::string m_message;
+public:
+  batch_file_x(std::string const &message) : m_message(message) { }
+  virtual ~batch_file_x() throw() { }
+
+  virtual const char *what() const throw() {
+    return m_message.c_str();
+  }
+};
+
+}}
+
 #endif // MTX_PROPEDIT_PROPEDIT_H
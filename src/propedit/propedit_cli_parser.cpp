@@ -14,6 +14,9 @@
 #include "common/common_pch.h"
 
 #include "common/ebml.h"
+#include "common/kax_analyzer.h"
+#include "common/mm_io_x.h"
+#include "common/strings/parsing.h"
 #include "common/strings/formatting.h"
 #include "common/translation.h"
 #include "propedit/propedit_cli_parser.h"
@@ -34,6 +37,11 @@ propedit_cli_parser_c::set_parse_mode() {
   }
 }
 
+void
+propedit_cli_parser_c::enable_index_cache() {
+  kax_analyzer_c::enable_index_cache(true);
+}
+
 void
 propedit_cli_parser_c::add_target() {
   try {
@@ -179,10 +187,51 @@ propedit_cli_parser_c::list_property_names_for_table(const std::vector<property_
 
 void
 propedit_cli_parser_c::set_file_name() {
-  m_options->set_file_name(m_current_arg);
+  m_file_names.push_back(m_current_arg);
+}
+
+void
+propedit_cli_parser_c::enable_batch_mode() {
+  m_options->m_batch_mode = true;
+}
+
+void
+propedit_cli_parser_c::read_batch_file() {
+  try {
+    m_options->read_batch_file(m_next_arg);
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(boost::format(Y("The batch file '%1%' could not be read: %2%.\n")) % m_next_arg % ex);
+  }
+}
+
+void
+propedit_cli_parser_c::set_batch_threads() {
+  if (!parse_number(m_next_arg, m_options->m_batch_threads) || !m_options->m_batch_threads)
+    mxerror(boost::format(Y("Invalid number of threads in '%1% %2%'.\n")) % m_current_arg % m_next_arg);
+}
+
+/** \brief Adds an option that modifies the file
+
+   The arguments of such options are recorded so that they can be
+   parsed again for each file in batch mode.
+*/
+void
+propedit_cli_parser_c::add_action(std::string const &spec,
+                                  cli_parser_cb_t const &callback,
+                                  translatable_string_c const &description) {
+  auto needs_arg = std::string::npos != spec.find('=');
+
+  add_option(spec, [this, callback, needs_arg]() {
+    m_options->m_action_args.push_back(m_current_arg);
+    if (needs_arg)
+      m_options->m_action_args.push_back(m_next_arg);
+
+    callback();
+  }, description);
 }
 
-#define OPT(spec, func, description) add_option(spec, std::bind(&propedit_cli_parser_c::func, this), description)
+#define OPT(spec, func, description)    add_option(spec, std::bind(&propedit_cli_parser_c::func, this), description)
+#define ACTION(spec, func, description) add_action(spec, std::bind(&propedit_cli_parser_c::func, this), description)
 
 void
 propedit_cli_parser_c::init_parser() {
@@ -190,30 +239,38 @@ propedit_cli_parser_c::init_parser() {
 
   add_section_header(YT("Options"));
   OPT("l|list-property-names",      list_property_names, YT("List all valid property names and exit"));
-  OPT("p|parse-mode=<mode>",        set_parse_mode,      YT("Sets the Matroska parser mode to 'fast' (default) or 'full'"));
+  ACTION("p|parse-mode=<mode>",     set_parse_mode,      YT("Sets the Matroska parser mode to 'fast' (default) or 'full'"));
+  OPT("index-cache",                enable_index_cache,  YT("Stores the list of top level elements in a cache file next to the file "
+                                                            "and uses it instead of scanning the file again"));
 
   add_section_header(YT("Actions for handling properties"));
-  OPT("e|edit=<selector>",          add_target,          YT("Sets the Matroska file section that all following add/set/delete "
+  ACTION("e|edit=<selector>",       add_target,          YT("Sets the Matroska file section that all following add/set/delete "
                                                             "actions operate on (see below and man page for syntax)"));
-  OPT("a|add=<name=value>",         add_change,          YT("Adds a property with the value even if such a property already "
+  ACTION("a|add=<name=value>",      add_change,          YT("Adds a property with the value even if such a property already "
                                                             "exists"));
-  OPT("s|set=<name=value>",         add_change,          YT("Sets a property to the value if it exists and add it otherwise"));
-  OPT("d|delete=<name>",            add_change,          YT("Delete all occurences of a property"));
+  ACTION("s|set=<name=value>",      add_change,          YT("Sets a property to the value if it exists and add it otherwise"));
+  ACTION("d|delete=<name>",         add_change,          YT("Delete all occurences of a property"));
 
   add_section_header(YT("Actions for handling tags and chapters"));
-  OPT("t|tags=<selector:filename>", add_tags,            YT("Add or replace tags in the file with the ones from 'filename' "
+  ACTION("t|tags=<selector:filename>", add_tags,         YT("Add or replace tags in the file with the ones from 'filename' "
                                                             "or remove them if 'filename' is empty "
                                                             "(see below and man page for syntax)"));
-  OPT("c|chapters=<filename>",      add_chapters,        YT("Add or replace chapters in the file with the ones from 'filename' "
+  ACTION("c|chapters=<filename>",   add_chapters,        YT("Add or replace chapters in the file with the ones from 'filename' "
                                                             "or remove them if 'filename' is empty"));
 
   add_section_header(YT("Actions for handling attachments"));
-  OPT("add-attachment=<filename>",                         add_attachment,             YT("Add the file 'filename' as a new attachment"));
-  OPT("replace-attachment=<attachment-selector:filename>", replace_attachment,         YT("Replace an attachment with the file 'filename'"));
-  OPT("delete-attachment=<attachment-selector>",           delete_attachment,          YT("Delete one or more attachments"));
-  OPT("attachment-name=<name>",                            set_attachment_name,        YT("Set the name to use for the following '--add-attachment' or '--replace-attachment' option"));
-  OPT("attachment-description=<description>",              set_attachment_description, YT("Set the description to use for the following '--add-attachment' or '--replace-attachment' option"));
-  OPT("attachment-mime-type=<mime-type>",                  set_attachment_mime_type,   YT("Set the MIME type to use for the following '--add-attachment' or '--replace-attachment' option"));
+  ACTION("add-attachment=<filename>",                         add_attachment,             YT("Add the file 'filename' as a new attachment"));
+  ACTION("replace-attachment=<attachment-selector:filename>", replace_attachment,         YT("Replace an attachment with the file 'filename'"));
+  ACTION("delete-attachment=<attachment-selector>",           delete_attachment,          YT("Delete one or more attachments"));
+  ACTION("attachment-name=<name>",                            set_attachment_name,        YT("Set the name to use for the following '--add-attachment' or '--replace-attachment' option"));
+  ACTION("attachment-description=<description>",              set_attachment_description, YT("Set the description to use for the following '--add-attachment' or '--replace-attachment' option"));
+  ACTION("attachment-mime-type=<mime-type>",                  set_attachment_mime_type,   YT("Set the MIME type to use for the following '--add-attachment' or '--replace-attachment' option"));
+
+  add_section_header(YT("Batch mode"));
+  OPT("batch",                      enable_batch_mode,   YT("Apply the actions to all files given on the command line instead of a single one"));
+  OPT("batch-file=<file>",          read_batch_file,     YT("Apply the actions to all files listed in 'file' (one per line); additional actions "
+                                                            "for a single file can follow its name separated by tab characters"));
+  OPT("batch-threads=<n>",          set_batch_threads,   YT("Number of files modified at the same time in batch mode (default: number of CPUs)"));
 
   add_section_header(YT("Other options"));
   add_common_options();
@@ -247,11 +304,18 @@ propedit_cli_parser_c::init_parser() {
 }
 
 #undef OPT
+#undef ACTION
 
 void
 propedit_cli_parser_c::validate() {
   if (m_attachment.m_name || m_attachment.m_description || m_attachment.m_mime_type)
     mxerror(Y("One of the options '--attachment-name', '--attachment-description' or '--attachment-mime-type' has been used without a following '--add-attachment' or '--replace-attachment' option.\n"));
+
+  for (auto const &file_name : m_file_names)
+    if (m_options->m_batch_mode)
+      m_options->add_batch_entry(file_name);
+    else
+      m_options->set_file_name(file_name);
 }
 
 options_cptr
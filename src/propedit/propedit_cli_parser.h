@@ -22,6 +22,7 @@ protected:
   options_cptr m_options;
   target_cptr m_target;
   attachment_target_c::options_t m_attachment;
+  std::vector<std::string> m_file_names;
 
 public:
   propedit_cli_parser_c(const std::vector<std::string> &args);
@@ -32,13 +33,20 @@ protected:
   void init_parser();
   void validate();
 
+  void add_action(std::string const &spec, cli_parser_cb_t const &callback, translatable_string_c const &description);
+
   void add_target();
   void add_change();
   void add_tags();
   void add_chapters();
   void set_parse_mode();
+  void enable_index_cache();
   void set_file_name();
 
+  void enable_batch_mode();
+  void read_batch_file();
+  void set_batch_threads();
+
   void set_attachment_name();
   void set_attachment_description();
   void set_attachment_mime_type();
@@ -0,0 +1,195 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   micro-benchmark harness
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <random>
+
+#include "tests/benchmarks/benchmark.h"
+
+namespace mtxbench {
+
+state_c::state_c(std::chrono::nanoseconds min_time)
+  : m_min_time{min_time}
+  , m_elapsed{}
+  , m_running{}
+  , m_num_iterations{}
+  , m_num_bytes{}
+  , m_num_frames{}
+{
+}
+
+bool
+state_c::keep_running() {
+  if (m_running) {
+    m_elapsed += clock_t::now() - m_started_at;
+    ++m_num_iterations;
+
+    if (m_elapsed >= m_min_time) {
+      m_running = false;
+      return false;
+    }
+  }
+
+  m_running    = true;
+  m_started_at = clock_t::now();
+
+  return true;
+}
+
+void
+state_c::pause_timing() {
+  m_elapsed += clock_t::now() - m_started_at;
+}
+
+void
+state_c::resume_timing() {
+  m_started_at = clock_t::now();
+}
+
+std::vector<benchmark_t> &
+get_benchmarks() {
+  static std::vector<benchmark_t> s_benchmarks;
+  return s_benchmarks;
+}
+
+registrar_c::registrar_c(std::string const &name,
+                         function_t const &function) {
+  get_benchmarks().push_back({ name, function });
+}
+
+static bool
+matches_filters(std::string const &name,
+                std::vector<std::string> const &filters) {
+  if (filters.empty())
+    return true;
+
+  for (auto const &filter : filters)
+    if (std::string::npos != name.find(filter))
+      return true;
+
+  return false;
+}
+
+static std::string
+format_rate(uint64_t amount,
+            double seconds,
+            double unit) {
+  if (!amount || (0 >= seconds))
+    return "-";
+
+  return (boost::format("%|1$.1f|") % (amount / unit / seconds)).str();
+}
+
+/** \brief Runs all benchmarks whose names contain one of the filters
+
+   All benchmarks are run if no filter is given. The results are
+   output as one line per benchmark.
+
+   \return The number of benchmarks that failed with an exception.
+*/
+int
+run_benchmarks(std::vector<std::string> const &filters,
+               std::chrono::nanoseconds min_time) {
+  auto benchmarks = get_benchmarks();
+  auto num_failed = 0;
+
+  brng::sort(benchmarks, [](benchmark_t const &a, benchmark_t const &b) { return a.m_name < b.m_name; });
+
+  mxinfo(boost::format("%|1$-36s| %|2$10s| %|3$12s| %|4$10s| %|5$12s|\n") % "benchmark" % "iterations" % "ms/iteration" % "MB/s" % "frames/s");
+
+  for (auto const &benchmark : benchmarks) {
+    if (!matches_filters(benchmark.m_name, filters))
+      continue;
+
+    state_c state{min_time};
+
+    try {
+      benchmark.m_function(state);
+
+    } catch (std::exception &ex) {
+      mxinfo(boost::format("%|1$-36s| failed: %2%\n") % benchmark.m_name % ex.what());
+      ++num_failed;
+      continue;
+    }
+
+    auto seconds        = std::chrono::duration<double>(state.get_elapsed()).count();
+    auto num_iterations = std::max<uint64_t>(state.get_num_iterations(), 1);
+
+    mxinfo(boost::format("%|1$-36s| %|2$10d| %|3$12.3f| %|4$10s| %|5$12s|\n")
+           % benchmark.m_name
+           % state.get_num_iterations()
+           % (seconds * 1000 / num_iterations)
+           % format_rate(state.get_num_bytes(),  seconds, 1024 * 1024)
+           % format_rate(state.get_num_frames(), seconds, 1));
+  }
+
+  return num_failed;
+}
+
+std::string
+random_data(std::size_t size,
+            unsigned int seed) {
+  auto generator = std::mt19937{seed};
+  auto data      = std::string(size, '\0');
+
+  for (auto &byte : data)
+    byte = static_cast<char>(generator() & 0xff);
+
+  return data;
+}
+
+/** \brief Generates random data that does not contain start codes
+
+   Used as payload for synthetic elementary streams: without zero bytes
+   the data contains neither start codes nor sequences that would need
+   emulation prevention bytes.
+*/
+std::string
+random_data_without_zero_bytes(std::size_t size,
+                               unsigned int seed) {
+  auto generator = std::mt19937{seed};
+  auto data      = std::string(size, '\0');
+
+  for (auto &byte : data)
+    byte = static_cast<char>(1 + generator() % 255);
+
+  return data;
+}
+
+/** \brief Generates text-like data that compresses with a ratio similar to subtitles
+*/
+std::string
+compressible_data(std::size_t size,
+                  unsigned int seed) {
+  static char const * const s_words[] = {
+    "the", "chunky", "bacon", "is", "a", "frame", "and", "subtitle",
+    "with", "some", "track", "of", "audio", "video", "in", "cluster",
+  };
+
+  auto generator = std::mt19937{seed};
+  auto data      = std::string{};
+
+  data.reserve(size + 32);
+
+  for (auto idx = 1u; data.size() < size; ++idx) {
+    data += s_words[generator() % 16];
+    data += 0 == (idx % 12) ? (boost::format("\n%1%\n") % (generator() % 10000)).str() : std::string{" "};
+  }
+
+  data.resize(size);
+
+  return data;
+}
+
+}
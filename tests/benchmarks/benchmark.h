@@ -0,0 +1,109 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   definitions for the micro-benchmark harness
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_TESTS_BENCHMARKS_BENCHMARK_H
+#define MTX_TESTS_BENCHMARKS_BENCHMARK_H
+
+#include "common/common_pch.h"
+
+#include <chrono>
+
+namespace mtxbench {
+
+/** \brief State of a single benchmark run
+
+   A benchmark function prepares its input and then calls
+   \c keep_running() in a loop. Each loop iteration processes the input
+   once and reports how many bytes and frames it has processed. Only
+   the time spent inside the loop is measured; \c pause_timing() and
+   \c resume_timing() exclude work that has to be redone for each
+   iteration (e.g. re-filling a container that the measured code
+   empties).
+*/
+class state_c {
+protected:
+  using clock_t = std::chrono::steady_clock;
+
+  std::chrono::nanoseconds m_min_time, m_elapsed;
+  clock_t::time_point m_started_at;
+  bool m_running;
+  uint64_t m_num_iterations, m_num_bytes, m_num_frames;
+
+public:
+  explicit state_c(std::chrono::nanoseconds min_time);
+
+  bool keep_running();
+  void pause_timing();
+  void resume_timing();
+
+  void add_bytes(uint64_t num_bytes) {
+    m_num_bytes += num_bytes;
+  }
+
+  void add_frames(uint64_t num_frames) {
+    m_num_frames += num_frames;
+  }
+
+  uint64_t get_num_iterations() const {
+    return m_num_iterations;
+  }
+
+  uint64_t get_num_bytes() const {
+    return m_num_bytes;
+  }
+
+  uint64_t get_num_frames() const {
+    return m_num_frames;
+  }
+
+  std::chrono::nanoseconds get_elapsed() const {
+    return m_elapsed;
+  }
+};
+
+using function_t = std::function<void(state_c &)>;
+
+struct benchmark_t {
+  std::string m_name;
+  function_t m_function;
+};
+
+std::vector<benchmark_t> &get_benchmarks();
+
+class registrar_c {
+public:
+  registrar_c(std::string const &name, function_t const &function);
+};
+
+int run_benchmarks(std::vector<std::string> const &filters, std::chrono::nanoseconds min_time);
+
+// Reproducible synthetic input data
+std::string random_data(std::size_t size, unsigned int seed);
+std::string random_data_without_zero_bytes(std::size_t size, unsigned int seed);
+std::string compressible_data(std::size_t size, unsigned int seed);
+
+}
+
+#define MTXBENCH_CONCAT_2(a, b) a ## b
+#define MTXBENCH_CONCAT(a, b)   MTXBENCH_CONCAT_2(a, b)
+
+/** \brief Registers the function \c function under the name \c name
+
+   Names consist of groups separated by slashes, e.g.
+   "common/checksum/md5". They are used for selecting benchmarks on
+   the command line.
+*/
+#define MTXBENCH_REGISTER(name, function) \
+  static ::mtxbench::registrar_c MTXBENCH_CONCAT(s_mtxbench_registrar_, __LINE__){name, function}
+
+#endif // MTX_TESTS_BENCHMARKS_BENCHMARK_H
@@ -0,0 +1,30 @@
+#include "common/common_pch.h"
+
+#include "common/checksums/base.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+void
+run_checksum(mtxbench::state_c &state,
+             mtx::checksum::algorithm_e algorithm) {
+  auto const frame_size = 4096u;
+  auto data             = mtxbench::random_data(16 * 1024 * 1024, 1);
+  auto num_frames       = data.size() / frame_size;
+  auto buffer           = reinterpret_cast<unsigned char const *>(data.c_str());
+
+  while (state.keep_running()) {
+    for (auto idx = 0u; idx < num_frames; ++idx)
+      mtx::checksum::calculate(algorithm, buffer + idx * frame_size, frame_size);
+
+    state.add_bytes(num_frames * frame_size);
+    state.add_frames(num_frames);
+  }
+}
+
+MTXBENCH_REGISTER("common/checksum/adler32",    [](mtxbench::state_c &state) { run_checksum(state, mtx::checksum::algorithm_e::adler32);    });
+MTXBENCH_REGISTER("common/checksum/crc8_atm",   [](mtxbench::state_c &state) { run_checksum(state, mtx::checksum::algorithm_e::crc8_atm);   });
+MTXBENCH_REGISTER("common/checksum/crc32_ieee", [](mtxbench::state_c &state) { run_checksum(state, mtx::checksum::algorithm_e::crc32_ieee); });
+MTXBENCH_REGISTER("common/checksum/md5",        [](mtxbench::state_c &state) { run_checksum(state, mtx::checksum::algorithm_e::md5);        });
+
+}
@@ -0,0 +1,146 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxCues.h>
+#include <matroska/KaxSegment.h>
+#include <matroska/KaxTracks.h>
+
+#include "common/ebml.h"
+#include "common/kax_file.h"
+#include "common/mm_io.h"
+#include "merge/libmatroska_extensions.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+auto const s_timecode_scale      = 1000000ll;
+auto const s_frame_duration      = 21333333ll; // 1024 samples at 48 kHz
+auto const s_frames_per_cluster  = 240u;
+auto const s_num_clusters        = 100u;
+
+struct cluster_data_t {
+  std::vector<memory_cptr> m_frames;
+  KaxSegment m_segment;
+  KaxTrackEntry m_track_entry;
+
+  cluster_data_t() {
+    auto sizes = mtxbench::random_data(s_frames_per_cluster, 11);
+
+    for (auto idx = 0u; idx < s_frames_per_cluster; ++idx)
+      m_frames.push_back(memory_c::clone(mtxbench::random_data(200u + static_cast<unsigned char>(sizes[idx]) * 2u, 12 + idx)));
+
+    GetChild<KaxTrackNumber>(m_track_entry).SetValue(1);
+    m_track_entry.SetGlobalTimecodeScale(s_timecode_scale);
+    m_track_entry.EnableLacing(true);
+  }
+};
+
+/** \brief Renders one cluster the same way \c cluster_helper_c::render() does
+
+   All frames are key frames of a single track so that consecutive
+   frames can be laced into the same SimpleBlock.
+*/
+void
+render_cluster(cluster_data_t &data,
+               mm_io_c &out,
+               int64_t first_timecode,
+               LacingType lacing_type) {
+  std::vector<kax_block_blob_cptr> groups;
+  KaxCues cues;
+  kax_cluster_c cluster;
+
+  cues.SetGlobalTimecodeScale(s_timecode_scale);
+  cluster.SetParent(data.m_segment);
+  cluster.SetPreviousTimecode(std::max<int64_t>(0, first_timecode - s_frame_duration), s_timecode_scale);
+
+  auto more_data    = false;
+  auto max_timecode = first_timecode;
+
+  for (auto const &frame : data.m_frames) {
+    if (!more_data) {
+      groups.push_back(kax_block_blob_cptr(new kax_block_blob_c(BLOCK_BLOB_ALWAYS_SIMPLE)));
+      cluster.AddBlockBlob(groups.back().get());
+      groups.back()->SetParent(cluster);
+    }
+
+    auto data_buffer = new DataBuffer(static_cast<binary *>(frame->get_buffer()), frame->get_size());
+    more_data        = groups.back()->add_frame_auto(data.m_track_entry, max_timecode, *data_buffer, lacing_type, -1, -1);
+    max_timecode    += s_frame_duration;
+  }
+
+  cluster.SetPreviousTimecode(first_timecode - 1, s_timecode_scale);
+  cluster.set_min_timecode(first_timecode);
+  cluster.set_max_timecode(max_timecode - s_frame_duration);
+
+  cluster.Render(out, cues);
+  cluster.delete_non_blocks();
+}
+
+void
+render_clusters(mtxbench::state_c &state,
+                LacingType lacing_type) {
+  cluster_data_t data;
+  mm_mem_io_c out{nullptr, 0, 16 * 1024 * 1024};
+
+  while (state.keep_running()) {
+    out.setFilePointer(0);
+
+    for (auto cluster_idx = 0u; cluster_idx < s_num_clusters; ++cluster_idx)
+      render_cluster(data, out, cluster_idx * s_frames_per_cluster * s_frame_duration, lacing_type);
+
+    state.add_bytes(out.getFilePointer());
+    state.add_frames(s_num_clusters * s_frames_per_cluster);
+  }
+}
+
+void
+run_render_ebml_lacing(mtxbench::state_c &state) {
+  render_clusters(state, LACING_EBML);
+}
+
+void
+run_render_no_lacing(mtxbench::state_c &state) {
+  render_clusters(state, LACING_NONE);
+}
+
+void
+run_read_ebml_lacing(mtxbench::state_c &state) {
+  cluster_data_t data;
+  mm_mem_io_c out{nullptr, 0, 16 * 1024 * 1024};
+
+  for (auto cluster_idx = 0u; cluster_idx < s_num_clusters; ++cluster_idx)
+    render_cluster(data, out, cluster_idx * s_frames_per_cluster * s_frame_duration, LACING_EBML);
+
+  auto buffer = memory_c::clone(out.get_buffer(), out.getFilePointer());
+
+  while (state.keep_running()) {
+    auto in         = mm_io_cptr{new mm_mem_io_c{buffer->get_buffer(), buffer->get_size()}};
+    auto num_frames = 0u;
+    kax_file_c file{in};
+
+    while (true) {
+      auto cluster = std::unique_ptr<KaxCluster>{file.read_next_cluster()};
+      if (!cluster)
+        break;
+
+      for (auto child : *cluster) {
+        auto block = dynamic_cast<KaxSimpleBlock *>(child);
+        if (block)
+          num_frames += block->NumberFrames();
+      }
+    }
+
+    if (num_frames != (s_num_clusters * s_frames_per_cluster))
+      throw std::runtime_error{(boost::format("expected %1% frames, got %2%") % (s_num_clusters * s_frames_per_cluster) % num_frames).str()};
+
+    state.add_bytes(buffer->get_size());
+    state.add_frames(num_frames);
+  }
+}
+
+MTXBENCH_REGISTER("merge/cluster/render_ebml_lacing", run_render_ebml_lacing);
+MTXBENCH_REGISTER("merge/cluster/render_no_lacing",   run_render_no_lacing);
+MTXBENCH_REGISTER("merge/cluster/read_ebml_lacing",   run_read_ebml_lacing);
+
+}
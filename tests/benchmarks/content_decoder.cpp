@@ -0,0 +1,47 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxContentEncoding.h>
+#include <matroska/KaxTracks.h>
+
+#include "common/compression.h"
+#include "common/content_decoder.h"
+#include "common/ebml.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+// Decompresses zlib compressed frames of text-like data the way the
+// Matroska reader does it.
+void
+run_zlib_content_decoding(mtxbench::state_c &state) {
+  auto const frame_size = 4096u;
+  auto const num_frames = 2048u;
+  auto data             = mtxbench::compressible_data(frame_size * num_frames, 2);
+  auto compressor       = compressor_c::create(COMPRESSION_ZLIB);
+  auto frames           = std::vector<memory_cptr>{};
+
+  for (auto idx = 0u; idx < num_frames; ++idx)
+    frames.push_back(compressor->compress(memory_c::clone(data.c_str() + idx * frame_size, frame_size)));
+
+  KaxTrackEntry track_entry;
+  GetChild<KaxTrackNumber>(track_entry).SetValue(1);
+  compressor->set_track_headers(GetChild<KaxContentEncoding>(GetChild<KaxContentEncodings>(track_entry)));
+
+  content_decoder_c decoder{track_entry};
+  if (!decoder.is_ok())
+    throw std::runtime_error{"content decoder initialization failed"};
+
+  while (state.keep_running()) {
+    for (auto const &frame : frames) {
+      auto decoded = memory_c::clone(frame->get_buffer(), frame->get_size());
+      decoder.reverse(decoded, CONTENT_ENCODING_SCOPE_BLOCK);
+    }
+
+    state.add_bytes(num_frames * frame_size);
+    state.add_frames(num_frames);
+  }
+}
+
+MTXBENCH_REGISTER("common/content_decoder/zlib", run_zlib_content_decoding);
+
+}
@@ -0,0 +1,74 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxCues.h>
+#include <matroska/KaxCuesData.h>
+#include <matroska/KaxSeekHead.h>
+#include <matroska/KaxSegment.h>
+
+#include "common/ebml.h"
+#include "common/mm_io.h"
+#include "merge/cues.h"
+#include "merge/output_control.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+/** \brief Creates cue points in the order the cluster helper adds them
+
+   Each cluster contains entries for 25 video frames followed by 25
+   entries for audio frames covering the same time span, so the points
+   have to be sorted before they're written.
+*/
+void
+create_cue_points(KaxCues &cues,
+                  unsigned int num_clusters) {
+  for (auto cluster_idx = 0u; cluster_idx < num_clusters; ++cluster_idx) {
+    auto cluster_position = 4096ull + cluster_idx * 1500000ull;
+
+    for (auto track_num = 1u; track_num <= 2; ++track_num)
+      for (auto frame_idx = 0u; frame_idx < 25; ++frame_idx) {
+        auto &point     = AddEmptyChild<KaxCuePoint>(cues);
+        auto &positions = GetChild<KaxCueTrackPositions>(point);
+
+        GetChild<KaxCueTime>(point).SetValue((cluster_idx * 25 + frame_idx) * (1 == track_num ? 40 : 39));
+        GetChild<KaxCueTrack>(positions).SetValue(track_num);
+        GetChild<KaxCueClusterPosition>(positions).SetValue(cluster_position);
+      }
+  }
+}
+
+void
+run_cues_write(mtxbench::state_c &state) {
+  auto const num_clusters = 10000u;
+  auto const num_points   = num_clusters * 50;
+
+  KaxCues kax_cues;
+  create_cue_points(kax_cues, num_clusters);
+
+  g_kax_segment           = std::unique_ptr<KaxSegment>(new KaxSegment);
+  g_timecode_scale        = TIMECODE_SCALE;
+  g_cue_writing_requested = true;
+
+  mm_mem_io_c out{nullptr, 0, 16 * 1024 * 1024};
+
+  while (state.keep_running()) {
+    state.pause_timing();
+
+    KaxSeekHead seek_head;
+    cues_c::get().add(kax_cues);
+    out.setFilePointer(0);
+
+    state.resume_timing();
+
+    cues_c::get().write(out, seek_head);
+
+    state.add_bytes(out.getFilePointer());
+    state.add_frames(num_points);
+  }
+
+  g_kax_segment.reset();
+}
+
+MTXBENCH_REGISTER("merge/cues/write", run_cues_write);
+
+}
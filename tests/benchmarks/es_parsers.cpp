@@ -0,0 +1,287 @@
+#include "common/common_pch.h"
+
+#include <random>
+
+#include "common/bit_cursor.h"
+#include "common/hevc.h"
+#include "common/math.h"
+#include "common/mpeg4_p10.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+// Synthetic elementary streams: valid parameter sets and slice
+// headers followed by random slice data without start codes. The
+// parsers only look at the headers, so they treat these streams like
+// real ones.
+
+auto const s_num_frames     = 750u;
+auto const s_gop_size       = 25u;
+auto const s_min_frame_size = 2 * 1024u;
+auto const s_max_frame_size = 24 * 1024u;
+auto const s_chunk_size     = 64 * 1024u;
+
+void
+put_unsigned_golomb(bit_writer_c &w,
+                    unsigned int value) {
+  auto num_bits = mtx::math::int_log2(value + 1);
+
+  w.put_bits(num_bits,     0);
+  w.put_bits(num_bits + 1, value + 1);
+}
+
+void
+put_zero_bits(bit_writer_c &w,
+              unsigned int num_bits) {
+  for (auto idx = 0u; idx < num_bits; ++idx)
+    w.put_bit(0);
+}
+
+/** \brief Creates a NALU including its start code
+
+   \c write_header writes the NALU header and the syntax elements. The
+   payload is appended after byte-aligning them, followed by the RBSP
+   trailing bits and emulation prevention.
+*/
+std::string
+create_nalu(std::function<void(bit_writer_c &)> const &write_header,
+            std::string const &payload,
+            std::function<void(memory_cptr &)> const &rbsp_to_nalu) {
+  unsigned char header[256];
+  memset(header, 0, sizeof(header));
+
+  bit_writer_c w{header, sizeof(header)};
+  write_header(w);
+  if (payload.empty())
+    w.put_bit(1);
+  w.byte_align();
+
+  auto rbsp = std::string{reinterpret_cast<char *>(header), static_cast<std::size_t>(w.get_bit_position() / 8)} + payload;
+  if (!payload.empty())
+    rbsp += '\x80';
+
+  auto nalu = memory_c::clone(rbsp);
+  rbsp_to_nalu(nalu);
+
+  return std::string{"\x00\x00\x00\x01", 4} + std::string{reinterpret_cast<char *>(nalu->get_buffer()), nalu->get_size()};
+}
+
+std::vector<std::size_t>
+random_frame_sizes(unsigned int seed) {
+  auto generator = std::mt19937{seed};
+  auto sizes     = std::vector<std::size_t>{};
+
+  for (auto idx = 0u; idx < s_num_frames; ++idx)
+    sizes.push_back(s_min_frame_size + generator() % (s_max_frame_size - s_min_frame_size + 1));
+
+  return sizes;
+}
+
+std::string
+create_avc_stream() {
+  auto rbsp_to_nalu = [](memory_cptr &buffer) { mpeg4::p10::rbsp_to_nalu(buffer); };
+  auto payload      = mtxbench::random_data_without_zero_bytes(s_max_frame_size, 3);
+  auto stream       = std::string{};
+
+  // 320x240, Baseline profile, picture order count type 2
+  auto sps = create_nalu([](bit_writer_c &w) {
+    w.put_bits(8, 0x67);
+    w.put_bits(8, 66);
+    w.put_bits(8, 0xc0);
+    w.put_bits(8, 30);
+    put_unsigned_golomb(w, 0);  // seq_parameter_set_id
+    put_unsigned_golomb(w, 0);  // log2_max_frame_num_minus4
+    put_unsigned_golomb(w, 2);  // pic_order_cnt_type
+    put_unsigned_golomb(w, 1);  // max_num_ref_frames
+    w.put_bit(0);               // gaps_in_frame_num_value_allowed_flag
+    put_unsigned_golomb(w, 19); // pic_width_in_mbs_minus1
+    put_unsigned_golomb(w, 14); // pic_height_in_map_units_minus1
+    w.put_bit(1);               // frame_mbs_only_flag
+    w.put_bit(1);               // direct_8x8_inference_flag
+    w.put_bit(0);               // frame_cropping_flag
+    w.put_bit(0);               // vui_parameters_present_flag
+  }, std::string{}, rbsp_to_nalu);
+
+  auto pps = create_nalu([](bit_writer_c &w) {
+    w.put_bits(8, 0x68);
+    put_unsigned_golomb(w, 0);  // pic_parameter_set_id
+    put_unsigned_golomb(w, 0);  // seq_parameter_set_id
+    w.put_bit(0);               // entropy_coding_mode_flag
+    w.put_bit(0);               // bottom_field_pic_order_in_frame_present_flag
+    put_unsigned_golomb(w, 0);  // num_slice_groups_minus1
+    put_unsigned_golomb(w, 0);  // num_ref_idx_l0_default_active_minus1
+    put_unsigned_golomb(w, 0);  // num_ref_idx_l1_default_active_minus1
+    w.put_bit(0);               // weighted_pred_flag
+    w.put_bits(2, 0);           // weighted_bipred_idc
+    put_unsigned_golomb(w, 0);  // pic_init_qp_minus26
+    put_unsigned_golomb(w, 0);  // pic_init_qs_minus26
+    put_unsigned_golomb(w, 0);  // chroma_qp_index_offset
+    w.put_bit(1);               // deblocking_filter_control_present_flag
+    w.put_bit(0);               // constrained_intra_pred_flag
+    w.put_bit(0);               // redundant_pic_cnt_present_flag
+  }, std::string{}, rbsp_to_nalu);
+
+  auto frame_sizes = random_frame_sizes(4);
+
+  for (auto idx = 0u; idx < s_num_frames; ++idx) {
+    auto frame_num = idx % s_gop_size;
+    auto is_idr    = 0 == frame_num;
+
+    if (is_idr)
+      stream += sps + pps;
+
+    stream += create_nalu([is_idr, frame_num](bit_writer_c &w) {
+      w.put_bits(8, is_idr ? 0x65 : 0x41);
+      put_unsigned_golomb(w, 0);            // first_mb_in_slice
+      put_unsigned_golomb(w, is_idr ? 7 : 5); // slice_type
+      put_unsigned_golomb(w, 0);            // pic_parameter_set_id
+      w.put_bits(4, frame_num % 16);        // frame_num
+      if (is_idr)
+        put_unsigned_golomb(w, 0);          // idr_pic_id
+    }, payload.substr(0, frame_sizes[idx]), rbsp_to_nalu);
+  }
+
+  return stream;
+}
+
+void
+put_hevc_profile_tier_level(bit_writer_c &w) {
+  w.put_bits(2, 0);             // general_profile_space
+  w.put_bit(0);                 // general_tier_flag
+  w.put_bits(5, 1);             // general_profile_idc (Main)
+  w.put_bits(16, 0x6000);       // general_profile_compatibility_flags
+  w.put_bits(16, 0x0000);
+  w.put_bits(4, 0x9);           // progressive, interlaced, non-packed, frame only
+  put_zero_bits(w, 44);         // general_reserved_zero_44bits
+  w.put_bits(8, 93);            // general_level_idc (3.1)
+}
+
+std::string
+create_hevc_stream() {
+  auto rbsp_to_nalu = [](memory_cptr &buffer) { mtx::hevc::rbsp_to_nalu(buffer); };
+  auto payload      = mtxbench::random_data_without_zero_bytes(s_max_frame_size, 5);
+  auto stream       = std::string{};
+
+  auto vps = create_nalu([](bit_writer_c &w) {
+    w.put_bits(16, (HEVC_NALU_TYPE_VIDEO_PARAM << 9) | 1);
+    w.put_bits(4, 0);           // vps_video_parameter_set_id
+    w.put_bits(2, 3);           // vps_reserved_three_2bits
+    w.put_bits(6, 0);           // vps_max_layers_minus1
+    w.put_bits(3, 0);           // vps_max_sub_layers_minus1
+    w.put_bit(1);               // vps_temporal_id_nesting_flag
+    w.put_bits(16, 0xffff);     // vps_reserved_0xffff_16bits
+    put_hevc_profile_tier_level(w);
+    w.put_bit(1);               // vps_sub_layer_ordering_info_present_flag
+    put_unsigned_golomb(w, 4);  // vps_max_dec_pic_buffering_minus1
+    put_unsigned_golomb(w, 0);  // vps_max_num_reorder_pics
+    put_unsigned_golomb(w, 0);  // vps_max_latency_increase_plus1
+    w.put_bits(6, 0);           // vps_max_layer_id
+    put_unsigned_golomb(w, 0);  // vps_num_layer_sets_minus1
+    w.put_bit(0);               // vps_timing_info_present_flag
+    w.put_bit(0);               // vps_extension_flag
+  }, std::string{}, rbsp_to_nalu);
+
+  // 320x240, 8 bit 4:2:0
+  auto sps = create_nalu([](bit_writer_c &w) {
+    w.put_bits(16, (HEVC_NALU_TYPE_SEQ_PARAM << 9) | 1);
+    w.put_bits(4, 0);           // sps_video_parameter_set_id
+    w.put_bits(3, 0);           // sps_max_sub_layers_minus1
+    w.put_bit(1);               // sps_temporal_id_nesting_flag
+    put_hevc_profile_tier_level(w);
+    put_unsigned_golomb(w, 0);   // sps_seq_parameter_set_id
+    put_unsigned_golomb(w, 1);   // chroma_format_idc
+    put_unsigned_golomb(w, 320); // pic_width_in_luma_samples
+    put_unsigned_golomb(w, 240); // pic_height_in_luma_samples
+    w.put_bit(0);                // conformance_window_flag
+    put_unsigned_golomb(w, 0);   // bit_depth_luma_minus8
+    put_unsigned_golomb(w, 0);   // bit_depth_chroma_minus8
+    put_unsigned_golomb(w, 4);   // log2_max_pic_order_cnt_lsb_minus4
+    w.put_bit(1);                // sps_sub_layer_ordering_info_present_flag
+    put_unsigned_golomb(w, 4);   // sps_max_dec_pic_buffering_minus1
+    put_unsigned_golomb(w, 0);   // sps_max_num_reorder_pics
+    put_unsigned_golomb(w, 0);   // sps_max_latency_increase_plus1
+    put_unsigned_golomb(w, 0);   // log2_min_luma_coding_block_size_minus3
+    put_unsigned_golomb(w, 1);   // log2_diff_max_min_luma_coding_block_size
+    put_unsigned_golomb(w, 0);   // log2_min_luma_transform_block_size_minus2
+    put_unsigned_golomb(w, 3);   // log2_diff_max_min_luma_transform_block_size
+    put_unsigned_golomb(w, 0);   // max_transform_hierarchy_depth_inter
+    put_unsigned_golomb(w, 0);   // max_transform_hierarchy_depth_intra
+    w.put_bit(0);                // scaling_list_enabled_flag
+    w.put_bit(0);                // amp_enabled_flag
+    w.put_bit(0);                // sample_adaptive_offset_enabled_flag
+    w.put_bit(0);                // pcm_enabled_flag
+    put_unsigned_golomb(w, 0);   // num_short_term_ref_pic_sets
+    w.put_bit(0);                // long_term_ref_pics_present_flag
+    w.put_bit(0);                // sps_temporal_mvp_enabled_flag
+    w.put_bit(0);                // strong_intra_smoothing_enabled_flag
+    w.put_bit(0);                // vui_parameters_present_flag
+    w.put_bit(0);                // sps_extension_flag
+  }, std::string{}, rbsp_to_nalu);
+
+  auto pps = create_nalu([](bit_writer_c &w) {
+    w.put_bits(16, (HEVC_NALU_TYPE_PIC_PARAM << 9) | 1);
+    put_unsigned_golomb(w, 0);  // pps_pic_parameter_set_id
+    put_unsigned_golomb(w, 0);  // pps_seq_parameter_set_id
+    w.put_bit(0);               // dependent_slice_segments_enabled_flag
+    w.put_bit(0);               // output_flag_present_flag
+    w.put_bits(3, 0);           // num_extra_slice_header_bits
+  }, std::string{}, rbsp_to_nalu);
+
+  auto frame_sizes = random_frame_sizes(6);
+
+  for (auto idx = 0u; idx < s_num_frames; ++idx) {
+    auto poc    = idx % s_gop_size;
+    auto is_idr = 0 == poc;
+
+    if (is_idr)
+      stream += vps + sps + pps;
+
+    stream += create_nalu([is_idr, poc](bit_writer_c &w) {
+      w.put_bits(16, ((is_idr ? HEVC_NALU_TYPE_IDR_W_RADL : HEVC_NALU_TYPE_TRAIL_R) << 9) | 1);
+      w.put_bit(1);                         // first_slice_segment_in_pic_flag
+      if (is_idr)
+        w.put_bit(0);                       // no_output_of_prior_pics_flag
+      put_unsigned_golomb(w, 0);            // slice_pic_parameter_set_id
+      put_unsigned_golomb(w, is_idr ? 2 : 1); // slice_type
+      if (!is_idr)
+        w.put_bits(8, poc);                 // slice_pic_order_cnt_lsb
+    }, payload.substr(0, frame_sizes[idx]), rbsp_to_nalu);
+  }
+
+  return stream;
+}
+
+template<typename parser_t>
+void
+run_es_parser(mtxbench::state_c &state,
+              std::string const &stream) {
+  auto buffer = memory_c::clone(stream);
+
+  while (state.keep_running()) {
+    parser_t parser;
+    auto num_frames = 0u;
+
+    for (auto position = 0u; position < stream.size(); position += s_chunk_size) {
+      parser.add_bytes(buffer->get_buffer() + position, std::min<std::size_t>(s_chunk_size, stream.size() - position));
+
+      for (; parser.frame_available(); ++num_frames)
+        parser.get_frame();
+    }
+
+    parser.flush();
+
+    for (; parser.frame_available(); ++num_frames)
+      parser.get_frame();
+
+    if (num_frames != s_num_frames)
+      throw std::runtime_error{(boost::format("expected %1% frames, got %2%") % s_num_frames % num_frames).str()};
+
+    state.add_bytes(stream.size());
+    state.add_frames(num_frames);
+  }
+}
+
+MTXBENCH_REGISTER("common/es_parser/avc",  [](mtxbench::state_c &state) { run_es_parser<mpeg4::p10::avc_es_parser_c>(state, create_avc_stream());  });
+MTXBENCH_REGISTER("common/es_parser/hevc", [](mtxbench::state_c &state) { run_es_parser<mtx::hevc::es_parser_c>(state,     create_hevc_stream()); });
+
+}
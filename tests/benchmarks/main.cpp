@@ -0,0 +1,79 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   micro-benchmark runner
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/hacks.h"
+#include "common/strings/parsing.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+void
+mxmsg_handler(unsigned int,
+              std::string const &message) {
+  throw std::runtime_error{message};
+}
+
+void
+usage() {
+  mxinfo("Usage: benchmarks [--min-time <seconds>] [--list] [filter ...]\n"
+         "\n"
+         "Runs all benchmarks whose names contain one of the filters, or all\n"
+         "benchmarks if no filter is given. Each benchmark runs for at least\n"
+         "--min-time seconds (default: 1).\n");
+}
+
+}
+
+int
+main(int argc,
+     char **argv) {
+  mtx_common_init("BENCHMARKS", argv[0]);
+
+  // Errors abort the current benchmark only.
+  set_mxmsg_handler(MXMSG_ERROR, mxmsg_handler);
+
+  engage_hack(ENGAGE_NO_VARIABLE_DATA);
+
+  auto min_time = std::chrono::nanoseconds{1000000000ll};
+  auto filters  = std::vector<std::string>{};
+
+  for (auto idx = 1; idx < argc; ++idx) {
+    auto arg = std::string{argv[idx]};
+
+    if ((arg == "-h") || (arg == "--help")) {
+      usage();
+      return 0;
+
+    } else if (arg == "--list") {
+      for (auto const &benchmark : mtxbench::get_benchmarks())
+        mxinfo(boost::format("%1%\n") % benchmark.m_name);
+      return 0;
+
+    } else if (arg == "--min-time") {
+      auto seconds = 0.0;
+      if (((idx + 1) >= argc) || !parse_number(argv[idx + 1], seconds) || (0 >= seconds)) {
+        usage();
+        return 2;
+      }
+
+      min_time = std::chrono::nanoseconds{static_cast<int64_t>(seconds * 1000000000ll)};
+      ++idx;
+
+    } else
+      filters.push_back(arg);
+  }
+
+  return mtxbench::run_benchmarks(filters, min_time) ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+#include "common/common_pch.h"
+
+#include "common/endian.h"
+#include "common/mm_io.h"
+#include "input/r_mpeg_ts.h"
+#include "merge/track_info.h"
+#include "tests/benchmarks/benchmark.h"
+
+namespace {
+
+auto const s_packet_size = 188u;
+auto const s_video_pid   = 0x100u;
+
+// Drives mpeg_ts_reader_c::parse_packet() directly for a single video
+// track. Completed PES packets are handed to the track as usual, but
+// the track has no packetizer that would process them.
+class ts_reader_c: public mpeg_ts_reader_c {
+public:
+  ts_reader_c(mm_io_cptr const &in)
+    : mpeg_ts_reader_c{track_info_c{}, in}
+  {
+    m_probing              = false;
+    m_detected_packet_size = s_packet_size;
+
+    auto track  = std::make_shared<mpeg_ts_track_c>(*this);
+    track->type = ES_VIDEO_TYPE;
+    track->pid  = s_video_pid;
+    track->ptzr = 0;
+
+    tracks.push_back(track);
+  }
+
+  unsigned int
+  parse_packets(unsigned char *buffer,
+                std::size_t size) {
+    auto num_pes_packets = 0u;
+    auto &track          = *tracks[0];
+
+    for (auto position = 0u; (position + s_packet_size) <= size; position += s_packet_size) {
+      track_buffer_ready = -1;
+      parse_packet(buffer + position);
+
+      if (-1 == track_buffer_ready)
+        continue;
+
+      // Without a packetizer the track only resets its PES buffer.
+      track.ptzr = -1;
+      track.send_to_packetizer();
+      track.ptzr = 0;
+
+      ++num_pes_packets;
+    }
+
+    return num_pes_packets;
+  }
+};
+
+void
+put_pts(unsigned char *buffer,
+        uint64_t pts) {
+  buffer[0] = 0x21 | ((pts >> 29) & 0x0e);
+  buffer[1] = (pts >> 22) & 0xff;
+  buffer[2] = 0x01 | ((pts >> 14) & 0xfe);
+  buffer[3] = (pts >>  7) & 0xff;
+  buffer[4] = 0x01 | ((pts <<  1) & 0xfe);
+}
+
+/** \brief Creates a transport stream with one PES packet per video frame
+
+   Each PES packet carries a PTS and its length, and its last transport
+   stream packet is padded with an adaptation field.
+*/
+std::string
+create_transport_stream(unsigned int num_frames) {
+  auto payload = mtxbench::random_data(65000, 7);
+  auto stream  = std::string{};
+  auto sizes   = mtxbench::random_data(num_frames, 8);
+  auto counter = 0u;
+
+  for (auto frame_idx = 0u; frame_idx < num_frames; ++frame_idx) {
+    auto frame_size = 2000u + static_cast<unsigned char>(sizes[frame_idx]) * 200u;
+
+    unsigned char pes_header[14];
+    pes_header[0] = 0x00;
+    pes_header[1] = 0x00;
+    pes_header[2] = 0x01;
+    pes_header[3] = 0xe0;
+    put_uint16_be(&pes_header[4], 3 + 5 + frame_size);
+    pes_header[6] = 0x80;
+    pes_header[7] = 0x80;       // PTS only
+    pes_header[8] = 5;
+    put_pts(&pes_header[9], 90000ull + frame_idx * 3600);
+
+    auto pes      = std::string{reinterpret_cast<char *>(pes_header), sizeof(pes_header)} + payload.substr(0, frame_size);
+    auto position = 0u;
+
+    while (position < pes.size()) {
+      auto remaining = pes.size() - position;
+      auto to_copy   = std::min<std::size_t>(remaining, s_packet_size - 4);
+
+      unsigned char packet[s_packet_size];
+      packet[0] = 0x47;
+      packet[1] = (0 == position ? 0x40 : 0x00) | (s_video_pid >> 8);
+      packet[2] = s_video_pid & 0xff;
+      packet[3] = 0x10 | (counter++ & 0x0f);
+
+      auto header_size = 4u;
+
+      if (to_copy < (s_packet_size - 4)) {
+        auto adaptation_field_size = s_packet_size - 4 - to_copy - 1;
+
+        packet[3] |= 0x20;
+        packet[4]  = adaptation_field_size;
+        if (adaptation_field_size) {
+          packet[5] = 0x00;
+          memset(&packet[6], 0xff, adaptation_field_size - 1);
+        }
+
+        header_size += 1 + adaptation_field_size;
+      }
+
+      memcpy(&packet[header_size], pes.c_str() + position, to_copy);
+
+      stream.append(reinterpret_cast<char *>(packet), s_packet_size);
+      position += to_copy;
+    }
+  }
+
+  return stream;
+}
+
+void
+run_mpeg_ts_parse_packet(mtxbench::state_c &state) {
+  auto const num_frames = 2000u;
+  auto stream           = create_transport_stream(num_frames);
+  auto buffer           = memory_c::clone(stream);
+  auto in               = mm_io_cptr{new mm_mem_io_c{buffer->get_buffer(), buffer->get_size()}};
+
+  while (state.keep_running()) {
+    state.pause_timing();
+    ts_reader_c reader{in};
+    state.resume_timing();
+
+    auto num_pes_packets = reader.parse_packets(buffer->get_buffer(), buffer->get_size());
+    if (num_pes_packets != num_frames)
+      throw std::runtime_error{(boost::format("expected %1% PES packets, got %2%") % num_frames % num_pes_packets).str()};
+
+    state.add_bytes(buffer->get_size());
+    state.add_frames(num_pes_packets);
+  }
+}
+
+MTXBENCH_REGISTER("input/mpeg_ts/parse_packet", run_mpeg_ts_parse_packet);
+
+}
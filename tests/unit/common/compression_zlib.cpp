@@ -0,0 +1,112 @@
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <random>
+
+#include "common/compression.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+memory_cptr
+create_frame(size_t size,
+             unsigned int seed) {
+  auto rng   = std::mt19937{seed};
+  auto words = std::vector<std::string>{ "chunky", "bacon", "foxes", "moose", "socks", " ", "\n" };
+  auto text  = std::string{};
+
+  while (text.size() < size)
+    text += words[rng() % words.size()];
+
+  text.resize(size);
+
+  return memory_c::clone(text);
+}
+
+TEST(CompressionZlib, RoundTrip) {
+  auto zlib = compressor_c::create(COMPRESSION_ZLIB);
+
+  for (auto size : std::vector<size_t>{ 0, 1, 3999, 4000, 4001, 100000, 1000000 }) {
+    auto frame = create_frame(size, size);
+    EXPECT_TRUE(*frame == *zlib->decompress(zlib->compress(frame))) << "size " << size;
+  }
+}
+
+TEST(CompressionZlib, ReusedStreamsWithChangingRatios) {
+  auto compressor   = compressor_c::create(COMPRESSION_ZLIB);
+  auto decompressor = compressor_c::create(COMPRESSION_ZLIB);
+
+  // Highly compressible frames after poorly compressible ones and vice
+  // versa so that the size estimate is both too big and too small.
+  for (auto idx = 0u; idx < 20; ++idx) {
+    auto frame = 0 == (idx % 2) ? create_frame(50000 + idx, idx) : memory_c::clone(std::string(200000 + idx, 'x'));
+    EXPECT_TRUE(*frame == *decompressor->decompress(compressor->compress(frame))) << "frame " << idx;
+  }
+}
+
+TEST(CompressionZlib, CorruptDataThrows) {
+  auto zlib       = compressor_c::create(COMPRESSION_ZLIB);
+  auto compressed = zlib->compress(create_frame(10000, 42));
+
+  compressed->get_buffer()[compressed->get_size() / 2] ^= 0xff;
+  compressed->get_buffer()[compressed->get_size() / 2 + 1] ^= 0xff;
+
+  EXPECT_THROW(zlib->decompress(compressed), mtx::compression_x);
+  EXPECT_THROW(zlib->decompress(memory_c::clone("This is not zlib data at all")), mtx::compression_x);
+
+  // The stream must be usable again after an error.
+  EXPECT_TRUE(*create_frame(1000, 1) == *zlib->decompress(zlib->compress(create_frame(1000, 1))));
+}
+
+TEST(CompressionZlib, TruncatedDataThrows) {
+  auto zlib       = compressor_c::create(COMPRESSION_ZLIB);
+  auto frame      = create_frame(100000, 23);
+  auto compressed = zlib->compress(frame);
+
+  for (auto size : std::vector<size_t>{ compressed->get_size() - 1, compressed->get_size() / 2, 2, 0 }) {
+    auto truncated = memory_c::clone(compressed->get_buffer(), size);
+    EXPECT_THROW(zlib->decompress(truncated), mtx::compression_x) << "size " << size;
+  }
+
+  EXPECT_TRUE(*frame == *zlib->decompress(compressed));
+}
+
+// Measures the decompression throughput of a decompressor that is
+// re-used for all frames of a track as content_decoder_c does against
+// one created for each frame. Run with
+// --gtest_also_run_disabled_tests.
+TEST(CompressionZlib, DISABLED_BenchmarkDecompression) {
+  auto compressor = compressor_c::create(COMPRESSION_ZLIB);
+
+  for (auto frame_size : std::vector<size_t>{ 200, 4000, 64 * 1024, 1024 * 1024 }) {
+    auto num_frames = std::max<size_t>(64 * 1024 * 1024 / frame_size, 16);
+    auto frames     = std::vector<memory_cptr>{};
+
+    for (auto idx = 0u; idx < 16; ++idx)
+      frames.emplace_back(compressor->compress(create_frame(frame_size, idx)));
+
+    auto reused   = compressor_c::create(COMPRESSION_ZLIB);
+    auto start    = std::chrono::steady_clock::now();
+    auto checksum = size_t{};
+
+    for (auto idx = 0u; idx < num_frames; ++idx)
+      checksum += reused->decompress(frames[idx % frames.size()])->get_size();
+
+    auto reused_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start          = std::chrono::steady_clock::now();
+
+    for (auto idx = 0u; idx < num_frames; ++idx)
+      checksum -= compressor_c::create(COMPRESSION_ZLIB)->decompress(frames[idx % frames.size()])->get_size();
+
+    auto fresh_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(0u, checksum);
+
+    auto total_mb = static_cast<double>(num_frames * frame_size) / (1024 * 1024);
+    std::cout << boost::format("%|1$7| bytes/frame: re-used decompressor %|2$8.1f| MB/s, new decompressor per frame %|3$8.1f| MB/s\n")
+      % frame_size % (total_mb * 1000000000 / reused_ns) % (total_mb * 1000000000 / fresh_ns);
+  }
+}
+
+}
@@ -0,0 +1,84 @@
+#include "common/common_pch.h"
+
+#if defined(HAVE_FLAC_FORMAT_H)
+
+#include "common/checksums/base.h"
+#include "common/flac.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// The first frame of the first example file in RFC 9639 as written by
+// libFLAC: 1 sample, 44.1 kHz, stereo, 16 bits, frame number 0. The
+// last two bytes are the frame's CRC-16.
+unsigned char const s_rfc_example_frame[] = {
+  0xff, 0xf8, 0x69, 0x18, 0x00, 0x00, 0xbf, 0x03, 0x58, 0xfd, 0x03, 0x12, 0x8b, 0xaa, 0x9a,
+};
+
+TEST(Flac, ParseFrameHeaderEncoderOutput) {
+  mtx::flac::frame_header_t parsed;
+
+  ASSERT_TRUE(mtx::flac::parse_frame_header(s_rfc_example_frame, sizeof(s_rfc_example_frame), parsed));
+  EXPECT_EQ(7u, parsed.size);
+  EXPECT_FALSE(parsed.variable_block_size);
+  EXPECT_EQ(0u, parsed.number);
+  EXPECT_EQ(1u, parsed.num_samples);
+
+  EXPECT_EQ(0u, mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc16_ansi, s_rfc_example_frame, sizeof(s_rfc_example_frame)));
+
+  // Header of a 16 sample frame with left/side stereo.
+  unsigned char const left_side[] = { 0xff, 0xf8, 0x69, 0x98, 0x00, 0x0f, 0x99 };
+
+  ASSERT_TRUE(mtx::flac::parse_frame_header(left_side, sizeof(left_side), parsed));
+  EXPECT_EQ(7u,  parsed.size);
+  EXPECT_EQ(16u, parsed.num_samples);
+}
+
+TEST(Flac, ParseFrameHeaderFixedBlockSize) {
+  // 4096 samples, 44.1 kHz, stereo, 16 bits, frame number 0
+  auto header = std::vector<unsigned char>{ 0xff, 0xf8, 0xc9, 0x18, 0x00, 0xc2 };
+  mtx::flac::frame_header_t parsed;
+
+  ASSERT_TRUE(mtx::flac::parse_frame_header(header.data(), header.size(), parsed));
+  EXPECT_EQ(6u,    parsed.size);
+  EXPECT_FALSE(parsed.variable_block_size);
+  EXPECT_EQ(0u,    parsed.number);
+  EXPECT_EQ(4096u, parsed.num_samples);
+
+  EXPECT_FALSE(mtx::flac::parse_frame_header(header.data(), header.size() - 1, parsed));
+
+  header[5] ^= 0x01;
+  EXPECT_FALSE(mtx::flac::parse_frame_header(header.data(), header.size(), parsed));
+}
+
+TEST(Flac, ParseFrameHeaderVariableBlockSize) {
+  // 16-bit block size of 4096 samples, sample number 128
+  auto header = std::vector<unsigned char>{ 0xff, 0xf9, 0x79, 0x18, 0xc2, 0x80, 0x0f, 0xff, 0x70 };
+  mtx::flac::frame_header_t parsed;
+
+  ASSERT_TRUE(mtx::flac::parse_frame_header(header.data(), header.size(), parsed));
+  EXPECT_EQ(9u,    parsed.size);
+  EXPECT_TRUE(parsed.variable_block_size);
+  EXPECT_EQ(128u,  parsed.number);
+  EXPECT_EQ(4096u, parsed.num_samples);
+}
+
+TEST(Flac, ParseFrameHeaderReservedValues) {
+  mtx::flac::frame_header_t parsed;
+
+  // The last bytes are the correct CRC-8 values.
+  auto reserved_block_size = std::vector<unsigned char>{ 0xff, 0xf8, 0x09, 0x18, 0x00, 0x4f };
+  auto reserved_channels   = std::vector<unsigned char>{ 0xff, 0xf8, 0xc9, 0xb8, 0x00, 0xda };
+  auto invalid_number      = std::vector<unsigned char>{ 0xff, 0xf8, 0xc9, 0x18, 0x80, 0x4b };
+  auto no_sync             = std::vector<unsigned char>{ 0xff, 0xfa, 0xc9, 0x18, 0x00, 0xee };
+
+  EXPECT_FALSE(mtx::flac::parse_frame_header(reserved_block_size.data(), reserved_block_size.size(), parsed));
+  EXPECT_FALSE(mtx::flac::parse_frame_header(reserved_channels.data(),   reserved_channels.size(),   parsed));
+  EXPECT_FALSE(mtx::flac::parse_frame_header(invalid_number.data(),      invalid_number.size(),      parsed));
+  EXPECT_FALSE(mtx::flac::parse_frame_header(no_sync.data(),             no_sync.size(),             parsed));
+}
+
+}
+
+#endif  // HAVE_FLAC_FORMAT_H
@@ -0,0 +1,107 @@
+#include "common/common_pch.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "common/instrumentation.h"
+
+namespace {
+
+using namespace mtx::instrumentation;
+
+class Instrumentation: public ::testing::Test {
+protected:
+  std::string m_report_name;
+
+  virtual void SetUp() {
+    m_report_name = (bfs::temp_directory_path() / bfs::unique_path("mtx-instrumentation-%%%%-%%%%.json")).string();
+    debugging_c::request(std::string{"instrumentation="} + m_report_name);
+  }
+
+  virtual void TearDown() {
+    debugging_c::request("instrumentation", false);
+
+    boost::system::error_code ec;
+    bfs::remove(bfs::path{m_report_name}, ec);
+  }
+};
+
+TEST_F(Instrumentation, DisabledReturnsNoCounter) {
+  debugging_c::request("instrumentation", false);
+
+  EXPECT_FALSE(enabled());
+  EXPECT_EQ(nullptr, get_counter("disabled", "object"));
+}
+
+TEST_F(Instrumentation, CountersAreShared) {
+  ASSERT_TRUE(enabled());
+
+  auto counter = get_counter("shared", "object");
+  ASSERT_NE(nullptr, counter);
+  EXPECT_EQ(counter, get_counter("shared", "object"));
+  EXPECT_NE(counter, get_counter("shared", "other object"));
+  EXPECT_NE(counter, get_counter("other stage", "object"));
+}
+
+TEST_F(Instrumentation, NestedScopes) {
+  auto outer = get_counter("nested", "outer");
+  auto inner = get_counter("nested", "inner");
+
+  {
+    scope_c outer_scope{outer};
+    outer_scope.add_bytes(10);
+
+    for (auto idx = 0; idx < 2; ++idx) {
+      scope_c inner_scope{inner};
+      inner_scope.add_bytes(5);
+      inner_scope.add_bytes(-1);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+
+  EXPECT_EQ(1u,  outer->m_num_calls.load());
+  EXPECT_EQ(10u, outer->m_num_bytes.load());
+  EXPECT_EQ(2u,  inner->m_num_calls.load());
+  EXPECT_EQ(10u, inner->m_num_bytes.load());
+
+  EXPECT_GE(outer->m_wall_nanos.load(),      inner->m_wall_nanos.load());
+  EXPECT_GE(inner->m_wall_nanos.load(),      4 * 1000 * 1000);
+  EXPECT_EQ(inner->m_wall_nanos.load(),      inner->m_self_wall_nanos.load());
+  EXPECT_EQ(outer->m_self_wall_nanos.load(), outer->m_wall_nanos.load() - inner->m_wall_nanos.load());
+}
+
+TEST_F(Instrumentation, FileWritesAndReport) {
+  auto out_name = (bfs::temp_directory_path() / bfs::unique_path("mtx-instrumentation-%%%%-%%%%.out")).string();
+
+  {
+    mm_file_io_c out{out_name, MODE_CREATE};
+    out.write(std::string{"Chunky Bacon"});
+    out.write_uint8(0);
+  }
+
+  auto counter = get_counter("write", out_name);
+  EXPECT_EQ(2u,  counter->m_num_calls.load());
+  EXPECT_EQ(13u, counter->m_num_bytes.load());
+
+  {
+    mm_file_io_c in{out_name};
+    in.getline();
+  }
+
+  EXPECT_EQ(2u, counter->m_num_calls.load());
+
+  boost::system::error_code ec;
+  bfs::remove(bfs::path{out_name}, ec);
+
+  dump_report();
+
+  auto report = mm_file_io_c::slurp(m_report_name);
+  auto json   = std::string{reinterpret_cast<char const *>(report->get_buffer()), report->get_size()};
+
+  EXPECT_NE(std::string::npos, json.find("\"stages\": ["));
+  EXPECT_NE(std::string::npos, json.find("{ \"stage\": \"write\", \"name\": \"" + out_name + "\", \"calls\": 2, \"bytes\": 13, "));
+  EXPECT_EQ(std::string::npos, json.find("\"stage\": \"shared\""));
+}
+
+}
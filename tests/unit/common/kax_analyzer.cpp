@@ -0,0 +1,161 @@
+#include "common/common_pch.h"
+
+#include <ebml/EbmlHead.h>
+#include <ebml/EbmlSubHead.h>
+#include <ebml/EbmlVoid.h>
+#include <matroska/KaxInfo.h>
+#include <matroska/KaxInfoData.h>
+#include <matroska/KaxSegment.h>
+#include <matroska/KaxTracks.h>
+#include <matroska/KaxTrackEntryData.h>
+
+#include "common/ebml.h"
+#include "common/kax_analyzer.h"
+#include "common/mm_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using namespace libebml;
+using namespace libmatroska;
+
+class KaxAnalyzerIndexCache: public ::testing::Test {
+protected:
+  std::string m_file_name, m_cache_name;
+
+  virtual void SetUp() {
+    m_file_name  = (bfs::temp_directory_path() / bfs::unique_path("mtx-kax-analyzer-%%%%-%%%%.mkv")).string();
+    m_cache_name = kax_analyzer_c::get_index_cache_file_name(m_file_name);
+
+    create_file();
+    kax_analyzer_c::enable_index_cache(true);
+  }
+
+  virtual void TearDown() {
+    kax_analyzer_c::enable_index_cache(false);
+
+    boost::system::error_code ec;
+    bfs::remove(bfs::path{m_file_name},  ec);
+    bfs::remove(bfs::path{m_cache_name}, ec);
+  }
+
+  void create_file() {
+    mm_file_io_c out{m_file_name, MODE_CREATE};
+
+    EbmlHead head;
+    GetChild<EDocType>(head).SetValue("matroska");
+    GetChild<EDocTypeVersion>(head).SetValue(4);
+    GetChild<EDocTypeReadVersion>(head).SetValue(2);
+    head.Render(out, true);
+
+    KaxSegment segment;
+
+    auto &info = GetChild<KaxInfo>(segment);
+    GetChild<KaxTimecodeScale>(info).SetValue(1000000);
+    GetChild<KaxSegmentUID>(info).CopyBuffer(reinterpret_cast<binary const *>("0123456789abcdef"), 16);
+
+    auto &entry = GetChild<KaxTrackEntry>(GetChild<KaxTracks>(segment));
+    GetChild<KaxTrackNumber>(entry).SetValue(1);
+    GetChild<KaxTrackUID>(entry).SetValue(1);
+    GetChild<KaxTrackType>(entry).SetValue(track_subtitle);
+    GetChild<KaxCodecID>(entry).SetValue("S_TEXT/UTF8");
+
+    // Make the file larger than the ranges covered by the checksums.
+    auto padding = new EbmlVoid;
+    padding->SetSize(200000);
+    segment.PushElement(*padding);
+
+    segment.Render(out, true);
+  }
+
+  std::unique_ptr<kax_analyzer_c> analyze() {
+    auto analyzer = std::make_unique<kax_analyzer_c>(m_file_name);
+    EXPECT_TRUE(analyzer->process(kax_analyzer_c::parse_mode_full, MODE_READ));
+
+    return analyzer;
+  }
+
+  void overwrite_byte(int64_t offset_from_end) {
+    auto path  = bfs::path{m_file_name};
+    auto mtime = bfs::last_write_time(path);
+
+    {
+      mm_file_io_c file{m_file_name, MODE_WRITE};
+      file.setFilePointer(offset_from_end, seek_end);
+      file.write_uint8(0xff);
+    }
+
+    bfs::last_write_time(path, mtime);
+  }
+};
+
+void
+expect_same_data(kax_analyzer_c const &expected,
+                 kax_analyzer_c const &actual) {
+  ASSERT_EQ(expected.m_data.size(), actual.m_data.size());
+
+  for (auto idx = 0u; idx < expected.m_data.size(); ++idx) {
+    EXPECT_TRUE(expected.m_data[idx]->m_id == actual.m_data[idx]->m_id);
+    EXPECT_EQ(expected.m_data[idx]->m_pos,  actual.m_data[idx]->m_pos);
+    EXPECT_EQ(expected.m_data[idx]->m_size, actual.m_data[idx]->m_size);
+  }
+}
+
+TEST_F(KaxAnalyzerIndexCache, MissThenHit) {
+  ASSERT_FALSE(bfs::exists(bfs::path{m_cache_name}));
+
+  auto scanned = analyze();
+  EXPECT_FALSE(scanned->is_data_from_index_cache());
+  EXPECT_FALSE(scanned->m_data.empty());
+  EXPECT_TRUE(bfs::exists(bfs::path{m_cache_name}));
+
+  auto cached = analyze();
+  EXPECT_TRUE(cached->is_data_from_index_cache());
+  expect_same_data(*scanned, *cached);
+}
+
+TEST_F(KaxAnalyzerIndexCache, DisabledCacheIsIgnored) {
+  analyze();
+  kax_analyzer_c::enable_index_cache(false);
+
+  EXPECT_FALSE(analyze()->is_data_from_index_cache());
+}
+
+TEST_F(KaxAnalyzerIndexCache, ModificationTimeInvalidates) {
+  analyze();
+
+  auto path = bfs::path{m_file_name};
+  bfs::last_write_time(path, bfs::last_write_time(path) + 10);
+
+  EXPECT_FALSE(analyze()->is_data_from_index_cache());
+  EXPECT_TRUE(analyze()->is_data_from_index_cache());
+}
+
+TEST_F(KaxAnalyzerIndexCache, ContentChangeWithSameSizeAndTimeInvalidates) {
+  auto scanned = analyze();
+
+  // Inside the void element near the end of the file, outside of the
+  // element headers.
+  overwrite_byte(-10);
+
+  auto rescanned = analyze();
+  EXPECT_FALSE(rescanned->is_data_from_index_cache());
+  expect_same_data(*scanned, *rescanned);
+
+  EXPECT_TRUE(analyze()->is_data_from_index_cache());
+}
+
+TEST_F(KaxAnalyzerIndexCache, CorruptCacheIsIgnored) {
+  analyze();
+
+  {
+    mm_file_io_c cache{m_cache_name, MODE_WRITE};
+    cache.truncate(cache.get_size() - 1);
+  }
+
+  EXPECT_FALSE(analyze()->is_data_from_index_cache());
+  EXPECT_TRUE(analyze()->is_data_from_index_cache());
+}
+
+}
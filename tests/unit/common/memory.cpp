@@ -0,0 +1,88 @@
+#include "common/common_pch.h"
+
+#include "common/memory.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Memory, ShareKeepsOwnerAlive) {
+  auto owner  = std::make_shared<std::string>("Hello world");
+  auto weak   = std::weak_ptr<std::string>{owner};
+  auto buffer = reinterpret_cast<unsigned char *>(&(*owner)[0]);
+  auto mem    = memory_c::share(buffer + 6, 5, owner);
+
+  owner.reset();
+
+  ASSERT_FALSE(weak.expired());
+  EXPECT_EQ(std::string{"world"}, std::string(reinterpret_cast<char *>(mem->get_buffer()), mem->get_size()));
+
+  mem.reset();
+
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(Memory, GrabDoesNotCopySharedMemory) {
+  auto owner  = std::make_shared<std::string>("Hello world");
+  auto buffer = reinterpret_cast<unsigned char *>(&(*owner)[0]);
+  auto mem    = memory_c::share(buffer, owner->length(), owner);
+
+  mem->grab();
+
+  EXPECT_EQ(buffer, mem->get_buffer());
+  EXPECT_FALSE(mem->is_free());
+}
+
+TEST(Memory, GrabCopiesUnownedMemory) {
+  std::string data{"Hello world"};
+  auto buffer = reinterpret_cast<unsigned char *>(&data[0]);
+  auto mem    = std::make_shared<memory_c>(buffer, data.length(), false);
+
+  mem->grab();
+
+  EXPECT_NE(buffer, mem->get_buffer());
+  EXPECT_TRUE(mem->is_free());
+  EXPECT_EQ(data, std::string(reinterpret_cast<char *>(mem->get_buffer()), mem->get_size()));
+}
+
+TEST(Memory, ResizeReleasesOwner) {
+  auto owner  = std::make_shared<std::string>("Hello world");
+  auto weak   = std::weak_ptr<std::string>{owner};
+  auto mem    = memory_c::share(&(*owner)[0], owner->length(), owner);
+
+  owner.reset();
+  mem->resize(5);
+
+  EXPECT_TRUE(weak.expired());
+  EXPECT_TRUE(mem->is_free());
+  EXPECT_EQ(std::string{"Hello"}, std::string(reinterpret_cast<char *>(mem->get_buffer()), mem->get_size()));
+}
+
+TEST(Memory, ResizeKeepsContentOfPooledBuffers) {
+  auto mem = memory_c::clone("Hello world");
+
+  mem->resize(100);
+  EXPECT_EQ(std::string{"Hello world"}, std::string(reinterpret_cast<char *>(mem->get_buffer()), 11));
+
+  mem->resize(100000);
+  EXPECT_EQ(std::string{"Hello world"}, std::string(reinterpret_cast<char *>(mem->get_buffer()), 11));
+  EXPECT_EQ(100000u, mem->get_size());
+
+  mem->resize(5);
+  EXPECT_EQ(std::string{"Hello"}, std::string(reinterpret_cast<char *>(mem->get_buffer()), mem->get_size()));
+}
+
+TEST(Memory, LockHandsOutMallocedBuffer) {
+  auto mem = memory_c::clone("Hello world");
+
+  mem->lock();
+
+  auto buffer = mem->get_buffer();
+  EXPECT_FALSE(mem->is_free());
+  EXPECT_EQ(std::string{"Hello world"}, std::string(reinterpret_cast<char *>(buffer), mem->get_size()));
+
+  mem.reset();
+  free(buffer);
+}
+
+}
@@ -0,0 +1,214 @@
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "common/memory_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(MemoryPool, CapacityIsRoundedUpToSizeClass) {
+  auto block = memory_pool_c::allocate(100);
+
+  EXPECT_EQ(128u, memory_pool_c::get_capacity(block));
+
+  memory_pool_c::release(block);
+}
+
+TEST(MemoryPool, LargeBlocksAreNotRoundedUp) {
+  auto size  = memory_pool_c::ms_max_pooled_size + 1;
+  auto block = memory_pool_c::allocate(size);
+
+  EXPECT_EQ(size, memory_pool_c::get_capacity(block));
+  memset(block, 42, size);
+
+  memory_pool_c::release(block);
+}
+
+TEST(MemoryPool, ReleasedBlocksAreReused) {
+  auto first = memory_pool_c::allocate(1000);
+  memory_pool_c::release(first);
+
+  auto second = memory_pool_c::allocate(1024);
+
+  EXPECT_EQ(first, second);
+
+  memory_pool_c::release(second);
+}
+
+TEST(MemoryPool, ReleasingNullptrIsAllowed) {
+  EXPECT_NO_THROW(memory_pool_c::release(nullptr));
+}
+
+TEST(MemoryPool, ConcurrentUse) {
+  auto workers = std::vector<std::thread>{};
+  auto failed  = std::vector<int>(4, 0);
+
+  for (auto worker_idx = 0u; worker_idx < failed.size(); ++worker_idx)
+    workers.emplace_back([worker_idx, &failed]() {
+      auto blocks = std::vector<std::pair<unsigned char *, size_t>>{};
+
+      for (auto round = 0u; round < 20000; ++round) {
+        auto size  = ((round * 7919) + worker_idx) % 3000;
+        auto block = memory_pool_c::allocate(size);
+        memset(block, worker_idx, size);
+        blocks.emplace_back(block, size);
+
+        if (blocks.size() < 16)
+          continue;
+
+        for (auto &entry : blocks) {
+          for (auto idx = 0u; idx < entry.second; ++idx)
+            if (entry.first[idx] != worker_idx)
+              failed[worker_idx] = 1;
+          memory_pool_c::release(entry.first);
+        }
+
+        blocks.clear();
+      }
+
+      for (auto &entry : blocks)
+        memory_pool_c::release(entry.first);
+    });
+
+  for (auto &worker : workers)
+    worker.join();
+
+  EXPECT_EQ(std::vector<int>(4, 0), failed);
+}
+
+TEST(MemoryPool, BlocksReleasedByOtherThreadsAreReused) {
+  auto block = memory_pool_c::allocate(10000);
+
+  // The releasing thread's cache is returned to the shared free list
+  // when it exits. A new thread's empty cache is refilled from the end
+  // of the shared list.
+  std::thread{[block]() { memory_pool_c::release(block); }}.join();
+
+  auto reused = static_cast<unsigned char *>(nullptr);
+  std::thread{[&reused]() {
+    reused = memory_pool_c::allocate(9000);
+    memory_pool_c::release(reused);
+  }}.join();
+
+  EXPECT_EQ(block, reused);
+}
+
+TEST(MemoryPool, ConcurrentReleasesByOtherThreads) {
+  std::mutex mutex;
+  std::condition_variable queued;
+  std::deque<std::pair<unsigned char *, size_t>> blocks;
+  auto num_producers_running = 2u;
+  auto failed                = std::vector<int>(2, 0);
+
+  auto producers = std::vector<std::thread>{};
+  auto consumers = std::vector<std::thread>{};
+
+  for (auto producer_idx = 0u; producer_idx < 2; ++producer_idx)
+    producers.emplace_back([producer_idx, &mutex, &queued, &blocks, &num_producers_running]() {
+      for (auto round = 0u; round < 50000; ++round) {
+        auto size  = ((round * 7919) + producer_idx) % 3000 + 1;
+        auto block = memory_pool_c::allocate(size);
+        memset(block, size & 0xff, size);
+
+        std::lock_guard<std::mutex> lock{mutex};
+        blocks.emplace_back(block, size);
+        queued.notify_one();
+      }
+
+      std::lock_guard<std::mutex> lock{mutex};
+      --num_producers_running;
+      queued.notify_all();
+    });
+
+  for (auto consumer_idx = 0u; consumer_idx < 2; ++consumer_idx)
+    consumers.emplace_back([consumer_idx, &mutex, &queued, &blocks, &num_producers_running, &failed]() {
+      while (true) {
+        std::unique_lock<std::mutex> lock{mutex};
+        queued.wait(lock, [&]() { return !blocks.empty() || !num_producers_running; });
+
+        if (blocks.empty())
+          return;
+
+        auto entry = blocks.front();
+        blocks.pop_front();
+        lock.unlock();
+
+        for (auto idx = 0u; idx < entry.second; ++idx)
+          if (entry.first[idx] != (entry.second & 0xff))
+            failed[consumer_idx] = 1;
+
+        memory_pool_c::release(entry.first);
+      }
+    });
+
+  for (auto &thread : producers)
+    thread.join();
+  for (auto &thread : consumers)
+    thread.join();
+
+  EXPECT_EQ(std::vector<int>(2, 0), failed);
+}
+
+// Compares the pool with malloc() and free() for several threads
+// allocating and releasing small blocks. The blocks are released
+// either by the allocating thread or by a neighbouring one. Run with
+// --gtest_also_run_disabled_tests.
+TEST(MemoryPool, DISABLED_BenchmarkAgainstMalloc) {
+  auto const num_threads = 4u, num_rounds = 5000u, num_blocks = 256u;
+
+  auto run = [&](std::function<unsigned char *(size_t)> const &allocate, std::function<void(unsigned char *)> const &release, bool cross_thread) -> double {
+    auto mailboxes = std::vector<std::vector<unsigned char *>>(num_threads);
+    auto mutexes   = std::vector<std::mutex>(num_threads);
+    auto threads   = std::vector<std::thread>{};
+    auto start     = std::chrono::steady_clock::now();
+
+    for (auto thread_idx = 0u; thread_idx < num_threads; ++thread_idx)
+      threads.emplace_back([&, thread_idx]() {
+        auto target = cross_thread ? (thread_idx + 1) % num_threads : thread_idx;
+        auto blocks = std::vector<unsigned char *>{};
+
+        for (auto round = 0u; round < num_rounds; ++round) {
+          blocks.clear();
+          for (auto idx = 0u; idx < num_blocks; ++idx)
+            blocks.push_back(allocate(16 + ((round + idx) * 37) % 1000));
+
+          {
+            std::lock_guard<std::mutex> lock{mutexes[target]};
+            std::swap(blocks, mailboxes[target]);
+          }
+
+          for (auto block : blocks)
+            release(block);
+        }
+      });
+
+    for (auto &thread : threads)
+      thread.join();
+
+    for (auto &mailbox : mailboxes)
+      for (auto block : mailbox)
+        release(block);
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+  };
+
+  auto pool_allocate   = [](size_t size) { return memory_pool_c::allocate(size); };
+  auto pool_release    = [](unsigned char *ptr) { memory_pool_c::release(ptr); };
+  auto malloc_allocate = [](size_t size) { return static_cast<unsigned char *>(malloc(size)); };
+  auto malloc_release  = [](unsigned char *ptr) { free(ptr); };
+
+  for (auto cross_thread : std::vector<bool>{ false, true })
+    std::cout << boost::format("released by %1% thread: memory pool %|2$8.1f| ms, malloc() %|3$8.1f| ms\n")
+      % (cross_thread ? "another" : "the same")
+      % run(pool_allocate, pool_release, cross_thread)
+      % run(malloc_allocate, malloc_release, cross_thread);
+}
+
+}
@@ -0,0 +1,67 @@
+#include "common/common_pch.h"
+
+#include "common/mm_async_write_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+contents(mm_mem_io_c &mem) {
+  return std::string(reinterpret_cast<char *>(mem.get_buffer()), mem.get_size());
+}
+
+TEST(MmAsyncWriteIo, SequentialWrites) {
+  mm_mem_io_c mem{nullptr, 0, 1024};
+  std::string expected;
+
+  {
+    mm_async_write_io_c out{&mem, 7, 2, false};
+
+    for (auto idx = 0; idx < 100; ++idx) {
+      auto line = (boost::format("line %1%\n") % idx).str();
+      expected += line;
+
+      out.write(line);
+      EXPECT_EQ(expected.size(), out.getFilePointer());
+    }
+
+    out.flush();
+    EXPECT_EQ(expected, contents(mem));
+  }
+
+  EXPECT_EQ(expected, contents(mem));
+}
+
+TEST(MmAsyncWriteIo, SeekingAndOverwriting) {
+  mm_mem_io_c mem{nullptr, 0, 1024};
+
+  {
+    mm_async_write_io_c out{&mem, 4, 1, false};
+
+    out.write(std::string{"Hello world"});
+    out.setFilePointer(6);
+    EXPECT_EQ(6u, out.getFilePointer());
+
+    out.write(std::string{"there"});
+    out.setFilePointer(0, seek_end);
+    out.write(std::string{"!"});
+  }
+
+  EXPECT_EQ(std::string{"Hello there!"}, contents(mem));
+}
+
+TEST(MmAsyncWriteIo, ReadingAfterWriting) {
+  mm_mem_io_c mem{nullptr, 0, 1024};
+  mm_async_write_io_c out{&mem, 3, 2, false};
+
+  out.write(std::string{"Chunky Bacon"});
+  out.setFilePointer(7);
+
+  std::string buffer;
+  EXPECT_EQ(5u, out.read(buffer, 5));
+  EXPECT_EQ(std::string{"Bacon"}, buffer);
+  EXPECT_EQ(12u, out.getFilePointer());
+}
+
+}
@@ -0,0 +1,156 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+#include "tests/unit/util.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_mmap_io.h"
+#include "common/mm_read_buffer_io.h"
+
+namespace {
+
+auto const s_file_name = std::string{"tests/unit/data/text/chunky_bacon.txt"};
+
+TEST(MmMmapIo, Read) {
+  if (!mm_mmap_io_c::is_supported())
+    return;
+
+  auto in = mm_mmap_io_c::open(s_file_name);
+  ASSERT_TRUE(!!in);
+
+  EXPECT_EQ(13, in->get_size());
+  EXPECT_EQ(std::string{"Chunky Bacon"}, in->getline());
+  EXPECT_EQ(13u, in->getFilePointer());
+  EXPECT_TRUE(in->eof());
+}
+
+TEST(MmMmapIo, Seek) {
+  if (!mm_mmap_io_c::is_supported())
+    return;
+
+  auto in = mm_mmap_io_c::open(s_file_name);
+  ASSERT_TRUE(!!in);
+
+  std::string buffer;
+
+  in->setFilePointer(7);
+  EXPECT_EQ(5u, in->read(buffer, 5));
+  EXPECT_EQ(std::string{"Bacon"}, buffer);
+
+  in->setFilePointer(-6, seek_end);
+  EXPECT_EQ('B', in->read_uint8());
+
+  in->setFilePointer(-8, seek_current);
+  EXPECT_EQ('C', in->read_uint8());
+
+  EXPECT_THROW(in->setFilePointer(14), mtx::mm_io::seek_x);
+  EXPECT_THROW(in->setFilePointer(-1), mtx::mm_io::seek_x);
+  EXPECT_NO_THROW(in->setFilePointer(0, seek_end));
+  EXPECT_EQ(0u, in->read(buffer, 5));
+}
+
+TEST(MmMmapIo, ReadShared) {
+  if (!mm_mmap_io_c::is_supported())
+    return;
+
+  auto in = mm_mmap_io_c::open(s_file_name);
+  ASSERT_TRUE(!!in);
+
+  in->setFilePointer(7);
+  auto bacon = in->read_shared(5);
+
+  EXPECT_EQ(std::string{"Bacon"}, bacon);
+  EXPECT_EQ(12u, in->getFilePointer());
+  EXPECT_THROW(in->read_shared(2), mtx::mm_io::end_of_file_x);
+
+  // The memory keeps the mapping alive.
+  in.reset();
+  EXPECT_EQ(std::string{"Bacon"}, bacon);
+
+  // The mapping is read-only; modifications require a copy.
+  EXPECT_TRUE(bacon->is_read_only());
+  bacon->make_writable();
+  EXPECT_FALSE(bacon->is_read_only());
+
+  bacon->get_buffer()[0] = 'b';
+  EXPECT_EQ(std::string{"bacon"}, bacon);
+  EXPECT_EQ(std::string{"Chunky Bacon\n"}, mm_file_io_c::slurp(s_file_name));
+}
+
+TEST(MmMmapIo, Truncation) {
+  if (!mm_mmap_io_c::is_supported())
+    return;
+
+  auto file_name = (bfs::temp_directory_path() / bfs::unique_path("mtx-mmap-io-%%%%-%%%%.bin")).string();
+
+  {
+    mm_file_io_c out{file_name, MODE_CREATE};
+    out.write(std::string(100, 'x'));
+  }
+
+  auto in = mm_mmap_io_c::open(file_name);
+  ASSERT_TRUE(!!in);
+
+  bfs::resize_file(bfs::path{file_name}, 50);
+
+  std::string buffer;
+
+  in->setFilePointer(40);
+  EXPECT_TRUE(g_warning_issued);
+  EXPECT_EQ(50, in->get_size());
+  EXPECT_EQ(10u, in->read(buffer, 20));
+  EXPECT_TRUE(in->eof());
+  EXPECT_THROW(in->setFilePointer(60), mtx::mm_io::seek_x);
+
+  in.reset();
+
+  boost::system::error_code ec;
+  bfs::remove(bfs::path{file_name}, ec);
+}
+
+TEST(MmMmapIo, WrapUsesMapping) {
+  if (!mm_mmap_io_c::is_supported())
+    return;
+
+  auto in = mm_mmap_io_c::open(s_file_name);
+  ASSERT_TRUE(!!in);
+
+  in->setFilePointer(7);
+
+  auto mapped   = std::static_pointer_cast<mm_mmap_io_c>(in)->get_mapped_data();
+  auto buffered = mm_read_buffer_io_c::wrap(in);
+
+  EXPECT_EQ(7u, buffered->getFilePointer());
+  ASSERT_TRUE(buffered->cursor_ensure(5));
+  EXPECT_EQ(mapped->get_buffer() + 7, buffered->cursor_data());
+  EXPECT_FALSE(buffered->cursor_ensure(7));
+
+  uint32_t u32;
+  buffered->setFilePointer(0);
+  ASSERT_TRUE(buffered->try_read_uint32_be(u32));
+  EXPECT_EQ(0x4368756eu, u32);
+  EXPECT_EQ(std::string{"ky Bacon"}, buffered->getline());
+  EXPECT_EQ(13u, buffered->getFilePointer());
+
+  buffered->setFilePointer(-6, seek_end);
+  EXPECT_EQ('B', buffered->read_uint8());
+  EXPECT_THROW(buffered->setFilePointer(-1), mtx::mm_io::seek_x);
+}
+
+TEST(MmMmapIo, Unmappable) {
+  EXPECT_FALSE(mm_mmap_io_c::open("doesnotexist"));
+  EXPECT_FALSE(mm_mmap_io_c::open("tests/unit/data/text"));
+}
+
+TEST(MmMmapIo, ReadSharedCopiesByDefault) {
+  auto data = std::string{"Chunky Bacon"};
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(data.c_str()), data.length()};
+
+  in.setFilePointer(7);
+  auto bacon = in.read_shared(5);
+
+  EXPECT_EQ(std::string{"Bacon"}, bacon);
+  EXPECT_NE(reinterpret_cast<unsigned char const *>(data.c_str()) + 7, bacon->get_buffer());
+}
+
+}
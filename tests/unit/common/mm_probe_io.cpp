@@ -0,0 +1,99 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+#include "tests/unit/util.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_probe_io.h"
+
+namespace {
+
+std::string const s_content{"0123456789abcdefghijklmnopqrstuvwxyz"};
+auto const s_data = reinterpret_cast<unsigned char const *>(s_content.c_str());
+
+TEST(MmProbeIo, ReadsFromHead) {
+  mm_mem_io_c in{s_data, s_content.length()};
+  mm_probe_io_c probe{&in, 10};
+
+  EXPECT_EQ(0u, probe.get_head_size());
+  EXPECT_EQ(36, probe.get_size());
+
+  std::string buffer;
+  for (auto idx = 0; idx < 3; ++idx) {
+    probe.setFilePointer(2);
+    EXPECT_EQ(5u, probe.read(buffer, 5));
+    EXPECT_EQ(std::string{"23456"}, buffer);
+  }
+
+  EXPECT_EQ(7u,  probe.getFilePointer());
+  EXPECT_EQ(10u, probe.get_head_size());
+  EXPECT_EQ(0u,  probe.get_num_deep_reads());
+}
+
+TEST(MmProbeIo, ReadsBeyondHead) {
+  mm_mem_io_c in{s_data, s_content.length()};
+  mm_probe_io_c probe{&in, 10};
+
+  std::string buffer;
+  probe.setFilePointer(8);
+  EXPECT_EQ(6u, probe.read(buffer, 6));
+  EXPECT_EQ(std::string{"89abcd"}, buffer);
+  EXPECT_EQ(1u, probe.get_num_deep_reads());
+  EXPECT_EQ(4u, probe.get_num_deep_bytes());
+
+  probe.setFilePointer(-2, seek_end);
+  EXPECT_EQ(2u, probe.read(buffer, 5));
+  EXPECT_EQ(std::string{"yz"}, buffer);
+  EXPECT_TRUE(probe.eof());
+
+  probe.setFilePointer(0);
+  EXPECT_FALSE(probe.eof());
+  EXPECT_EQ('0', probe.read_uint8());
+
+  EXPECT_THROW(probe.setFilePointer(-1), mtx::mm_io::seek_x);
+}
+
+TEST(MmProbeIo, HeadLargerThanFile) {
+  mm_mem_io_c in{s_data, s_content.length()};
+  mm_probe_io_c probe{&in, 1024};
+
+  EXPECT_EQ(0, memcmp(probe.get_head(12), s_content.c_str(), 36));
+  EXPECT_EQ(36u, probe.get_head_size());
+
+  std::string buffer;
+  probe.setFilePointer(30);
+  EXPECT_EQ(6u, probe.read(buffer, 10));
+  EXPECT_EQ(0u, probe.get_num_deep_reads());
+}
+
+TEST(MmProbeIo, ReadsHeadOnDemand) {
+  std::string content;
+  for (auto idx = 0; idx < 300 * 1024; ++idx)
+    content += static_cast<char>(idx % 251);
+
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()};
+  mm_probe_io_c probe{&in, 256 * 1024};
+
+  EXPECT_EQ(0u, probe.get_head_size());
+
+  EXPECT_EQ(content[4], static_cast<char>(probe.get_head(12)[4]));
+  EXPECT_EQ(64u * 1024, probe.get_head_size());
+
+  probe.setFilePointer(100 * 1024);
+  EXPECT_EQ(content[100 * 1024], static_cast<char>(probe.read_uint8()));
+  EXPECT_EQ(128u * 1024, probe.get_head_size());
+
+  probe.setFilePointer(10);
+  EXPECT_EQ(content[10], static_cast<char>(probe.read_uint8()));
+  EXPECT_EQ(128u * 1024, probe.get_head_size());
+
+  std::string buffer;
+  probe.setFilePointer(250 * 1024);
+  EXPECT_EQ(10u * 1024, probe.read(buffer, 10 * 1024));
+  EXPECT_EQ(content.substr(250 * 1024, 10 * 1024), buffer);
+  EXPECT_EQ(256u * 1024, probe.get_head_size());
+  EXPECT_EQ(1u,          probe.get_num_deep_reads());
+  EXPECT_EQ(4u * 1024,   probe.get_num_deep_bytes());
+}
+
+}
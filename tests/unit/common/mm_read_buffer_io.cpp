@@ -0,0 +1,97 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+#include "tests/unit/util.h"
+
+#include "common/mm_read_buffer_io.h"
+
+namespace {
+
+std::string const s_content{"0123456789abcdefghijklmnopqrstuvwxyz"};
+auto const s_data = reinterpret_cast<unsigned char const *>(s_content.c_str());
+
+TEST(MmReadBufferIo, TryReadAcrossRefills) {
+  mm_mem_io_c in{s_data, s_content.length()};
+  mm_read_buffer_io_c buffered{&in, 5, false};
+
+  uint8_t u8;
+  uint16_t u16;
+  uint32_t u32;
+
+  ASSERT_TRUE(buffered.try_read_uint8(u8));
+  EXPECT_EQ('0', u8);
+  ASSERT_TRUE(buffered.try_read_uint16_be(u16));
+  EXPECT_EQ(0x3132u, u16);
+  ASSERT_TRUE(buffered.try_read_uint32_be(u32));
+  EXPECT_EQ(0x33343536u, u32);
+  EXPECT_EQ(7u, buffered.getFilePointer());
+
+  EXPECT_EQ('7', buffered.read_uint8());
+  ASSERT_TRUE(buffered.try_read_uint8(u8));
+  EXPECT_EQ('8', u8);
+  EXPECT_EQ(9u, buffered.getFilePointer());
+}
+
+TEST(MmReadBufferIo, CursorAtEnd) {
+  mm_mem_io_c in{s_data, s_content.length()};
+  mm_read_buffer_io_c buffered{&in, 8, false};
+
+  buffered.setFilePointer(-3, seek_end);
+
+  EXPECT_TRUE(buffered.cursor_ensure(3));
+  EXPECT_EQ(0, memcmp(buffered.cursor_data(), "xyz", 3));
+  EXPECT_FALSE(buffered.cursor_ensure(4));
+  EXPECT_EQ(3u, buffered.cursor_available());
+
+  buffered.cursor_advance(2);
+
+  uint16_t u16;
+  EXPECT_FALSE(buffered.try_read_uint16_be(u16));
+  EXPECT_EQ(35u, buffered.getFilePointer());
+}
+
+TEST(MmReadBufferIo, TrySkip) {
+  mm_mem_io_c in{s_data, s_content.length()};
+  mm_read_buffer_io_c buffered{&in, 4, false};
+
+  uint8_t u8;
+
+  EXPECT_TRUE(buffered.try_skip(2));
+  ASSERT_TRUE(buffered.try_read_uint8(u8));
+  EXPECT_EQ('2', u8);
+
+  EXPECT_TRUE(buffered.try_skip(20));
+  EXPECT_EQ(23u, buffered.getFilePointer());
+  ASSERT_TRUE(buffered.try_read_uint8(u8));
+  EXPECT_EQ('n', u8);
+
+  EXPECT_TRUE(buffered.try_skip(-10));
+  ASSERT_TRUE(buffered.try_read_uint8(u8));
+  EXPECT_EQ('e', u8);
+
+  EXPECT_FALSE(buffered.try_skip(100));
+  EXPECT_FALSE(buffered.try_skip(-100));
+  EXPECT_EQ(15u, buffered.getFilePointer());
+
+  EXPECT_TRUE(buffered.try_skip(21));
+  EXPECT_FALSE(buffered.try_read_uint8(u8));
+}
+
+TEST(MmReadBufferIo, Wrap) {
+  auto in = mm_io_cptr{new mm_mem_io_c{s_data, s_content.length()}};
+  in->setFilePointer(10);
+
+  auto buffered = mm_read_buffer_io_c::wrap(in, 4);
+  ASSERT_TRUE(!!buffered);
+  EXPECT_EQ(10u, buffered->getFilePointer());
+  EXPECT_EQ(36u, buffered->get_size());
+
+  uint32_t u32;
+  ASSERT_TRUE(buffered->try_read_uint32_be(u32));
+  EXPECT_EQ(0x61626364u, u32);
+
+  auto rewrapped = mm_read_buffer_io_c::wrap(buffered);
+  EXPECT_EQ(buffered.get(), rewrapped.get());
+}
+
+}
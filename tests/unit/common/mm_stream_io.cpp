@@ -0,0 +1,90 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+#include "tests/unit/util.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_read_buffer_io.h"
+#include "common/mm_stream_io.h"
+
+namespace {
+
+std::string
+make_content(size_t size) {
+  std::string content;
+  for (size_t idx = 0; idx < size; ++idx)
+    content += static_cast<char>(idx % 251);
+
+  return content;
+}
+
+TEST(MmStreamIo, Head) {
+  auto content = make_content(1000);
+  mm_stream_io_c in{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()}, "test", 100};
+
+  EXPECT_EQ(-1, in.get_size());
+  EXPECT_THROW(in.setFilePointer(-1, seek_end), mtx::mm_io::seek_x);
+
+  auto head = in.read_head(2000);
+  EXPECT_EQ(1000u, head->get_size());
+  EXPECT_EQ(0, memcmp(head->get_buffer(), content.c_str(), 1000));
+  EXPECT_EQ(0u, in.getFilePointer());
+  EXPECT_FALSE(in.eof());
+
+  EXPECT_EQ(1000, in.get_size());
+  in.setFilePointer(-10, seek_end);
+  EXPECT_EQ(content[990], static_cast<char>(in.read_uint8()));
+}
+
+TEST(MmStreamIo, History) {
+  auto content = make_content(300 * 1024);
+  mm_stream_io_c in{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()}, "test", 1000};
+
+  in.setFilePointer(100);
+  EXPECT_EQ(content[100], static_cast<char>(in.read_uint8()));
+
+  in.release_head();
+
+  // Seeking forward reads and discards the data in between.
+  in.setFilePointer(200 * 1024);
+  EXPECT_EQ(content[200 * 1024], static_cast<char>(in.read_uint8()));
+
+  in.setFilePointer(200 * 1024 - 500);
+  EXPECT_EQ(content[200 * 1024 - 500], static_cast<char>(in.read_uint8()));
+
+  EXPECT_THROW(in.setFilePointer(100), mtx::mm_io::seek_x);
+  EXPECT_THROW(in.read_head(10), mtx::mm_io::seek_x);
+
+  unsigned char buffer[100];
+  in.setFilePointer(-50, seek_current);
+  EXPECT_EQ(100u, in.read(buffer, 100));
+  EXPECT_EQ(0, memcmp(buffer, content.c_str() + 200 * 1024 - 500 + 1 - 50, 100));
+
+  in.setFilePointer(content.length() - 10);
+  EXPECT_EQ(10u, in.read(buffer, 100));
+  EXPECT_TRUE(in.eof());
+  EXPECT_EQ(static_cast<int64_t>(content.length()), in.get_size());
+}
+
+TEST(MmStreamIo, ReadBufferWhileSizeIsUnknown) {
+  auto content  = make_content(300 * 1024);
+  auto in       = std::make_shared<mm_stream_io_c>(new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()}, "test", 1000);
+  auto buffered = mm_read_buffer_io_c::wrap(in, 16 * 1024);
+
+  EXPECT_EQ(-1, buffered->get_size());
+  EXPECT_THROW(buffered->setFilePointer(-1, seek_end), mtx::mm_io::seek_x);
+
+  buffered->setFilePointer(100 * 1024);
+  EXPECT_EQ(content[100 * 1024], static_cast<char>(buffered->read_uint8()));
+
+  in->release_head();
+
+  std::string buffer;
+  buffered->setFilePointer(200 * 1024);
+  EXPECT_EQ(100u * 1024, buffered->read(buffer, content.length()));
+  EXPECT_EQ(content.substr(200 * 1024), buffer);
+  EXPECT_TRUE(buffered->eof());
+  EXPECT_EQ(static_cast<int64_t>(content.length()), buffered->get_size());
+}
+
+}
@@ -0,0 +1,69 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+#include "tests/unit/util.h"
+
+#include "common/mm_io_x.h"
+
+namespace {
+
+std::vector<std::string>
+read_lines(std::string const &content) {
+  mm_text_io_c in{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()}};
+  std::vector<std::string> lines;
+  std::string line;
+
+  while (in.getline2(line))
+    lines.push_back(line);
+
+  return lines;
+}
+
+TEST(MmTextIo, LineEndings) {
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "", "four" }), read_lines("one\ntwo\n\nfour\n"));
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "", "four" }), read_lines("one\r\ntwo\r\n\r\nfour"));
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "", "four" }), read_lines("one\rtwo\r\rfour\r"));
+}
+
+TEST(MmTextIo, LongLines) {
+  auto long_line = std::string(100000, 'x');
+
+  EXPECT_EQ((std::vector<std::string>{ long_line, "y" }), read_lines(long_line + "\r\ny"));
+}
+
+TEST(MmTextIo, Utf8) {
+  EXPECT_EQ((std::vector<std::string>{ "\xc3\xa4", "b" }), read_lines("\xef\xbb\xbf\xc3\xa4\nb"));
+  EXPECT_EQ((std::vector<std::string>{ "a" }),             read_lines("\xef\xbb\xbf" "a\xc3"));
+
+  std::string content{"\xef\xbb\xbf\xff\n"};
+  mm_text_io_c in{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()}};
+  EXPECT_THROW(in.getline(), mtx::mm_io::text::invalid_utf8_char_x);
+}
+
+TEST(MmTextIo, Utf16) {
+  EXPECT_EQ((std::vector<std::string>{ "a", "\xc3\xa4" }), read_lines(std::string{"\xff\xfe" "a\0\r\0\n\0\xe4\0", 10}));
+}
+
+TEST(MmTextIo, Positions) {
+  std::string content{"\xef\xbb\xbfone\ntwo\nthree"};
+  mm_mem_io_c mem{reinterpret_cast<unsigned char const *>(content.c_str()), content.length()};
+
+  {
+    mm_text_io_c in{&mem, false};
+
+    EXPECT_EQ(std::string{"one"}, in.getline());
+    EXPECT_EQ(7u, in.getFilePointer());
+    EXPECT_EQ('t', in.read_uint8());
+
+    in.setFilePointer(0);
+    EXPECT_EQ(3u, in.getFilePointer());
+    EXPECT_EQ(std::string{"one"}, in.getline());
+    EXPECT_EQ(std::string{"two"}, in.getline());
+    EXPECT_FALSE(in.eof());
+  }
+
+  // The proxied I/O is positioned after the last line read.
+  EXPECT_EQ(11u, mem.getFilePointer());
+}
+
+}
@@ -0,0 +1,109 @@
+#include "common/common_pch.h"
+
+#include "common/mpeg.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::size_t
+find_start_code_naive(std::vector<unsigned char> const &buffer) {
+  for (std::size_t pos = 0; (pos + 2) < buffer.size(); ++pos)
+    if (!buffer[pos] && !buffer[pos + 1] && (1 == buffer[pos + 2]))
+      return pos;
+
+  return buffer.size();
+}
+
+TEST(MPEG, FindStartCodeSmallBuffers) {
+  unsigned char buffer[] = { 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01 };
+
+  EXPECT_EQ(0u, mtx::mpeg::find_start_code(buffer, 0));
+  EXPECT_EQ(2u, mtx::mpeg::find_start_code(buffer, 2));
+  EXPECT_EQ(0u, mtx::mpeg::find_start_code(buffer, 3));
+  EXPECT_EQ(0u, mtx::mpeg::find_start_code(buffer, 7));
+  EXPECT_EQ(1u, mtx::mpeg::find_start_code(buffer + 3, 4));
+  EXPECT_EQ(3u, mtx::mpeg::find_start_code(buffer + 1, 3));
+}
+
+TEST(MPEG, FindStartCodeAtAllPositions) {
+  for (std::size_t size = 3; size < 100; ++size)
+    for (std::size_t pos = 0; (pos + 3) <= size; ++pos) {
+      std::vector<unsigned char> buffer(size, 0x00);
+
+      // Lots of zeros but no start code except for the one at 'pos'.
+      for (std::size_t idx = 2; idx < size; idx += 3)
+        buffer[idx] = 0x02;
+
+      buffer[pos]     = 0x00;
+      buffer[pos + 1] = 0x00;
+      buffer[pos + 2] = 0x01;
+
+      EXPECT_EQ(find_start_code_naive(buffer), mtx::mpeg::find_start_code(&buffer[0], size));
+    }
+}
+
+TEST(MPEG, FindStartCodeRandomData) {
+  std::vector<unsigned char> buffer(4096);
+  unsigned int state = 4711;
+
+  for (auto run = 0; run < 200; ++run) {
+    for (auto &byte : buffer) {
+      state = state * 1103515245u + 12345u;
+      auto value = (state >> 16) & 0xff;
+      byte = value < 0xa0 ? 0x00 : value < 0xa8 ? 0x01 : value;
+    }
+
+    std::size_t offset = 0;
+    while (offset < buffer.size()) {
+      std::vector<unsigned char> rest(buffer.begin() + offset, buffer.end());
+      auto expected = find_start_code_naive(rest);
+
+      ASSERT_EQ(expected, mtx::mpeg::find_start_code(&buffer[offset], rest.size()));
+
+      offset += expected + 1;
+    }
+  }
+}
+
+TEST(MPEG, FindNALUStartCode) {
+  unsigned char buffer[] = { 0x12, 0x00, 0x00, 0x01, 0x65, 0x00, 0x00, 0x00, 0x01, 0x41, 0x00, 0x00 };
+  std::size_t marker_size = 0;
+
+  EXPECT_EQ(1u, mtx::mpeg::find_nalu_start_code(buffer, sizeof(buffer), 0, marker_size));
+  EXPECT_EQ(3u, marker_size);
+
+  EXPECT_EQ(5u, mtx::mpeg::find_nalu_start_code(buffer, sizeof(buffer), 4, marker_size));
+  EXPECT_EQ(4u, marker_size);
+
+  EXPECT_EQ(sizeof(buffer), mtx::mpeg::find_nalu_start_code(buffer, sizeof(buffer), 9, marker_size));
+  EXPECT_EQ(sizeof(buffer), mtx::mpeg::find_nalu_start_code(buffer, sizeof(buffer), 20, marker_size));
+}
+
+TEST(MPEG, SplitNALUs) {
+  unsigned char stream[] = { 0x00, 0x00, 0x00, 0x01, 0x65, 0x11, 0x22, 0x00, 0x00, 0x01, 0x41, 0x33, 0x00, 0x00, 0x00, 0x01, 0x06 };
+  auto expected_nalus    = std::vector<std::string>{ std::string{"\x65\x11\x22"}, std::string{"\x41\x33"} };
+  auto expected_offsets  = std::vector<std::size_t>{ 0, 7 };
+
+  for (std::size_t split_at = 0; split_at <= sizeof(stream); ++split_at) {
+    auto nalus           = std::vector<std::string>{};
+    auto offsets         = std::vector<std::size_t>{};
+    auto unparsed_buffer = memory_cptr{};
+    auto base_offset     = std::size_t{};
+    auto handle_nalu     = [&](memory_cptr const &nalu, std::size_t offset) {
+      nalus.emplace_back(reinterpret_cast<char const *>(nalu->get_buffer()), nalu->get_size());
+      offsets.push_back(base_offset + offset);
+    };
+
+    base_offset += mtx::mpeg::split_nalus(stream,            split_at,                  unparsed_buffer, handle_nalu);
+    base_offset += mtx::mpeg::split_nalus(stream + split_at, sizeof(stream) - split_at, unparsed_buffer, handle_nalu);
+
+    EXPECT_EQ(expected_nalus,   nalus);
+    EXPECT_EQ(expected_offsets, offsets);
+    EXPECT_EQ(12u,              base_offset);
+    ASSERT_TRUE(!!unparsed_buffer);
+    EXPECT_EQ(std::string("\x00\x00\x00\x01\x06", 5), std::string(reinterpret_cast<char const *>(unparsed_buffer->get_buffer()), unparsed_buffer->get_size()));
+  }
+}
+
+}
@@ -0,0 +1,17 @@
+#include "common/common_pch.h"
+
+#include "common/strings/editing.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(StringsEditing, EscapeJson) {
+  EXPECT_EQ(std::string{""},                   escape_json(""));
+  EXPECT_EQ(std::string{"Chunky Bacon"},       escape_json("Chunky Bacon"));
+  EXPECT_EQ(std::string{"a\\\"b\\\\c"},        escape_json("a\"b\\c"));
+  EXPECT_EQ(std::string{"\\n\\r\\t\\u0001"},   escape_json("\n\r\t\x01"));
+  EXPECT_EQ(std::string{"\xc3\xa4\xc3\xb6"},   escape_json("\xc3\xa4\xc3\xb6"));
+}
+
+}
@@ -0,0 +1,53 @@
+#include "common/common_pch.h"
+
+#include "common/strings/fast_format.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(StringsFastFormat, Literals) {
+  EXPECT_EQ("",                    fast_format_c{""}.format({}));
+  EXPECT_EQ("chunky bacon",        fast_format_c{"chunky bacon"}.format({}));
+  EXPECT_EQ("100% and %",          fast_format_c{"100%% and %%"}.format({}));
+  EXPECT_EQ(0u,                    fast_format_c{"chunky bacon"}.get_num_args());
+}
+
+TEST(StringsFastFormat, DefaultFormatting) {
+  auto format = fast_format_c{"%1% frame, track %2%, timecode %3% (%4%), size %5%%6%\n"};
+
+  EXPECT_EQ(6u, format.get_num_args());
+  EXPECT_EQ("I frame, track 1, timecode -42 (00:00:00.042), size 1234567890123\n",
+            format.format({ 'I', 1u, -42ll, std::string{"00:00:00.042"}, 1234567890123ull, "" }));
+}
+
+TEST(StringsFastFormat, MatchesBoostFormat) {
+  auto check = [](std::string const &spec, fast_format_c::arg_c const &arg, std::string const &expected) {
+    EXPECT_EQ(expected, fast_format_c{spec}.format({ arg })) << spec;
+  };
+
+  check("adler 0x%|1$08x|", 0x1234abcdu,                     (boost::format("adler 0x%|1$08x|") % 0x1234abcdu).str());
+  check("adler 0x%|1$08x|", 0xbcdu,                          (boost::format("adler 0x%|1$08x|") % 0xbcdu).str());
+  check("duration %|1$.3f|", 41.70833206176758,               (boost::format("duration %|1$.3f|") % 41.70833206176758).str());
+  check("%|1$02d|:",        7,                               (boost::format("%|1$02d|:") % 7).str());
+  check("%|1$5|",           42u,                             (boost::format("%|1$5|") % 42u).str());
+  check("%1%",              -9223372036854775807ll - 1,       (boost::format("%1%") % (-9223372036854775807ll - 1)).str());
+  check("%1%",              18446744073709551615ull,          (boost::format("%1%") % 18446744073709551615ull).str());
+  check("%1%",              0.5,                             (boost::format("%1%") % 0.5).str());
+}
+
+TEST(StringsFastFormat, ReorderedAndRepeatedArguments) {
+  auto format = fast_format_c{"%2% %1% %2%"};
+
+  EXPECT_EQ("bacon chunky bacon", format.format({ "chunky", "bacon" }));
+
+  auto dst = std::string{"moose: "};
+  format.append(dst, { 1, 2 });
+  EXPECT_EQ("moose: 2 1 2", dst);
+}
+
+TEST(StringsFastFormat, MissingArgumentsAreEmpty) {
+  EXPECT_EQ("a  c", fast_format_c{"a %1% c"}.format({}));
+}
+
+}
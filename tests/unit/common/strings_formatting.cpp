@@ -21,4 +21,16 @@ TEST(StringsFormatting, FileSize) {
   EXPECT_EQ(   "2.0 GiB", format_file_size(2147483648ll));
 }
 
+TEST(StringsFormatting, AppendTimecodeMatchesFormatTimecode) {
+  auto timecodes = std::vector<int64_t>{ 0, 1, 499999, 500000, 999999999, 1000000000, 59999999999ll, 3599999500000ll, 3600000000000ll, 362439123456789ll, -1, -1500000, -3600000000001ll };
+
+  for (auto timecode : timecodes)
+    for (auto precision : std::vector<unsigned int>{ 0, 1, 3, 6, 9, 12 }) {
+      auto appended = std::string{"prefix "};
+      append_timecode(appended, timecode, precision);
+
+      EXPECT_EQ("prefix " + format_timecode(timecode, precision), appended) << "timecode " << timecode << " precision " << precision;
+    }
+}
+
 }
@@ -0,0 +1,59 @@
+#include "common/common_pch.h"
+
+#include <atomic>
+
+#include "common/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(ThreadPool, RunsAllJobs) {
+  auto results = std::vector<unsigned int>(1000, 0);
+  auto futures = std::vector<std::future<void>>{};
+
+  {
+    thread_pool_c pool{4};
+    EXPECT_EQ(4u, pool.get_num_threads());
+
+    for (auto idx = 0u; idx < results.size(); ++idx)
+      futures.emplace_back(pool.submit([&results, idx]() { results[idx] = idx * 2; }));
+
+    for (auto &future : futures)
+      ASSERT_NO_THROW(future.get());
+  }
+
+  for (auto idx = 0u; idx < results.size(); ++idx)
+    EXPECT_EQ(idx * 2, results[idx]);
+}
+
+TEST(ThreadPool, PropagatesExceptions) {
+  thread_pool_c pool{2};
+
+  auto failing = pool.submit([]() { throw std::runtime_error{"chunky bacon"}; });
+  auto working = pool.submit([]() {});
+
+  EXPECT_THROW(failing.get(), std::runtime_error);
+  EXPECT_NO_THROW(working.get());
+}
+
+TEST(ThreadPool, DestructorWaitsForQueuedJobs) {
+  std::atomic<unsigned int> num_run{0};
+
+  {
+    thread_pool_c pool{1};
+    for (auto idx = 0; idx < 100; ++idx)
+      pool.submit([&num_run]() { ++num_run; });
+  }
+
+  EXPECT_EQ(100u, num_run.load());
+}
+
+TEST(ThreadPool, DefaultNumberOfThreads) {
+  thread_pool_c pool;
+
+  EXPECT_LE(1u, pool.get_num_threads());
+  EXPECT_EQ(thread_pool_c::get_default_num_threads(), pool.get_num_threads());
+}
+
+}
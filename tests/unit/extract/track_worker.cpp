@@ -0,0 +1,107 @@
+#include "common/common_pch.h"
+
+#include <future>
+
+#include "extract/track_worker.h"
+#include "extract/xtr_base.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class failing_xtr_c: public xtr_base_c {
+public:
+  failing_xtr_c(track_spec_t &tspec)
+    : xtr_base_c{"A_MS/ACM", 0, tspec}
+  {
+  }
+
+  virtual void handle_frame(xtr_frame_t &) {
+    mxerror("cannot handle the frame\n");
+  }
+};
+
+void
+queue_frame(track_worker_c &worker,
+            xtr_base_c &extractor,
+            std::string const &content) {
+  auto frame = memory_c::clone(content);
+
+  worker.add_job([&extractor, frame]() mutable {
+    xtr_frame_t f{frame, nullptr, 0, 0, -1, -1, true, false, true, timecode_c{}};
+    extractor.decode_and_handle_frame(f);
+  });
+}
+
+TEST(TrackWorker, RunsJobsInOrder) {
+  track_worker_c worker{2};
+  auto result = std::vector<int>{};
+
+  for (auto idx = 0; idx < 100; ++idx)
+    worker.add_job([&result, idx]() { result.push_back(idx); });
+
+  ASSERT_NO_THROW(worker.finish());
+
+  ASSERT_EQ(100u, result.size());
+  for (auto idx = 0; idx < 100; ++idx)
+    EXPECT_EQ(idx, result[idx]);
+}
+
+TEST(TrackWorker, ExtractsFrames) {
+  track_spec_t tspec;
+  xtr_base_c extractor{"A_MS/ACM", 0, tspec};
+  auto out = std::make_shared<mm_mem_io_c>(nullptr, 0, 1024);
+  extractor.m_out = out;
+
+  track_worker_c worker{4};
+  for (auto idx = 0; idx < 20; ++idx)
+    queue_frame(worker, extractor, (boost::format("frame %1%;") % idx).str());
+
+  ASSERT_NO_THROW(worker.finish());
+
+  auto expected = std::string{};
+  for (auto idx = 0; idx < 20; ++idx)
+    expected += (boost::format("frame %1%;") % idx).str();
+
+  EXPECT_EQ(static_cast<int64_t>(expected.size()), extractor.m_bytes_written);
+  EXPECT_EQ(expected, std::string(reinterpret_cast<char const *>(out->get_buffer()), out->get_size()));
+}
+
+TEST(TrackWorker, ErrorsAreRethrownOnTheAddingThread) {
+  track_spec_t tspec;
+  failing_xtr_c extractor{tspec};
+  track_worker_c worker{1};
+
+  queue_frame(worker, extractor, "frame");
+
+  try {
+    worker.finish();
+    FAIL() << "no exception thrown";
+  } catch (mtx::output::error_x &ex) {
+    EXPECT_EQ(std::string{"cannot handle the frame\n"}, ex.error());
+  }
+}
+
+TEST(TrackWorker, AbortDropsQueuedJobs) {
+  track_worker_c worker{100};
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  auto num_run  = 0;
+
+  worker.add_job([released]() { released.wait(); });
+  for (auto idx = 0; idx < 50; ++idx)
+    worker.add_job([&num_run]() { ++num_run; });
+
+  std::thread releaser{[&release]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    release.set_value();
+  }};
+
+  worker.abort();
+  releaser.join();
+
+  EXPECT_EQ(0, num_run);
+  EXPECT_NO_THROW(worker.finish());
+}
+
+}
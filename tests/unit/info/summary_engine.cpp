@@ -0,0 +1,129 @@
+#include "common/common_pch.h"
+
+#include "common/checksums/base.h"
+#include "common/mm_io.h"
+#include "info/summary_engine.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+element(std::string const &id,
+        std::string const &data) {
+  // Always use eight bytes for the size.
+  auto result = id + std::string(1, '\x01');
+  for (auto shift = 48; shift >= 0; shift -= 8)
+    result += static_cast<char>((data.size() >> shift) & 0xff);
+
+  return result + data;
+}
+
+std::string
+create_clusters() {
+  auto xiph_laced = std::string{"\x82\xff\xfd\x02\x02\xff\x2d\x02", 8} + std::string(300, 'b') + std::string(2, 'c') + std::string(7, 'd');
+  auto ebml_laced = std::string{"\x81\x00\x0a\x06\x02\x40\x64\xb5", 8} + std::string(100, 'e') + std::string(90, 'f') + std::string(50, 'g');
+  auto fixed_laced = std::string{"\x83\x00\x00\x04\x03", 5} + std::string(100, 'h');
+
+  auto first_cluster = element("\xe7", std::string{"\x03\xe8", 2})
+                     + element("\xa3", std::string{"\x81\x00\x05\x80", 4} + std::string(10, 'a'))
+                     + element("\xa0", element("\xa1", xiph_laced) + element("\x9b", "\x14") + element("\xfb", "\xfe") + element("\xfb", "\x02"))
+                     + element("\xec", std::string(5, '\0'))
+                     + element("\xa3", ebml_laced)
+                     + element("\xa3", fixed_laced);
+  auto second_cluster = element("\xe7", "\x10")
+                      + element("\xa3", std::string{"\x81\x00\x01\x00", 4} + std::string(3, 'z'));
+
+  return element("\x1f\x43\xb6\x75", first_cluster) + element("\x1f\x43\xb6\x75", second_cluster);
+}
+
+std::vector<summary_block_t>
+summarize(std::string const &data,
+          bool calc_checksums,
+          unsigned int &num_clusters) {
+  auto blocks = std::vector<summary_block_t>{};
+
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(data.c_str()), data.size()};
+  summary_engine_c engine{in, [&blocks](summary_block_t const &block) { blocks.push_back(block); }, calc_checksums};
+
+  num_clusters = 0;
+  while (engine.process_cluster(1000000, data.size()))
+    ++num_clusters;
+
+  engine.flush();
+
+  return blocks;
+}
+
+TEST(SummaryEngine, ParsesBlockHeaders) {
+  auto num_clusters = 0u;
+  auto blocks       = summarize(create_clusters(), false, num_clusters);
+
+  EXPECT_EQ(2u, num_clusters);
+  ASSERT_EQ(5u, blocks.size());
+
+  EXPECT_EQ('I',         blocks[0].get_frame_type());
+  EXPECT_EQ(1u,          blocks[0].m_track_number);
+  EXPECT_EQ(1005000000,  blocks[0].m_timecode);
+  ASSERT_EQ(1u,          blocks[0].m_frames.size());
+  EXPECT_EQ(36,          blocks[0].m_frames[0].m_position);
+  EXPECT_EQ(10,          blocks[0].m_frames[0].m_size);
+
+  EXPECT_EQ('B',         blocks[1].get_frame_type());
+  EXPECT_EQ(2u,          blocks[1].m_track_number);
+  EXPECT_EQ(997000000,   blocks[1].m_timecode);
+  EXPECT_TRUE(blocks[1].m_has_duration);
+  EXPECT_EQ(20u,         blocks[1].m_duration);
+  ASSERT_EQ(3u,          blocks[1].m_frames.size());
+  EXPECT_EQ(300,         blocks[1].m_frames[0].m_size);
+  EXPECT_EQ(2,           blocks[1].m_frames[1].m_size);
+  EXPECT_EQ(7,           blocks[1].m_frames[2].m_size);
+  EXPECT_EQ(309,         blocks[1].get_total_size());
+
+  EXPECT_EQ('P',         blocks[2].get_frame_type());
+  ASSERT_EQ(3u,          blocks[2].m_frames.size());
+  EXPECT_EQ(100,         blocks[2].m_frames[0].m_size);
+  EXPECT_EQ(90,          blocks[2].m_frames[1].m_size);
+  EXPECT_EQ(50,          blocks[2].m_frames[2].m_size);
+  EXPECT_EQ(blocks[2].m_frames[0].m_position + 190, blocks[2].m_frames[2].m_position);
+
+  EXPECT_EQ(3u,          blocks[3].m_track_number);
+  ASSERT_EQ(4u,          blocks[3].m_frames.size());
+  for (auto const &frame : blocks[3].m_frames)
+    EXPECT_EQ(25,        frame.m_size);
+
+  EXPECT_EQ(17000000,    blocks[4].m_timecode);
+}
+
+TEST(SummaryEngine, CalculatesChecksums) {
+  auto data         = create_clusters();
+  auto num_clusters = 0u;
+  auto blocks       = summarize(data, true, num_clusters);
+
+  EXPECT_EQ(2u, num_clusters);
+
+  for (auto const &block : blocks)
+    for (auto const &frame : block.m_frames)
+      EXPECT_EQ(mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, reinterpret_cast<unsigned char const *>(data.c_str()) + frame.m_position, frame.m_size), frame.m_adler);
+
+  auto blocks_without_checksums = summarize(data, false, num_clusters);
+  ASSERT_EQ(blocks.size(), blocks_without_checksums.size());
+
+  for (auto idx = 0u; idx < blocks.size(); ++idx)
+    EXPECT_EQ(blocks[idx].get_total_size(), blocks_without_checksums[idx].get_total_size());
+}
+
+TEST(SummaryEngine, LeavesDamagedClustersAlone) {
+  auto data         = create_clusters();
+  auto num_clusters = 0u;
+
+  data.resize(data.size() - 2);
+
+  EXPECT_EQ(4u, summarize(data, false, num_clusters).size());
+  EXPECT_EQ(1u, num_clusters);
+
+  EXPECT_EQ(4u, summarize(data, true, num_clusters).size());
+  EXPECT_EQ(1u, num_clusters);
+}
+
+}
@@ -0,0 +1,68 @@
+#include "common/common_pch.h"
+
+#include "common/compression.h"
+#include "merge/compression_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+memory_cptr
+create_data(unsigned int idx) {
+  auto text = std::string{};
+  for (auto line = 0u; line <= idx; ++line)
+    text += (boost::format("Chunky bacon number %1%. ") % line).str();
+
+  return memory_c::clone(text);
+}
+
+TEST(CompressionPool, CompressesAllPackets) {
+  compression_pool_c pool{3};
+  auto zlib = compressor_c::create(COMPRESSION_ZLIB);
+  auto packets = std::vector<packet_cptr>{};
+  auto futures = std::vector<std::future<void>>{};
+
+  EXPECT_EQ(3u, pool.get_num_threads());
+
+  for (auto idx = 0u; idx < 100; ++idx) {
+    packets.emplace_back(std::make_shared<packet_t>(create_data(idx)));
+    packets.back()->data_adds.emplace_back(create_data(idx + 1));
+
+    futures.emplace_back(pool.compress(COMPRESSION_ZLIB, packets.back()));
+  }
+
+  for (auto idx = 0u; idx < 100; ++idx) {
+    ASSERT_NO_THROW(futures[idx].get());
+
+    EXPECT_TRUE(*create_data(idx)     == *zlib->decompress(packets[idx]->data));
+    EXPECT_TRUE(*create_data(idx + 1) == *zlib->decompress(packets[idx]->data_adds[0]));
+  }
+}
+
+TEST(CompressionPool, ReusedStreamMatchesFreshStream) {
+  auto reused = compressor_c::create(COMPRESSION_ZLIB);
+
+  for (auto idx = 0u; idx < 10; ++idx) {
+    auto fresh = compressor_c::create(COMPRESSION_ZLIB);
+    auto data  = create_data(idx);
+
+    EXPECT_TRUE(*fresh->compress(data) == *reused->compress(data));
+  }
+}
+
+TEST(CompressionPool, ShutdownFinishesQueuedJobs) {
+  auto packet = std::make_shared<packet_t>(create_data(20));
+  auto future = compression_pool_c::get().compress(COMPRESSION_ZLIB, packet);
+
+  compression_pool_c::shutdown();
+  compression_pool_c::shutdown();
+
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds{0}));
+  ASSERT_NO_THROW(future.get());
+  EXPECT_TRUE(*create_data(20) == *compressor_c::create(COMPRESSION_ZLIB)->decompress(packet->data));
+
+  EXPECT_LE(1u, compression_pool_c::get().get_num_threads());
+  compression_pool_c::shutdown();
+}
+
+}
@@ -0,0 +1,105 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxCues.h>
+#include <matroska/KaxCuesData.h>
+
+#include "common/ebml.h"
+#include "common/mm_io.h"
+#include "merge/cues.h"
+#include "merge/output_control.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct point_t {
+  uint64_t time, track, cluster_position, codec_state, relative_position, duration, block_number;
+};
+
+class CuePoint: public ::testing::Test, public cues_c {
+protected:
+  std::string render(point_t const &p) {
+    KaxCuePoint point;
+    GetChild<KaxCueTime>(point).SetValue(p.time);
+
+    auto &positions = GetChild<KaxCueTrackPositions>(point);
+    GetChild<KaxCueTrack>(positions).SetValue(p.track);
+    GetChild<KaxCueClusterPosition>(positions).SetValue(p.cluster_position);
+
+    if (p.codec_state)
+      GetChild<KaxCueCodecState>(positions).SetValue(p.codec_state);
+    if (p.relative_position)
+      GetChild<KaxCueRelativePosition>(positions).SetValue(p.relative_position);
+    if (p.duration)
+      GetChild<KaxCueDuration>(positions).SetValue(p.duration);
+    if (p.block_number)
+      GetChild<KaxCueBlockNumber>(positions).SetValue(p.block_number);
+
+    mm_mem_io_c out{nullptr, 0, 1024};
+    point.Render(out);
+
+    return std::string{reinterpret_cast<char const *>(out.get_buffer()), static_cast<size_t>(out.get_size())};
+  }
+
+  std::string serialize(point_t const &p) {
+    auto scale    = static_cast<uint64_t>(g_timecode_scale);
+    auto timecode = p.time * scale;
+
+    m_points.clear();
+    m_codec_state_position_map.clear();
+
+    m_points.add(timecode, p.cluster_position, p.track, p.block_number);
+    m_points.m_relative_positions.back() = p.relative_position;
+    m_points.m_durations.back()          = p.duration * scale;
+
+    if (p.codec_state)
+      m_codec_state_position_map[ id_timecode_t{ p.track, timecode } ] = p.codec_state;
+
+    unsigned char buffer[1024];
+    auto end  = serialize_point(0, buffer);
+    auto size = static_cast<uint64_t>(end - buffer);
+
+    EXPECT_EQ(calculate_point_size(0), size);
+
+    return std::string{reinterpret_cast<char const *>(buffer), static_cast<size_t>(size)};
+  }
+};
+
+TEST_F(CuePoint, Minimal) {
+  auto p = point_t{ 0, 1, 0, 0, 0, 0, 0 };
+  EXPECT_EQ(render(p), serialize(p));
+
+  p = point_t{ 1234, 2, 4711, 0, 0, 0, 0 };
+  EXPECT_EQ(render(p), serialize(p));
+}
+
+TEST_F(CuePoint, CodecState) {
+  auto p = point_t{ 1234, 2, 4711, 815, 0, 0, 0 };
+  EXPECT_EQ(render(p), serialize(p));
+}
+
+TEST_F(CuePoint, RelativePositionAndDuration) {
+  auto p = point_t{ 1234, 2, 4711, 0, 42, 0, 0 };
+  EXPECT_EQ(render(p), serialize(p));
+
+  p = point_t{ 1234, 2, 4711, 0, 0, 40, 0 };
+  EXPECT_EQ(render(p), serialize(p));
+
+  p = point_t{ 1234, 2, 4711, 0, 0x12345, 0x1234, 0 };
+  EXPECT_EQ(render(p), serialize(p));
+}
+
+TEST_F(CuePoint, BlockNumber) {
+  auto p = point_t{ 1234, 2, 4711, 0, 0, 0, 3 };
+  EXPECT_EQ(render(p), serialize(p));
+
+  p = point_t{ 1234, 2, 4711, 815, 42, 40, 0x123456 };
+  EXPECT_EQ(render(p), serialize(p));
+}
+
+TEST_F(CuePoint, LargeValues) {
+  auto p = point_t{ 0xffffffffffull, 0xffffffffull, 0xffffffffffffffffull, 0xffffffffffffffffull, 0xffffffffull, 0xffffffffull, 0xffffffffffffffffull };
+  EXPECT_EQ(render(p), serialize(p));
+}
+
+}
@@ -0,0 +1,128 @@
+#include "common/common_pch.h"
+
+#if defined(HAVE_FLAC_FORMAT_H)
+
+#include "common/mm_io.h"
+#include "input/r_flac.h"
+#include "merge/generic_packetizer.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using bytes_t = std::vector<unsigned char>;
+
+// "fLaC" and a STREAMINFO block: 4096 samples per block, 44.1 kHz,
+// stereo, 16 bits, 4 samples.
+bytes_t const s_file_header{
+  'f', 'L', 'a', 'C', 0x80, 0x00, 0x00, 0x22, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0xc4, 0x42, 0xf0, 0x00, 0x00,
+  0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// The first one is the frame of the first example file in RFC 9639 as
+// written by libFLAC. The others only differ in their frame numbers
+// and therefore in their CRC-8 and CRC-16 values.
+bytes_t const s_frames[] = {
+  { 0xff, 0xf8, 0x69, 0x18, 0x00, 0x00, 0xbf, 0x03, 0x58, 0xfd, 0x03, 0x12, 0x8b, 0xaa, 0x9a },
+  { 0xff, 0xf8, 0x69, 0x18, 0x01, 0x00, 0xaa, 0x03, 0x58, 0xfd, 0x03, 0x12, 0x8b, 0xb8, 0xaa },
+  { 0xff, 0xf8, 0x69, 0x18, 0x02, 0x00, 0x95, 0x03, 0x58, 0xfd, 0x03, 0x12, 0x8b, 0x8e, 0xfa },
+  { 0xff, 0xf8, 0x69, 0x18, 0x03, 0x00, 0x80, 0x03, 0x58, 0xfd, 0x03, 0x12, 0x8b, 0x9c, 0xca },
+};
+
+class recording_packetizer_c: public generic_packetizer_c {
+public:
+  std::vector<bytes_t> m_frames;
+
+public:
+  recording_packetizer_c(generic_reader_c *reader, track_info_c &ti)
+    : generic_packetizer_c{reader, ti}
+  {
+  }
+
+  virtual translatable_string_c get_format_name() const {
+    return "recording";
+  }
+
+  virtual connection_result_e can_connect_to(generic_packetizer_c *, std::string &) {
+    return CAN_CONNECT_YES;
+  }
+
+  virtual void set_headers() {
+  }
+
+protected:
+  virtual int process_impl(packet_cptr packet) {
+    m_frames.emplace_back(packet->data->get_buffer(), packet->data->get_buffer() + packet->data->get_size());
+    return FILE_STATUS_MOREDATA;
+  }
+};
+
+bytes_t
+operator +(bytes_t lhs,
+           bytes_t const &rhs) {
+  lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+  return lhs;
+}
+
+std::vector<bytes_t>
+read_frames(bytes_t const &content) {
+  auto reader = std::make_shared<flac_reader_c>(track_info_c{}, mm_io_cptr{new mm_mem_io_c{content.data(), content.size()}});
+  reader->read_headers();
+
+  reader->m_appending = true;
+  auto ptzr           = new recording_packetizer_c{reader.get(), reader->m_ti};
+  reader->add_packetizer(ptzr);
+
+  while (FILE_STATUS_MOREDATA == reader->read(ptzr))
+    ;
+
+  return ptzr->m_frames;
+}
+
+TEST(FlacReader, Frames) {
+  auto frames = read_frames(s_file_header + s_frames[0] + s_frames[1] + s_frames[2]);
+
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(s_frames[0], frames[0]);
+  EXPECT_EQ(s_frames[1], frames[1]);
+  EXPECT_EQ(s_frames[2], frames[2]);
+}
+
+TEST(FlacReader, ResyncAfterCorruptedFrame) {
+  auto corrupted = s_frames[1];
+  corrupted[0]   = 0xfe;
+
+  auto frames = read_frames(s_file_header + s_frames[0] + corrupted + s_frames[2] + s_frames[3]);
+
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(s_frames[0], frames[0]);
+  EXPECT_EQ(s_frames[2], frames[1]);
+  EXPECT_EQ(s_frames[3], frames[2]);
+}
+
+TEST(FlacReader, TrailingTag) {
+  auto tag = bytes_t{ 'T', 'A', 'G' };
+  tag.resize(128, 0x00);
+
+  auto frames = read_frames(s_file_header + s_frames[0] + s_frames[1] + s_frames[2] + tag);
+
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(s_frames[0], frames[0]);
+  EXPECT_EQ(s_frames[1], frames[1]);
+  EXPECT_EQ(s_frames[2], frames[2]);
+}
+
+TEST(FlacReader, TruncatedLastFrame) {
+  auto truncated = s_frames[2];
+  truncated.resize(10);
+
+  auto frames = read_frames(s_file_header + s_frames[0] + s_frames[1] + truncated);
+
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(s_frames[1], frames[1]);
+  EXPECT_EQ(truncated,   frames[2]);
+}
+
+}
+
+#endif  // HAVE_FLAC_FORMAT_H
@@ -0,0 +1,28 @@
+#include "common/common_pch.h"
+
+#include "merge/id_result.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(IdResult, PropertiesToJsonEmpty) {
+  EXPECT_EQ(std::string{"{}"}, id_result_properties_to_json({}));
+}
+
+TEST(IdResult, PropertiesToJsonTypes) {
+  EXPECT_EQ(std::string{"{\"duration\":12345,\"number\":-3,\"language\":\"eng\",\"private\":\"007\",\"uid\":\"18446744073709551615\"}"},
+            id_result_properties_to_json({ "duration:12345", "number:-3", "language:eng", "private:007", "uid:18446744073709551615" }));
+}
+
+TEST(IdResult, PropertiesToJsonUnescapes) {
+  EXPECT_EQ(std::string{"{\"title\":\"Chunky Bacon: \\\"the\\\" movie\"}"},
+            id_result_properties_to_json({ "title:Chunky\\sBacon\\c\\s\\2the\\2\\smovie" }));
+}
+
+TEST(IdResult, PropertiesToJsonSeveralPairsPerEntry) {
+  EXPECT_EQ(std::string{"{\"stream_id\":\"e0\",\"sub_stream_id\":\"00\"}"},
+            id_result_properties_to_json({ "stream_id:e0 sub_stream_id:00" }));
+}
+
+}
@@ -0,0 +1,163 @@
+#include "common/common_pch.h"
+
+#include "common/compression.h"
+#include "common/mm_io.h"
+#include "input/r_matroska.h"
+#include "merge/generic_packetizer.h"
+
+#include "tests/unit/init.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using bytes_t = std::vector<unsigned char>;
+
+bytes_t
+operator +(bytes_t lhs,
+           bytes_t const &rhs) {
+  lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+  return lhs;
+}
+
+// Element sizes are always coded with eight bytes.
+bytes_t
+element(bytes_t id,
+        bytes_t const &content) {
+  auto size = static_cast<uint64_t>(content.size());
+
+  id.push_back(0x01);
+  for (auto shift = 48; 0 <= shift; shift -= 8)
+    id.push_back((size >> shift) & 0xff);
+
+  return id + content;
+}
+
+bytes_t
+simple_block(unsigned int timecode,
+             memory_cptr const &data) {
+  auto content = bytes_t{ 0x81, static_cast<unsigned char>(timecode >> 8), static_cast<unsigned char>(timecode & 0xff), 0x80 };
+  content.insert(content.end(), data->get_buffer(), data->get_buffer() + data->get_size());
+
+  return element({ 0xa3 }, content);
+}
+
+// A file with a single zlib compressed subtitle track using an
+// unknown CodecID. Its blocks are 10ms apart.
+bytes_t
+create_file(std::vector<memory_cptr> const &frames) {
+  auto ebml_head = element({ 0x1a, 0x45, 0xdf, 0xa3 }, element({ 0x42, 0x82 }, { 'm', 'a', 't', 'r', 'o', 's', 'k', 'a' }));
+  auto info      = element({ 0x15, 0x49, 0xa9, 0x66 }, element({ 0x2a, 0xd7, 0xb1 }, { 0x0f, 0x42, 0x40 }));
+  auto encoding  = element({ 0x62, 0x40 },
+                           element({ 0x50, 0x31 }, { 0x00 })
+                         + element({ 0x50, 0x32 }, { 0x01 })
+                         + element({ 0x50, 0x33 }, { 0x00 })
+                         + element({ 0x50, 0x34 }, element({ 0x42, 0x54 }, { 0x00 })));
+  auto tracks    = element({ 0x16, 0x54, 0xae, 0x6b },
+                           element({ 0xae },
+                                     element({ 0xd7 },       { 0x01 })
+                                   + element({ 0x73, 0xc5 }, { 0x01 })
+                                   + element({ 0x83 },       { 0x11 })
+                                   + element({ 0x86 },       { 'S', '_', 'C', 'H', 'U', 'N', 'K', 'Y' })
+                                   + element({ 0x6d, 0x80 }, encoding)));
+  auto cluster   = element({ 0xe7 }, { 0x00 });
+
+  for (auto idx = 0u; idx < frames.size(); ++idx)
+    cluster = cluster + simple_block(idx * 10, frames[idx]);
+
+  return ebml_head + element({ 0x18, 0x53, 0x80, 0x67 }, info + tracks + element({ 0x1f, 0x43, 0xb6, 0x75 }, cluster));
+}
+
+class recording_packetizer_c: public generic_packetizer_c {
+public:
+  std::vector<packet_cptr> m_packets;
+
+public:
+  recording_packetizer_c(generic_reader_c *reader, track_info_c &ti)
+    : generic_packetizer_c{reader, ti}
+  {
+  }
+
+  virtual translatable_string_c get_format_name() const {
+    return "recording";
+  }
+
+  virtual connection_result_e can_connect_to(generic_packetizer_c *, std::string &) {
+    return CAN_CONNECT_YES;
+  }
+
+  virtual void set_headers() {
+  }
+
+protected:
+  virtual int process_impl(packet_cptr packet) {
+    packet->data->grab();
+    m_packets.push_back(packet);
+    return FILE_STATUS_MOREDATA;
+  }
+};
+
+class recording_kax_reader_c: public kax_reader_c {
+public:
+  recording_packetizer_c *m_ptzr;
+
+public:
+  recording_kax_reader_c(mm_io_cptr const &in)
+    : kax_reader_c{track_info_c{}, in}
+    , m_ptzr{}
+  {
+    m_appending = true;
+  }
+
+  virtual void create_packetizer(int64_t) {
+    // The test files only contain a single track with the number 1.
+    m_ptzr = new recording_packetizer_c{this, m_ti};
+    set_track_packetizer(find_track_by_num(1), m_ptzr);
+  }
+};
+
+std::vector<packet_cptr>
+read_packets(bytes_t const &content) {
+  recording_kax_reader_c reader{mm_io_cptr{new mm_mem_io_c{content.data(), content.size()}}};
+  reader.read_headers();
+  reader.create_packetizers();
+
+  EXPECT_NE(nullptr, reader.m_ptzr);
+  if (!reader.m_ptzr)
+    return {};
+
+  while (FILE_STATUS_MOREDATA == reader.read(reader.m_ptzr, true))
+    ;
+
+  return reader.m_ptzr->m_packets;
+}
+
+TEST(MatroskaReader, DecompressesFrames) {
+  mtxut::init_case();
+
+  auto zlib    = compressor_c::create(COMPRESSION_ZLIB);
+  auto packets = read_packets(create_file({ zlib->compress(memory_c::clone("chunky")), zlib->compress(memory_c::clone("bacon")) }));
+
+  ASSERT_EQ(2u, packets.size());
+  EXPECT_TRUE(*memory_c::clone("chunky") == *packets[0]->data);
+  EXPECT_TRUE(*memory_c::clone("bacon")  == *packets[1]->data);
+  EXPECT_FALSE(g_warning_issued);
+}
+
+TEST(MatroskaReader, SkipsFramesThatCannotBeDecompressed) {
+  mtxut::init_case();
+
+  auto zlib      = compressor_c::create(COMPRESSION_ZLIB);
+  auto truncated = zlib->compress(memory_c::clone(std::string(1000, 'x')));
+  truncated      = memory_c::clone(truncated->get_buffer(), truncated->get_size() / 2);
+  auto packets   = read_packets(create_file({ zlib->compress(memory_c::clone("chunky")), truncated, zlib->compress(memory_c::clone("bacon")) }));
+
+  ASSERT_EQ(2u, packets.size());
+  EXPECT_TRUE(*memory_c::clone("chunky") == *packets[0]->data);
+  EXPECT_TRUE(*memory_c::clone("bacon")  == *packets[1]->data);
+  EXPECT_EQ(0,        packets[0]->timecode);
+  EXPECT_EQ(20000000, packets[1]->timecode);
+  EXPECT_TRUE(g_warning_issued);
+}
+
+}
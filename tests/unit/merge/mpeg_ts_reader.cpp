@@ -0,0 +1,198 @@
+#include "common/common_pch.h"
+
+#include "common/bswap.h"
+#include "common/checksums/base.h"
+#include "common/endian.h"
+#include "common/mm_io_x.h"
+#include "common/mm_stream_io.h"
+#include "input/r_mpeg_ts.h"
+
+#include "tests/unit/init.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using bytes_t = std::vector<unsigned char>;
+
+bytes_t
+operator +(bytes_t lhs,
+           bytes_t const &rhs) {
+  lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+  return lhs;
+}
+
+bytes_t
+ts_packet(uint16_t pid,
+          bool unit_start,
+          unsigned int continuity_counter,
+          bytes_t const &payload) {
+  auto packet = bytes_t{ 0x47, static_cast<unsigned char>((unit_start ? 0x40 : 0x00) | (pid >> 8)), static_cast<unsigned char>(pid & 0xff), static_cast<unsigned char>(0x10 | (continuity_counter & 0x0f)) } + payload;
+  packet.resize(188, 0xff);
+
+  return packet;
+}
+
+// Sections are prefixed with their pointer field and end with their
+// CRC stored the way the reader expects it.
+bytes_t
+section(bytes_t content) {
+  unsigned char crc[4];
+  put_uint32_be(crc, mtx::bswap_32(mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc32_ieee, content.data(), content.size(), 0xffffffff)));
+
+  return bytes_t{ 0x00 } + content + bytes_t(crc, crc + 4);
+}
+
+// A single program with an MPEG-1 layer 3 track on PID 0x101. Its
+// only PES packet follows after 1.5 MB of null packets, which is past
+// the head read for probing.
+bytes_t
+create_stream() {
+  auto pat     = section({ 0x00, 0xb0, 0x0d, 0x00, 0x01, 0xc1, 0x00, 0x00, 0x00, 0x01, 0xe1, 0x00 });
+  auto pmt     = section({ 0x02, 0xb0, 0x12, 0x00, 0x01, 0xc1, 0x00, 0x00, 0xe1, 0x01, 0xf0, 0x00, 0x03, 0xe1, 0x01, 0xf0, 0x00 });
+  auto frame   = bytes_t{ 0xff, 0xfb, 0x90, 0x64 };
+  frame.resize(417, 0x00);
+
+  auto pes     = bytes_t{ 0x00, 0x00, 0x01, 0xc0, 0x01, 0xa9, 0x80, 0x80, 0x05, 0x21, 0x00, 0x01, 0x00, 0x01 } + frame;
+  auto null    = ts_packet(0x1fff, false, 0, {});
+  auto content = ts_packet(0x0000, true, 0, pat) + ts_packet(0x0100, true, 0, pmt);
+
+  for (auto idx = 0; idx < 8000; ++idx)
+    content.insert(content.end(), null.begin(), null.end());
+
+  for (auto offset = 0u; offset < pes.size(); offset += 184) {
+    auto packet = ts_packet(0x0101, !offset, offset / 184, bytes_t(pes.begin() + offset, pes.begin() + std::min<size_t>(offset + 184, pes.size())));
+    content.insert(content.end(), packet.begin(), packet.end());
+  }
+
+  for (auto idx = 0; idx < 6000; ++idx)
+    content.insert(content.end(), null.begin(), null.end());
+
+  return content;
+}
+
+class counting_mem_io_c: public mm_mem_io_c {
+public:
+  uint64_t m_num_read;
+
+public:
+  counting_mem_io_c(bytes_t const &content)
+    : mm_mem_io_c{content.data(), content.size()}
+    , m_num_read{}
+  {
+  }
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size) {
+    auto num_read  = mm_mem_io_c::_read(buffer, size);
+    m_num_read    += num_read;
+    return num_read;
+  }
+};
+
+struct seek_t {
+  int64_t target;
+  uint64_t window_end;
+  bool failed;
+};
+
+// Records all seeks together with how much of the source had been
+// read at that time. As the head is kept until release_head() that is
+// exactly the range that can be seeked to.
+class recording_stream_io_c: public mm_stream_io_c {
+public:
+  counting_mem_io_c *m_source;
+  std::vector<seek_t> m_seeks;
+
+public:
+  recording_stream_io_c(counting_mem_io_c *source)
+    : mm_stream_io_c{source, "test"}
+    , m_source{source}
+  {
+  }
+
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning) {
+    auto size   = get_size();
+    auto target = seek_beginning == mode ? offset
+                : seek_current   == mode ? static_cast<int64_t>(getFilePointer()) + offset
+                : 0 > size               ? -1
+                :                          size + offset;
+
+    m_seeks.push_back({ target, m_source->m_num_read, false });
+
+    try {
+      mm_stream_io_c::setFilePointer(offset, mode);
+    } catch (mtx::mm_io::seek_x &) {
+      m_seeks.back().failed = true;
+      throw;
+    }
+  }
+};
+
+class test_mpeg_ts_reader_c: public mpeg_ts_reader_c {
+public:
+  test_mpeg_ts_reader_c(mm_io_cptr const &in)
+    : mpeg_ts_reader_c{track_info_c{}, in}
+  {
+  }
+
+  bool headers_found() const {
+    return PAT_found && PMT_found && !es_to_process;
+  }
+
+  mpeg_ts_track_ptr find_track(uint16_t pid) const {
+    for (auto const &track : tracks)
+      if (track->pid == pid)
+        return track;
+    return {};
+  }
+};
+
+TEST(MpegTsReader, ReadHeadersStaysWithinStreamHead) {
+  mtxut::init_case();
+
+  auto content = create_stream();
+  auto source  = new counting_mem_io_c{content};
+  auto stream  = std::make_shared<recording_stream_io_c>(source);
+
+  // The same order as in create_readers(): probe the head, parse the
+  // headers, release the head.
+  stream->read_head(1024 * 1024 + 64 * 1024);
+
+  test_mpeg_ts_reader_c reader{stream};
+  EXPECT_EQ(0u, reader.m_size);
+
+  reader.read_headers();
+
+  EXPECT_TRUE(reader.headers_found());
+
+  auto track = reader.find_track(0x0101);
+  ASSERT_TRUE(!!track);
+  EXPECT_TRUE(track->probed_ok);
+  EXPECT_TRUE(track->codec.is(codec_c::type_e::A_MP3));
+
+  ASSERT_FALSE(stream->m_seeks.empty());
+  for (auto const &seek : stream->m_seeks) {
+    EXPECT_FALSE(seek.failed);
+    EXPECT_LE(0, seek.target);
+    EXPECT_LE(seek.target, static_cast<int64_t>(seek.window_end));
+  }
+
+  // The headers haven't been read up to the end of the stream.
+  EXPECT_LT(source->m_num_read, content.size());
+  EXPECT_EQ(-1, stream->get_size());
+  EXPECT_EQ(0u, reader.m_in->getFilePointer());
+  EXPECT_EQ(0, reader.get_progress());
+
+  stream->release_head();
+
+  std::string buffer;
+  while (reader.m_in->read(buffer, 64 * 1024))
+    ;
+
+  EXPECT_EQ(static_cast<int64_t>(content.size()), stream->get_size());
+  EXPECT_EQ(100, reader.get_progress());
+  EXPECT_FALSE(g_warning_issued);
+}
+
+}
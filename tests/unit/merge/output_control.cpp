@@ -0,0 +1,155 @@
+#include "common/common_pch.h"
+
+#include <ebml/EbmlStream.h>
+#include <ebml/EbmlVoid.h>
+#include <matroska/KaxSeekHead.h>
+#include <matroska/KaxSegment.h>
+#include <matroska/KaxTracks.h>
+#include <matroska/KaxTrackEntryData.h>
+
+#include "common/ebml.h"
+#include "common/mm_io.h"
+#include "merge/output_control.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class RerenderTrackHeaders: public ::testing::Test {
+protected:
+  mm_mem_io_c m_out;
+  KaxTracks m_tracks;
+  KaxTrackEntry *m_entry;
+  std::unique_ptr<EbmlVoid> m_void;
+
+public:
+  RerenderTrackHeaders()
+    : m_out{nullptr, 0, 1024}
+    , m_entry{new KaxTrackEntry}
+  {
+  }
+
+protected:
+  virtual void SetUp() {
+    m_tracks.PushElement(*m_entry);
+    GetChild<KaxTrackNumber>(*m_entry).SetValue(1);
+    GetChild<KaxCodecID>(*m_entry).SetValue("V_MPEG4/ISO/AVC");
+
+    m_tracks.Render(m_out, false);
+
+    m_void = std::make_unique<EbmlVoid>();
+    m_void->SetSize(100);
+    m_void->Render(m_out);
+  }
+
+  void set_codec_private(size_t size) {
+    auto data = std::string(size, 'x');
+    GetChild<KaxCodecPrivate>(*m_entry).CopyBuffer(reinterpret_cast<binary const *>(data.c_str()), size);
+  }
+
+  void write_data() {
+    m_out.setFilePointer(0, seek_end);
+    m_out.write(std::string(1000, 'c'));
+  }
+
+  std::string get_content() {
+    return std::string{reinterpret_cast<char const *>(m_out.get_buffer()), static_cast<size_t>(m_out.get_size())};
+  }
+
+  int64_t get_end_of_void() {
+    return m_void->GetElementPosition() + m_void->ElementSize();
+  }
+};
+
+TEST_F(RerenderTrackHeaders, ShrinksVoidInPlace) {
+  write_data();
+
+  auto end_of_void = get_end_of_void();
+  auto data        = get_content().substr(end_of_void);
+  auto position    = m_out.getFilePointer();
+
+  set_codec_private(50);
+
+  ASSERT_TRUE(rerender_track_headers_in_place(m_out, m_tracks, m_void, 200));
+  EXPECT_EQ(end_of_void, get_end_of_void());
+  EXPECT_EQ(m_tracks.GetElementPosition() + m_tracks.ElementSize(), m_void->GetElementPosition());
+  EXPECT_EQ(position, m_out.getFilePointer());
+  EXPECT_EQ(data, get_content().substr(end_of_void));
+}
+
+TEST_F(RerenderTrackHeaders, GrowsIfNothingFollows) {
+  auto size = m_tracks.ElementSize();
+
+  set_codec_private(500);
+
+  ASSERT_TRUE(rerender_track_headers_in_place(m_out, m_tracks, m_void, 200));
+  EXPECT_LT(size + 500, m_tracks.ElementSize());
+  EXPECT_EQ(m_tracks.GetElementPosition() + m_tracks.ElementSize(), m_void->GetElementPosition());
+  EXPECT_EQ(200u, m_void->ElementSize());
+  EXPECT_EQ(get_end_of_void(), m_out.get_size());
+}
+
+TEST_F(RerenderTrackHeaders, OverflowLeavesWrittenDataAlone) {
+  write_data();
+
+  auto content  = get_content();
+  auto position = m_out.getFilePointer();
+
+  set_codec_private(500);
+
+  EXPECT_FALSE(rerender_track_headers_in_place(m_out, m_tracks, m_void, 200));
+  EXPECT_EQ(position, m_out.getFilePointer());
+  EXPECT_EQ(content, get_content());
+}
+
+TEST_F(RerenderTrackHeaders, RelocatesIfDataFollows) {
+  KaxSegment segment;
+  KaxSeekHead seek_head;
+
+  seek_head.IndexThis(m_tracks, segment);
+  write_data();
+
+  auto old_tracks_pos = m_tracks.GetElementPosition();
+  auto end_of_void    = get_end_of_void();
+  auto data           = get_content().substr(end_of_void);
+  auto old_size       = m_out.get_size();
+
+  set_codec_private(500);
+
+  ASSERT_FALSE(rerender_track_headers_in_place(m_out, m_tracks, m_void, 200));
+  relocate_track_headers(m_out, m_tracks, m_void, seek_head, segment, 200);
+
+  // The data already written stays where it is.
+  EXPECT_EQ(data, get_content().substr(end_of_void, data.size()));
+
+  // The track headers and the new void follow it.
+  EXPECT_EQ(old_size, static_cast<int64_t>(m_tracks.GetElementPosition()));
+  EXPECT_EQ(m_tracks.GetElementPosition() + m_tracks.ElementSize(), m_void->GetElementPosition());
+  EXPECT_EQ(200u, m_void->ElementSize());
+  EXPECT_EQ(get_end_of_void(), m_out.get_size());
+  EXPECT_EQ(m_out.get_size(), static_cast<int64_t>(m_out.getFilePointer()));
+
+  // The old location is a single void element.
+  m_out.setFilePointer(old_tracks_pos);
+  EbmlStream stream{m_out};
+  auto element = std::unique_ptr<EbmlElement>{stream.FindNextID(EBML_INFO(EbmlVoid), 0xFFFFFFFFL)};
+
+  ASSERT_TRUE(!!element);
+  EXPECT_EQ(old_tracks_pos, element->GetElementPosition());
+  EXPECT_EQ(end_of_void, element->GetElementPosition() + element->HeadSize() + element->GetSize());
+
+  // The seek head only refers to the new location.
+  auto num_entries = 0;
+  for (auto child : seek_head) {
+    auto seek = dynamic_cast<KaxSeek *>(child);
+    if (!seek)
+      continue;
+
+    ++num_entries;
+    EXPECT_EQ(segment.GetRelativePosition(m_tracks), FindChildValue<KaxSeekPosition>(*seek));
+  }
+
+  EXPECT_EQ(1, num_entries);
+}
+
+}
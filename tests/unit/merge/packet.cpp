@@ -0,0 +1,49 @@
+#include "common/common_pch.h"
+
+#include "merge/packet.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Packet, SharedPacketsComeFromPool) {
+  auto data  = memory_c::alloc(100);
+  auto first = memory_pool_c::make_shared<packet_t>(data);
+
+  first.reset();
+
+  auto num_reused = memory_pool_c::get_num_reused();
+  auto second     = memory_pool_c::make_shared<packet_t>(data);
+
+  // Object and control block share a single block.
+  EXPECT_EQ(num_reused + 1, memory_pool_c::get_num_reused());
+  EXPECT_EQ(data, second->data);
+}
+
+TEST(Packet, OwnedPacketsComeFromPool) {
+  auto data  = memory_c::alloc(100);
+  auto first = memory_pool_c::own(new packet_t(data));
+
+  first.reset();
+
+  auto num_reused = memory_pool_c::get_num_reused();
+  auto second     = memory_pool_c::own(new packet_t(data));
+
+  // One block for the object, one for the control block.
+  EXPECT_EQ(num_reused + 2, memory_pool_c::get_num_reused());
+}
+
+TEST(Packet, PacketMemoryComesFromPool) {
+  auto first = memory_c::alloc(100);
+
+  first.reset();
+
+  auto num_reused = memory_pool_c::get_num_reused();
+  auto second     = memory_c::alloc(100);
+
+  // The memory_c object with its control block, its counter and its
+  // buffer.
+  EXPECT_EQ(num_reused + 3, memory_pool_c::get_num_reused());
+}
+
+}
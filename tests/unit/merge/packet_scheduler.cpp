@@ -0,0 +1,132 @@
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <random>
+
+#include "merge/packet_scheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(PacketScheduler, Empty) {
+  packet_scheduler_c scheduler;
+
+  EXPECT_TRUE(scheduler.empty());
+  EXPECT_EQ(0u, scheduler.size());
+}
+
+TEST(PacketScheduler, LowestTimecodeFirst) {
+  packet_scheduler_c scheduler;
+
+  scheduler.add(0, 300);
+  scheduler.add(1, 100);
+  scheduler.add(2, 200);
+
+  EXPECT_EQ(3u, scheduler.size());
+  EXPECT_EQ(1u, scheduler.pop());
+  EXPECT_EQ(2u, scheduler.pop());
+  EXPECT_EQ(0u, scheduler.pop());
+  EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(PacketScheduler, TiesBrokenByLowerIndex) {
+  packet_scheduler_c scheduler;
+
+  scheduler.add(3, 100);
+  scheduler.add(1, 100);
+  scheduler.add(2, 100);
+  scheduler.add(0, 200);
+
+  EXPECT_EQ(1u, scheduler.pop());
+  EXPECT_EQ(2u, scheduler.pop());
+  EXPECT_EQ(3u, scheduler.pop());
+  EXPECT_EQ(0u, scheduler.pop());
+}
+
+TEST(PacketScheduler, Clear) {
+  packet_scheduler_c scheduler;
+
+  scheduler.add(0, 100);
+  scheduler.add(1, 200);
+  scheduler.clear();
+
+  EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(PacketScheduler, SameOrderAsLinearScan) {
+  auto const num_tracks = 17u;
+  auto rng              = std::mt19937{42};
+  auto durations        = std::uniform_int_distribution<int64_t>{1, 50};
+  auto next_timecodes   = std::vector<int64_t>(num_tracks, 0);
+  packet_scheduler_c scheduler;
+
+  for (auto idx = 0u; idx < num_tracks; ++idx)
+    scheduler.add(idx, next_timecodes[idx]);
+
+  for (auto packet = 0; packet < 10000; ++packet) {
+    auto expected = 0u;
+    for (auto idx = 1u; idx < num_tracks; ++idx)
+      if (next_timecodes[idx] < next_timecodes[expected])
+        expected = idx;
+
+    auto actual = scheduler.pop();
+    ASSERT_EQ(expected, actual);
+
+    next_timecodes[actual] += durations(rng);
+    scheduler.add(actual, next_timecodes[actual]);
+  }
+}
+
+// Compares the per-packet cost of selecting the next packet with a
+// linear scan over all tracks to that of the scheduler. Run with
+// --gtest_also_run_disabled_tests.
+TEST(PacketScheduler, DISABLED_BenchmarkAgainstLinearScan) {
+  auto const num_packets = 2000000;
+
+  for (auto num_tracks : std::vector<unsigned int>{ 2, 8, 32, 64, 128 }) {
+    auto rng       = std::mt19937{42};
+    auto durations = std::uniform_int_distribution<int64_t>{1, 50};
+    auto checksum  = int64_t{};
+
+    auto next_timecodes = std::vector<int64_t>(num_tracks, 0);
+    auto start          = std::chrono::steady_clock::now();
+
+    for (auto packet = 0; packet < num_packets; ++packet) {
+      auto winner = 0u;
+      for (auto idx = 1u; idx < num_tracks; ++idx)
+        if (next_timecodes[idx] < next_timecodes[winner])
+          winner = idx;
+
+      checksum               += winner;
+      next_timecodes[winner] += durations(rng);
+    }
+
+    auto linear_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    rng = std::mt19937{42};
+    next_timecodes.assign(num_tracks, 0);
+    packet_scheduler_c scheduler;
+
+    start = std::chrono::steady_clock::now();
+
+    for (auto idx = 0u; idx < num_tracks; ++idx)
+      scheduler.add(idx, 0);
+
+    for (auto packet = 0; packet < num_packets; ++packet) {
+      auto winner             = scheduler.pop();
+      checksum               -= winner;
+      next_timecodes[winner] += durations(rng);
+      scheduler.add(winner, next_timecodes[winner]);
+    }
+
+    auto heap_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(0, checksum);
+
+    std::cout << boost::format("%|1$3| tracks: linear scan %|2$7.2f| ns/packet, scheduler %|3$7.2f| ns/packet\n")
+      % num_tracks % (static_cast<double>(linear_ns) / num_packets) % (static_cast<double>(heap_ns) / num_packets);
+  }
+}
+
+}
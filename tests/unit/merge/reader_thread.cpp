@@ -0,0 +1,190 @@
+#include "common/common_pch.h"
+
+#include <thread>
+
+#include "common/endian.h"
+#include "common/mm_io.h"
+#include "merge/generic_packetizer.h"
+#include "merge/generic_reader.h"
+#include "merge/reader_thread.h"
+
+#include "tests/unit/init.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class fake_reader_c: public generic_reader_c {
+public:
+  unsigned int m_num_reads, m_fail_after;
+  unsigned char m_buffer[4];
+  std::thread::id m_read_thread_id;
+
+public:
+  fake_reader_c(unsigned int num_reads, unsigned int fail_after = 0)
+    : generic_reader_c{track_info_c{}, mm_io_cptr{new mm_mem_io_c{nullptr, 100, 100}}}
+    , m_num_reads{num_reads}
+    , m_fail_after{fail_after}
+  {
+    m_appending = true;
+  }
+
+  virtual translatable_string_c get_format_name() const {
+    return "fake";
+  }
+
+  virtual void read_headers() {
+  }
+
+  virtual void identify() {
+  }
+
+  virtual void create_packetizer(int64_t) {
+  }
+
+  virtual file_status_e read(generic_packetizer_c *, bool) {
+    m_read_thread_id = std::this_thread::get_id();
+
+    if (!m_num_reads)
+      return flush_packetizers();
+
+    if (m_fail_after && !--m_fail_after)
+      mxerror("Chunky bacon\n");
+
+    // The same buffer is handed over each time, just like real readers do.
+    put_uint32_be(m_buffer, m_num_reads--);
+    PTZR0->process(new packet_t(new memory_c(m_buffer, 4, false)));
+
+    return FILE_STATUS_MOREDATA;
+  }
+};
+
+class fake_packetizer_c: public generic_packetizer_c {
+public:
+  std::vector<uint32_t> m_values;
+  std::vector<std::thread::id> m_thread_ids;
+  bool m_flushed;
+
+public:
+  fake_packetizer_c(generic_reader_c *reader, track_info_c &ti)
+    : generic_packetizer_c{reader, ti}
+    , m_flushed{}
+  {
+  }
+
+  virtual translatable_string_c get_format_name() const {
+    return "fake";
+  }
+
+  virtual connection_result_e can_connect_to(generic_packetizer_c *, std::string &) {
+    return CAN_CONNECT_YES;
+  }
+
+  virtual void set_headers() {
+  }
+
+protected:
+  virtual int process_impl(packet_cptr packet) {
+    m_values.push_back(get_uint32_be(packet->data->get_buffer()));
+    m_thread_ids.push_back(std::this_thread::get_id());
+
+    return FILE_STATUS_MOREDATA;
+  }
+
+  virtual void flush_impl() {
+    m_flushed = true;
+    m_thread_ids.push_back(std::this_thread::get_id());
+  }
+};
+
+fake_packetizer_c *
+add_fake_packetizer(generic_reader_c &reader) {
+  auto ptzr = new fake_packetizer_c{&reader, reader.m_ti};
+  reader.add_packetizer(ptzr);
+
+  return ptzr;
+}
+
+file_status_e
+read_all(generic_packetizer_c &ptzr,
+         unsigned int &num_reads) {
+  auto status = FILE_STATUS_MOREDATA;
+  num_reads   = 0;
+
+  while (FILE_STATUS_MOREDATA == status) {
+    status = ptzr.read();
+    ++num_reads;
+  }
+
+  return status;
+}
+
+TEST(ReaderThread, ProcessesPacketsOnCallingThread) {
+  fake_reader_c reader{100};
+  auto ptzr = add_fake_packetizer(reader);
+
+  reader.m_reader_thread.reset(new reader_thread_c{reader, 4});
+  reader.m_reader_thread->start();
+
+  auto num_reads = 0u;
+  EXPECT_EQ(FILE_STATUS_DONE, read_all(*ptzr, num_reads));
+  EXPECT_EQ(101u, num_reads);
+
+  reader.m_reader_thread.reset();
+
+  EXPECT_NE(std::this_thread::get_id(), reader.m_read_thread_id);
+  EXPECT_TRUE(ptzr->m_flushed);
+
+  ASSERT_EQ(100u, ptzr->m_values.size());
+  for (auto idx = 0u; idx < 100; ++idx)
+    EXPECT_EQ(100 - idx, ptzr->m_values[idx]);
+
+  for (auto const &thread_id : ptzr->m_thread_ids)
+    EXPECT_EQ(std::this_thread::get_id(), thread_id);
+}
+
+TEST(ReaderThread, SameResultsAsSequentialReading) {
+  fake_reader_c sequential_reader{50}, threaded_reader{50};
+  auto sequential_ptzr = add_fake_packetizer(sequential_reader);
+  auto threaded_ptzr   = add_fake_packetizer(threaded_reader);
+
+  threaded_reader.m_reader_thread.reset(new reader_thread_c{threaded_reader, 1});
+  threaded_reader.m_reader_thread->start();
+
+  auto sequential_num_reads = 0u, threaded_num_reads = 0u;
+  EXPECT_EQ(read_all(*sequential_ptzr, sequential_num_reads), read_all(*threaded_ptzr, threaded_num_reads));
+  EXPECT_EQ(sequential_num_reads, threaded_num_reads);
+  EXPECT_EQ(sequential_ptzr->m_values, threaded_ptzr->m_values);
+  EXPECT_EQ(std::this_thread::get_id(), sequential_reader.m_read_thread_id);
+
+  // Reading after the end has been reached keeps reporting it.
+  EXPECT_EQ(FILE_STATUS_DONE, threaded_ptzr->read());
+}
+
+TEST(ReaderThread, ReportsErrorsOnCallingThread) {
+  fake_reader_c reader{100, 11};
+  auto ptzr = add_fake_packetizer(reader);
+
+  reader.m_reader_thread.reset(new reader_thread_c{reader, 4});
+  reader.m_reader_thread->start();
+
+  auto num_reads = 0u;
+  EXPECT_THROW(read_all(*ptzr, num_reads), mtxut::mxerror_x);
+  EXPECT_EQ(10u, ptzr->m_values.size());
+  EXPECT_FALSE(ptzr->m_flushed);
+}
+
+TEST(ReaderThread, StopsWhileWorkerWaits) {
+  fake_reader_c reader{1000};
+  auto ptzr = add_fake_packetizer(reader);
+
+  reader.m_reader_thread.reset(new reader_thread_c{reader, 2});
+  reader.m_reader_thread->start();
+
+  EXPECT_EQ(FILE_STATUS_MOREDATA, ptzr->read());
+  reader.m_reader_thread.reset();
+
+  EXPECT_EQ(1u, ptzr->m_values.size());
+}
+
+}
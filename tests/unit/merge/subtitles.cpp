@@ -0,0 +1,36 @@
+#include "common/common_pch.h"
+
+#include "input/subtitles.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(SrtParser, MatchTimecodeLine) {
+  int64_t start = 0, end = 0;
+
+  EXPECT_TRUE(srt_parser_c::match_timecode_line("00:01:02,345 --> 00:01:03.5", start, end));
+  EXPECT_EQ(62345000000ll, start);
+  EXPECT_EQ(63500000000ll, end);
+
+  EXPECT_TRUE(srt_parser_c::match_timecode_line(" 1:2:3,4  ->  01:02:05,000123", start, end));
+  EXPECT_EQ(3723400000000ll, start);
+  EXPECT_EQ(3725000123000ll, end);
+
+  EXPECT_TRUE(srt_parser_c::match_timecode_line("-00:00:01,000 --> 00:00:02,000", start, end));
+  EXPECT_EQ(-1000000000ll, start);
+  EXPECT_EQ(2000000000ll,  end);
+}
+
+TEST(SrtParser, MatchTimecodeLineRejectsWrongSeparators) {
+  int64_t start = 0, end = 0;
+
+  EXPECT_FALSE(srt_parser_c::match_timecode_line("00:00:01:500 --> 00:00:02:000", start, end));
+  EXPECT_FALSE(srt_parser_c::match_timecode_line("00:00:01,500 --> 00:00:02:000", start, end));
+  EXPECT_FALSE(srt_parser_c::match_timecode_line("00,00:01,500 --> 00:00:02,000", start, end));
+  EXPECT_FALSE(srt_parser_c::match_timecode_line("00:00.01,500 --> 00:00:02,000", start, end));
+  EXPECT_FALSE(srt_parser_c::match_timecode_line("00:00:01,500 --> 00:00:02",     start, end));
+  EXPECT_FALSE(srt_parser_c::match_timecode_line("00:00:01,500 00:00:02,000",     start, end));
+}
+
+}
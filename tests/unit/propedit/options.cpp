@@ -0,0 +1,36 @@
+#include "common/common_pch.h"
+
+#include "propedit/options.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Options, ParseBatchLineFileNameOnly) {
+  auto entry = options_c::parse_batch_line("movie.mkv");
+
+  EXPECT_EQ("movie.mkv", entry.m_file_name);
+  EXPECT_TRUE(entry.m_args.empty());
+}
+
+TEST(Options, ParseBatchLineWithArguments) {
+  auto entry = options_c::parse_batch_line("some movie.mkv\t--edit\ttrack:a1\t--set\tname=Director's comments");
+
+  EXPECT_EQ("some movie.mkv", entry.m_file_name);
+  ASSERT_EQ(4u, entry.m_args.size());
+  EXPECT_EQ("--edit",                   entry.m_args[0]);
+  EXPECT_EQ("track:a1",                 entry.m_args[1]);
+  EXPECT_EQ("--set",                    entry.m_args[2]);
+  EXPECT_EQ("name=Director's comments", entry.m_args[3]);
+}
+
+TEST(Options, ParseBatchLineSkipsEmptyArguments) {
+  auto entry = options_c::parse_batch_line("movie.mkv\t\t--edit\t\ttrack:v1");
+
+  EXPECT_EQ("movie.mkv", entry.m_file_name);
+  ASSERT_EQ(2u, entry.m_args.size());
+  EXPECT_EQ("--edit",   entry.m_args[0]);
+  EXPECT_EQ("track:v1", entry.m_args[1]);
+}
+
+}